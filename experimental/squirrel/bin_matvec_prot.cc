@@ -14,7 +14,9 @@
 
 #include "experimental/squirrel/bin_matvec_prot.h"
 
+#include <algorithm>
 #include <future>
+#include <iterator>
 
 #include "seal/seal.h"
 #include "seal/util/polyarithsmallmod.h"
@@ -52,6 +54,16 @@ int64_t GetRows(const StlSparseMatrix &mat) {
   return mat.rows();
 }
 
+template <>
+int64_t GetCols(const SparseBinMatrix &mat) {
+  return mat.cols();
+}
+
+template <>
+int64_t GetRows(const SparseBinMatrix &mat) {
+  return mat.rows();
+}
+
 void GenerateOneKSKey(seal::util::ConstRNSIter new_key,
                       const seal::SecretKey &secret_key,
                       const seal::SEALContext &context,
@@ -74,6 +86,13 @@ void LiftLWEDimension(const spu::mpc::cheetah::LWECt &src,
                       const seal::SEALContext &dst_context,
                       spu::mpc::cheetah::LWECt &dst);
 
+struct BinMatVecProtocol::EncryptedVector {
+  spu::Type eltype;
+  int64_t dim_in = 0;
+  // RLWE_n ciphertexts in the coefficient form, see A2hRecv().
+  std::vector<seal::Ciphertext> rlwes;
+};
+
 struct BinMatVecProtocol::Impl : public spu::mpc::cheetah::EnableCPRNG {
  public:
   static constexpr int64_t kCtAsyncParallel = 8;  // not to send too much aysnc
@@ -98,77 +117,182 @@ struct BinMatVecProtocol::Impl : public spu::mpc::cheetah::EnableCPRNG {
     auto field = ashare.eltype().as<spu::RingTy>()->field();
 
     // convert from AShare to HE ciphertext
-    A2hSend(ashare);
+    A2hSend(ashare, dim_in);
 
     // Wait result
     return H2aRecv(field, dim_out).as(ashare.eltype());
   }
 
+  spu::NdArrayRef BatchSend(const spu::NdArrayRef &fresh, int64_t num_vecs,
+                            int64_t dim_out, int64_t dim_in) {
+    if (num_vecs == 0 || dim_in == 0 || dim_out == 0) {
+      return spu::NdArrayRef(fresh.eltype(), {0});
+    }
+    auto field = fresh.eltype().as<spu::RingTy>()->field();
+
+    // No A2H when all the vectors are kept by the matrix holder.
+    A2hSend(fresh, dim_in);
+
+    return H2aRecv(field, num_vecs * dim_out).as(fresh.eltype());
+  }
+
   template <class SparsMatType>
   spu::NdArrayRef Recv(const spu::NdArrayRef &ashare, int64_t dim_out,
                        int64_t dim_in, const SparsMatType &prv_bin_mat,
-                       absl::Span<const uint8_t> indicator) {
+                       absl::Span<const uint8_t> indicator,
+                       EncryptedVectorPtr *cached = nullptr) {
     int64_t n = ashare.numel();
     SPU_ENFORCE_EQ(n, dim_in);
+    auto encrypted = std::make_shared<EncryptedVector>();
+    encrypted->eltype = ashare.eltype();
+    encrypted->dim_in = dim_in;
     if (dim_in == 0 || dim_out == 0) {
+      if (cached != nullptr) {
+        *cached = std::move(encrypted);
+      }
       return spu::NdArrayRef(ashare.eltype(), {0});
     }
+    CheckMatrixShape(prv_bin_mat, dim_out, dim_in);
+    // Step 1: A2H
+    encrypted->rlwes.resize(
+        CeilDiv<size_t>(dim_in, poly_degree_in(ring_bitwidth_)));
+    A2hRecv(ashare, dim_in, absl::MakeSpan(encrypted->rlwes));
+
+    EncryptedVectorPtr vec = std::move(encrypted);
+    auto out = MatVec({&vec, 1}, dim_out, prv_bin_mat, {&indicator, 1});
+    if (cached != nullptr) {
+      *cached = std::move(vec);
+    }
+    return out;
+  }
+
+  template <class SparsMatType>
+  spu::NdArrayRef BatchRecv(
+      const spu::NdArrayRef &fresh, int64_t dim_out, int64_t dim_in,
+      const SparsMatType &prv_bin_mat,
+      absl::Span<const absl::Span<const uint8_t>> indicators,
+      absl::Span<EncryptedVectorPtr> vecs) {
+    const int64_t rlwes_per_vec =
+        CeilDiv<int64_t>(dim_in, poly_degree_in(ring_bitwidth_));
+    const int64_t num_fresh = dim_in == 0 ? 0 : fresh.numel() / dim_in;
+    std::vector<seal::Ciphertext> rlwes(num_fresh * rlwes_per_vec);
+    if (dim_in > 0 && dim_out > 0) {
+      CheckMatrixShape(prv_bin_mat, dim_out, dim_in);
+      // Step 1: A2H on all the fresh vectors at once
+      A2hRecv(fresh, dim_in, absl::MakeSpan(rlwes));
+    }
+
+    auto next = rlwes.begin();
+    for (auto &vec : vecs) {
+      if (vec != nullptr) {
+        SPU_ENFORCE_EQ(vec->dim_in, dim_in);
+        continue;
+      }
+      auto encrypted = std::make_shared<EncryptedVector>();
+      encrypted->eltype = fresh.eltype();
+      encrypted->dim_in = dim_in;
+      encrypted->rlwes.assign(std::make_move_iterator(next),
+                              std::make_move_iterator(next + rlwes_per_vec));
+      next += rlwes_per_vec;
+      vec = std::move(encrypted);
+    }
+
+    if (vecs.empty() || dim_in == 0 || dim_out == 0) {
+      return spu::NdArrayRef(fresh.eltype(), {0});
+    }
+    return MatVec(vecs, dim_out, prv_bin_mat, indicators);
+  }
+
+  // Step 2 to 4 of Recv() on the vector that is already in the HE form.
+  template <class SparsMatType>
+  spu::NdArrayRef RecvCached(const EncryptedVectorPtr &encrypted,
+                             int64_t dim_out, const SparsMatType &prv_bin_mat,
+                             absl::Span<const uint8_t> indicator) {
+    if (encrypted->dim_in == 0 || dim_out == 0) {
+      return spu::NdArrayRef(encrypted->eltype, {0});
+    }
+    CheckMatrixShape(prv_bin_mat, dim_out, encrypted->dim_in);
+    return MatVec({&encrypted, 1}, dim_out, prv_bin_mat, {&indicator, 1});
+  }
+
+  spu::NdArrayRef SendCached(const spu::Type &eltype, int64_t dim_out) {
+    if (dim_out == 0) {
+      return spu::NdArrayRef(eltype, {0});
+    }
+    auto field = eltype.as<spu::RingTy>()->field();
+    return H2aRecv(field, dim_out).as(eltype);
+  }
+
+ private:
+  template <class SparsMatType>
+  static void CheckMatrixShape(const SparsMatType &prv_bin_mat,
+                               int64_t dim_out, int64_t dim_in) {
     int64_t cols = GetCols(prv_bin_mat);
     int64_t rows = GetRows(prv_bin_mat);
     SPU_ENFORCE_EQ(cols, dim_in, "dim_in mismatch, expected={}, got = {}", cols,
                    dim_in);
     SPU_ENFORCE_EQ(rows, dim_out, "dim_out mismatch, expected={}, got={}", rows,
                    dim_out);
-    auto field = ashare.eltype().as<spu::RingTy>()->field();
-    // Step 1: A2H
-    std::vector<seal::Ciphertext> rlwe_cipers(
-        CeilDiv<size_t>(dim_in, poly_degree_in(ring_bitwidth_)));
-    A2hRecv(ashare, absl::MakeSpan(rlwe_cipers));
+  }
 
-#if ENABLE_CACHED_RLWE
-    // TODO(lwj): implement the AVX acceleration
-    using CtType = spu::mpc::cheetah::CachedRLWECt;
-    const auto &in_context = *(in_cntxts_.find(ring_)->second);
-    std::vector<CtType> cached_rlwe_ciphers(rlwe_cipers.size());
-    yacl::parallel_for(
-        0, rlwe_cipers.size(), kParallelStride, [&](size_t bgn, size_t end) {
-          for (size_t i = bgn; i < end; ++i) {
-            cached_rlwe_ciphers[i].CacheIt(rlwe_cipers[i], in_context);
-          }
-        });
-    absl::Span<const CtType> hshare = absl::MakeSpan(cached_rlwe_ciphers);
-#else
-    using CtType = seal::Ciphertext;
-    absl::Span<const CtType> hshare = absl::MakeSpan(rlwe_cipers);
-#endif
+  // The outputs of all the vectors are stacked, so that they are packed and
+  // reshared together.
+  template <class SparsMatType>
+  spu::NdArrayRef MatVec(
+      absl::Span<const EncryptedVectorPtr> vecs, int64_t dim_out,
+      const SparsMatType &prv_bin_mat,
+      absl::Span<const absl::Span<const uint8_t>> indicators) {
+    SPU_ENFORCE(!vecs.empty());
+    SPU_ENFORCE_EQ(vecs.size(), indicators.size());
+    const auto &eltype = vecs.front()->eltype;
+    auto field = eltype.as<spu::RingTy>()->field();
+    const int64_t total_out = dim_out * static_cast<int64_t>(vecs.size());
 
     // Step 2: Extract-then-Add
     size_t num_lwes = 0;
-    if (dim_out <= static_cast<int64_t>(poly_degree_out(ring_bitwidth_))) {
-      num_lwes = absl::bit_ceil(static_cast<size_t>(dim_out));
+    if (total_out <= static_cast<int64_t>(poly_degree_out(ring_bitwidth_))) {
+      num_lwes = absl::bit_ceil(static_cast<size_t>(total_out));
     } else {
       // NOTE: we find the smallest `d` such that
-      //       dim_out <= k*poly_degree_out + 2^d
-      size_t floor = absl::bit_floor(static_cast<size_t>(dim_out));
-      size_t margin = dim_out - floor;
+      //       total_out <= k*poly_degree_out + 2^d
+      size_t floor = absl::bit_floor(static_cast<size_t>(total_out));
+      size_t margin = total_out - floor;
       num_lwes = floor;
       if (margin > 0) {
         num_lwes += absl::bit_ceil(margin);
       }
     }
     std::vector<spu::mpc::cheetah::LWECt> lwes(num_lwes);
-    doBinMatVec<CtType>(field, prv_bin_mat, hshare, indicator,
-                        {lwes.data(), static_cast<size_t>(dim_out)});
+    for (size_t k = 0; k < vecs.size(); ++k) {
+      const auto &rlwe_cipers = vecs[k]->rlwes;
+#if ENABLE_CACHED_RLWE
+      // TODO(lwj): implement the AVX acceleration
+      using CtType = spu::mpc::cheetah::CachedRLWECt;
+      const auto &in_context = *(in_cntxts_.find(ring_)->second);
+      std::vector<CtType> cached_rlwe_ciphers(rlwe_cipers.size());
+      yacl::parallel_for(
+          0, rlwe_cipers.size(), kParallelStride, [&](size_t bgn, size_t end) {
+            for (size_t i = bgn; i < end; ++i) {
+              cached_rlwe_ciphers[i].CacheIt(rlwe_cipers[i], in_context);
+            }
+          });
+      absl::Span<const CtType> hshare = absl::MakeSpan(cached_rlwe_ciphers);
+#else
+      using CtType = seal::Ciphertext;
+      absl::Span<const CtType> hshare = absl::MakeConstSpan(rlwe_cipers);
+#endif
+      doBinMatVec<CtType>(
+          field, prv_bin_mat, hshare, indicators[k],
+          {lwes.data() + k * dim_out, static_cast<size_t>(dim_out)});
+    }
     // Step 3: Pack LWEs as RLWEs
     std::vector<seal::Ciphertext> packed_lwes =
         doPackLWEs(field, absl::MakeSpan(lwes));
 
     // Step 4: reshare via H2A
-    return H2aSend(field, dim_out, absl::MakeSpan(packed_lwes))
-        .as(ashare.eltype());
+    return H2aSend(field, total_out, absl::MakeSpan(packed_lwes)).as(eltype);
   }
 
- private:
   constexpr size_t poly_degree_in(size_t ring_bitlen) const {
     if (ring_bitlen <= 32) {
       return 4096;
@@ -249,15 +373,14 @@ struct BinMatVecProtocol::Impl : public spu::mpc::cheetah::EnableCPRNG {
 
     auto pick_then_sum = [&](size_t row_start, size_t row_util) {
       for (size_t row = row_start; row < row_util; ++row) {
-        for (auto col_iter = matrix.iterate_row_begin(row);
-             col_iter != matrix.iterate_row_end(row); ++col_iter) {
-          SPU_ENFORCE(*col_iter < dim_in);
-          if (not indicator.empty() and 0 == indicator[*col_iter]) {
-            continue;
+        matrix.ForEachInRow(row, [&](size_t col) {
+          SPU_ENFORCE(col < dim_in);
+          if (not indicator.empty() and 0 == indicator[col]) {
+            return;
           }
-          auto loc = mapper.MapToLoc(*col_iter);
+          auto loc = mapper.MapToLoc(col);
           outp[row].AddLazyInplace(vec[loc[0]], loc[1], context);
-        }
+        });
 
         if (!outp[row].IsValid()) {
           // empty LWE
@@ -269,9 +392,10 @@ struct BinMatVecProtocol::Impl : public spu::mpc::cheetah::EnableCPRNG {
     yacl::parallel_for(0, dim_out, pick_then_sum);
   }
 
-  void A2hSend(const spu::NdArrayRef &ashare);
+  // `ashare` stacks vectors of `vec_len`, each encrypted into its own RLWEs.
+  void A2hSend(const spu::NdArrayRef &ashare, int64_t vec_len);
 
-  void A2hRecv(const spu::NdArrayRef &ashare,
+  void A2hRecv(const spu::NdArrayRef &ashare, int64_t vec_len,
                absl::Span<seal::Ciphertext> hshare);
 
   spu::NdArrayRef H2aSend(spu::FieldType field, int64_t len,
@@ -639,14 +763,17 @@ spu::NdArrayRef BinMatVecProtocol::Impl::DecodePolyToVector(
   return ret;
 }
 
-void BinMatVecProtocol::Impl::A2hSend(const spu::NdArrayRef &ashare) {
+void BinMatVecProtocol::Impl::A2hSend(const spu::NdArrayRef &ashare,
+                                      int64_t vec_len) {
   int64_t n = ashare.numel();
   if (n == 0) {
     return;
   }
+  SPU_ENFORCE(vec_len > 0 && n % vec_len == 0, "n={} vec_len={}", n, vec_len);
 
   int64_t poly_deg_n = poly_degree_in(ring_bitwidth_);
-  int64_t num_rlwes = CeilDiv(n, poly_deg_n);
+  int64_t rlwes_per_vec = CeilDiv(vec_len, poly_deg_n);
+  int64_t num_rlwes = (n / vec_len) * rlwes_per_vec;
 
   const auto &context = *in_context_;
   const auto &rlwe_sk = *in_skey_;
@@ -660,8 +787,9 @@ void BinMatVecProtocol::Impl::A2hSend(const spu::NdArrayRef &ashare) {
     seal::Plaintext pt;
     seal::Ciphertext ct;
     for (int64_t i = start; i < until; ++i) {
-      int64_t bgn = i * poly_deg_n;
-      int64_t end = std::min(bgn + poly_deg_n, n);
+      int64_t vec_bgn = (i / rlwes_per_vec) * vec_len;
+      int64_t bgn = vec_bgn + (i % rlwes_per_vec) * poly_deg_n;
+      int64_t end = std::min(bgn + poly_deg_n, vec_bgn + vec_len);
       EncodeVectorToPoly(ashare.slice({bgn}, {end}, {1}), vencoder, pt);
       spu::mpc::cheetah::SymmetricRLWEEncrypt(rlwe_sk, context, {&pt, 1}, ntt,
                                               save_seed, {&ct, 1});
@@ -692,14 +820,17 @@ void BinMatVecProtocol::Impl::A2hSend(const spu::NdArrayRef &ashare) {
 }
 
 void BinMatVecProtocol::Impl::A2hRecv(const spu::NdArrayRef &ashare,
+                                      int64_t vec_len,
                                       absl::Span<seal::Ciphertext> hshare) {
   int64_t n = ashare.numel();
   if (n == 0) {
     return;
   }
+  SPU_ENFORCE(vec_len > 0 && n % vec_len == 0, "n={} vec_len={}", n, vec_len);
 
   int64_t poly_deg_n = poly_degree_in(ring_bitwidth_);
-  int64_t num_rlwes = CeilDiv(n, poly_deg_n);
+  int64_t rlwes_per_vec = CeilDiv(vec_len, poly_deg_n);
+  int64_t num_rlwes = (n / vec_len) * rlwes_per_vec;
   SPU_ENFORCE_EQ(num_rlwes, (int64_t)hshare.size(), "expected={} got={}",
                  num_rlwes, hshare.size());
 
@@ -719,8 +850,9 @@ void BinMatVecProtocol::Impl::A2hRecv(const spu::NdArrayRef &ashare,
   auto ecd_callback = [&](int64_t start, int64_t until) {
     using namespace spu::mpc;
     for (int64_t i = start; i < until; ++i) {
-      int64_t bgn = i * poly_deg_n;
-      int64_t end = std::min(bgn + poly_deg_n, n);
+      int64_t vec_bgn = (i / rlwes_per_vec) * vec_len;
+      int64_t bgn = vec_bgn + (i % rlwes_per_vec) * poly_deg_n;
+      int64_t end = std::min(bgn + poly_deg_n, vec_bgn + vec_len);
       EncodeVectorToPoly(ashare.slice({bgn}, {end}, {1}), vencoder, polys[i]);
     }
   };
@@ -758,10 +890,11 @@ spu::NdArrayRef BinMatVecProtocol::Send(const spu::NdArrayRef &vec_in,
   return impl_->Send(vec_in, dim_out, dim_in);
 }
 
-spu::NdArrayRef BinMatVecProtocol::Recv(const spu::NdArrayRef &vec_in,
-                                        int64_t dim_out, int64_t dim_in,
-                                        const StlSparseMatrix &prv_bin_mat,
-                                        absl::Span<const uint8_t> indicator) {
+namespace {
+
+void CheckRecvInputs(const spu::NdArrayRef &vec_in, int64_t dim_in,
+                     size_t ring_bitwidth,
+                     absl::Span<const uint8_t> indicator) {
   SPU_ENFORCE_EQ(vec_in.shape().ndim(), 1L);
   SPU_ENFORCE_EQ(vec_in.numel(), dim_in);
   if (not indicator.empty()) {
@@ -773,10 +906,102 @@ spu::NdArrayRef BinMatVecProtocol::Recv(const spu::NdArrayRef &vec_in,
 
   auto eltype = vec_in.eltype();
   SPU_ENFORCE(eltype.isa<spu::RingTy>());
-  SPU_ENFORCE_EQ(ring_bitwidth_, SizeOf(eltype.as<spu::RingTy>()->field()) * 8);
+  SPU_ENFORCE_EQ(ring_bitwidth, SizeOf(eltype.as<spu::RingTy>()->field()) * 8);
+}
+
+}  // namespace
+
+spu::NdArrayRef BinMatVecProtocol::Recv(const spu::NdArrayRef &vec_in,
+                                        int64_t dim_out, int64_t dim_in,
+                                        const StlSparseMatrix &prv_bin_mat,
+                                        absl::Span<const uint8_t> indicator) {
+  CheckRecvInputs(vec_in, dim_in, ring_bitwidth_, indicator);
+  return impl_->Recv(vec_in, dim_out, dim_in, prv_bin_mat, indicator);
+}
+
+spu::NdArrayRef BinMatVecProtocol::Recv(const spu::NdArrayRef &vec_in,
+                                        int64_t dim_out, int64_t dim_in,
+                                        const SparseBinMatrix &prv_bin_mat,
+                                        absl::Span<const uint8_t> indicator) {
+  CheckRecvInputs(vec_in, dim_in, ring_bitwidth_, indicator);
   return impl_->Recv(vec_in, dim_out, dim_in, prv_bin_mat, indicator);
 }
 
+spu::NdArrayRef BinMatVecProtocol::RecvAndCache(
+    const spu::NdArrayRef &vec_in, int64_t dim_out, int64_t dim_in,
+    const SparseBinMatrix &prv_bin_mat, absl::Span<const uint8_t> indicator,
+    EncryptedVectorPtr *cached) {
+  SPU_ENFORCE(cached != nullptr);
+  CheckRecvInputs(vec_in, dim_in, ring_bitwidth_, indicator);
+  return impl_->Recv(vec_in, dim_out, dim_in, prv_bin_mat, indicator, cached);
+}
+
+spu::NdArrayRef BinMatVecProtocol::RecvCached(
+    const EncryptedVectorPtr &cached, int64_t dim_out,
+    const SparseBinMatrix &prv_bin_mat, absl::Span<const uint8_t> indicator) {
+  SPU_ENFORCE(cached != nullptr, "no cached vector");
+  SPU_ENFORCE(indicator.empty() || (int64_t)indicator.size() == cached->dim_in,
+              "indicator size mismatch, expected={}, got={}", cached->dim_in,
+              indicator.size());
+  if (not indicator.empty()) {
+    SPU_ENFORCE(std::any_of(indicator.begin(), indicator.end(),
+                            [](uint8_t x) { return x > 0; }),
+                "empty matrix is not allowed");
+  }
+  return impl_->RecvCached(cached, dim_out, prv_bin_mat, indicator);
+}
+
+spu::NdArrayRef BinMatVecProtocol::SendCached(const spu::Type &eltype,
+                                              int64_t dim_out) {
+  SPU_ENFORCE(eltype.isa<spu::RingTy>());
+  SPU_ENFORCE_EQ(ring_bitwidth_,
+                 spu::SizeOf(eltype.as<spu::RingTy>()->field()) * 8);
+  return impl_->SendCached(eltype, dim_out);
+}
+
+spu::NdArrayRef BinMatVecProtocol::BatchSend(const spu::NdArrayRef &fresh_vecs,
+                                             int64_t num_vecs, int64_t dim_out,
+                                             int64_t dim_in) {
+  auto eltype = fresh_vecs.eltype();
+  SPU_ENFORCE(eltype.isa<spu::RingTy>());
+  SPU_ENFORCE_EQ(ring_bitwidth_,
+                 spu::SizeOf(eltype.as<spu::RingTy>()->field()) * 8);
+  SPU_ENFORCE(dim_in > 0 && fresh_vecs.numel() % dim_in == 0 &&
+                  fresh_vecs.numel() / dim_in <= num_vecs,
+              "invalid {} fresh elements of {} vectors, dim_in={}",
+              fresh_vecs.numel(), num_vecs, dim_in);
+  return impl_->BatchSend(fresh_vecs.reshape({fresh_vecs.numel()}), num_vecs,
+                          dim_out, dim_in);
+}
+
+spu::NdArrayRef BinMatVecProtocol::BatchRecv(
+    const spu::NdArrayRef &fresh_vecs, int64_t dim_out, int64_t dim_in,
+    const SparseBinMatrix &prv_bin_mat,
+    absl::Span<const absl::Span<const uint8_t>> indicators,
+    absl::Span<EncryptedVectorPtr> vecs) {
+  auto eltype = fresh_vecs.eltype();
+  SPU_ENFORCE(eltype.isa<spu::RingTy>());
+  SPU_ENFORCE_EQ(ring_bitwidth_,
+                 spu::SizeOf(eltype.as<spu::RingTy>()->field()) * 8);
+  SPU_ENFORCE_EQ(indicators.size(), vecs.size());
+  auto num_fresh = std::count(vecs.begin(), vecs.end(), nullptr);
+  SPU_ENFORCE(dim_in > 0 && fresh_vecs.numel() == num_fresh * dim_in,
+              "expect {} fresh vectors of dim_in={}, got {} elements",
+              num_fresh, dim_in, fresh_vecs.numel());
+  for (const auto &indicator : indicators) {
+    SPU_ENFORCE(indicator.empty() || (int64_t)indicator.size() == dim_in,
+                "indicator size mismatch, expected={}, got={}", dim_in,
+                indicator.size());
+    if (not indicator.empty()) {
+      SPU_ENFORCE(std::any_of(indicator.begin(), indicator.end(),
+                              [](uint8_t x) { return x > 0; }),
+                  "empty matrix is not allowed");
+    }
+  }
+  return impl_->BatchRecv(fresh_vecs.reshape({fresh_vecs.numel()}), dim_out,
+                          dim_in, prv_bin_mat, indicators, vecs);
+}
+
 void GenerateLWEKeySwitchKey(const seal::SecretKey &src_key,
                              const seal::SecretKey &dst_key,
                              const seal::SEALContext &src_context,
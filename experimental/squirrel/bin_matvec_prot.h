@@ -14,9 +14,11 @@
 
 #pragma once
 #include <iterator>
+#include <memory>
 #include <unordered_set>
 
 #include "Eigen/Sparse"
+#include "experimental/squirrel/sparse_bin_matrix.h"
 
 #include "libspu/core/context.h"
 #include "libspu/core/value.h"
@@ -54,6 +56,13 @@ struct StlSparseMatrix {
 
   auto iterate_row_end(size_t row) const { return rows_data_.at(row).cend(); }
 
+  template <typename Fn>
+  void ForEachInRow(int64_t row, Fn&& fn) const {
+    for (size_t col : rows_data_.at(row)) {
+      fn(col);
+    }
+  }
+
   int64_t cols_ = 0;
   std::vector<SparseRow> rows_data_;
 };
@@ -110,6 +119,53 @@ class BinMatVecProtocol {
                        int64_t dim_in, const StlSparseMatrix& priv_bin_mat,
                        absl::Span<const uint8_t> indicator);
 
+  // Same as above, but with the matrix in the compact CSR/bitmap layout.
+  spu::NdArrayRef Recv(const spu::NdArrayRef& vec_in, int64_t dim_out,
+                       int64_t dim_in, const SparseBinMatrix& priv_bin_mat,
+                       absl::Span<const uint8_t> indicator = {});
+
+  // The vector (v0 + v1) in the HE form, kept by the matrix holder.
+  // It takes about 2 * 8 * #primes bytes per element.
+  struct EncryptedVector;
+  using EncryptedVectorPtr = std::shared_ptr<const EncryptedVector>;
+
+  // Same as Recv() but also keeps the encrypted vector in `cached`, so that
+  // it can be multiplied again via RecvCached() without the A2H.
+  spu::NdArrayRef RecvAndCache(const spu::NdArrayRef& vec_in, int64_t dim_out,
+                               int64_t dim_in,
+                               const SparseBinMatrix& priv_bin_mat,
+                               absl::Span<const uint8_t> indicator,
+                               EncryptedVectorPtr* cached);
+
+  // Compute (BinMat * diag(indicator)) * vec on a vector cached by
+  // RecvAndCache(). The vector holder calls SendCached() at the same time,
+  // which only receives the output shares.
+  spu::NdArrayRef RecvCached(const EncryptedVectorPtr& cached, int64_t dim_out,
+                             const SparseBinMatrix& priv_bin_mat,
+                             absl::Span<const uint8_t> indicator = {});
+
+  spu::NdArrayRef SendCached(const spu::Type& eltype, int64_t dim_out);
+
+  // Batched mat-vec of one matrix with several vectors, e.g., the gradients
+  // on several tree nodes. The i-th output is
+  //   (BinMat * diag(indicators[i])) * vec_i
+  // and the outputs are stacked in the shape (#vectors * dim_out,). All the
+  // vectors go through one A2H, one PackLWEs and one H2A.
+  //
+  // The matrix holder keeps the vectors in the HE form in `vecs`. The null
+  // entries of `vecs` take the rows of `fresh_vecs`, a (#nulls * dim_in,)
+  // array, in order and are set after the call. The vector holder calls
+  // BatchSend() with its shares of the same rows at the same time.
+  spu::NdArrayRef BatchSend(const spu::NdArrayRef& fresh_vecs,
+                            int64_t num_vecs, int64_t dim_out,
+                            int64_t dim_in);
+
+  spu::NdArrayRef BatchRecv(
+      const spu::NdArrayRef& fresh_vecs, int64_t dim_out, int64_t dim_in,
+      const SparseBinMatrix& priv_bin_mat,
+      absl::Span<const absl::Span<const uint8_t>> indicators,
+      absl::Span<EncryptedVectorPtr> vecs);
+
  private:
   size_t ring_bitwidth_;
   struct Impl;
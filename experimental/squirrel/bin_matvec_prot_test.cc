@@ -172,4 +172,205 @@ TEST_P(BinMatVecProtTest, WithIndicator) {
     }
   });
 }
+
+TEST_P(BinMatVecProtTest, SparseBinMatrix) {
+  using namespace spu;
+  using namespace spu::mpc;
+  constexpr size_t kWorldSize = 2;
+
+  FieldType field = std::get<0>(GetParam());
+  int64_t dim_in = std::get<0>(std::get<1>(GetParam()));
+  int64_t dim_out = std::get<1>(std::get<1>(GetParam()));
+
+  StlSparseMatrix mat;
+  PrepareBinaryMat(mat, dim_out, dim_in, 0);
+  std::vector<std::vector<uint32_t>> rows(dim_out);
+  for (int64_t r = 0; r < dim_out; ++r) {
+    rows[r].assign(mat.iterate_row_begin(r), mat.iterate_row_end(r));
+  }
+  auto csr_mat = SparseBinMatrix::Initialize(rows, dim_in);
+
+  NdArrayRef vec_shr[2];
+  vec_shr[0] = ring_rand(field, {dim_in})
+                   .as(spu::makeType<spu::mpc::cheetah::AShrTy>(field));
+  vec_shr[1] = ring_rand(field, {dim_in})
+                   .as(spu::makeType<spu::mpc::cheetah::AShrTy>(field));
+
+  NdArrayRef vec = ring_add(vec_shr[0], vec_shr[1]);
+
+  NdArrayRef out_shr[2];
+  utils::simulate(kWorldSize, [&](std::shared_ptr<yacl::link::Context> lctx) {
+    BinMatVecProtocol binmat_prot(SizeOf(field) * 8, lctx);
+    if (0 == lctx->Rank()) {
+      out_shr[0] = binmat_prot.Send(vec_shr[0], dim_out, dim_in);
+    } else {
+      out_shr[1] = binmat_prot.Recv(vec_shr[1], dim_out, dim_in, csr_mat);
+    }
+  });
+  NdArrayRef reveal = ring_add(out_shr[0], out_shr[1]);
+
+  DISPATCH_ALL_FIELDS(field, "", [&]() {
+    NdArrayView<ring2k_t> _vec(vec);
+    auto expected = BinAccumuate<ring2k_t>(_vec, mat);
+    NdArrayView<ring2k_t> got(reveal);
+
+    EXPECT_EQ(expected.size(), (size_t)got.numel());
+    for (int64_t i = 0; i < dim_out; ++i) {
+      EXPECT_NEAR(expected[i], got[i], 1);
+    }
+  });
+}
+
+TEST_P(BinMatVecProtTest, CachedVector) {
+  using namespace spu;
+  using namespace spu::mpc;
+  constexpr size_t kWorldSize = 2;
+
+  FieldType field = std::get<0>(GetParam());
+  int64_t dim_in = std::get<0>(std::get<1>(GetParam()));
+  int64_t dim_out = std::get<1>(std::get<1>(GetParam()));
+
+  StlSparseMatrix mat;
+  PrepareBinaryMat(mat, dim_out, dim_in, 0);
+  std::vector<std::vector<uint32_t>> rows(dim_out);
+  for (int64_t r = 0; r < dim_out; ++r) {
+    rows[r].assign(mat.iterate_row_begin(r), mat.iterate_row_end(r));
+  }
+  auto csr_mat = SparseBinMatrix::Initialize(rows, dim_in);
+
+  NdArrayRef vec_shr[2];
+  vec_shr[0] = ring_rand(field, {dim_in})
+                   .as(spu::makeType<spu::mpc::cheetah::AShrTy>(field));
+  vec_shr[1] = ring_rand(field, {dim_in})
+                   .as(spu::makeType<spu::mpc::cheetah::AShrTy>(field));
+  NdArrayRef vec = ring_add(vec_shr[0], vec_shr[1]);
+
+  // The second indicator is a subset of the first one, as the children of
+  // a split node in the XGB training.
+  std::vector<uint8_t> indicators[2];
+  indicators[0].resize(dim_in);
+  indicators[1].resize(dim_in);
+  std::default_random_engine rdv;
+  std::uniform_int_distribution<uint8_t> dist(0, 10);
+  for (int64_t i = 0; i < dim_in; ++i) {
+    indicators[0][i] = dist(rdv) > 2;
+    indicators[1][i] = indicators[0][i] & (dist(rdv) > 5);
+  }
+  indicators[1][0] = indicators[0][0] = 1;
+
+  NdArrayRef out_shr[2][2];
+  utils::simulate(kWorldSize, [&](std::shared_ptr<yacl::link::Context> lctx) {
+    BinMatVecProtocol binmat_prot(SizeOf(field) * 8, lctx);
+    int rank = lctx->Rank();
+    if (0 == rank) {
+      out_shr[0][rank] = binmat_prot.Send(vec_shr[0], dim_out, dim_in);
+      out_shr[1][rank] = binmat_prot.SendCached(vec_shr[0].eltype(), dim_out);
+      return;
+    }
+    BinMatVecProtocol::EncryptedVectorPtr cached;
+    out_shr[0][rank] = binmat_prot.RecvAndCache(
+        vec_shr[1], dim_out, dim_in, csr_mat,
+        absl::MakeConstSpan(indicators[0]), &cached);
+    out_shr[1][rank] = binmat_prot.RecvCached(
+        cached, dim_out, csr_mat, absl::MakeConstSpan(indicators[1]));
+  });
+
+  for (int k : {0, 1}) {
+    NdArrayRef reveal = ring_add(out_shr[k][0], out_shr[k][1]);
+    DISPATCH_ALL_FIELDS(field, "", [&]() {
+      NdArrayView<ring2k_t> _vec(vec);
+      auto expected = BinAccumuate<ring2k_t>(
+          _vec, mat, absl::MakeConstSpan(indicators[k]));
+      NdArrayView<ring2k_t> got(reveal);
+
+      EXPECT_EQ(expected.size(), (size_t)got.numel());
+      for (int64_t i = 0; i < dim_out; ++i) {
+        EXPECT_NEAR(expected[i], got[i], 1);
+      }
+    });
+  }
+}
+
+TEST_P(BinMatVecProtTest, BatchedVectors) {
+  using namespace spu;
+  using namespace spu::mpc;
+  constexpr size_t kWorldSize = 2;
+  constexpr int kNumVecs = 3;
+
+  FieldType field = std::get<0>(GetParam());
+  int64_t dim_in = std::get<0>(std::get<1>(GetParam()));
+  int64_t dim_out = std::get<1>(std::get<1>(GetParam()));
+
+  StlSparseMatrix mat;
+  PrepareBinaryMat(mat, dim_out, dim_in, 0);
+  std::vector<std::vector<uint32_t>> rows(dim_out);
+  for (int64_t r = 0; r < dim_out; ++r) {
+    rows[r].assign(mat.iterate_row_begin(r), mat.iterate_row_end(r));
+  }
+  auto csr_mat = SparseBinMatrix::Initialize(rows, dim_in);
+
+  auto ashr_ty = spu::makeType<spu::mpc::cheetah::AShrTy>(field);
+  NdArrayRef vec_shr[kNumVecs][2];
+  NdArrayRef vec[kNumVecs];
+  for (int k = 0; k < kNumVecs; ++k) {
+    vec_shr[k][0] = ring_rand(field, {dim_in}).as(ashr_ty);
+    vec_shr[k][1] = ring_rand(field, {dim_in}).as(ashr_ty);
+    vec[k] = ring_add(vec_shr[k][0], vec_shr[k][1]);
+  }
+
+  // The last vector takes all the samples.
+  std::vector<uint8_t> indicators[kNumVecs];
+  std::default_random_engine rdv;
+  std::uniform_int_distribution<uint8_t> dist(0, 10);
+  for (int k = 0; k + 1 < kNumVecs; ++k) {
+    indicators[k].resize(dim_in);
+    for (int64_t i = 0; i < dim_in; ++i) {
+      indicators[k][i] = dist(rdv) > 4;
+    }
+    indicators[k][0] = 1;
+  }
+
+  // The 0-th vector is cached by a previous mat-vec, and the others are sent
+  // together in the batch.
+  NdArrayRef out_shr[2];
+  utils::simulate(kWorldSize, [&](std::shared_ptr<yacl::link::Context> lctx) {
+    BinMatVecProtocol binmat_prot(SizeOf(field) * 8, lctx);
+    int rank = lctx->Rank();
+    NdArrayRef fresh = vec_shr[1][rank].concatenate({vec_shr[2][rank]}, 0);
+    if (0 == rank) {
+      binmat_prot.Send(vec_shr[0][rank], dim_out, dim_in);
+      out_shr[rank] = binmat_prot.BatchSend(fresh, kNumVecs, dim_out, dim_in);
+      return;
+    }
+    std::vector<BinMatVecProtocol::EncryptedVectorPtr> vecs(kNumVecs);
+    binmat_prot.RecvAndCache(vec_shr[0][rank], dim_out, dim_in, csr_mat,
+                             absl::MakeConstSpan(indicators[0]), &vecs[0]);
+    std::vector<absl::Span<const uint8_t>> inds;
+    for (const auto &indicator : indicators) {
+      inds.push_back(indicator);
+    }
+    out_shr[rank] = binmat_prot.BatchRecv(fresh, dim_out, dim_in, csr_mat,
+                                          inds, absl::MakeSpan(vecs));
+    for (const auto &v : vecs) {
+      EXPECT_TRUE(v != nullptr);
+    }
+  });
+
+  NdArrayRef reveal = ring_add(out_shr[0], out_shr[1]);
+  ASSERT_EQ(reveal.numel(), kNumVecs * dim_out);
+  DISPATCH_ALL_FIELDS(field, "", [&]() {
+    NdArrayView<ring2k_t> got(reveal);
+    for (int k = 0; k < kNumVecs; ++k) {
+      NdArrayView<ring2k_t> _vec(vec[k]);
+      std::optional<absl::Span<const uint8_t>> indicator;
+      if (!indicators[k].empty()) {
+        indicator = absl::MakeConstSpan(indicators[k]);
+      }
+      auto expected = BinAccumuate<ring2k_t>(_vec, mat, indicator);
+      for (int64_t i = 0; i < dim_out; ++i) {
+        EXPECT_NEAR(expected[i], got[k * dim_out + i], 1);
+      }
+    }
+  });
+}
 }  // namespace squirrel::test
@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "xtensor/xsort.hpp"
+#include "yacl/utils/parallel.h"
 
 #include "libspu/core/prelude.h"
 
@@ -110,17 +111,122 @@ void Binning::Fit(const absl::Span<const double> x) {
   std::swap(bin_thresholds_, bin_thresholds);
 }
 
-std::vector<uint16_t> Binning::Transform(absl::Span<const double> x) {
-  size_t n = x.size();
-  std::vector<uint16_t> ret(n);
-  for (size_t i = 0; i < n; ++i) {
-    auto lower =
-        std::lower_bound(bin_thresholds_.begin(), bin_thresholds_.end(), x[i]);
-    // x(i) <= *lower
-    auto bin = std::distance(bin_thresholds_.begin(), lower);
-    ret[i] = static_cast<uint16_t>(bin);
+void Binning::Fit(const QuantileSketch& sketch) {
+  SPU_ENFORCE(sketch.count() > 0, "can not quantize empty input");
+  const uint64_t nsamples = sketch.count();
+  const size_t max_bins = nbuckets_;
+
+  // Values that are (almost) equal fall into one category.
+  std::vector<std::pair<double, uint64_t>> categories;
+  for (const auto& [v, w] : sketch.WeightedItems()) {
+    if (!categories.empty() && math_eq(v, categories.back().first)) {
+      categories.back().second += w;
+    } else {
+      categories.emplace_back(v, w);
+    }
+  }
+
+  std::vector<double> bin_thresholds;
+  if (categories.size() <= max_bins) {
+    // Use category as split point.
+    for (size_t i = 1; i < categories.size(); ++i) {
+      bin_thresholds.push_back(categories[i].first);
+    }
+  } else {
+    // Cut at the category that covers the expected rank, then spread the
+    // remaining samples evenly over the remaining bins. This follows the
+    // fast-skip path of Fit(x).
+    uint64_t expected_idx = CeilDiv<uint64_t>(nsamples, max_bins);
+    uint64_t rank = 0;  // rank of the first sample in categories[i]
+    for (size_t i = 0; i < categories.size(); ++i) {
+      uint64_t end = rank + categories[i].second;
+      if (i == 0 || end <= expected_idx) {
+        rank = end;
+        continue;
+      }
+      uint64_t idx = std::max(rank, expected_idx);
+      bin_thresholds.push_back(categories[i].first);
+      size_t nn = bin_thresholds.size();
+      if (nn + 1 == max_bins) {
+        break;
+      }
+      expected_idx = idx + CeilDiv<uint64_t>(nsamples - idx, max_bins - nn);
+      rank = end;
+    }
   }
+
+  // add `infty` for test samples that might larger than the train samples
+  bin_thresholds.push_back(std::numeric_limits<double>::infinity());
+
+  SPU_ENFORCE(bin_thresholds.size() <= nbuckets_);
+
+  std::swap(bin_thresholds_, bin_thresholds);
+}
+
+std::vector<uint16_t> Binning::Transform(absl::Span<const double> x) const {
+  std::vector<uint16_t> ret(x.size());
+  Transform(x.data(), /*stride*/ 1, absl::MakeSpan(ret));
   return ret;
 }
 
+void Binning::Transform(const double* x, size_t stride,
+                        absl::Span<uint16_t> out) const {
+  yacl::parallel_for(0, out.size(), [&](int64_t bgn, int64_t end) {
+    for (int64_t i = bgn; i < end; ++i) {
+      auto lower = std::lower_bound(bin_thresholds_.begin(),
+                                    bin_thresholds_.end(), x[i * stride]);
+      // x(i) <= *lower
+      auto bin = std::distance(bin_thresholds_.begin(), lower);
+      out[i] = static_cast<uint16_t>(bin);
+    }
+  });
+}
+
+StreamingBinning::StreamingBinning(size_t nfeatures, size_t nbuckets,
+                                   size_t sketch_k)
+    : nbuckets_(nbuckets) {
+  SPU_ENFORCE(nbuckets_ >= 3);
+  sketches_.reserve(nfeatures);
+  for (size_t f = 0; f < nfeatures; ++f) {
+    sketches_.emplace_back(sketch_k, /*seed*/ f);
+  }
+}
+
+void StreamingBinning::Update(const xt::xarray<double>& chunk) {
+  SPU_ENFORCE_EQ(chunk.dimension(), 2UL);
+  SPU_ENFORCE_EQ(chunk.shape()[1], sketches_.size());
+  const size_t nrows = chunk.shape()[0];
+  yacl::parallel_for(0, sketches_.size(), 1, [&](int64_t bgn, int64_t end) {
+    for (int64_t f = bgn; f < end; ++f) {
+      for (size_t i = 0; i < nrows; ++i) {
+        sketches_[f].Update(chunk(i, f));
+      }
+    }
+  });
+}
+
+void StreamingBinning::Merge(const StreamingBinning& other) {
+  SPU_ENFORCE_EQ(nbuckets_, other.nbuckets_);
+  SPU_ENFORCE_EQ(sketches_.size(), other.sketches_.size());
+  yacl::parallel_for(0, sketches_.size(), 1, [&](int64_t bgn, int64_t end) {
+    for (int64_t f = bgn; f < end; ++f) {
+      sketches_[f].Merge(other.sketches_[f]);
+    }
+  });
+}
+
+uint64_t StreamingBinning::count() const {
+  return sketches_.empty() ? 0 : sketches_[0].count();
+}
+
+std::vector<Binning> StreamingBinning::Finalize() const {
+  std::vector<Binning> binnings(sketches_.size(), Binning(nbuckets_));
+  yacl::parallel_for(0, sketches_.size(), 1, [&](int64_t bgn, int64_t end) {
+    for (int64_t f = bgn; f < end; ++f) {
+      binnings[f].Fit(sketches_[f]);
+    }
+  });
+  return binnings;
+}
+
 }  // namespace squirrel
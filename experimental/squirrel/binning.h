@@ -15,6 +15,7 @@
 #pragma once
 
 #include "absl/types/span.h"
+#include "experimental/squirrel/quantile_sketch.h"
 #include "xtensor/xarray.hpp"
 
 namespace squirrel {
@@ -42,12 +43,46 @@ class Binning {
   // The last bin indicates infty: bin_thresholds[-1] = infty
   void Fit(absl::Span<const double> x);
 
+  // Same as above but on the (approximated) sorted samples kept by a sketch.
+  // The thresholds are the same as Fit(x) when the sketch is exact and x has
+  // many distinct values.
+  void Fit(const QuantileSketch& sketch);
+
   // Missing values will be mapped to the last bin.
-  std::vector<uint16_t> Transform(absl::Span<const double> x);
+  std::vector<uint16_t> Transform(absl::Span<const double> x) const;
+
+  // Transform x[i * stride] for i in [0, out.size()).
+  void Transform(const double* x, size_t stride,
+                 absl::Span<uint16_t> out) const;
 
  private:
   size_t nbuckets_{0};
   std::vector<double> bin_thresholds_;
 };
 
+// Fit the binnings of many features from chunks of rows, using one quantile
+// sketch per feature. The features of a chunk are updated concurrently, and
+// the states of different data partitions can be merged.
+class StreamingBinning {
+ public:
+  StreamingBinning(size_t nfeatures, size_t nbuckets,
+                   size_t sketch_k = QuantileSketch::kDefaultK);
+
+  // chunk: nrows x nfeatures
+  void Update(const xt::xarray<double>& chunk);
+
+  void Merge(const StreamingBinning& other);
+
+  size_t nfeatures() const { return sketches_.size(); }
+
+  // Number of rows seen.
+  uint64_t count() const;
+
+  std::vector<Binning> Finalize() const;
+
+ private:
+  size_t nbuckets_;
+  std::vector<QuantileSketch> sketches_;
+};
+
 }  // namespace squirrel
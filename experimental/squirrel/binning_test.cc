@@ -123,4 +123,53 @@ TEST_F(BinningTest, LargerValue) {
     }
   }
 }
+
+TEST_F(BinningTest, Sketch) {
+  std::default_random_engine rdv;
+  std::uniform_real_distribution<double> uniform(-100., 100.);
+  for (size_t nsample : {777, 5000}) {
+    for (size_t nbuckets : {3, 16}) {
+      std::vector<double> x(nsample);
+      std::generate_n(x.data(), x.size(), [&]() { return uniform(rdv); });
+
+      // An exact sketch gives the same thresholds as the sorted samples.
+      Binning exact(nbuckets);
+      exact.Fit(absl::MakeConstSpan(x));
+      QuantileSketch sketch(/*k*/ 8192);
+      sketch.Update(x);
+      Binning approx(nbuckets);
+      approx.Fit(sketch);
+      EXPECT_EQ(exact.bin_thresholds(), approx.bin_thresholds());
+    }
+  }
+}
+
+TEST_F(BinningTest, Streaming) {
+  std::default_random_engine rdv;
+  std::uniform_real_distribution<double> uniform(-100., 100.);
+  size_t nfeatures = 3;
+  size_t nbuckets = 10;
+  size_t nrows = 1000;
+
+  StreamingBinning part0(nfeatures, nbuckets, /*sketch_k*/ 128);
+  StreamingBinning part1(nfeatures, nbuckets, /*sketch_k*/ 128);
+  for (size_t c = 0; c < 20; ++c) {
+    xt::xarray<double> chunk(std::vector<size_t>{nrows, nfeatures});
+    std::generate_n(chunk.data(), chunk.size(), [&]() { return uniform(rdv); });
+    (c % 2 == 0 ? part0 : part1).Update(chunk);
+  }
+  part0.Merge(part1);
+  EXPECT_EQ(part0.count(), 20 * nrows);
+
+  auto binnings = part0.Finalize();
+  ASSERT_EQ(binnings.size(), nfeatures);
+  for (const auto& bin : binnings) {
+    const auto& thresholds = bin.bin_thresholds();
+    ASSERT_EQ(thresholds.size(), nbuckets);
+    // About 10% of the samples in each bucket.
+    for (size_t i = 0; i + 1 < nbuckets; ++i) {
+      EXPECT_NEAR(thresholds[i], -100. + 20. * (i + 1), 8.);
+    }
+  }
+}
 }  // namespace squirrel::test
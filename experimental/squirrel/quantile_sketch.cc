@@ -0,0 +1,123 @@
+// Copyright 2024 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "experimental/squirrel/quantile_sketch.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "libspu/core/prelude.h"
+
+namespace squirrel {
+
+QuantileSketch::QuantileSketch(size_t k, uint64_t seed)
+    : k_(k), compactors_(1), rdv_(seed) {
+  SPU_ENFORCE(k_ >= 8, "k={} is too small", k_);
+}
+
+size_t QuantileSketch::Capacity(size_t level) const {
+  size_t depth = compactors_.size() - 1 - level;
+  double cap = std::ceil(k_ * std::pow(2. / 3., depth));
+  return std::max<size_t>(2, static_cast<size_t>(cap));
+}
+
+size_t QuantileSketch::size() const {
+  size_t n = 0;
+  for (const auto& c : compactors_) {
+    n += c.size();
+  }
+  return n;
+}
+
+void QuantileSketch::Update(double x) {
+  compactors_[0].push_back(x);
+  ++count_;
+  if (compactors_[0].size() >= Capacity(0)) {
+    Compress();
+  }
+}
+
+void QuantileSketch::Update(absl::Span<const double> xs) {
+  for (double x : xs) {
+    Update(x);
+  }
+}
+
+void QuantileSketch::Merge(const QuantileSketch& other) {
+  SPU_ENFORCE_EQ(k_, other.k_, "can not merge sketches of different k");
+  if (compactors_.size() < other.compactors_.size()) {
+    compactors_.resize(other.compactors_.size());
+  }
+  for (size_t h = 0; h < other.compactors_.size(); ++h) {
+    const auto& src = other.compactors_[h];
+    compactors_[h].insert(compactors_[h].end(), src.begin(), src.end());
+  }
+  count_ += other.count_;
+  Compress();
+}
+
+void QuantileSketch::Compress() {
+  // A full level pushes half of its items to the next one, which might then
+  // overflow in turn.
+  for (size_t h = 0; h < compactors_.size(); ++h) {
+    if (compactors_[h].size() < Capacity(h)) {
+      continue;
+    }
+    if (h + 1 == compactors_.size()) {
+      compactors_.emplace_back();
+    }
+    auto& buf = compactors_[h];
+    auto& next = compactors_[h + 1];
+    std::sort(buf.begin(), buf.end());
+    // Leave the largest item here when the size is odd. Each promoted item
+    // takes the weight of two, so the total weight is unchanged.
+    size_t m = buf.size() & ~static_cast<size_t>(1);
+    size_t offset = rdv_() & 1;
+    for (size_t i = offset; i < m; i += 2) {
+      next.push_back(buf[i]);
+    }
+    buf.erase(buf.begin(), buf.begin() + m);
+  }
+}
+
+std::vector<std::pair<double, uint64_t>> QuantileSketch::WeightedItems()
+    const {
+  std::vector<std::pair<double, uint64_t>> items;
+  items.reserve(size());
+  for (size_t h = 0; h < compactors_.size(); ++h) {
+    for (double x : compactors_[h]) {
+      items.emplace_back(x, static_cast<uint64_t>(1) << h);
+    }
+  }
+  std::sort(items.begin(), items.end());
+  return items;
+}
+
+double QuantileSketch::Quantile(double q) const {
+  SPU_ENFORCE(count_ > 0, "empty sketch");
+  SPU_ENFORCE(q >= 0. && q <= 1., "invalid quantile {}", q);
+  auto items = WeightedItems();
+  auto target = std::max<uint64_t>(1, std::ceil(q * count_));
+  uint64_t rank = 0;
+  for (const auto& [x, w] : items) {
+    rank += w;
+    if (rank >= target) {
+      return x;
+    }
+  }
+  return items.back().first;
+}
+
+}  // namespace squirrel
@@ -0,0 +1,75 @@
+// Copyright 2024 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "absl/types/span.h"
+
+namespace squirrel {
+
+// A mergeable quantile sketch of a stream of doubles.
+//
+// REF: Optimal Quantile Approximation in Streams (KLL)
+// https://arxiv.org/abs/1603.05346
+//
+// Items are kept in a stack of compactors. An item on level h stands for 2^h
+// samples. When a compactor is full, it is sorted and every other item, from
+// a random offset, is promoted to the next level. The capacity of level h is
+// about k * (2/3)^(H - 1 - h) for H levels, so the sketch holds O(k) items
+// and the rank error is about n / k. The sketch is exact before the first
+// compaction, i.e., for less than k samples.
+class QuantileSketch {
+ public:
+  static constexpr size_t kDefaultK = 1024;
+
+  explicit QuantileSketch(size_t k = kDefaultK, uint64_t seed = 0);
+
+  void Update(double x);
+
+  void Update(absl::Span<const double> xs);
+
+  // Absorb the samples of another sketch. Both sketches should use the same k.
+  void Merge(const QuantileSketch& other);
+
+  // Number of samples seen.
+  uint64_t count() const { return count_; }
+
+  // Number of items kept.
+  size_t size() const;
+
+  // The kept items in ascending order with their weights. The weights sum up
+  // to count().
+  std::vector<std::pair<double, uint64_t>> WeightedItems() const;
+
+  // The approximated q-quantile for q in [0, 1].
+  double Quantile(double q) const;
+
+ private:
+  size_t Capacity(size_t level) const;
+
+  void Compress();
+
+  size_t k_;
+  uint64_t count_ = 0;
+  // compactors_[h] holds items of weight 2^h.
+  std::vector<std::vector<double>> compactors_;
+  std::mt19937_64 rdv_;
+};
+
+}  // namespace squirrel
@@ -0,0 +1,94 @@
+// Copyright 2024 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "experimental/squirrel/quantile_sketch.h"
+
+#include <algorithm>
+#include <random>
+
+#include "gtest/gtest.h"
+
+namespace squirrel::test {
+class QuantileSketchTest : public ::testing::Test {
+ public:
+  static std::vector<double> RandomData(size_t n, uint64_t seed) {
+    std::default_random_engine rdv(seed);
+    std::normal_distribution<double> normal(0., 10.);
+    std::vector<double> x(n);
+    std::generate_n(x.data(), n, [&]() { return normal(rdv); });
+    return x;
+  }
+
+  // Rank of q-quantile returned by the sketch in the exact sorted data.
+  static double RankError(const std::vector<double>& sorted,
+                          const QuantileSketch& sketch, double q) {
+    double v = sketch.Quantile(q);
+    auto rank = std::upper_bound(sorted.begin(), sorted.end(), v) -
+                sorted.begin();
+    return std::abs(static_cast<double>(rank) / sorted.size() - q);
+  }
+};
+
+TEST_F(QuantileSketchTest, Exact) {
+  auto x = RandomData(500, 1);
+  QuantileSketch sketch(1024);
+  sketch.Update(x);
+  EXPECT_EQ(sketch.count(), x.size());
+  EXPECT_EQ(sketch.size(), x.size());
+
+  std::sort(x.begin(), x.end());
+  auto items = sketch.WeightedItems();
+  ASSERT_EQ(items.size(), x.size());
+  for (size_t i = 0; i < x.size(); ++i) {
+    EXPECT_EQ(items[i].first, x[i]);
+    EXPECT_EQ(items[i].second, 1U);
+  }
+}
+
+TEST_F(QuantileSketchTest, StreamAndMerge) {
+  const size_t n = 200000;
+  auto x = RandomData(n, 2);
+
+  QuantileSketch whole(256);
+  whole.Update(x);
+
+  // Four partitions fed by chunks, then merged.
+  std::vector<QuantileSketch> parts;
+  for (size_t p = 0; p < 4; ++p) {
+    parts.emplace_back(256, p);
+  }
+  for (size_t i = 0; i < n; i += 1000) {
+    parts[(i / 1000) % 4].Update(absl::MakeConstSpan(x).subspan(i, 1000));
+  }
+  for (size_t p = 1; p < 4; ++p) {
+    parts[0].Merge(parts[p]);
+  }
+
+  std::sort(x.begin(), x.end());
+  for (const auto* sketch : {&whole, &parts[0]}) {
+    EXPECT_EQ(sketch->count(), n);
+    EXPECT_LT(sketch->size(), 4 * 256U);
+    uint64_t total = 0;
+    for (const auto& item : sketch->WeightedItems()) {
+      total += item.second;
+    }
+    EXPECT_EQ(total, n);
+    for (double q : {0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99}) {
+      EXPECT_LT(RankError(x, *sketch, q), 0.02) << "q=" << q;
+    }
+  }
+}
+
+}  // namespace squirrel::test
@@ -0,0 +1,273 @@
+// Copyright 2024 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "experimental/squirrel/sparse_bin_matrix.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+
+#include "yacl/utils/parallel.h"
+
+#include "libspu/core/prelude.h"
+
+namespace squirrel {
+
+namespace {
+
+constexpr uint64_t kMagic = 0x5351524c42494e31ULL;  // "SQRLBIN1"
+constexpr size_t kHeaderWords = 4;
+
+size_t MetaWords(size_t rows) { return kHeaderWords + rows + rows + 1; }
+
+}  // namespace
+
+std::shared_ptr<std::vector<uint64_t>> SparseBinMatrix::Allocate(
+    absl::Span<const uint64_t> row_nnz, size_t cols) {
+  SPU_ENFORCE(cols <= std::numeric_limits<uint32_t>::max(),
+              "too many columns {}", cols);
+  const size_t rows = row_nnz.size();
+
+  std::vector<uint64_t> row_offset(rows + 1, 0);
+  for (size_t r = 0; r < rows; ++r) {
+    const size_t words =
+        IsBitmap(row_nnz[r], cols) ? BitmapWords(cols) : row_nnz[r];
+    row_offset[r + 1] = row_offset[r] + words;
+  }
+  const size_t num_words = row_offset[rows];
+
+  // uint64 storage keeps every section 8-byte aligned, the payload takes
+  // num_words / 2 of it.
+  const size_t meta_words = MetaWords(rows);
+  auto holder = std::make_shared<std::vector<uint64_t>>(
+      meta_words + (num_words + 1) / 2, 0);
+  uint64_t* buf = holder->data();
+  buf[0] = kMagic;
+  buf[1] = rows;
+  buf[2] = cols;
+  buf[3] = num_words;
+  std::copy(row_nnz.begin(), row_nnz.end(), buf + kHeaderWords);
+  std::copy(row_offset.begin(), row_offset.end(), buf + kHeaderWords + rows);
+  return holder;
+}
+
+SparseBinMatrix SparseBinMatrix::Initialize(
+    absl::Span<const std::vector<uint32_t>> rows_data, size_t cols) {
+  const size_t rows = rows_data.size();
+  std::vector<uint64_t> row_nnz(rows);
+  for (size_t r = 0; r < rows; ++r) {
+    row_nnz[r] = rows_data[r].size();
+  }
+
+  auto holder = Allocate(row_nnz, cols);
+  const uint64_t* row_offset = holder->data() + kHeaderWords + rows;
+  auto* payload =
+      reinterpret_cast<uint32_t*>(holder->data() + MetaWords(rows));
+
+  yacl::parallel_for(0, rows, 1, [&](int64_t bgn, int64_t end) {
+    for (int64_t r = bgn; r < end; ++r) {
+      const auto& row = rows_data[r];
+      uint32_t* dst = payload + row_offset[r];
+      if (IsBitmap(row.size(), cols)) {
+        for (uint32_t c : row) {
+          SPU_ENFORCE(c < cols, "column {} out of bound {}", c, cols);
+          SPU_ENFORCE((dst[c / 32] >> (c % 32) & 1) == 0,
+                      "duplicated column {} in row {}", c, r);
+          dst[c / 32] |= static_cast<uint32_t>(1) << (c % 32);
+        }
+      } else {
+        std::copy(row.begin(), row.end(), dst);
+        std::sort(dst, dst + row.size());
+        SPU_ENFORCE(row.empty() || dst[row.size() - 1] < cols,
+                    "column {} out of bound {}", dst[row.size() - 1], cols);
+        SPU_ENFORCE(std::adjacent_find(dst, dst + row.size()) ==
+                        dst + row.size(),
+                    "duplicated column in row {}", r);
+      }
+    }
+  });
+
+  SparseBinMatrix mat;
+  mat.BindBuffer(std::shared_ptr<const void>(holder, holder->data()),
+                 holder->size() * sizeof(uint64_t));
+  return mat;
+}
+
+SparseBinMatrix SparseBinMatrix::FromBuckets(
+    absl::Span<const std::vector<uint16_t>> buckets, size_t nbuckets) {
+  SPU_ENFORCE(not buckets.empty() && nbuckets > 0);
+  const size_t cols = buckets[0].size();
+  for (const auto& b : buckets) {
+    SPU_ENFORCE_EQ(b.size(), cols);
+  }
+
+  BucketMapBuilder builder(buckets.size(), nbuckets, cols);
+  yacl::parallel_for(0, buckets.size(), 1, [&](int64_t bgn, int64_t end) {
+    for (int64_t g = bgn; g < end; ++g) {
+      builder.Count(g, buckets[g]);
+    }
+  });
+  builder.FinishCount();
+  yacl::parallel_for(0, buckets.size(), 1, [&](int64_t bgn, int64_t end) {
+    for (int64_t g = bgn; g < end; ++g) {
+      builder.Fill(g, buckets[g]);
+    }
+  });
+  return builder.Finish();
+}
+
+SparseBinMatrix::BucketMapBuilder::BucketMapBuilder(size_t ngroups,
+                                                    size_t nbuckets,
+                                                    size_t cols)
+    : ngroups_(ngroups),
+      nbuckets_(nbuckets),
+      cols_(cols),
+      row_nnz_(ngroups * nbuckets, 0),
+      next_col_(ngroups, 0) {
+  SPU_ENFORCE(ngroups > 0 && nbuckets > 0);
+}
+
+void SparseBinMatrix::BucketMapBuilder::Count(
+    size_t g, absl::Span<const uint16_t> buckets) {
+  SPU_ENFORCE(holder_ == nullptr, "counting has finished");
+  SPU_ENFORCE(g < ngroups_, "group {} out of bound {}", g, ngroups_);
+  SPU_ENFORCE(next_col_[g] + buckets.size() <= cols_,
+              "group {} has more than {} columns", g, cols_);
+
+  // Each column has exactly one non-zero among the rows of a group.
+  uint64_t* nnz = row_nnz_.data() + g * nbuckets_;
+  for (uint16_t b : buckets) {
+    SPU_ENFORCE(b < nbuckets_, "bucket {} out of bound {}", b, nbuckets_);
+    nnz[b] += 1;
+  }
+  next_col_[g] += buckets.size();
+}
+
+void SparseBinMatrix::BucketMapBuilder::FinishCount() {
+  SPU_ENFORCE(holder_ == nullptr, "counting has finished");
+  for (size_t g = 0; g < ngroups_; ++g) {
+    SPU_ENFORCE_EQ(next_col_[g], cols_, "group {} is not complete", g);
+  }
+  std::fill(next_col_.begin(), next_col_.end(), 0);
+
+  const size_t rows = row_nnz_.size();
+  holder_ = Allocate(row_nnz_, cols_);
+  row_offset_ = holder_->data() + kHeaderWords + rows;
+  payload_ = reinterpret_cast<uint32_t*>(holder_->data() + MetaWords(rows));
+  cursor_.resize(rows);
+  for (size_t r = 0; r < rows; ++r) {
+    cursor_[r] = payload_ + row_offset_[r];
+  }
+}
+
+void SparseBinMatrix::BucketMapBuilder::Fill(
+    size_t g, absl::Span<const uint16_t> buckets) {
+  SPU_ENFORCE(holder_ != nullptr, "call FinishCount() first");
+  SPU_ENFORCE(g < ngroups_, "group {} out of bound {}", g, ngroups_);
+  SPU_ENFORCE(next_col_[g] + buckets.size() <= cols_,
+              "group {} has more than {} columns", g, cols_);
+
+  // Columns are visited in ascending order, so the sparse rows come out
+  // sorted.
+  const size_t row0 = g * nbuckets_;
+  size_t c = next_col_[g];
+  for (uint16_t b : buckets) {
+    SPU_ENFORCE(b < nbuckets_, "bucket {} out of bound {}", b, nbuckets_);
+    const size_t r = row0 + b;
+    if (IsBitmap(row_nnz_[r], cols_)) {
+      payload_[row_offset_[r] + c / 32] |= static_cast<uint32_t>(1) << (c % 32);
+    } else {
+      SPU_ENFORCE(cursor_[r] < payload_ + row_offset_[r + 1],
+                  "row {} has more non-zeros than counted", r);
+      *cursor_[r]++ = static_cast<uint32_t>(c);
+    }
+    ++c;
+  }
+  next_col_[g] = c;
+}
+
+SparseBinMatrix SparseBinMatrix::BucketMapBuilder::Finish() {
+  SPU_ENFORCE(holder_ != nullptr, "call FinishCount() first");
+  for (size_t g = 0; g < ngroups_; ++g) {
+    SPU_ENFORCE_EQ(next_col_[g], cols_, "group {} is not complete", g);
+  }
+
+  SparseBinMatrix mat;
+  mat.BindBuffer(std::shared_ptr<const void>(holder_, holder_->data()),
+                 holder_->size() * sizeof(uint64_t));
+  holder_.reset();
+  return mat;
+}
+
+void SparseBinMatrix::BindBuffer(std::shared_ptr<const void> buffer,
+                                 size_t num_bytes) {
+  SPU_ENFORCE(num_bytes >= kHeaderWords * sizeof(uint64_t),
+              "invalid buffer of {} bytes", num_bytes);
+  const auto* buf = static_cast<const uint64_t*>(buffer.get());
+  SPU_ENFORCE(buf[0] == kMagic, "not a SparseBinMatrix buffer");
+
+  const size_t rows = buf[1];
+  const size_t meta_words = MetaWords(rows);
+  SPU_ENFORCE(meta_words * sizeof(uint64_t) <= num_bytes,
+              "truncated SparseBinMatrix buffer");
+  SPU_ENFORCE((meta_words + (buf[3] + 1) / 2) * sizeof(uint64_t) <= num_bytes,
+              "truncated SparseBinMatrix buffer");
+
+  rows_ = static_cast<int64_t>(rows);
+  cols_ = static_cast<int64_t>(buf[2]);
+  row_nnz_ = buf + kHeaderWords;
+  row_offset_ = row_nnz_ + rows;
+  payload_ = reinterpret_cast<const uint32_t*>(buf + meta_words);
+  SPU_ENFORCE(row_offset_[rows] == buf[3], "corrupted row offsets");
+
+  buffer_ = std::move(buffer);
+  num_bytes_ = num_bytes;
+}
+
+void SparseBinMatrix::Save(const std::string& path) const {
+  SPU_ENFORCE(buffer_ != nullptr, "empty matrix");
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  SPU_ENFORCE(out.is_open(), "can not open {}", path);
+  out.write(static_cast<const char*>(buffer_.get()), num_bytes_);
+  SPU_ENFORCE(out.good(), "failed to write {}", path);
+}
+
+SparseBinMatrix SparseBinMatrix::MapFile(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  SPU_ENFORCE(fd >= 0, "can not open {}", path);
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    SPU_THROW("can not stat {}", path);
+  }
+  const size_t num_bytes = st.st_size;
+  void* addr = ::mmap(nullptr, num_bytes, PROT_READ, MAP_SHARED, fd, 0);
+  // The mapping holds its own reference to the file.
+  ::close(fd);
+  SPU_ENFORCE(addr != MAP_FAILED, "can not mmap {}", path);
+
+  std::shared_ptr<const void> buffer(addr, [num_bytes](const void* p) {
+    ::munmap(const_cast<void*>(p), num_bytes);
+  });
+  SparseBinMatrix mat;
+  mat.BindBuffer(std::move(buffer), num_bytes);
+  return mat;
+}
+
+}  // namespace squirrel
@@ -0,0 +1,167 @@
+// Copyright 2024 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/numeric/bits.h"
+#include "absl/types/span.h"
+
+namespace squirrel {
+
+// A read-only binary matrix in a CSR/bitmap hybrid layout.
+//
+// Each row is stored contiguously either as the sorted uint32 column indices
+// of its non-zeros (sparse rows), or as a bitmap of `cols` bits (dense rows),
+// whichever is smaller. For the XGB bucket map, a row of a feature with B
+// buckets holds about 1/B of the samples, so rows usually end up as bitmaps
+// that take cols/8 bytes.
+//
+// The whole matrix lives in one flat buffer:
+//   header     : uint64 x 4, {magic, rows, cols, num_words}
+//   row_nnz    : uint64 x rows
+//   row_offset : uint64 x (rows + 1), in words of the payload
+//   payload    : uint32 x num_words
+// so Save() writes the buffer as is, and MapFile() mmaps it back without any
+// parsing.
+class SparseBinMatrix {
+ public:
+  SparseBinMatrix() = default;
+
+  // Build from the non-zero column indices of each row. Indices of a row can
+  // be unsorted but should not be repeated.
+  static SparseBinMatrix Initialize(
+      absl::Span<const std::vector<uint32_t>> rows_data, size_t cols);
+
+  // Build the bucket map from the bucket index of each column, where
+  // buckets[g][c] = b means (g * nbuckets + b, c) = 1. The groups are filled
+  // concurrently.
+  static SparseBinMatrix FromBuckets(
+      absl::Span<const std::vector<uint16_t>> buckets, size_t nbuckets);
+
+  // Builds the same bucket map as FromBuckets from chunks of columns, so
+  // that the bucket indices of all the columns are never held at once.
+  //
+  // Every group is given its columns in ascending order, first to Count()
+  // and then again to Fill(); FinishCount() sizes the rows in between. So
+  // the memory is the final matrix plus one cursor per row. Different groups
+  // can be counted or filled concurrently.
+  class BucketMapBuilder {
+   public:
+    BucketMapBuilder(size_t ngroups, size_t nbuckets, size_t cols);
+
+    // Counts the next columns of group `g`.
+    void Count(size_t g, absl::Span<const uint16_t> buckets);
+
+    // Allocates the matrix after all the columns have been counted.
+    void FinishCount();
+
+    // Puts the next columns of group `g` into the matrix.
+    void Fill(size_t g, absl::Span<const uint16_t> buckets);
+
+    // The matrix after all the columns have been filled.
+    SparseBinMatrix Finish();
+
+   private:
+    size_t ngroups_;
+    size_t nbuckets_;
+    size_t cols_;
+    std::vector<uint64_t> row_nnz_;
+    // The next column of each group.
+    std::vector<size_t> next_col_;
+
+    std::shared_ptr<std::vector<uint64_t>> holder_;
+    const uint64_t* row_offset_ = nullptr;
+    uint32_t* payload_ = nullptr;
+    // The next non-zero of each sparse row.
+    std::vector<uint32_t*> cursor_;
+  };
+
+  // Map the matrix saved by Save() into memory. The file is shared
+  // read-only, i.e., the pages are loaded on demand.
+  static SparseBinMatrix MapFile(const std::string& path);
+
+  void Save(const std::string& path) const;
+
+  int64_t rows() const { return rows_; }
+
+  int64_t cols() const { return cols_; }
+
+  int64_t nnz(int64_t row) const { return row_nnz_[row]; }
+
+  // Size of the underlying buffer in bytes.
+  size_t ByteSize() const { return num_bytes_; }
+
+  bool IsBitmapRow(int64_t row) const {
+    return IsBitmap(row_nnz_[row], cols_);
+  }
+
+  // The sorted column indices of a sparse row.
+  absl::Span<const uint32_t> SparseRow(int64_t row) const {
+    return {payload_ + row_offset_[row], static_cast<size_t>(row_nnz_[row])};
+  }
+
+  // The bitmap of a dense row, bit c of word c/32 is set iff (row, c) = 1.
+  absl::Span<const uint32_t> BitmapRow(int64_t row) const {
+    return {payload_ + row_offset_[row], BitmapWords(cols_)};
+  }
+
+  // Call fn(col) for each non-zero of the row in ascending order.
+  template <typename Fn>
+  void ForEachInRow(int64_t row, Fn&& fn) const {
+    if (!IsBitmapRow(row)) {
+      for (uint32_t col : SparseRow(row)) {
+        fn(static_cast<size_t>(col));
+      }
+      return;
+    }
+    auto bitmap = BitmapRow(row);
+    for (size_t w = 0; w < bitmap.size(); ++w) {
+      for (uint32_t bits = bitmap[w]; bits != 0; bits &= bits - 1) {
+        fn(w * 32 + static_cast<size_t>(absl::countr_zero(bits)));
+      }
+    }
+  }
+
+ private:
+  static size_t BitmapWords(int64_t cols) { return (cols + 31) / 32; }
+
+  // A bitmap row takes cols/32 words while a sparse row takes nnz words.
+  static bool IsBitmap(int64_t nnz, int64_t cols) {
+    return static_cast<size_t>(nnz) >= BitmapWords(cols);
+  }
+
+  // The buffer with the header, row_nnz and row_offset filled in, and a
+  // zeroed payload.
+  static std::shared_ptr<std::vector<uint64_t>> Allocate(
+      absl::Span<const uint64_t> row_nnz, size_t cols);
+
+  void BindBuffer(std::shared_ptr<const void> buffer, size_t num_bytes);
+
+  int64_t rows_ = 0;
+  int64_t cols_ = 0;
+
+  // Either a heap buffer or a mmaped file.
+  std::shared_ptr<const void> buffer_;
+  size_t num_bytes_ = 0;
+
+  const uint64_t* row_nnz_ = nullptr;
+  const uint64_t* row_offset_ = nullptr;
+  const uint32_t* payload_ = nullptr;
+};
+
+}  // namespace squirrel
@@ -0,0 +1,156 @@
+// Copyright 2024 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "experimental/squirrel/sparse_bin_matrix.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <random>
+
+#include "gtest/gtest.h"
+
+namespace squirrel::test {
+class SparseBinMatrixTest : public ::testing::Test {
+ public:
+  // Row r keeps each column with probability density[r].
+  static std::vector<std::vector<uint32_t>> RandomRows(
+      const std::vector<double>& density, size_t cols) {
+    std::default_random_engine rdv;
+    std::uniform_real_distribution<double> uniform(0., 1.);
+    std::vector<std::vector<uint32_t>> rows(density.size());
+    for (size_t r = 0; r < rows.size(); ++r) {
+      for (size_t c = 0; c < cols; ++c) {
+        if (uniform(rdv) < density[r]) {
+          rows[r].push_back(c);
+        }
+      }
+      std::shuffle(rows[r].begin(), rows[r].end(), rdv);
+    }
+    return rows;
+  }
+
+  static void ExpectSame(const SparseBinMatrix& mat,
+                         std::vector<std::vector<uint32_t>> rows) {
+    ASSERT_EQ(mat.rows(), (int64_t)rows.size());
+    for (int64_t r = 0; r < mat.rows(); ++r) {
+      std::sort(rows[r].begin(), rows[r].end());
+      std::vector<uint32_t> got;
+      mat.ForEachInRow(r, [&](size_t c) { got.push_back(c); });
+      EXPECT_EQ(got, rows[r]) << "row " << r;
+      EXPECT_EQ(mat.nnz(r), (int64_t)rows[r].size());
+    }
+  }
+};
+
+TEST_F(SparseBinMatrixTest, Hybrid) {
+  size_t cols = 1000;
+  auto rows = RandomRows({0.0, 0.01, 0.02, 0.2, 0.9, 1.0}, cols);
+  auto mat = SparseBinMatrix::Initialize(rows, cols);
+
+  EXPECT_EQ(mat.cols(), (int64_t)cols);
+  // cols / 32 = 32 words for a bitmap row.
+  EXPECT_FALSE(mat.IsBitmapRow(0));
+  EXPECT_FALSE(mat.IsBitmapRow(1));
+  EXPECT_TRUE(mat.IsBitmapRow(3));
+  EXPECT_TRUE(mat.IsBitmapRow(5));
+  ExpectSame(mat, rows);
+}
+
+TEST_F(SparseBinMatrixTest, SaveAndMap) {
+  size_t cols = 77;
+  auto rows = RandomRows({0.05, 0.3, 0.5, 0.0, 0.02}, cols);
+  auto mat = SparseBinMatrix::Initialize(rows, cols);
+
+  auto path = std::filesystem::temp_directory_path() /
+              "squirrel_sparse_bin_matrix_test.bin";
+  mat.Save(path.string());
+  auto mapped = SparseBinMatrix::MapFile(path.string());
+  std::filesystem::remove(path);
+
+  EXPECT_EQ(mapped.cols(), (int64_t)cols);
+  EXPECT_EQ(mapped.ByteSize(), mat.ByteSize());
+  ExpectSame(mapped, rows);
+}
+
+TEST_F(SparseBinMatrixTest, InvalidInput) {
+  std::vector<std::vector<uint32_t>> rows = {{0, 3}, {2, 10}};
+  EXPECT_ANY_THROW(SparseBinMatrix::Initialize(rows, 10));
+
+  rows = {{0, 3, 3}};
+  EXPECT_ANY_THROW(SparseBinMatrix::Initialize(rows, 10));
+}
+
+TEST_F(SparseBinMatrixTest, FromBuckets) {
+  size_t cols = 300;
+  size_t nbuckets = 8;
+  std::default_random_engine rdv;
+  // A skewed feature so that some buckets are sparse rows.
+  std::geometric_distribution<uint16_t> geometric(0.6);
+  std::vector<std::vector<uint16_t>> buckets(2, std::vector<uint16_t>(cols));
+  std::vector<std::vector<uint32_t>> rows(2 * nbuckets);
+  for (size_t g = 0; g < buckets.size(); ++g) {
+    for (size_t c = 0; c < cols; ++c) {
+      buckets[g][c] = std::min<uint16_t>(geometric(rdv), nbuckets - 1);
+      rows[g * nbuckets + buckets[g][c]].push_back(c);
+    }
+  }
+
+  auto mat = SparseBinMatrix::FromBuckets(buckets, nbuckets);
+  EXPECT_EQ(mat.cols(), (int64_t)cols);
+  EXPECT_EQ(mat.ByteSize(), SparseBinMatrix::Initialize(rows, cols).ByteSize());
+  ExpectSame(mat, rows);
+
+  buckets[1][3] = nbuckets;
+  EXPECT_ANY_THROW(SparseBinMatrix::FromBuckets(buckets, nbuckets));
+}
+
+TEST_F(SparseBinMatrixTest, BucketMapBuilder) {
+  size_t cols = 300;
+  size_t nbuckets = 8;
+  size_t chunk = 64;
+  std::default_random_engine rdv;
+  std::geometric_distribution<uint16_t> geometric(0.6);
+  std::vector<std::vector<uint16_t>> buckets(3, std::vector<uint16_t>(cols));
+  for (auto& group : buckets) {
+    for (auto& b : group) {
+      b = std::min<uint16_t>(geometric(rdv), nbuckets - 1);
+    }
+  }
+
+  // Columns are given in chunks, the last one is partial.
+  SparseBinMatrix::BucketMapBuilder builder(buckets.size(), nbuckets, cols);
+  for (size_t c = 0; c < cols; c += chunk) {
+    for (size_t g = 0; g < buckets.size(); ++g) {
+      builder.Count(g, absl::MakeConstSpan(buckets[g]).subspan(c, chunk));
+    }
+  }
+  EXPECT_ANY_THROW(builder.Fill(0, buckets[0]));
+  builder.FinishCount();
+  for (size_t c = 0; c < cols; c += chunk) {
+    for (size_t g = 0; g < buckets.size(); ++g) {
+      builder.Fill(g, absl::MakeConstSpan(buckets[g]).subspan(c, chunk));
+    }
+  }
+  auto mat = builder.Finish();
+
+  auto expected = SparseBinMatrix::FromBuckets(buckets, nbuckets);
+  EXPECT_EQ(mat.ByteSize(), expected.ByteSize());
+  std::vector<std::vector<uint32_t>> rows(expected.rows());
+  for (int64_t r = 0; r < expected.rows(); ++r) {
+    expected.ForEachInRow(r, [&](size_t c) { rows[r].push_back(c); });
+  }
+  ExpectSame(mat, rows);
+}
+
+}  // namespace squirrel::test
@@ -223,13 +223,12 @@ void RunTest(spu::SPUContext* hctx, squirrel::XGBTreeBuilder& builder,
   SPDLOG_DEBUG("Computing inference on testing set ...");
 
   std::vector<double> probs(nsamples);
+  auto preds = builder.Inference(hctx, worker, {dframe.data(), dframe.size()},
+                                 nsamples);
+  preds = spu::kernel::hal::reveal(hctx, preds);
   for (int64_t i = 0; i < nsamples; ++i) {
-    xt::xarray<double> row = xt::row(dframe, i);
-    auto pred = builder.Inference(hctx, worker, {row.data(), row.size()});
-    pred = spu::kernel::hal::reveal(hctx, pred);
-
     if (has_label) {
-      double p = pred.data().at<int64_t>(0) / fxp;
+      double p = preds.data().at<int64_t>(i) / fxp;
       double prob;
       if (act_t == squirrel::ActivationType::Logistic) {
         prob = 1. / (1. + std::exp(-p));
@@ -338,12 +337,12 @@ int main(int argc, char** argv) {
   double fxp = std::pow(2., hctx->config().fxp_fraction_bits());
   int32_t correct = 0;
   SPDLOG_DEBUG("Computing inference on training set ...");
+  auto preds = builder.Inference(
+      hctx.get(), worker, {dframe.data(), dframe.size()}, nsamples);
+  preds = spu::kernel::hal::reveal(hctx.get(), preds);
   for (int64_t i = 0; i < (int64_t)nsamples; ++i) {
-    xt::xarray<double> row = xt::row(dframe, i);
-    auto pred = builder.Inference(hctx.get(), worker, {row.data(), row.size()});
-    pred = spu::kernel::hal::reveal(hctx.get(), pred);
     if (has_label) {
-      double p = pred.data().at<int64_t>(0) / fxp;
+      double p = preds.data().at<int64_t>(i) / fxp;
       double prob;
       if (act_t == squirrel::ActivationType::Logistic) {
         prob = 1. / (1. + std::exp(-p));
@@ -15,6 +15,7 @@
 
 #include "experimental/squirrel/bin_matvec_prot.h"
 #include "experimental/squirrel/objectives.h"
+#include "yacl/utils/parallel.h"
 
 #include "libspu/core/ndarray_ref.h"
 #include "libspu/core/prelude.h"
@@ -52,7 +53,7 @@ void XGBTreeBuildWorker::Setup(size_t ring_bitwidth,
   rank_ = conn->Rank();
 }
 
-void XGBTreeBuildWorker::SetUpBucketMap(const StlSparseMatrix& bucket_map,
+void XGBTreeBuildWorker::SetUpBucketMap(const SparseBinMatrix& bucket_map,
                                         const std::vector<Binning>& binnings) {
   SPU_ENFORCE_EQ(binnings.size(), nfeatures_);
   for (const auto& bin : binnings) {
@@ -69,84 +70,167 @@ void XGBTreeBuildWorker::BuildMap(const xt::xarray<double>& dframe) {
   size_t nsamples = dframe.shape()[0];
   size_t nfeatures = dframe.shape()[1];
   SPU_ENFORCE_EQ(nfeatures, nfeatures_);
-  binnings_.resize(nfeatures, Binning(bucket_size_));
-
-  std::vector<StlSparseMatrix::SparseRow> nzero_position(
-      /*nrows*/ bucket_size_ * nfeatures);
-
-  for (size_t f = 0; f < nfeatures; ++f) {
-    const size_t feature_bucket_pos = f * bucket_size_;
-
-    xt::xarray<double> fd =
-        xt::ravel<xt::layout_type::column_major>(xt::col(dframe, f));
-    absl::Span<const double> _fd = {fd.data(), fd.size()};
-
-    binnings_[f].Fit(_fd);
-    std::vector<uint16_t> bucket_indices = binnings_[f].Transform(_fd);
+  binnings_.assign(nfeatures, Binning(bucket_size_));
+
+  // feature -> bucket index of each sample
+  std::vector<std::vector<uint16_t>> bucket_indices(nfeatures);
+  yacl::parallel_for(0, nfeatures, 1, [&](int64_t bgn, int64_t end) {
+    for (int64_t f = bgn; f < end; ++f) {
+      xt::xarray<double> fd =
+          xt::ravel<xt::layout_type::column_major>(xt::col(dframe, f));
+      absl::Span<const double> _fd = {fd.data(), fd.size()};
+
+      binnings_[f].Fit(_fd);
+      bucket_indices[f] = binnings_[f].Transform(_fd);
+      SPU_ENFORCE_EQ(nsamples, bucket_indices[f].size());
+    }
+  });
 
-    SPU_ENFORCE_EQ(nsamples, bucket_indices.size());
+  // Put samples in bucket[0], ..., bucket[bucket_size-1]
+  bucket_map_ = SparseBinMatrix::FromBuckets(bucket_indices, bucket_size_);
+}
 
-    // Put samples in bucket[0], ..., bucket[bucket_size-1]
-    for (size_t i = 0; i < nsamples; ++i) {
-      size_t bucket = bucket_indices[i];
-      SPU_ENFORCE(bucket < bucket_size_);
-      int row = static_cast<int>(feature_bucket_pos + bucket);
-      int col = static_cast<int>(i);
-      nzero_position[row].insert(col);
-    }
-  }
+void XGBTreeBuildWorker::BuildMap(const StreamingBinning& binning,
+                                  const ChunkReader& read_chunks) {
+  SPU_ENFORCE_EQ(binning.nfeatures(), nfeatures_);
+  binnings_ = binning.Finalize();
+  const size_t nsamples = binning.count();
+
+  // The chunks are read twice, to size the rows of the bucket map and then to
+  // fill them, so only the bucket indices of one chunk are held at a time.
+  SparseBinMatrix::BucketMapBuilder builder(nfeatures_, bucket_size_,
+                                            nsamples);
+  auto for_each_chunk = [&](auto&& put) {
+    size_t offset = 0;
+    // xarray is row-major, i.e., feature f of a chunk is at stride nfeatures.
+    read_chunks([&](const xt::xarray<double>& chunk) {
+      SPU_ENFORCE_EQ(chunk.dimension(), 2UL);
+      SPU_ENFORCE_EQ(chunk.shape()[1], nfeatures_);
+      const size_t nrows = chunk.shape()[0];
+      SPU_ENFORCE(offset + nrows <= nsamples, "more rows than fitted");
+      yacl::parallel_for(0, nfeatures_, 1, [&](int64_t bgn, int64_t end) {
+        std::vector<uint16_t> buckets(nrows);
+        for (int64_t f = bgn; f < end; ++f) {
+          binnings_[f].Transform(chunk.data() + f, /*stride*/ nfeatures_,
+                                 absl::MakeSpan(buckets));
+          put(f, absl::MakeConstSpan(buckets));
+        }
+      });
+      offset += nrows;
+    });
+    SPU_ENFORCE_EQ(offset, nsamples, "fewer rows than fitted");
+  };
 
-  bucket_map_ = StlSparseMatrix::Initialize(nzero_position, /*ncols*/ nsamples);
+  for_each_chunk([&](size_t f, absl::Span<const uint16_t> buckets) {
+    builder.Count(f, buckets);
+  });
+  builder.FinishCount();
+  for_each_chunk([&](size_t f, absl::Span<const uint16_t> buckets) {
+    builder.Fill(f, buckets);
+  });
+  bucket_map_ = builder.Finish();
 }
 
 std::pair<spu::Value, spu::Value> XGBTreeBuildWorker::ComputeGradientSums(
     spu::SPUContext* ctx, const spu::Value& gradient, const spu::Value& hessian,
-    absl::Span<const uint8_t> sample_indicator) {
+    absl::Span<const uint8_t> sample_indicator, GradientCache* cache) {
+  auto sums = ComputeGradientSums(ctx, absl::MakeConstSpan(&gradient, 1),
+                                  absl::MakeConstSpan(&hessian, 1),
+                                  absl::MakeConstSpan(&sample_indicator, 1),
+                                  absl::MakeConstSpan(&cache, 1));
+  return sums.front();
+}
+
+std::vector<std::pair<spu::Value, spu::Value>>
+XGBTreeBuildWorker::ComputeGradientSums(
+    spu::SPUContext* ctx, absl::Span<const spu::Value> gradients,
+    absl::Span<const spu::Value> hessians,
+    absl::Span<const absl::Span<const uint8_t>> sample_indicators,
+    absl::Span<GradientCache* const> caches) {
   using namespace spu;
-  SPU_TRACE_HAL_LEAF(ctx, gradient, hessian);
+  SPU_TRACE_HAL_LEAF(ctx, gradients.size());
   SPU_ENFORCE(matvec_prot_send_ != nullptr && matvec_prot_recv_ != nullptr,
               "Call Setup() first");
+  const size_t num_nodes = gradients.size();
+  SPU_ENFORCE(num_nodes > 0);
+  SPU_ENFORCE_EQ(hessians.size(), num_nodes);
+  SPU_ENFORCE_EQ(sample_indicators.size(), num_nodes);
+  SPU_ENFORCE_EQ(caches.size(), num_nodes);
   size_t dim_in = bucket_map_.cols();
   size_t dim_out = bucket_map_.rows();
-  SPU_ENFORCE_EQ(gradient.numel(), hessian.numel());
-  SPU_ENFORCE_EQ(dim_in, (size_t)gradient.numel());
-  SPU_ENFORCE(sample_indicator.empty() || dim_in == sample_indicator.size());
-
-  // Need 1D tensor
-  auto grad = gradient.data().reshape({gradient.numel()});
-  auto hess = hessian.data().reshape({hessian.numel()});
   size_t peer_dim_out = peer_nfeatures_ * bucket_size_;
+  const auto eltype = gradients.front().data().eltype();
+
+  // The gradient and hessian of the i-th node are the (2i)-th and (2i+1)-th
+  // vectors of the mat-vec. The vector holder only sends the ones that are
+  // not cached by the matrix holder.
+  std::vector<BinMatVecProtocol::EncryptedVectorPtr> encrypted(2 * num_nodes);
+  std::vector<absl::Span<const uint8_t>> indicators(2 * num_nodes);
+  std::vector<NdArrayRef> self_fresh;
+  std::vector<NdArrayRef> peer_fresh;
+  for (size_t i = 0; i < num_nodes; ++i) {
+    const auto& gradient = gradients[i];
+    const auto& hessian = hessians[i];
+    SPU_ENFORCE_EQ(gradient.numel(), hessian.numel());
+    SPU_ENFORCE_EQ(dim_in, (size_t)gradient.numel());
+    SPU_ENFORCE(sample_indicators[i].empty() ||
+                dim_in == sample_indicators[i].size());
+    indicators[2 * i] = sample_indicators[i];
+    indicators[2 * i + 1] = sample_indicators[i];
+
+    // Need 1D tensor
+    auto grad = gradient.data().reshape({gradient.numel()});
+    auto hess = hessian.data().reshape({hessian.numel()});
+
+    const auto* cache = caches[i];
+    if (cache != nullptr && cache->valid[rank_]) {
+      SPU_ENFORCE(cache->grad != nullptr && cache->hess != nullptr);
+      encrypted[2 * i] = cache->grad;
+      encrypted[2 * i + 1] = cache->hess;
+    } else {
+      self_fresh.push_back(grad);
+      self_fresh.push_back(hess);
+    }
+    if (cache == nullptr || !cache->valid[1 - rank_]) {
+      peer_fresh.push_back(grad);
+      peer_fresh.push_back(hess);
+    }
+  }
+
+  auto stack = [&](const std::vector<NdArrayRef>& vecs) {
+    if (vecs.empty()) {
+      return NdArrayRef(eltype, {0});
+    }
+    return vecs.front().concatenate(absl::MakeConstSpan(vecs).subspan(1), 0);
+  };
+
+  auto send = [&]() {
+    return matvec_prot_send_->BatchSend(stack(peer_fresh), 2 * num_nodes,
+                                        peer_dim_out, dim_in);
+  };
+
+  auto recv = [&]() {
+    return matvec_prot_recv_->BatchRecv(stack(self_fresh), dim_out, dim_in,
+                                        bucket_map_, indicators,
+                                        absl::MakeSpan(encrypted));
+  };
 
   // parallel rank0 -> rank1 BinMatVec
-  auto subtask =
-      std::async(std::launch::async, [&]() -> std::array<spu::NdArrayRef, 2> {
-        if (rank_ == 0) {
-          auto G = matvec_prot_send_->Send(grad, peer_dim_out, dim_in);
-          auto H = matvec_prot_send_->Send(hess, peer_dim_out, dim_in);
-          return {G, H};
-        }
-        auto G = matvec_prot_recv_->Recv(grad, dim_out, dim_in, bucket_map_,
-                                         sample_indicator);
-        auto H = matvec_prot_recv_->Recv(hess, dim_out, dim_in, bucket_map_,
-                                         sample_indicator);
-        return {G, H};
-      });
+  auto subtask = std::async(std::launch::async, [&]() {
+    return rank_ == 0 ? send() : recv();
+  });
 
   // parallel rank1 -> rank0 BinMatVec
-  spu::NdArrayRef G0;
-  spu::NdArrayRef H0;
-  if (rank_ == 1) {
-    // From rank1, peer_total_buckets = #rows of matrix 0
-    G0 = matvec_prot_send_->Send(grad, peer_dim_out, dim_in);
-    H0 = matvec_prot_send_->Send(hess, peer_dim_out, dim_in);
-  } else {
-    G0 = matvec_prot_recv_->Recv(grad, dim_out, dim_in, bucket_map_,
-                                 sample_indicator);
-    H0 = matvec_prot_recv_->Recv(hess, dim_out, dim_in, bucket_map_,
-                                 sample_indicator);
+  auto GH0 = rank_ == 1 ? send() : recv();
+
+  auto GH1 = subtask.get();
+  for (size_t i = 0; i < num_nodes; ++i) {
+    if (caches[i] != nullptr) {
+      caches[i]->grad = encrypted[2 * i];
+      caches[i]->hess = encrypted[2 * i + 1];
+      caches[i]->valid = {true, true};
+    }
   }
-
-  auto [G1, H1] = subtask.get();
   size_t nfeatures_0 = rank_ == 0 ? nfeatures_ : peer_nfeatures_;
   size_t nfeatures_1 = rank_ == 1 ? nfeatures_ : peer_nfeatures_;
 
@@ -161,30 +245,36 @@ std::pair<spu::Value, spu::Value> XGBTreeBuildWorker::ComputeGradientSums(
   // Using this partial sum format, we can simplify the computation of split
   // gain. where
   //      gain[i] = \sum_{j <= i} bin[j] + \sum{j > i} bin[j] - \sum_{k} bin[k]
-  AccumulateHistogram(G0, nfeatures_0, bucket_size_);
-  AccumulateHistogram(H0, nfeatures_0, bucket_size_);
-  AccumulateHistogram(G1, nfeatures_1, bucket_size_);
-  AccumulateHistogram(H1, nfeatures_1, bucket_size_);
-
-  spu::Shape shape0 = {1L, G0.numel()};
-  spu::Shape shape1 = {1L, G1.numel()};
-  G0 = G0.reshape(shape0);
-  H0 = H0.reshape(shape0);
-  G1 = G1.reshape(shape1);
-  H1 = H1.reshape(shape1);
-
-  spu::Value G0_(G0, gradient.dtype());
-  spu::Value G1_(G1, gradient.dtype());
-
-  spu::Value H0_(H0, hessian.dtype());
-  spu::Value H1_(H1, hessian.dtype());
-
-  // We let rank0's buckets come before rank1's buckets.
-  // G = G0 || G1
-  // H = H0 || H1
-  auto G_ = spu::kernel::hlo::Concatenate(ctx, {G0_, G1_}, 1);
-  auto H_ = spu::kernel::hlo::Concatenate(ctx, {H0_, H1_}, 1);
-  return {G_, H_};
+  //
+  // The stacked histograms are accumulated as the ones of 2 * num_nodes times
+  // as many features.
+  AccumulateHistogram(GH0, 2 * num_nodes * nfeatures_0, bucket_size_);
+  AccumulateHistogram(GH1, 2 * num_nodes * nfeatures_1, bucket_size_);
+
+  const int64_t nbuckets_0 = nfeatures_0 * bucket_size_;
+  const int64_t nbuckets_1 = nfeatures_1 * bucket_size_;
+  auto histogram = [&](const NdArrayRef& stacked, int64_t nbuckets,
+                       size_t k) {
+    int64_t bgn = k * nbuckets;
+    auto hist = stacked.slice({bgn}, {bgn + nbuckets}, {1});
+    return hist.reshape({1L, nbuckets});
+  };
+
+  std::vector<std::pair<spu::Value, spu::Value>> sums;
+  for (size_t i = 0; i < num_nodes; ++i) {
+    spu::Value G0_(histogram(GH0, nbuckets_0, 2 * i), gradients[i].dtype());
+    spu::Value G1_(histogram(GH1, nbuckets_1, 2 * i), gradients[i].dtype());
+
+    spu::Value H0_(histogram(GH0, nbuckets_0, 2 * i + 1), hessians[i].dtype());
+    spu::Value H1_(histogram(GH1, nbuckets_1, 2 * i + 1), hessians[i].dtype());
+
+    // We let rank0's buckets come before rank1's buckets.
+    // G = G0 || G1
+    // H = H0 || H1
+    sums.emplace_back(spu::kernel::hlo::Concatenate(ctx, {G0_, G1_}, 1),
+                      spu::kernel::hlo::Concatenate(ctx, {H0_, H1_}, 1));
+  }
+  return sums;
 }
 
 std::pair<size_t, double> XGBTreeBuildWorker::SplitInfo(
@@ -210,14 +300,12 @@ std::vector<uint8_t> XGBTreeBuildWorker::PotentialLeftIndicator(
 
   // bucket_map_: (bucket_size * nfeatures) x nsample mapping
   for (size_t k = bucket_bgn; k <= target_bucket_index; ++k) {
-    for (auto col_iter = bucket_map_.iterate_row_begin(k);
-         col_iter != bucket_map_.iterate_row_end(k); ++col_iter) {
-      size_t sample_index = *col_iter;
+    bucket_map_.ForEachInRow(k, [&](size_t sample_index) {
       SPU_ENFORCE(sample_index < nsamples);
       // hit once
       SPU_ENFORCE(indicator[sample_index] == 0);
       indicator[sample_index] = 1;
-    }
+    });
   }
   return indicator;
 }
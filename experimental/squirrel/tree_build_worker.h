@@ -11,6 +11,11 @@
 // WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 // See the License for the specific language governing permissions and
 // limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <functional>
 #include <future>
 #include <random>
 
@@ -42,18 +47,52 @@ class XGBTreeBuildWorker {
   // Sum of gradients: G = bucket_map * g \in RR^{nfeatures * bucket_size}
   void BuildMap(const xt::xarray<double>& dframe);
 
+  // Calls the given function on each chunk of rows, in order.
+  using ChunkReader = std::function<void(
+      const std::function<void(const xt::xarray<double>&)>&)>;
+
+  // Same as above, but for data that does not fit in memory. The binnings
+  // come from a StreamingBinning that has seen all the rows. The chunks are
+  // then read twice more, to count and then to fill the buckets, so besides
+  // the bucket map only one chunk and its bucket indices are in memory.
+  void BuildMap(const StreamingBinning& binning,
+                const ChunkReader& read_chunks);
+
   // Directly setup the bucketing maps.
   // Indeed, for the XGB training, we only need the bucketing maps
   // instead of the dataframe itself.
-  void SetUpBucketMap(const StlSparseMatrix& bucket_map,
+  void SetUpBucketMap(const SparseBinMatrix& bucket_map,
                       const std::vector<Binning>& binnings);
 
+  // The gradients encrypted for the mat-vec on the bucket maps.
+  // valid[r] = true means the mat-vec on rank r's bucket map can reuse the
+  // gradients that were encrypted before, which is the same on both ranks.
+  // Only rank r holds the ciphertexts for valid[r].
+  struct GradientCache {
+    std::array<bool, 2> valid = {false, false};
+    BinMatVecProtocol::EncryptedVectorPtr grad;
+    BinMatVecProtocol::EncryptedVectorPtr hess;
+  };
+
   // Ignore sample_indicator[i] = 0
   // Empty indicator is regarded as all 1s indicator.
+  //
+  // When `cache` is given, the valid entries are used instead of encrypting
+  // the gradients again, and all entries are valid after the call.
   std::pair<spu::Value, spu::Value> ComputeGradientSums(
       spu::SPUContext* ctx, const spu::Value& gradient,
       const spu::Value& hessian,
-      absl::Span<const uint8_t> sample_indicator = {nullptr, 0});
+      absl::Span<const uint8_t> sample_indicator = {nullptr, 0},
+      GradientCache* cache = nullptr);
+
+  // Batched version of the above on several nodes, e.g., the nodes on one
+  // level of several trees. The gradients and hessians of all the nodes go
+  // through one mat-vec on each rank's bucket map. A null cache is fine.
+  std::vector<std::pair<spu::Value, spu::Value>> ComputeGradientSums(
+      spu::SPUContext* ctx, absl::Span<const spu::Value> gradients,
+      absl::Span<const spu::Value> hessians,
+      absl::Span<const absl::Span<const uint8_t>> sample_indicators,
+      absl::Span<GradientCache* const> caches);
 
   // The b* indicator. b*[i] = 1 <=> sample i feature[fidx] >
   // buckets[target_bucket_index] where fidx = target_bucket_index / bucket_size
@@ -95,7 +134,7 @@ class XGBTreeBuildWorker {
   size_t nfeatures_;       // number of self's features
   size_t peer_nfeatures_;  // number of peer's features
 
-  StlSparseMatrix bucket_map_;  // (bucket_size * nfeatures) x nsamples mapping
+  SparseBinMatrix bucket_map_;  // (bucket_size * nfeatures) x nsamples mapping
   std::vector<Binning> binnings_;  // feature -> partition percentiles
 };
 
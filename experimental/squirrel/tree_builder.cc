@@ -22,6 +22,7 @@
 #include "experimental/squirrel/tree_build_worker.h"
 #include "experimental/squirrel/utils.h"
 
+#include "libspu/core/parallel_utils.h"
 #include "libspu/core/prelude.h"
 #include "libspu/core/type_util.h"
 #include "libspu/kernel/hal/fxp_base.h"
@@ -105,18 +106,37 @@ XGBTreeBuilder::XGBTreeBuilder(int max_depth, double reg_lambda,
 void XGBTreeBuilder::BuildTree(
     spu::SPUContext* ctx, const std::shared_ptr<XGBTreeBuildWorker>& worker,
     double learn_rate) {
+  XGBTreeBuilder* self = this;
+  BuildTrees(ctx, absl::MakeConstSpan(&self, 1), worker, learn_rate);
+}
+
+void XGBTreeBuilder::BuildTrees(
+    spu::SPUContext* ctx, absl::Span<XGBTreeBuilder* const> builders,
+    const std::shared_ptr<XGBTreeBuildWorker>& worker, double learn_rate) {
   SPU_ENFORCE(worker != nullptr);
-  SPU_ENFORCE_EQ(nsamples_, worker->num_samples());
-  split_identifier_t dummy;
-  // Node index starts from 1, so we add a dummy
-  dummy.push_back({false, 0, 0.});
-  split_identifiers_.push_back(dummy);
-  for (int depth = 1; depth <= max_depth_; ++depth) {
-    TrainLevel(ctx, worker, depth);
+  SPU_ENFORCE(!builders.empty());
+  const auto* leader = builders.front();
+  for (auto* builder : builders) {
+    SPU_ENFORCE(builder != nullptr);
+    SPU_ENFORCE_EQ(builder->nsamples_, worker->num_samples());
+    // The trees grow in lockstep and share one gain evaluation per level.
+    SPU_ENFORCE_EQ(builder->max_depth_, leader->max_depth_);
+    SPU_ENFORCE_EQ(builder->reg_lambda_, leader->reg_lambda_);
+
+    split_identifier_t dummy;
+    // Node index starts from 1, so we add a dummy
+    dummy.push_back({false, 0, 0.});
+    builder->split_identifiers_.push_back(dummy);
+  }
+
+  for (int depth = 1; depth <= leader->max_depth_; ++depth) {
+    TrainLevel(ctx, builders, worker, depth);
   }
 
   SPDLOG_DEBUG("ComputeLeafWeights ...");
-  ComputeLeafWeights(ctx, worker, learn_rate);
+  for (auto* builder : builders) {
+    builder->ComputeLeafWeights(ctx, worker, learn_rate);
+  }
   SPDLOG_DEBUG("ComputeLeafWeights done");
 }
 
@@ -171,23 +191,18 @@ void XGBTreeBuilder::ComputeLeafWeights(
   using namespace spu::kernel;
   SPU_ENFORCE(learn_rate > 0. && learn_rate < 10.);
 
-  const int64_t bucket_size = worker->bucket_size();
   std::vector<spu::Value> _Gsum;
   std::vector<spu::Value> _Hsum;
-  // G shape (1, nfeatures * bucket_size)
+  // G shape (1, 1)
   size_t leaf_idx_start = 1UL << (max_depth_ - 1);
   size_t leaf_idx_end = 1UL << (max_depth_);
 
   for (size_t idx = leaf_idx_start; idx < leaf_idx_end; ++idx) {
     auto kv = cached_GHs_.find(idx);
     SPU_ENFORCE(kv != cached_GHs_.end(), "Leaf {} is missing", idx);
-    const auto& G = kv->second.first;
-    const auto& H = kv->second.second;
-    // last bucket is the sum of all gradients on the node
-    _Gsum.push_back(
-        hlo::Slice(ctx, G, {0, bucket_size - 1}, {1, bucket_size}, {1, 1}));
-    _Hsum.push_back(
-        hlo::Slice(ctx, H, {0, bucket_size - 1}, {1, bucket_size}, {1, 1}));
+    // leafs keep the sums of gradients on the node
+    _Gsum.push_back(kv->second.first);
+    _Hsum.push_back(kv->second.second);
   }
 
   // shape (#leafs, 1)
@@ -252,10 +267,27 @@ spu::Value XGBTreeBuilder::UpdateGradient(spu::SPUContext* ctx,
   return MulArithShareWithPrivateBoolean(ctx, gradient, indicator);
 }
 
-void XGBTreeBuilder::TrainLevel(
+spu::Value XGBTreeBuilder::LeafSum(
     spu::SPUContext* ctx, const std::shared_ptr<XGBTreeBuildWorker>& worker,
-    size_t level) {
+    const spu::Value& gradient, absl::Span<const uint8_t> indicator) {
   using namespace spu::kernel;
+  // The gradients are already masked by the splits along the path.
+  // Subsampling is applied through the indicator of rank0, the same as the
+  // last bucket of the first feature on rank0 in the histogram.
+  auto masked = gradient;
+  if (subsample_ < 1.) {
+    if (worker->rank() == 0) {
+      SPU_ENFORCE_EQ(indicator.size(), nsamples_);
+      masked = UpdateGradient(ctx, gradient, indicator);
+    } else {
+      masked = UpdateGradient(ctx, gradient);
+    }
+  }
+  masked = hlo::Reshape(ctx, masked, {1, masked.numel()});
+  return ReduceSum(ctx, masked, /*axis*/ 1, /*keepdims*/ true);
+}
+
+void XGBTreeBuilder::CheckLevel(size_t level) const {
   SPU_ENFORCE(level > 0 && level <= (size_t)max_depth_);
   // Level 1: node 1
   // Level 2: node 2, 3
@@ -269,79 +301,159 @@ void XGBTreeBuilder::TrainLevel(
     SPU_ENFORCE(sample_indicators_.find(idx) != sample_indicators_.end(),
                 "indicator on node {} is missing", idx);
   }
+}
 
-  const bool is_leaf_level = level == static_cast<size_t>(max_depth_);
-  std::vector<spu::Value> current_G;
-  std::vector<spu::Value> current_H;
-  for (size_t idx = node_idx_bgn; idx < node_idx_end; idx += 2) {
+void XGBTreeBuilder::LeafSums(
+    spu::SPUContext* ctx, const std::shared_ptr<XGBTreeBuildWorker>& worker) {
+  const auto level = static_cast<size_t>(max_depth_);
+  CheckLevel(level);
+  // The leaf weights only need the G and H sums on each leaf, which are
+  // local sums of the masked gradients. No need to compute the histograms
+  // with the mat-vec on this level.
+  cached_enc_gh_.clear();  // no more mat-vec on this tree
+  size_t node_idx_bgn = 1UL << (level - 1);
+  size_t node_idx_end = 1UL << level;
+  for (size_t idx = node_idx_bgn; idx < node_idx_end; ++idx) {
     RECORD_STATS("gradient_sum", ctx);
     const auto& indicator = sample_indicators_.find(idx)->second;
     const auto& [gradient, hessian] = cached_gh_.find(idx)->second;
+    cached_GHs_.erase(idx / 2);
+    cached_GHs_.insert({idx,
+                        {LeafSum(ctx, worker, gradient, indicator),
+                         LeafSum(ctx, worker, hessian, indicator)}});
+  }
+}
+
+std::vector<std::pair<spu::Value, spu::Value>>
+XGBTreeBuilder::LevelHistograms(
+    spu::SPUContext* ctx, absl::Span<XGBTreeBuilder* const> builders,
+    const std::shared_ptr<XGBTreeBuildWorker>& worker, size_t level) {
+  using namespace spu::kernel;
+  size_t node_idx_bgn = 1UL << (level - 1);
+  size_t node_idx_end = 1UL << level;
+
+  // The left child of each sibling pair, over all the trees.
+  std::vector<spu::Value> gradients;
+  std::vector<spu::Value> hessians;
+  std::vector<absl::Span<const uint8_t>> indicators;
+  std::vector<XGBTreeBuildWorker::GradientCache*> caches;
+  for (auto* builder : builders) {
+    builder->CheckLevel(level);
+    SPU_ENFORCE(level < (size_t)builder->max_depth_,
+                "no histogram on the leafs");
+    for (size_t idx = node_idx_bgn; idx < node_idx_end; idx += 2) {
+      const auto& [gradient, hessian] = builder->cached_gh_.find(idx)->second;
+      gradients.push_back(gradient);
+      hessians.push_back(hessian);
+      indicators.push_back(builder->sample_indicators_.find(idx)->second);
+      caches.push_back(&builder->cached_enc_gh_[idx]);
+    }
+  }
 
-    // Left child
-    SPDLOG_DEBUG("ComputeGradientSums on Node {} ...", idx);
-    auto [GL, HL] = worker->ComputeGradientSums(ctx, gradient, hessian,
-                                                absl::MakeSpan(indicator));
-    SPDLOG_DEBUG("ComputeGradientSums on Node {} done", idx);
+  std::vector<std::pair<spu::Value, spu::Value>> left_sums;
+  {
+    StatsGuard guard(builders.front()->stats_["gradient_sum"], ctx->lctx());
+    SPDLOG_DEBUG("ComputeGradientSums on {} nodes ...", gradients.size());
+    left_sums = worker->ComputeGradientSums(ctx, gradients, hessians,
+                                            indicators, caches);
+    SPDLOG_DEBUG("ComputeGradientSums on {} nodes done", gradients.size());
+  }
 
-    if (not is_leaf_level) {
+  std::vector<std::pair<spu::Value, spu::Value>> histograms;
+  auto left = left_sums.begin();
+  for (auto* builder : builders) {
+    std::vector<spu::Value> current_G;
+    std::vector<spu::Value> current_H;
+    for (size_t idx = node_idx_bgn; idx < node_idx_end; idx += 2, ++left) {
+      const auto& [GL, HL] = *left;
       current_G.push_back(GL);
       current_H.push_back(HL);
-    }
-    cached_GHs_.insert({idx, {GL, HL}});
+      builder->cached_GHs_.insert({idx, {GL, HL}});
 
-    size_t parent_idx = idx / 2;
-    auto parent_GH = cached_GHs_.find(parent_idx);
-    if (parent_GH == cached_GHs_.end()) {
-      // level = 1
-      continue;
-    }
+      size_t parent_idx = idx / 2;
+      auto parent_GH = builder->cached_GHs_.find(parent_idx);
+      if (parent_GH == builder->cached_GHs_.end()) {
+        // level = 1
+        continue;
+      }
 
-    // Histgram subtraction to obtain the siblings
-    const auto& Gp = parent_GH->second.first;
-    const auto& Hp = parent_GH->second.second;
-    auto GR = hlo::Sub(ctx, Gp, GL);
-    auto HR = hlo::Sub(ctx, Hp, HL);
+      // Histgram subtraction to obtain the siblings
+      const auto& Gp = parent_GH->second.first;
+      const auto& Hp = parent_GH->second.second;
+      auto GR = hlo::Sub(ctx, Gp, GL);
+      auto HR = hlo::Sub(ctx, Hp, HL);
 
-    if (not is_leaf_level) {
       current_G.push_back(GR);
       current_H.push_back(HR);
+      builder->cached_GHs_.erase(parent_idx);
+      builder->cached_GHs_.insert({idx + 1, {GR, HR}});
     }
-    cached_GHs_.erase(parent_idx);
-    cached_GHs_.insert({idx + 1, {GR, HR}});
+
+    // Level-wise growth. Concat all the G and H in this level.
+    histograms.emplace_back(hlo::Concatenate(ctx, current_G, 0),
+                            hlo::Concatenate(ctx, current_H, 0));
   }
+  return histograms;
+}
+
+std::pair<spu::Value, spu::Value> XGBTreeBuilder::FindBestSplits(
+    spu::SPUContext* ctx, const std::shared_ptr<XGBTreeBuildWorker>& worker,
+    const spu::Value& Gs, const spu::Value& Hs) {
+  RECORD_STATS("find_best_split", ctx);
+  using namespace spu::kernel;
+  auto max_gains_index = MaxGainOnLevel(ctx, Gs, Hs, reg_lambda_);
+  // To see 1{max index >= #buckets on rank0}
+  // 1{max_index >= #buckets on rank0} => 1{max_index > #buckets on rank0 - 1}
+  // If max_index >= #buckets on rank0 => the split feature belongs to rank1
+  // If max_index < #buckets on rank0 => the split feature belongs to rank0
+  int64_t nbuckets_rank0 =
+      worker->nfeatures(/*rank*/ 0) * worker->bucket_size();
+  auto greater_bits = hlo::Greater(
+      ctx, max_gains_index,
+      hlo::Constant(ctx, nbuckets_rank0 - 1, max_gains_index.shape()));
+  // Reveal to both.
+  greater_bits = hal::reveal(ctx, greater_bits);
+  return {max_gains_index, greater_bits};
+}
 
-  if (is_leaf_level) {
+void XGBTreeBuilder::TrainLevel(
+    spu::SPUContext* ctx, absl::Span<XGBTreeBuilder* const> builders,
+    const std::shared_ptr<XGBTreeBuildWorker>& worker, size_t level) {
+  using namespace spu::kernel;
+  if (level == static_cast<size_t>(builders.front()->max_depth_)) {
     // already a leaf, no need to split
+    for (auto* builder : builders) {
+      builder->LeafSums(ctx, worker);
+    }
     return;
   }
 
-  // Level-wise growth. Concat all the G and H in this level.
-  spu::Value Gs = hlo::Concatenate(ctx, current_G, 0);
-  spu::Value Hs = hlo::Concatenate(ctx, current_H, 0);
+  std::vector<spu::Value> all_G;
+  std::vector<spu::Value> all_H;
+  for (auto& [Gs, Hs] : LevelHistograms(ctx, builders, worker, level)) {
+    all_G.push_back(Gs);
+    all_H.push_back(Hs);
+  }
+
+  // Stack the nodes of all trees on this level, so that the gains, the
+  // argmax and the reveal run once for all trees.
+  spu::Value Gs = hlo::Concatenate(ctx, all_G, 0);
+  spu::Value Hs = hlo::Concatenate(ctx, all_H, 0);
 
   SPDLOG_DEBUG("Max gain on level {} ...", level);
-  spu::Value max_gains_index;
-  spu::Value greater_bits;
-  {
-    RECORD_STATS("find_best_split", ctx);
-    max_gains_index = MaxGainOnLevel(ctx, Gs, Hs, reg_lambda_);
-    // To see 1{max index >= #buckets on rank0}
-    // 1{max_index >= #buckets on rank0} => 1{max_index > #buckets on rank0 - 1}
-    // If max_index >= #buckets on rank0 => the split feature belongs to rank1
-    // If max_index < #buckets on rank0 => the split feature belongs to rank0
-    int64_t nbuckets_rank0 =
-        worker->nfeatures(/*rank*/ 0) * worker->bucket_size();
-    greater_bits = hlo::Greater(
-        ctx, max_gains_index,
-        hlo::Constant(ctx, nbuckets_rank0 - 1, max_gains_index.shape()));
-    // Reveal to both.
-    greater_bits = hal::reveal(ctx, greater_bits);
-  }
+  auto [max_gains_index, greater_bits] =
+      builders.front()->FindBestSplits(ctx, worker, Gs, Hs);
   SPDLOG_DEBUG("Max gain on level {} done", level);
 
   SPDLOG_DEBUG("Update gradient share on level {} ...", level);
-  SplitLevel(ctx, worker, level, max_gains_index, greater_bits);
+  const int64_t num_nodes = 1L << (level - 1);
+  for (size_t k = 0; k < builders.size(); ++k) {
+    int64_t bgn = k * num_nodes;
+    int64_t end = bgn + num_nodes;
+    builders[k]->SplitLevel(
+        ctx, worker, level, hlo::Slice(ctx, max_gains_index, {bgn}, {end}, {1}),
+        hlo::Slice(ctx, greater_bits, {bgn}, {end}, {1}));
+  }
   SPDLOG_DEBUG("Update gradient share on level {} done", level);
 }
 
@@ -422,6 +534,20 @@ void XGBTreeBuilder::SplitLevel(spu::SPUContext* ctx,
     cached_gh_.erase(nidx);  // clean up
     cached_gh_.insert({2 * nidx, {grad_L, hess_L}});
     cached_gh_.insert({2 * nidx + 1, {grad_R, hess_R}});
+
+    // The children's gradients differ from the ones encrypted before only on
+    // the samples that the splitter's indicator already excludes. Thus the
+    // ciphertexts for the splitter's bucket map stay valid, while the ones
+    // for the other bucket map need to be encrypted again.
+    auto enc_gh = cached_enc_gh_[nidx];
+    cached_enc_gh_.erase(nidx);
+    enc_gh.valid[1 - belongs_to] = false;
+    if (worker->rank() != belongs_to) {
+      enc_gh.grad.reset();
+      enc_gh.hess.reset();
+    }
+    cached_enc_gh_.insert({2 * nidx, enc_gh});
+    cached_enc_gh_.insert({2 * nidx + 1, enc_gh});
     // back() point to the current tree
     split_identifiers_.back().push_back(split_info);
   }
@@ -435,6 +561,7 @@ void XGBTreeBuilder::InitGradients(const spu::Value& gradient,
   cached_gh_.clear();
   cached_gh_.insert({1, {gradient, hessian}});
   cached_GHs_.clear();
+  cached_enc_gh_.clear();
 
   sample_indicators_.clear();
   constexpr size_t root = 1;
@@ -454,58 +581,94 @@ void XGBTreeBuilder::InitGradients(const spu::Value& gradient,
 spu::Value XGBTreeBuilder::Inference(
     spu::SPUContext* ctx, const std::shared_ptr<XGBTreeBuildWorker>& worker,
     const absl::Span<const double> x) {
+  auto pred = Inference(ctx, worker, x, /*nsamples*/ 1);
+  return spu::kernel::hlo::Reshape(ctx, pred, {});
+}
+
+spu::Value XGBTreeBuilder::Inference(
+    spu::SPUContext* ctx, const std::shared_ptr<XGBTreeBuildWorker>& worker,
+    absl::Span<const double> x, int64_t nsamples) {
   using namespace spu;
   RECORD_STATS("inference", ctx);
 
   size_t ntrees = split_identifiers_.size();
-  size_t nfeature = x.size();
+  size_t nfeature = worker->nfeatures(worker->rank());
   SPU_ENFORCE_EQ(ntrees, leaf_weights_.size());
-  SPU_ENFORCE_EQ(nfeature, worker->nfeatures(worker->rank()));
+  SPU_ENFORCE(nsamples > 0);
+  SPU_ENFORCE_EQ(x.size(), nsamples * nfeature);
 
   const size_t leaf_idx_start = 1UL << (max_depth_ - 1);
   const size_t num_leafs = (1UL << max_depth_) - leaf_idx_start;
 
-  std::vector<uint8_t> leaf_indicators(num_leafs * ntrees);
-  for (size_t t = 0; t < ntrees; ++t) {
-    const auto& split_identifiers = split_identifiers_[t];
-    size_t num_nodes = split_identifiers.size();
-    std::vector<uint8_t> path_indicator(1UL << max_depth_, 0);
-    path_indicator[1] = 1;  // init root
-    for (size_t nidx = 1; nidx < num_nodes; ++nidx) {
-      const auto& [self, feature, threshold] = split_identifiers[nidx];
-      size_t lchild = 2 * nidx;
-      size_t rchild = 2 * nidx + 1;
-      if (self) {
-        SPU_ENFORCE(feature < nfeature);
-        if (x[feature] <= threshold) {
-          // go left
-          path_indicator[lchild] = path_indicator[nidx];
-          path_indicator[rchild] = 0;
-        } else {
-          // go right
-          path_indicator[lchild] = 0;
-          path_indicator[rchild] = path_indicator[nidx];
+  // leaf_indicators[(t * num_leafs + k) * nsamples + i] = 1 iff the i-th
+  // sample can fall into the k-th leaf of the t-th tree, from the view of
+  // the splits held by this rank.
+  std::vector<uint8_t> leaf_indicators(num_leafs * ntrees * nsamples);
+  spu::pforeach(0, nsamples, [&](int64_t bgn, int64_t end) {
+    std::vector<uint8_t> path_indicator(1UL << max_depth_);
+    for (int64_t i = bgn; i < end; ++i) {
+      const double* xi = x.data() + i * nfeature;
+      for (size_t t = 0; t < ntrees; ++t) {
+        const auto& split_identifiers = split_identifiers_[t];
+        size_t num_nodes = split_identifiers.size();
+        std::fill(path_indicator.begin(), path_indicator.end(), 0);
+        path_indicator[1] = 1;  // init root
+        for (size_t nidx = 1; nidx < num_nodes; ++nidx) {
+          const auto& [self, feature, threshold] = split_identifiers[nidx];
+          uint8_t go_left = 1;
+          uint8_t go_right = 1;
+          if (self) {
+            SPU_ENFORCE(feature < nfeature);
+            go_left = xi[feature] <= threshold;
+            go_right = 1 - go_left;
+          }
+          // not holding the split feature, then both children are possible
+          path_indicator[2 * nidx] = path_indicator[nidx] & go_left;
+          path_indicator[2 * nidx + 1] = path_indicator[nidx] & go_right;
+        }
+
+        for (size_t k = 0; k < num_leafs; ++k) {
+          leaf_indicators[(t * num_leafs + k) * nsamples + i] =
+              path_indicator[leaf_idx_start + k];
         }
-      } else {
-        // not holding the split feature
-        path_indicator[lchild] = path_indicator[nidx];
-        path_indicator[rchild] = path_indicator[nidx];
       }
     }
-
-    std::copy_n(path_indicator.data() + leaf_idx_start, num_leafs,
-                leaf_indicators.data() + t * num_leafs);
-  }
+  });
 
   // ntrees * num_leafs
   auto leaf_weights = kernel::hlo::Concatenate(ctx, leaf_weights_, 0);
 
-  auto updated =
-      MulArithShareWithANDBoolShare(ctx, leaf_weights, leaf_indicators);
+  // AND the paths of the two ranks and pick the leaf weights for all samples
+  // at once.
+  auto updated = BatchMulArithShareWithANDBoolShare(ctx, leaf_weights,
+                                                    nsamples, leaf_indicators);
+  updated = kernel::hlo::Reshape(
+      ctx, updated, {static_cast<int64_t>(ntrees * num_leafs), nsamples});
 
   return ReduceSum(ctx, updated, 0);
 }
 
+void XGBTreeBuilder::InferenceStream(
+    spu::SPUContext* ctx, const std::shared_ptr<XGBTreeBuildWorker>& worker,
+    int64_t chunk_size,
+    const std::function<int64_t(std::vector<double>&)>& next_chunk,
+    const std::function<void(const spu::Value&)>& consume) {
+  SPU_ENFORCE(chunk_size > 0);
+  const size_t nfeature = worker->nfeatures(worker->rank());
+  std::vector<double> chunk;
+  chunk.reserve(chunk_size * nfeature);
+  while (true) {
+    chunk.clear();
+    int64_t nrows = next_chunk(chunk);
+    SPU_ENFORCE(nrows >= 0 && nrows <= chunk_size, "invalid chunk of {} rows",
+                nrows);
+    if (nrows == 0) {
+      break;
+    }
+    consume(Inference(ctx, worker, chunk, nrows));
+  }
+}
+
 std::pair<spu::Value, spu::Value> XGBTreeBuilder::BinaryClassificationGradients(
     spu::SPUContext* ctx, const spu::Value& pred, const spu::Value& label,
     ActivationType act) {
@@ -561,23 +724,18 @@ double XGBTreeBuilder::DEBUG_OpenObjects(
     const std::shared_ptr<XGBTreeBuildWorker>& worker) const {
   using namespace spu::kernel;
 
-  const int64_t bucket_size = worker->bucket_size();
   std::vector<spu::Value> _Gsum;
   std::vector<spu::Value> _Hsum;
-  // G shape (1, nfeatures * bucket_size)
+  // G shape (1, 1)
   size_t leaf_idx_start = 1UL << (max_depth_ - 1);
   size_t leaf_idx_end = 1UL << (max_depth_);
 
   for (size_t idx = leaf_idx_start; idx < leaf_idx_end; ++idx) {
     auto kv = cached_GHs_.find(idx);
     SPU_ENFORCE(kv != cached_GHs_.end(), "Leaf {} is missing", idx);
-    const auto& G = kv->second.first;
-    const auto& H = kv->second.second;
-    // last bucket is the sum of all gradients on the node
-    _Gsum.push_back(
-        hlo::Slice(ctx, G, {0, bucket_size - 1}, {1, bucket_size}, {1, 1}));
-    _Hsum.push_back(
-        hlo::Slice(ctx, H, {0, bucket_size - 1}, {1, bucket_size}, {1, 1}));
+    // leafs keep the sums of gradients on the node
+    _Gsum.push_back(kv->second.first);
+    _Hsum.push_back(kv->second.second);
   }
 
   // shape (#leafs, 1)
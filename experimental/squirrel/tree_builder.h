@@ -11,17 +11,22 @@
 // WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 // See the License for the specific language governing permissions and
 // limitations under the License.
-//
+
+#pragma once
+
 #include <chrono>
+#include <functional>
 #include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "experimental/squirrel/tree_build_worker.h"
 
 #include "libspu/core/context.h"
 #include "libspu/core/value.h"
 
 namespace squirrel {
 
-class XGBTreeBuildWorker;
-
 using TimeCommuStat = std::pair<std::chrono::nanoseconds, size_t>;
 
 enum class ActivationType {
@@ -40,6 +45,17 @@ class XGBTreeBuilder {
                  const std::shared_ptr<XGBTreeBuildWorker>& worker,
                  double learn_rate = 1.);
 
+  // Build one tree on each builder, e.g., the per-class trees of a multi-class
+  // boosting round. The trees grow level by level in lockstep, and the best
+  // splits of all their nodes on a level are found by one batched gain,
+  // argmax and reveal.
+  //
+  // NOTE: the builders should share the same max_depth and reg_lambda.
+  static void BuildTrees(spu::SPUContext* ctx,
+                         absl::Span<XGBTreeBuilder* const> builders,
+                         const std::shared_ptr<XGBTreeBuildWorker>& worker,
+                         double learn_rate = 1.);
+
   spu::Value UpdatePrediction(spu::SPUContext* ctx,
                               const spu::Value& predictions, size_t tree_index);
 
@@ -47,6 +63,25 @@ class XGBTreeBuilder {
                        const std::shared_ptr<XGBTreeBuildWorker>& worker,
                        absl::Span<const double> x);
 
+  // Batched inference on the row-major `nsamples x nfeatures` matrix `x`,
+  // where nfeatures is the number of features on this rank.
+  // Returns the predictions in shape (nsamples,).
+  spu::Value Inference(spu::SPUContext* ctx,
+                       const std::shared_ptr<XGBTreeBuildWorker>& worker,
+                       absl::Span<const double> x, int64_t nsamples);
+
+  // Score a stream of samples chunk by chunk. `next_chunk` appends the
+  // row-major features of at most `chunk_size` rows and returns the number
+  // of rows, or 0 at the end of the stream. The predictions of each chunk
+  // are passed to `consume`.
+  //
+  // NOTE: both ranks should feed the same number of rows in each chunk.
+  void InferenceStream(
+      spu::SPUContext* ctx, const std::shared_ptr<XGBTreeBuildWorker>& worker,
+      int64_t chunk_size,
+      const std::function<int64_t(std::vector<double>&)>& next_chunk,
+      const std::function<void(const spu::Value&)>& consume);
+
   std::pair<spu::Value, spu::Value> BinaryClassificationGradients(
       spu::SPUContext* ctx, const spu::Value& pred, const spu::Value& label,
       ActivationType act = ActivationType::Logistic);
@@ -63,14 +98,40 @@ class XGBTreeBuilder {
                         const spu::Value& label) const;
 
  private:
-  void TrainLevel(spu::SPUContext* ctx,
-                  const std::shared_ptr<XGBTreeBuildWorker>& worker,
-                  size_t level);
+  static void TrainLevel(spu::SPUContext* ctx,
+                         absl::Span<XGBTreeBuilder* const> builders,
+                         const std::shared_ptr<XGBTreeBuildWorker>& worker,
+                         size_t level);
+
+  void CheckLevel(size_t level) const;
+
+  // Gradient sums of the nodes on a non-leaf level of each tree, in shape
+  // (#nodes, #buckets). The left child of each sibling pair is summed by
+  // one batched mat-vec over all the trees, and the right one comes from
+  // the histogram subtraction.
+  static std::vector<std::pair<spu::Value, spu::Value>> LevelHistograms(
+      spu::SPUContext* ctx, absl::Span<XGBTreeBuilder* const> builders,
+      const std::shared_ptr<XGBTreeBuildWorker>& worker, size_t level);
+
+  void LeafSums(spu::SPUContext* ctx,
+                const std::shared_ptr<XGBTreeBuildWorker>& worker);
+
+  // Returns the argmax bucket of each node and the revealed bits of whether
+  // the bucket belongs to rank1.
+  std::pair<spu::Value, spu::Value> FindBestSplits(
+      spu::SPUContext* ctx, const std::shared_ptr<XGBTreeBuildWorker>& worker,
+      const spu::Value& Gs, const spu::Value& Hs);
 
   // NOTE: empty indicator indicates all 1s.
   spu::Value UpdateGradient(spu::SPUContext* ctx, const spu::Value& gradient,
                             absl::Span<const uint8_t> indicator = {nullptr, 0});
 
+  // Sum of the gradients on a leaf, with shape (1, 1).
+  spu::Value LeafSum(spu::SPUContext* ctx,
+                     const std::shared_ptr<XGBTreeBuildWorker>& worker,
+                     const spu::Value& gradient,
+                     absl::Span<const uint8_t> indicator);
+
   void SplitLevel(spu::SPUContext* ctx,
                   std::shared_ptr<XGBTreeBuildWorker> worker, size_t level,
                   const spu::Value& max_gains_index,
@@ -97,10 +158,15 @@ class XGBTreeBuilder {
   std::vector<spu::Value> leaf_weights_;
   // NodeIdx -> GH pair
   std::unordered_map<size_t, std::pair<spu::Value, spu::Value>> cached_gh_;
-  // NodeIdx -> GH pair
+  // NodeIdx -> GH pair, the histograms on inner nodes and the sums on leafs
   std::unordered_map<size_t, std::pair<spu::Value, spu::Value>> cached_GHs_;
   // NodeIdx -> Sample Indicator
   std::unordered_map<size_t, std::vector<uint8_t>> sample_indicators_;
+  // NodeIdx -> gradients encrypted for the mat-vec. A split by rank r only
+  // shrinks rank r's own indicator, so the children keep the ciphertexts on
+  // rank r's bucket map.
+  std::unordered_map<size_t, XGBTreeBuildWorker::GradientCache>
+      cached_enc_gh_;
   // Timing Statistics
   std::unordered_map<std::string, TimeCommuStat> stats_;
 };
@@ -0,0 +1,227 @@
+// Copyright 2024 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "experimental/squirrel/tree_builder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "xtensor/xarray.hpp"
+
+#include "libspu/device/io.h"
+#include "libspu/kernel/hal/type_cast.h"
+#include "libspu/kernel/hlo/casting.h"
+#include "libspu/mpc/factory.h"
+#include "libspu/mpc/utils/simulate.h"
+
+namespace squirrel::test {
+
+class TreeBuilderTest : public ::testing::Test {
+ protected:
+  static constexpr size_t kBucketSize = 4;
+  static constexpr size_t kNumSamples = 96;
+  static constexpr int kMaxDepth = 3;
+  static constexpr double kRegLambda = 1.0;
+  static constexpr double kLearnRate = 0.3;
+  static constexpr size_t kNumFeatures[2] = {3, 2};
+
+  static std::unique_ptr<spu::SPUContext> MakeContext(
+      const std::shared_ptr<yacl::link::Context>& lctx) {
+    spu::RuntimeConfig config;
+    config.set_protocol(spu::ProtocolKind::CHEETAH);
+    config.set_field(spu::FM64);
+    config.set_fxp_fraction_bits(18);
+    auto ctx = std::make_unique<spu::SPUContext>(config, lctx);
+    spu::mpc::Factory::RegisterProtocol(ctx.get(), lctx);
+    return ctx;
+  }
+
+  // The features of rank r, with a fixed seed per rank.
+  static xt::xarray<double> MakeFeatures(int rank, size_t nsamples) {
+    std::mt19937 rdv(rank + 1);
+    std::uniform_real_distribution<double> uniform(-1., 1.);
+    xt::xarray<double> x = xt::zeros<double>({nsamples, kNumFeatures[rank]});
+    std::generate_n(x.data(), x.size(), [&]() { return uniform(rdv); });
+    return x;
+  }
+
+  static std::shared_ptr<XGBTreeBuildWorker> MakeWorker(
+      spu::SPUContext* ctx) {
+    int rank = ctx->lctx()->Rank();
+    auto worker = std::make_shared<XGBTreeBuildWorker>(
+        kBucketSize, kNumFeatures[rank], kNumFeatures[1 - rank]);
+    worker->BuildMap(MakeFeatures(rank, kNumSamples));
+    worker->Setup(64, ctx->lctx());
+    return worker;
+  }
+
+  // Secret gradient and hessian of the k-th tree, set by rank0.
+  static std::pair<spu::Value, spu::Value> MakeGradients(spu::SPUContext* ctx,
+                                                         size_t k) {
+    std::mt19937 rdv(100 + k);
+    std::uniform_real_distribution<double> grad(-1., 1.);
+    std::uniform_real_distribution<double> hess(0.05, 0.25);
+    xt::xarray<double> g = xt::zeros<double>({kNumSamples});
+    xt::xarray<double> h = xt::zeros<double>({kNumSamples});
+    std::generate_n(g.data(), g.size(), [&]() { return grad(rdv); });
+    std::generate_n(h.data(), h.size(), [&]() { return hess(rdv); });
+
+    spu::device::ColocatedIo cio(ctx);
+    if (ctx->lctx()->Rank() == 0) {
+      cio.hostSetVar("g", g);
+      cio.hostSetVar("h", h);
+    }
+    cio.sync();
+    auto to_secret = [&](const spu::Value& x) {
+      return spu::kernel::hlo::Cast(ctx, x, spu::VIS_SECRET, x.dtype());
+    };
+    return {to_secret(cio.deviceGetVar("g")),
+            to_secret(cio.deviceGetVar("h"))};
+  }
+
+  static std::vector<double> Reveal(spu::SPUContext* ctx,
+                                    const spu::Value& x) {
+    auto revealed = spu::kernel::hal::reveal(ctx, x);
+    const double fxp = std::pow(2., ctx->config().fxp_fraction_bits());
+    std::vector<double> out(revealed.numel());
+    for (int64_t i = 0; i < revealed.numel(); ++i) {
+      out[i] = revealed.data().at<int64_t>(i) / fxp;
+    }
+    return out;
+  }
+
+  // Revealed predictions on the training samples.
+  static std::vector<double> Predict(
+      spu::SPUContext* ctx, XGBTreeBuilder& builder,
+      const std::shared_ptr<XGBTreeBuildWorker>& worker) {
+    int rank = ctx->lctx()->Rank();
+    auto x = MakeFeatures(rank, kNumSamples);
+    return Reveal(ctx, builder.Inference(ctx, worker, {x.data(), x.size()},
+                                         static_cast<int64_t>(kNumSamples)));
+  }
+};
+
+TEST_F(TreeBuilderTest, BuildTreesMatchesBuildTree) {
+  constexpr size_t kNumTrees = 3;
+
+  spu::mpc::utils::simulate(
+      2, [&](const std::shared_ptr<yacl::link::Context>& lctx) {
+        auto ctx = MakeContext(lctx);
+        auto worker = MakeWorker(ctx.get());
+
+        std::vector<std::pair<spu::Value, spu::Value>> gh;
+        for (size_t k = 0; k < kNumTrees; ++k) {
+          gh.push_back(MakeGradients(ctx.get(), k));
+        }
+
+        // K trees grown in lockstep.
+        std::vector<std::unique_ptr<XGBTreeBuilder>> batched;
+        std::vector<XGBTreeBuilder*> batched_ptrs;
+        for (size_t k = 0; k < kNumTrees; ++k) {
+          batched.push_back(std::make_unique<XGBTreeBuilder>(
+              kMaxDepth, kRegLambda, kNumSamples));
+          batched[k]->InitGradients(gh[k].first, gh[k].second);
+          batched_ptrs.push_back(batched[k].get());
+        }
+        XGBTreeBuilder::BuildTrees(ctx.get(), batched_ptrs, worker,
+                                   kLearnRate);
+
+        for (size_t k = 0; k < kNumTrees; ++k) {
+          // The same tree built alone.
+          XGBTreeBuilder single(kMaxDepth, kRegLambda, kNumSamples);
+          single.InitGradients(gh[k].first, gh[k].second);
+          single.BuildTree(ctx.get(), worker, kLearnRate);
+
+          auto expected = Predict(ctx.get(), single, worker);
+          auto got = Predict(ctx.get(), *batched[k], worker);
+          ASSERT_EQ(expected.size(), kNumSamples);
+          ASSERT_EQ(got.size(), kNumSamples);
+          for (size_t i = 0; i < kNumSamples; ++i) {
+            EXPECT_NEAR(expected[i], got[i], 1e-2)
+                << "tree " << k << " sample " << i;
+          }
+        }
+      });
+}
+
+TEST_F(TreeBuilderTest, BatchedInference) {
+  constexpr size_t kNumTrees = 2;
+  // 3 chunks of 4, 4 and 2 rows.
+  constexpr int64_t kNumRows = 10;
+  constexpr int64_t kChunkSize = 4;
+
+  spu::mpc::utils::simulate(
+      2, [&](const std::shared_ptr<yacl::link::Context>& lctx) {
+        auto ctx = MakeContext(lctx);
+        auto worker = MakeWorker(ctx.get());
+        int rank = lctx->Rank();
+        const size_t nfeatures = kNumFeatures[rank];
+
+        XGBTreeBuilder builder(kMaxDepth, kRegLambda, kNumSamples);
+        for (size_t k = 0; k < kNumTrees; ++k) {
+          auto [g, h] = MakeGradients(ctx.get(), k);
+          builder.InitGradients(g, h);
+          builder.BuildTree(ctx.get(), worker, kLearnRate);
+        }
+
+        auto x = MakeFeatures(rank, kNumRows);
+        absl::Span<const double> rows(x.data(), x.size());
+
+        // one sample per call
+        std::vector<double> expected;
+        for (int64_t i = 0; i < kNumRows; ++i) {
+          auto pred = builder.Inference(
+              ctx.get(), worker, rows.subspan(i * nfeatures, nfeatures));
+          EXPECT_EQ(pred.shape().ndim(), 0);
+          expected.push_back(Reveal(ctx.get(), pred).at(0));
+        }
+
+        auto batched = Reveal(
+            ctx.get(), builder.Inference(ctx.get(), worker, rows, kNumRows));
+        ASSERT_EQ(batched.size(), expected.size());
+        for (int64_t i = 0; i < kNumRows; ++i) {
+          EXPECT_NEAR(expected[i], batched[i], 1e-3) << "sample " << i;
+        }
+
+        int64_t next_row = 0;
+        std::vector<int64_t> chunk_rows;
+        std::vector<double> streamed;
+        builder.InferenceStream(
+            ctx.get(), worker, kChunkSize,
+            [&](std::vector<double>& chunk) {
+              int64_t n = std::min(kChunkSize, kNumRows - next_row);
+              auto part = rows.subspan(next_row * nfeatures, n * nfeatures);
+              chunk.insert(chunk.end(), part.begin(), part.end());
+              next_row += n;
+              return n;
+            },
+            [&](const spu::Value& pred) {
+              chunk_rows.push_back(pred.numel());
+              auto revealed = Reveal(ctx.get(), pred);
+              streamed.insert(streamed.end(), revealed.begin(),
+                              revealed.end());
+            });
+        EXPECT_EQ(chunk_rows, std::vector<int64_t>({4, 4, 2}));
+        ASSERT_EQ(streamed.size(), expected.size());
+        for (int64_t i = 0; i < kNumRows; ++i) {
+          EXPECT_NEAR(expected[i], streamed[i], 1e-3) << "sample " << i;
+        }
+      });
+}
+
+}  // namespace squirrel::test
@@ -266,17 +266,15 @@ spu::Value BatchMulArithShareWithANDBoolShare(spu::SPUContext* ctx,
   SPU_ENFORCE(batch_size > 0);
   SPU_ENFORCE_EQ(batch_size * static_cast<size_t>(ashr.numel()), bshr.size());
 
-  auto flatten = spu::kernel::hlo::Reshape(ctx, ashr, {ashr.numel()});
-  std::vector<spu::Value> batched(ashr.numel());
-  for (int64_t i = 0; i < ashr.numel(); ++i) {
-    auto ai = spu::kernel::hlo::Broadcast(
-        ctx, spu::kernel::hlo::Slice(ctx, flatten, {i}, {i + 1}, {1}),
-        {static_cast<int64_t>(batch_size)}, {});
-    batched[i] = MulArithShareWithANDBoolShare(
-        ctx, ai, bshr.subspan(i * batch_size, batch_size));
-  }
-
-  return spu::kernel::hlo::Concatenate(ctx, batched, 0);
+  // Repeat each ashr[i] for batch_size times, and run all the products in
+  // one call.
+  const int64_t n = ashr.numel();
+  auto flatten = spu::kernel::hlo::Reshape(ctx, ashr, {n});
+  auto batched = spu::kernel::hlo::Broadcast(
+      ctx, flatten, {n, static_cast<int64_t>(batch_size)}, {0});
+  batched = spu::kernel::hlo::Reshape(ctx, batched, {batched.numel()});
+
+  return MulArithShareWithANDBoolShare(ctx, batched, bshr);
 }
 
 }  // namespace squirrel
@@ -0,0 +1,67 @@
+// Copyright 2024 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+namespace spu {
+
+// The brain floating point format, i.e., the upper 16 bits of an IEEE f32.
+//
+// Only the storage and the conversions are provided, arithmetic goes through
+// the implicit conversion to float. The conversions are branch free so that
+// loops over bf16 buffers can be vectorized.
+struct bfloat16 {
+  uint16_t bits = 0;
+
+  bfloat16() = default;
+
+  /* implicit */ bfloat16(float f) : bits(fromFloat(f)) {}  // NOLINT
+
+  /* implicit */ operator float() const { return toFloat(bits); }  // NOLINT
+
+  bfloat16& operator++() {
+    *this = bfloat16(static_cast<float>(*this) + 1.0F);
+    return *this;
+  }
+
+  static bfloat16 fromBits(uint16_t bits) {
+    bfloat16 ret;
+    ret.bits = bits;
+    return ret;
+  }
+
+  // Round to nearest even, NaN stays a (quiet) NaN.
+  static uint16_t fromFloat(float f) {
+    uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    const uint32_t rounded = u + 0x7FFFU + ((u >> 16) & 1U);
+    const uint32_t qnan = (u >> 16) | 0x0040U;
+    const bool is_nan = (u & 0x7FFFFFFFU) > 0x7F800000U;
+    return static_cast<uint16_t>(is_nan ? qnan : (rounded >> 16));
+  }
+
+  static float toFloat(uint16_t bits) {
+    const uint32_t u = static_cast<uint32_t>(bits) << 16;
+    float f;
+    std::memcpy(&f, &u, sizeof(f));
+    return f;
+  }
+};
+
+static_assert(sizeof(bfloat16) == 2);
+
+}  // namespace spu
@@ -47,6 +47,15 @@ SPUContext::SPUContext(const RuntimeConfig& config,
         max_cluster_level_concurrency_, config.max_concurrency());
   }
 
+  const auto& tp_config = config.thread_pool_config();
+  if (tp_config.num_threads() > 0) {
+    thread_pool_ = std::make_shared<ThreadPool>(
+        tp_config.num_threads(),
+        std::vector<int32_t>(tp_config.cpu_affinity().begin(),
+                             tp_config.cpu_affinity().end()),
+        tp_config.grain_size());
+  }
+
   if (lctx_) {
     auto other_max = yacl::link::AllGather(
         lctx, {&max_cluster_level_concurrency_, sizeof(int32_t)}, "num_cores");
@@ -64,6 +73,7 @@ std::unique_ptr<SPUContext> SPUContext::fork() const {
       lctx_ ? lctx_->Spawn() : nullptr;
   auto new_sctx = std::make_unique<SPUContext>(config_, new_lctx);
   new_sctx->prot_ = prot_->fork();
+  new_sctx->thread_pool_ = thread_pool_;
   return new_sctx;
 }
 
@@ -21,6 +21,7 @@
 #include "yacl/link/context.h"
 
 #include "libspu/core/object.h"
+#include "libspu/core/parallel_utils.h"
 #include "libspu/core/prelude.h"
 #include "libspu/core/value.h"
 
@@ -41,6 +42,9 @@ class SPUContext final {
   // Min number of cores in SPU cluster
   int32_t max_cluster_level_concurrency_;
 
+  // The runtime thread pool, shared by forked contexts.
+  std::shared_ptr<ThreadPool> thread_pool_;
+
  public:
   explicit SPUContext(const RuntimeConfig& config,
                       const std::shared_ptr<yacl::link::Context>& lctx);
@@ -62,6 +66,12 @@ class SPUContext final {
     return fbits;
   }
 
+  // Return fixed point fractional bits of the value, which may override the
+  // current working one.
+  size_t getFxpBits(const Value& x) const {
+    return x.fxp_bits() != 0 ? x.fxp_bits() : getFxpBits();
+  }
+
   // Return current working field of MPC engine.
   FieldType getField() const { return config_.field(); }
 
@@ -85,6 +95,9 @@ class SPUContext final {
     return prot_->template getState<StateT>();
   }
 
+  // Return the runtime thread pool, nullptr if the process wide pool is used.
+  ThreadPool* threadPool() const { return thread_pool_.get(); }
+
   // If any task assumes same level of parallelism across all instances,
   // this is the max number of tasks to launch at the same time.
   int32_t getClusterLevelMaxConcurrency() const {
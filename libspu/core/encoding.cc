@@ -14,12 +14,65 @@
 
 #include "libspu/core/encoding.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <type_traits>
 
 #include "libspu/core/parallel_utils.h"
 
 namespace spu {
+namespace {
+
+// The kernels below work on raw pointers of compact buffers, the loops are
+// branch free so that the compiler can vectorize them.
+
+// f16 and bf16 are computed in f32.
+template <typename Float>
+using ComputeFloatT =
+    std::conditional_t<std::is_same_v<Float, double>, double, float>;
+
+template <typename Float, typename T>
+void encodeFloatCompact(const Float* src, T* dst, int64_t numel, T scale,
+                        ComputeFloatT<Float> flp_lower,
+                        ComputeFloatT<Float> flp_upper, T fxp_lower,
+                        T fxp_upper) {
+  using C = ComputeFloatT<Float>;
+  const C c_scale = static_cast<C>(scale);
+  SPU_PFOREACH(0, numel, 4, [&](int64_t begin, int64_t end) {
+    for (int64_t idx = begin; idx < end; ++idx) {
+      const C v = static_cast<C>(src[idx]);
+      // NaN is encoded as zero, see numpy.nan_to_num
+      const C x = (v == v) ? v : C(0);
+      // Clamp before the cast, out of range float-to-int casts are undefined.
+      const C clamped = std::min(std::max(x, flp_lower), flp_upper);
+      T r = static_cast<T>(clamped * c_scale);
+      r = x >= flp_upper ? fxp_upper : r;
+      r = x <= flp_lower ? fxp_lower : r;
+      dst[idx] = r;
+    }
+  });
+}
+
+template <typename S, typename T>
+void castCompact(const S* src, T* dst, int64_t numel) {
+  SPU_PFOREACH(0, numel, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t idx = begin; idx < end; ++idx) {
+      dst[idx] = static_cast<T>(src[idx]);  // NOLINT
+    }
+  });
+}
+
+template <typename T, typename Float>
+void decodeFloatCompact(const T* src, Float* dst, int64_t numel, T scale) {
+  const double d_scale = static_cast<double>(scale);
+  SPU_PFOREACH(0, numel, 4, [&](int64_t begin, int64_t end) {
+    for (int64_t idx = begin; idx < end; ++idx) {
+      dst[idx] = static_cast<Float>(static_cast<double>(src[idx]) / d_scale);
+    }
+  });
+}
+
+}  // namespace
 
 DataType getEncodeType(PtType pt_type) {
 #define CASE(PTYPE, DTYPE) \
@@ -59,7 +112,8 @@ NdArrayRef encodeToRing(const PtBufferView& bv, FieldType field,
     *out_dtype = getEncodeType(pt_type);
   }
 
-  if (pt_type == PT_F32 || pt_type == PT_F64 || pt_type == PT_F16) {
+  if (pt_type == PT_F32 || pt_type == PT_F64 || pt_type == PT_F16 ||
+      pt_type == PT_BF16) {
     DISPATCH_FLOAT_PT_TYPES(pt_type, "_", [&]() {
       DISPATCH_ALL_FIELDS(field, "_", [&]() {
         using Float = ScalarT;
@@ -72,15 +126,23 @@ NdArrayRef encodeToRing(const PtBufferView& bv, FieldType field,
         const T kScale = T(1) << fxp_bits;
         const T kFxpLower = -(T)std::pow(2, k - 2);
         const T kFxpUpper = (T)std::pow(2, k - 2) - 1;
+        using C = ComputeFloatT<Float>;
         const auto kFlpUpper =
-            static_cast<Float>(static_cast<double>(kFxpUpper) / kScale);
+            static_cast<C>(static_cast<double>(kFxpUpper) / kScale);
         const auto kFlpLower =
-            static_cast<Float>(static_cast<double>(kFxpLower) / kScale);
+            static_cast<C>(static_cast<double>(kFxpLower) / kScale);
+
+        if (bv.isCompact()) {
+          encodeFloatCompact(static_cast<const Float*>(bv.ptr), dst.data<T>(),
+                             numel, kScale, kFlpLower, kFlpUpper, kFxpLower,
+                             kFxpUpper);
+          return;
+        }
 
         auto _dst = NdArrayView<T>(dst);
 
-        pforeach(0, numel, [&](int64_t idx) {
-          auto src_value = bv.get<Float>(idx);
+        SPU_PFOREACH(0, numel, 8, [&](int64_t idx) {
+          auto src_value = static_cast<C>(bv.get<Float>(idx));
           if (std::isnan(src_value)) {
             // see numpy.nan_to_num
             // note(jint) I dont know why nan could be
@@ -109,9 +171,15 @@ NdArrayRef encodeToRing(const PtBufferView& bv, FieldType field,
 
         using T = std::make_signed_t<ring2k_t>;
 
-        auto _dst = NdArrayView<T>(dst);
         // TODO: encoding integer in range [-2^(k-2),2^(k-2))
-        pforeach(0, numel, [&](int64_t idx) {
+        if (bv.isCompact() && !bv.isBitSet()) {
+          castCompact(static_cast<const Integer*>(bv.ptr), dst.data<T>(),
+                      numel);
+          return;
+        }
+
+        auto _dst = NdArrayView<T>(dst);
+        SPU_PFOREACH(0, numel, 2, [&](int64_t idx) {
           auto src_value = bv.get<Integer>(idx);
           _dst[idx] = static_cast<T>(src_value);  // NOLINT
         });
@@ -142,23 +210,34 @@ void decodeFromRing(const NdArrayRef& src, DataType in_dtype, size_t fxp_bits,
     DISPATCH_ALL_PT_TYPES(pt_type, "pt_type", [&]() {
       using T = std::make_signed_t<ring2k_t>;
 
+      const bool compact = src.isCompact() && out_bv->isCompact() &&
+                           !out_bv->isBitSet() && in_dtype != DT_I1;
+      if (compact) {
+        auto* dst = static_cast<ScalarT*>(out_bv->ptr);
+        if (isFixedPoint(in_dtype)) {
+          decodeFloatCompact(src.data<T>(), dst, numel, T(1) << fxp_bits);
+        } else {
+          castCompact(src.data<T>(), dst, numel);
+        }
+        return;
+      }
+
       auto _src = NdArrayView<T>(src);
 
       if (in_dtype == DT_I1) {
-        pforeach(0, numel, [&](int64_t idx) {
+        SPU_PFOREACH(0, numel, 2, [&](int64_t idx) {
           bool value = !((_src[idx] & 0x1) == 0);
           out_bv->set<bool>(idx, value);
         });
-      } else if (in_dtype == DT_F32 || in_dtype == DT_F64 ||
-                 in_dtype == DT_F16) {
+      } else if (isFixedPoint(in_dtype)) {
         const T kScale = T(1) << fxp_bits;
-        pforeach(0, numel, [&](int64_t idx) {
+        SPU_PFOREACH(0, numel, 8, [&](int64_t idx) {
           auto value =
               static_cast<ScalarT>(static_cast<double>(_src[idx]) / kScale);
           out_bv->set<ScalarT>(idx, value);
         });
       } else {
-        pforeach(0, numel, [&](int64_t idx) {
+        SPU_PFOREACH(0, numel, 2, [&](int64_t idx) {
           auto value = static_cast<ScalarT>(_src[idx]);
           out_bv->set<ScalarT>(idx, value);
         });
@@ -63,6 +63,7 @@ namespace spu {
   FN(PT_U64, DT_U64)            \
   FN(PT_I1, DT_I1)              \
   FN(PT_F16, DT_F16)            \
+  FN(PT_BF16, DT_BF16)          \
   FN(PT_F32, DT_F32)            \
   FN(PT_F64, DT_F64)
 
@@ -77,6 +78,7 @@ namespace spu {
   FN(DT_U64, PT_U64)            \
   FN(DT_I1, PT_I1)              \
   FN(DT_F16, PT_F16)            \
+  FN(DT_BF16, PT_BF16)          \
   FN(DT_F32, PT_F32)            \
   FN(DT_F64, PT_F64)
 
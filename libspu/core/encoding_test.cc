@@ -32,6 +32,8 @@ TEST(EncodingTypeTest, EncodeDecodeMap) {
   EXPECT_EQ(getEncodeType(PT_I64), DT_I64);
   EXPECT_EQ(getEncodeType(PT_U64), DT_U64);
   EXPECT_EQ(getEncodeType(PT_I1), DT_I1);
+  EXPECT_EQ(getEncodeType(PT_F16), DT_F16);
+  EXPECT_EQ(getEncodeType(PT_BF16), DT_BF16);
   EXPECT_EQ(getEncodeType(PT_F32), DT_F32);
   EXPECT_EQ(getEncodeType(PT_F64), DT_F64);
 
@@ -44,6 +46,8 @@ TEST(EncodingTypeTest, EncodeDecodeMap) {
   EXPECT_EQ(getDecodeType(DT_I64), PT_I64);
   EXPECT_EQ(getDecodeType(DT_U64), PT_U64);
   EXPECT_EQ(getDecodeType(DT_I1), PT_I1);
+  EXPECT_EQ(getDecodeType(DT_F16), PT_F16);
+  EXPECT_EQ(getDecodeType(DT_BF16), PT_BF16);
   EXPECT_EQ(getDecodeType(DT_F32), PT_F32);
   EXPECT_EQ(getDecodeType(DT_F64), PT_F64);
 }
@@ -144,6 +148,83 @@ TYPED_TEST(FloatEncodingTest, Works) {
   EXPECT_NEAR(out_ptr_by_pv[5], 3.1415926, 0.00001F);
 }
 
+TYPED_TEST(FloatEncodingTest, CompactAndStrided) {
+  using FloatT = typename std::tuple_element<0, TypeParam>::type;
+  using FieldT = typename std::tuple_element<1, TypeParam>::type;
+  constexpr FieldType kField = FieldT();
+  constexpr size_t kFxpBits = 18;
+  constexpr int64_t kNumel = 1000;
+
+  // Every other element of `buf` forms the strided view.
+  std::vector<FloatT> buf(2 * kNumel);
+  for (int64_t i = 0; i < 2 * kNumel; ++i) {
+    buf[i] = static_cast<FloatT>((i - kNumel) * 0.37);
+  }
+  buf[0] = std::numeric_limits<FloatT>::quiet_NaN();
+  buf[2] = std::numeric_limits<FloatT>::infinity();
+  buf[4] = -std::numeric_limits<FloatT>::infinity();
+  buf[6] = static_cast<FloatT>(1e30);
+  std::vector<FloatT> compact(kNumel);
+  for (int64_t i = 0; i < kNumel; ++i) {
+    compact[i] = buf[2 * i];
+  }
+
+  PtBufferView strided_pv(buf.data(), PtTypeToEnum<FloatT>::value, {kNumel},
+                          {2});
+  PtBufferView compact_pv(compact.data(), PtTypeToEnum<FloatT>::value,
+                          {kNumel}, {1});
+  ASSERT_FALSE(strided_pv.isCompact());
+  ASSERT_TRUE(compact_pv.isCompact());
+
+  auto by_strided = encodeToRing(strided_pv, kField, kFxpBits);
+  auto by_compact = encodeToRing(compact_pv, kField, kFxpBits);
+  for (int64_t i = 0; i < kNumel; ++i) {
+    EXPECT_EQ(by_strided.at<int64_t>(i), by_compact.at<int64_t>(i)) << i;
+  }
+  EXPECT_EQ(by_compact.at<int64_t>(0), 0);
+
+  // Decode into compact and strided outputs.
+  std::vector<FloatT> out_compact(kNumel);
+  std::vector<FloatT> out_strided(2 * kNumel);
+  PtBufferView out_compact_pv(out_compact.data(), PtTypeToEnum<FloatT>::value,
+                              {kNumel}, {1});
+  PtBufferView out_strided_pv(out_strided.data(), PtTypeToEnum<FloatT>::value,
+                              {kNumel}, {2});
+  DataType dtype = getEncodeType(PtTypeToEnum<FloatT>::value);
+  decodeFromRing(by_compact, dtype, kFxpBits, &out_compact_pv);
+  decodeFromRing(by_compact, dtype, kFxpBits, &out_strided_pv);
+  for (int64_t i = 4; i < kNumel; ++i) {
+    EXPECT_EQ(out_compact[i], out_strided[2 * i]) << i;
+    EXPECT_NEAR(out_compact[i], compact[i], 1e-3);
+  }
+}
+
+TEST(BFloat16EncodingTest, Works) {
+  constexpr size_t kFxpBits = 18;
+
+  std::vector<bfloat16> src = {0.0F,  1.0F,     -1.0F,  0.5F,    -2.25F,
+                               96.0F, -1024.0F, 3.75F,  -0.125F, 7.0F};
+  src.push_back(std::numeric_limits<float>::quiet_NaN());
+  src.push_back(std::numeric_limits<float>::infinity());
+  const auto numel = static_cast<int64_t>(src.size());
+
+  PtBufferView src_pv(src.data(), PT_BF16, {numel}, {1});
+  DataType dtype;
+  auto encoded = encodeToRing(src_pv, FM64, kFxpBits, &dtype);
+  EXPECT_EQ(dtype, DT_BF16);
+
+  // Every value above is exactly representable, so the round trip is exact.
+  std::vector<bfloat16> out(numel);
+  PtBufferView out_pv(out.data(), PT_BF16, {numel}, {1});
+  decodeFromRing(encoded, dtype, kFxpBits, &out_pv);
+  for (int64_t i = 0; i < numel - 2; ++i) {
+    EXPECT_EQ(out[i].bits, src[i].bits) << i;
+  }
+  EXPECT_EQ(static_cast<float>(out[numel - 2]), 0.0F);
+  // bf16 keeps the f32 exponent range, inf is clamped to the ring maximum.
+  EXPECT_GT(static_cast<float>(out[numel - 1]), 1e12F);
+}
+
 template <typename S>
 class IntEncodingTest : public ::testing::Test {};
 TYPED_TEST_SUITE(IntEncodingTest, IntTypes);
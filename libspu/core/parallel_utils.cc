@@ -14,4 +14,214 @@
 
 #include "libspu/core/parallel_utils.h"
 
-namespace spu {}  // namespace spu
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <thread>
+#include <utility>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "spdlog/spdlog.h"
+
+#include "libspu/core/prelude.h"
+
+namespace spu {
+namespace {
+
+thread_local ThreadPool* tls_current_pool = nullptr;
+thread_local bool tls_in_parallel_region = false;
+
+void pinCurrentThread(int32_t cpu) {
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+    SPDLOG_WARN("failed to pin thread to cpu {}", cpu);
+  }
+#else
+  SPDLOG_WARN("cpu pinning is not supported on this platform, cpu={}", cpu);
+#endif
+}
+
+// Completion state of one parallelFor call, lives on the caller's stack.
+struct Batch {
+  std::mutex mutex;
+  std::condition_variable cv;
+  int64_t pending = 0;
+  std::exception_ptr error;
+
+  void done(std::exception_ptr err) {
+    std::unique_lock lk(mutex);
+    if (err && !error) {
+      error = std::move(err);
+    }
+    if (--pending == 0) {
+      cv.notify_all();
+    }
+  }
+};
+
+}  // namespace
+
+struct ThreadPool::Worker {
+  std::thread thread;
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<std::function<void()>> tasks;
+  bool stop = false;
+
+  void push(std::function<void()> task) {
+    {
+      std::unique_lock lk(mutex);
+      tasks.emplace_back(std::move(task));
+    }
+    cv.notify_one();
+  }
+
+  void run(ThreadPool* pool, int32_t cpu) {
+    tls_current_pool = pool;
+    tls_in_parallel_region = true;
+    if (cpu >= 0) {
+      pinCurrentThread(cpu);
+    }
+
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock lk(mutex);
+        cv.wait(lk, [this] { return stop || !tasks.empty(); });
+        if (tasks.empty()) {
+          return;
+        }
+        task = std::move(tasks.front());
+        tasks.pop_front();
+      }
+      task();
+    }
+  }
+};
+
+ThreadPool::ThreadPool(int32_t num_threads, std::vector<int32_t> cpus,
+                       int64_t grain_size)
+    : num_threads_(num_threads),
+      cpus_(std::move(cpus)),
+      grain_size_(grain_size) {
+  SPU_ENFORCE(num_threads_ > 0, "invalid num_threads={}", num_threads_);
+  SPU_ENFORCE(grain_size_ >= 0, "invalid grain_size={}", grain_size_);
+}
+
+ThreadPool::~ThreadPool() {
+  for (auto& worker : workers_) {
+    {
+      std::unique_lock lk(worker->mutex);
+      worker->stop = true;
+    }
+    worker->cv.notify_one();
+  }
+  for (auto& worker : workers_) {
+    worker->thread.join();
+  }
+}
+
+void ThreadPool::startWorkers() {
+  workers_.reserve(num_threads_ - 1);
+  for (int32_t i = 0; i + 1 < num_threads_; ++i) {
+    const int32_t cpu =
+        cpus_.empty() ? -1 : cpus_[static_cast<size_t>(i) % cpus_.size()];
+    auto& worker = workers_.emplace_back(std::make_unique<Worker>());
+    worker->thread = std::thread(&Worker::run, worker.get(), this, cpu);
+  }
+}
+
+void ThreadPool::parallelFor(int64_t begin, int64_t end, int64_t grain_size,
+                             const std::function<void(int64_t, int64_t)>& fn) {
+  const int64_t numel = end - begin;
+  if (numel <= 0) {
+    return;
+  }
+
+  grain_size = std::max<int64_t>(grain_size, 1);
+  int64_t num_tasks =
+      std::min<int64_t>(num_threads_, (numel + grain_size - 1) / grain_size);
+  if (num_tasks <= 1 || inParallelRegion() || yacl::in_parallel_region()) {
+    fn(begin, end);
+    return;
+  }
+
+  std::call_once(start_flag_, [this] { startWorkers(); });
+
+  const int64_t chunk = (numel + num_tasks - 1) / num_tasks;
+  num_tasks = (numel + chunk - 1) / chunk;
+
+  Batch batch;
+  batch.pending = num_tasks - 1;
+  for (int64_t task = 1; task < num_tasks; ++task) {
+    const int64_t task_begin = begin + task * chunk;
+    const int64_t task_end = std::min(end, task_begin + chunk);
+    workers_[task - 1]->push([&batch, &fn, task_begin, task_end] {
+      std::exception_ptr err;
+      try {
+        fn(task_begin, task_end);
+      } catch (...) {
+        err = std::current_exception();
+      }
+      batch.done(std::move(err));
+    });
+  }
+
+  // The first chunk runs on the caller, loops nested in it run inline.
+  std::exception_ptr err;
+  tls_in_parallel_region = true;
+  try {
+    fn(begin, std::min(end, begin + chunk));
+  } catch (...) {
+    err = std::current_exception();
+  }
+  tls_in_parallel_region = false;
+
+  std::unique_lock lk(batch.mutex);
+  batch.cv.wait(lk, [&batch] { return batch.pending == 0; });
+  if (!err) {
+    err = batch.error;
+  }
+  if (err) {
+    std::rethrow_exception(err);
+  }
+}
+
+GrainTuner::GrainTuner(double cost)
+    : ns_per_iter_(cost * kTargetTaskNs / kMinTaskSize) {
+  SPU_ENFORCE(cost > 0, "invalid cost={}", cost);
+}
+
+int64_t GrainTuner::grainSize() const {
+  const double grain = kTargetTaskNs / nsPerIteration();
+  return static_cast<int64_t>(std::clamp<double>(grain, 1, kMinTaskSize * 64));
+}
+
+void GrainTuner::record(int64_t iterations, int64_t elapsed_ns) {
+  // Short tasks are dominated by timer resolution.
+  if (iterations <= 0 || elapsed_ns < 1000) {
+    return;
+  }
+  const double sample = static_cast<double>(elapsed_ns) / iterations;
+  const double prev = nsPerIteration();
+  ns_per_iter_.store(prev + (sample - prev) / 4, std::memory_order_relaxed);
+}
+
+ThreadPool* ThreadPool::current() { return tls_current_pool; }
+
+bool ThreadPool::inParallelRegion() { return tls_in_parallel_region; }
+
+ThreadPoolScope::ThreadPoolScope(ThreadPool* pool) : prev_(tls_current_pool) {
+  tls_current_pool = pool;
+}
+
+ThreadPoolScope::~ThreadPoolScope() { tls_current_pool = prev_; }
+
+}  // namespace spu
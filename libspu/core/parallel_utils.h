@@ -15,7 +15,13 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 #include "yacl/utils/parallel.h"
 
@@ -23,22 +29,176 @@ namespace spu {
 
 constexpr int64_t kMinTaskSize = 50000;
 
+// The target running time of one task, i.e. about kMinTaskSize 64-bit adds.
+constexpr int64_t kTargetTaskNs = 50000;
+
+// Grain size statistics of one pforeach call site.
+//
+// The grain size is chosen so that a task runs for about kTargetTaskNs.
+// Before any measurement, one iteration is assumed to cost `cost` 64-bit adds.
+// Every loop then times its tasks and updates the estimate, so the grain size
+// follows the real cost of the loop body on this machine.
+//
+// Tuners are meant to be static, one per call site, see SPU_PFOREACH.
+class GrainTuner final {
+ public:
+  explicit GrainTuner(double cost = 1.0);
+
+  int64_t grainSize() const;
+
+  double nsPerIteration() const {
+    return ns_per_iter_.load(std::memory_order_relaxed);
+  }
+
+  void record(int64_t iterations, int64_t elapsed_ns);
+
+ private:
+  // A moving average, concurrent updates may be lost which is fine.
+  std::atomic<double> ns_per_iter_;
+};
+
+// A fixed size thread pool for data parallel loops.
+//
+// Unlike the process wide yacl pool, a ThreadPool is owned by the runtime
+// (see SPUContext::threadPool) so that its size, cpu pinning and grain size
+// follow the RuntimeConfig.
+//
+// Loops are statically partitioned: the first chunk of a loop runs on the
+// calling thread and the i-th chunk (i > 0) always runs on worker i - 1.
+// With pinned workers, the pages of a buffer that is first written by a
+// pforeach stay on the numa node that keeps reading them, except for the
+// first chunk, which follows the (unpinned) calling thread.
+class ThreadPool final {
+ public:
+  // `num_threads` counts the calling thread, i.e. `num_threads - 1` workers
+  // are spawned. Worker `i` is pinned to `cpus[i % cpus.size()]` if `cpus` is
+  // not empty. `grain_size` is the min number of iterations per task, 0 for
+  // kMinTaskSize.
+  explicit ThreadPool(int32_t num_threads, std::vector<int32_t> cpus = {},
+                      int64_t grain_size = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  int32_t numThreads() const { return num_threads_; }
+
+  int64_t grainSize() const { return grain_size_; }
+
+  // Run `fn` over [begin, end) in chunks of at least `grain_size` iterations.
+  // Nested calls (from inside a chunk) run inline. The first exception thrown
+  // by any chunk is rethrown to the caller after all chunks finished.
+  void parallelFor(int64_t begin, int64_t end, int64_t grain_size,
+                   const std::function<void(int64_t, int64_t)>& fn);
+
+  // The pool pforeach dispatches to on this thread, nullptr for yacl's.
+  static ThreadPool* current();
+
+  // Whether this thread is running a chunk of some parallelFor.
+  static bool inParallelRegion();
+
+ private:
+  struct Worker;
+
+  void startWorkers();
+
+  const int32_t num_threads_;
+  const std::vector<int32_t> cpus_;
+  const int64_t grain_size_;
+
+  // Workers are spawned on first use, so that forked contexts sharing the
+  // config do not pay for threads they never use.
+  std::once_flag start_flag_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+};
+
+// Makes `pool` the current pool of this thread during the scope.
+class ThreadPoolScope final {
+  ThreadPool* prev_;
+
+ public:
+  explicit ThreadPoolScope(ThreadPool* pool);
+  ~ThreadPoolScope();
+
+  ThreadPoolScope(const ThreadPoolScope&) = delete;
+  ThreadPoolScope& operator=(const ThreadPoolScope&) = delete;
+};
+
 template <class F>
 inline auto pforeach(int64_t begin, int64_t end, F&& f)
     -> std::enable_if_t<
         std::is_same_v<decltype(f(int64_t(), int64_t())), void>> {
+  if (auto* pool = ThreadPool::current()) {
+    const int64_t grain =
+        pool->grainSize() > 0 ? pool->grainSize() : kMinTaskSize;
+    return pool->parallelFor(begin, end, grain, f);
+  }
   return yacl::parallel_for(begin, end, kMinTaskSize, f);
 }
 
 template <class F>
 inline auto pforeach(int64_t begin, int64_t end, F&& f)
     -> std::enable_if_t<std::is_same_v<decltype(f(int64_t())), void>> {
-  return yacl::parallel_for(begin, end, kMinTaskSize,
-                            [&f](int64_t begin, int64_t end) {
-                              for (int64_t idx = begin; idx < end; ++idx) {
-                                f(idx);
-                              }
-                            });
+  return pforeach(begin, end, [&f](int64_t begin, int64_t end) {
+    for (int64_t idx = begin; idx < end; ++idx) {
+      f(idx);
+    }
+  });
+}
+
+// pforeach with an explicit grain size, for loops whose iterations are
+// already large tasks, e.g. one ciphertext per iteration with grain size 1.
+template <class F>
+inline auto pforeach(int64_t begin, int64_t end, int64_t grain_size, F&& f)
+    -> std::enable_if_t<
+        std::is_same_v<decltype(f(int64_t(), int64_t())), void>> {
+  if (auto* pool = ThreadPool::current()) {
+    return pool->parallelFor(begin, end, grain_size, f);
+  }
+  return yacl::parallel_for(begin, end, grain_size, f);
+}
+
+template <class F>
+inline auto pforeach(int64_t begin, int64_t end, GrainTuner& tuner, F&& f)
+    -> std::enable_if_t<
+        std::is_same_v<decltype(f(int64_t(), int64_t())), void>> {
+  const int64_t grain = tuner.grainSize();
+  auto timed = [&](int64_t begin, int64_t end) {
+    const auto start = std::chrono::steady_clock::now();
+    f(begin, end);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    tuner.record(
+        end - begin,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+  };
+  if (auto* pool = ThreadPool::current()) {
+    // The configured grain size is a floor, the tuner only coarsens it.
+    return pool->parallelFor(begin, end, std::max(grain, pool->grainSize()),
+                             timed);
+  }
+  return yacl::parallel_for(begin, end, grain, timed);
+}
+
+template <class F>
+inline auto pforeach(int64_t begin, int64_t end, GrainTuner& tuner, F&& f)
+    -> std::enable_if_t<std::is_same_v<decltype(f(int64_t())), void>> {
+  return pforeach(begin, end, tuner, [&f](int64_t begin, int64_t end) {
+    for (int64_t idx = begin; idx < end; ++idx) {
+      f(idx);
+    }
+  });
 }
 
+// pforeach with a grain size tuned for this call site. `cost` is the initial
+// estimate of one iteration in 64-bit adds, e.g.
+//
+//   SPU_PFOREACH(0, numel, 4, [&](int64_t idx) { z[idx] = x[idx] * y[idx]; });
+//
+// In templates every instantiation gets its own tuner.
+#define SPU_PFOREACH(BEGIN, END, COST, ...)                       \
+  do {                                                            \
+    static ::spu::GrainTuner spu_pforeach_tuner(COST);            \
+    ::spu::pforeach(BEGIN, END, spu_pforeach_tuner, __VA_ARGS__); \
+  } while (false)
+
 }  // namespace spu
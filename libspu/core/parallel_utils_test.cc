@@ -0,0 +1,194 @@
+// Copyright 2024 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libspu/core/parallel_utils.h"
+
+#include <atomic>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+namespace spu {
+
+TEST(ThreadPoolTest, CoversRange) {
+  ThreadPool pool(4);
+
+  std::vector<int> hits(1000, 0);
+  pool.parallelFor(0, 1000, 10, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      hits[i] += 1;
+    }
+  });
+  for (int hit : hits) {
+    EXPECT_EQ(hit, 1);
+  }
+
+  // Empty and tiny ranges.
+  pool.parallelFor(5, 5, 1, [&](int64_t, int64_t) { FAIL(); });
+  int64_t calls = 0;
+  pool.parallelFor(0, 3, 10, [&](int64_t begin, int64_t end) {
+    EXPECT_EQ(begin, 0);
+    EXPECT_EQ(end, 3);
+    ++calls;
+  });
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(ThreadPoolTest, StaticPartition) {
+  ThreadPool pool(4);
+
+  // The same chunk always lands on the same thread.
+  auto owners = [&]() {
+    std::vector<std::thread::id> ids(4);
+    pool.parallelFor(0, 400, 1, [&](int64_t begin, int64_t) {
+      ids[begin / 100] = std::this_thread::get_id();
+    });
+    return ids;
+  };
+  auto first = owners();
+  EXPECT_EQ(std::set<std::thread::id>(first.begin(), first.end()).size(), 4U);
+  EXPECT_EQ(first[0], std::this_thread::get_id());
+  for (int round = 0; round < 10; ++round) {
+    EXPECT_EQ(owners(), first);
+  }
+}
+
+TEST(ThreadPoolTest, NestedRunsInline) {
+  ThreadPool pool(4);
+
+  std::atomic<int64_t> inner_calls = 0;
+  pool.parallelFor(0, 4, 1, [&](int64_t, int64_t) {
+    EXPECT_TRUE(ThreadPool::inParallelRegion());
+    pool.parallelFor(0, 100, 1, [&](int64_t begin, int64_t end) {
+      EXPECT_EQ(end - begin, 100);
+      inner_calls++;
+    });
+  });
+  EXPECT_EQ(inner_calls, 4);
+  EXPECT_FALSE(ThreadPool::inParallelRegion());
+}
+
+TEST(ThreadPoolTest, Exception) {
+  ThreadPool pool(4);
+
+  EXPECT_THROW(pool.parallelFor(0, 400, 1,
+                                [&](int64_t begin, int64_t) {
+                                  if (begin >= 300) {
+                                    throw std::runtime_error("worker");
+                                  }
+                                }),
+               std::runtime_error);
+  EXPECT_THROW(pool.parallelFor(0, 400, 1,
+                                [&](int64_t begin, int64_t) {
+                                  if (begin == 0) {
+                                    throw std::runtime_error("caller");
+                                  }
+                                }),
+               std::runtime_error);
+
+  // The pool is still usable.
+  std::atomic<int64_t> sum = 0;
+  pool.parallelFor(0, 400, 1, [&](int64_t begin, int64_t end) {
+    sum += end - begin;
+  });
+  EXPECT_EQ(sum, 400);
+}
+
+TEST(ThreadPoolTest, PforeachUsesCurrentPool) {
+  ThreadPool pool(2, {}, 10);
+  EXPECT_EQ(ThreadPool::current(), nullptr);
+
+  {
+    ThreadPoolScope scope(&pool);
+    EXPECT_EQ(ThreadPool::current(), &pool);
+
+    std::set<std::thread::id> ids;
+    std::mutex mutex;
+    std::vector<int> hits(100, 0);
+    pforeach(0, 100, [&](int64_t idx) {
+      hits[idx] += 1;
+      std::unique_lock lk(mutex);
+      ids.insert(std::this_thread::get_id());
+    });
+    for (int hit : hits) {
+      EXPECT_EQ(hit, 1);
+    }
+    // 100 iterations with grain 10 are split across both threads.
+    EXPECT_EQ(ids.size(), 2U);
+  }
+
+  EXPECT_EQ(ThreadPool::current(), nullptr);
+}
+
+TEST(GrainTunerTest, Works) {
+  GrainTuner cheap;
+  EXPECT_EQ(cheap.grainSize(), kMinTaskSize);
+
+  GrainTuner heavy(100);
+  EXPECT_EQ(heavy.grainSize(), kMinTaskSize / 100);
+
+  // Too short to be measured.
+  heavy.record(10, 100);
+  EXPECT_EQ(heavy.grainSize(), kMinTaskSize / 100);
+
+  // Converges to the measured cost, 1us per iteration.
+  for (int i = 0; i < 100; ++i) {
+    heavy.record(1000, 1000000);
+  }
+  EXPECT_NEAR(heavy.nsPerIteration(), 1000, 1);
+  EXPECT_EQ(heavy.grainSize(), kTargetTaskNs / 1000);
+}
+
+TEST(GrainTunerTest, Pforeach) {
+  ThreadPool pool(4);
+  ThreadPoolScope scope(&pool);
+
+  // An expensive body on a small range is split across the pool.
+  std::set<std::thread::id> ids;
+  std::mutex mutex;
+  std::vector<int> hits(64, 0);
+  for (int round = 0; round < 3; ++round) {
+    ids.clear();
+    SPU_PFOREACH(0, 64, 10000, [&](int64_t idx) {
+      hits[idx] += 1;
+      std::this_thread::sleep_for(std::chrono::microseconds(20));
+      std::unique_lock lk(mutex);
+      ids.insert(std::this_thread::get_id());
+    });
+  }
+  for (int hit : hits) {
+    EXPECT_EQ(hit, 3);
+  }
+  EXPECT_EQ(ids.size(), 4U);
+}
+
+TEST(GrainTunerTest, PoolGrainSizeIsFloor) {
+  ThreadPool pool(4, {}, /*grain_size*/ 64);
+  ThreadPoolScope scope(&pool);
+
+  // The tuner alone would split 64 expensive iterations across the pool.
+  GrainTuner tuner(10000);
+  ASSERT_LT(tuner.grainSize(), 64);
+  int64_t calls = 0;
+  pforeach(0, 64, tuner, [&](int64_t begin, int64_t end) {
+    EXPECT_EQ(begin, 0);
+    EXPECT_EQ(end, 64);
+    ++calls;
+  });
+  EXPECT_EQ(calls, 1);
+}
+
+}  // namespace spu
@@ -21,6 +21,7 @@
 
 #include "yacl/base/int128.h"
 
+#include "libspu/core/bfloat16.h"
 #include "libspu/core/half.h"
 #include "libspu/core/prelude.h"
 
@@ -53,6 +54,7 @@ std::ostream& operator<<(std::ostream& os, const Visibility& vtype);
 
 #define FOREACH_FXP_DTYPES(FN) \
   FN(DT_F16, F16, 16)          \
+  FN(DT_BF16, BF16, 16)        \
   FN(DT_F32, F32, 32)          \
   FN(DT_F64, F64, 64)
 
@@ -71,6 +73,7 @@ std::ostream& operator<<(std::ostream& os, const DataType& dtype);
 //////////////////////////////////////////////////////////////
 #define FOREACH_FLOAT_PT_TYPES(FN)  \
   FN(PT_F16, half_float::half, F16) \
+  FN(PT_BF16, spu::bfloat16, BF16)  \
   FN(PT_F32, float, F32)            \
   FN(PT_F64, double, F64)
 
@@ -108,6 +111,7 @@ std::ostream& operator<<(std::ostream& os, const DataType& dtype);
   [&] {                                                                 \
     switch (PT_TYPE) {                                                  \
       __CASE_PT_TYPE(spu::PT_F16, NAME, __VA_ARGS__)                    \
+      __CASE_PT_TYPE(spu::PT_BF16, NAME, __VA_ARGS__)                   \
       __CASE_PT_TYPE(spu::PT_F32, NAME, __VA_ARGS__)                    \
       __CASE_PT_TYPE(spu::PT_F64, NAME, __VA_ARGS__)                    \
       default:                                                          \
@@ -158,6 +162,7 @@ std::ostream& operator<<(std::ostream& os, const DataType& dtype);
       __CASE_PT_TYPE(spu::PT_I64, NAME, __VA_ARGS__)                    \
       __CASE_PT_TYPE(spu::PT_U64, NAME, __VA_ARGS__)                    \
       __CASE_PT_TYPE(spu::PT_F16, NAME, __VA_ARGS__)                    \
+      __CASE_PT_TYPE(spu::PT_BF16, NAME, __VA_ARGS__)                   \
       __CASE_PT_TYPE(spu::PT_F32, NAME, __VA_ARGS__)                    \
       __CASE_PT_TYPE(spu::PT_F64, NAME, __VA_ARGS__)                    \
       default:                                                          \
@@ -177,6 +182,7 @@ std::ostream& operator<<(std::ostream& os, const DataType& dtype);
       __CASE_PT_TYPE(spu::PT_I64, NAME, __VA_ARGS__)                    \
       __CASE_PT_TYPE(spu::PT_U64, NAME, __VA_ARGS__)                    \
       __CASE_PT_TYPE(spu::PT_F16, NAME, __VA_ARGS__)                    \
+      __CASE_PT_TYPE(spu::PT_BF16, NAME, __VA_ARGS__)                   \
       __CASE_PT_TYPE(spu::PT_F32, NAME, __VA_ARGS__)                    \
       __CASE_PT_TYPE(spu::PT_F64, NAME, __VA_ARGS__)                    \
       default:                                                          \
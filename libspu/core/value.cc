@@ -120,6 +120,12 @@ ValueProto Value::toProto(size_t max_chunk_size) const {
 
 ValueMetaProto Value::toMetaProto() const {
   SPU_ENFORCE(dtype_ != DT_INVALID && vtype() != VIS_INVALID);
+  // The meta proto has no room for per value scale, so everything leaving
+  // the runtime must use the configured fraction bits.
+  SPU_ENFORCE(fxp_bits_ == 0,
+              "value with {} fraction bits should be rescaled to the runtime "
+              "default before serialization",
+              fxp_bits_);
 
   ValueMetaProto proto;
   proto.set_data_type(dtype_);
@@ -192,9 +198,9 @@ Value Value::fromProto(const ValueProto& value) {
 
 Value Value::clone() const {
   if (isComplex()) {
-    return Value(data_.clone(), imag_->clone(), dtype());
+    return Value(data_.clone(), imag_->clone(), dtype()).setFxpBits(fxp_bits_);
   }
-  return Value(data_.clone(), dtype());
+  return Value(data_.clone(), dtype()).setFxpBits(fxp_bits_);
 }
 
 std::ostream& operator<<(std::ostream& out, const Value& v) {
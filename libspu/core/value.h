@@ -39,6 +39,8 @@ class Value final {
   NdArrayRef data_;
   std::optional<NdArrayRef> imag_;
   DataType dtype_ = DT_INVALID;
+  // Fraction bits of a fixed-point value, 0 means the runtime default.
+  size_t fxp_bits_ = 0;
 
  public:
   Value() = default;
@@ -80,6 +82,17 @@ class Value final {
   // unless we forcely do it.
   Value& setDtype(DataType new_dtype, bool force = false);
 
+  // Get/set fraction bits of a fixed-point value.
+  //
+  // A value normally shares `RuntimeConfig.fxp_fraction_bits` with all other
+  // values, which is encoded as 0 here. Use SPUContext::getFxpBits(value) to
+  // get the effective one.
+  size_t fxp_bits() const { return fxp_bits_; }
+  Value& setFxpBits(size_t bits) {
+    fxp_bits_ = bits;
+    return *this;
+  }
+
   // Serialize to protobuf.
   ValueProto toProto(size_t max_chunk_size) const;
   size_t chunksCount(size_t max_chunk_size) const;
@@ -102,11 +115,14 @@ struct SimdTrait<Value> {
     int64_t total_numel = 0;
     const Type ty = first->storage_type();
     const auto dtype = first->dtype();
+    const auto fxp_bits = first->fxp_bits();
     for (auto itr = first; itr != last; ++itr) {
       SPU_ENFORCE(itr->storage_type() == ty, "type mismatch {} != {}",
                   itr->storage_type(), ty);
       SPU_ENFORCE(itr->dtype() == dtype, "dtype mismatch {} != {}",
                   itr->dtype(), dtype);
+      SPU_ENFORCE(itr->fxp_bits() == fxp_bits, "fxp bits mismatch {} != {}",
+                  itr->fxp_bits(), fxp_bits);
       total_numel += itr->numel();
     }
     NdArrayRef result(ty, {total_numel});
@@ -119,7 +135,7 @@ struct SimdTrait<Value> {
       pi.push_back(first->shape());
       offset += first->numel() * ty.size();
     }
-    return Value(result, dtype);
+    return Value(result, dtype).setFxpBits(fxp_bits);
   }
 
   template <typename OutputIt>
@@ -136,7 +152,7 @@ struct SimdTrait<Value> {
     for (const auto& shape : pi) {
       auto arr = NdArrayRef(v.data().buf(), v.storage_type(), shape,
                             makeCompactStrides(shape), offset);
-      *result++ = Value(arr, v.dtype());
+      *result++ = Value(arr, v.dtype()).setFxpBits(v.fxp_bits());
       offset += shape.numel() * v.elsize();
     }
 
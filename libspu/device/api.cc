@@ -28,7 +28,9 @@
 #include "libspu/core/trace.h"
 #include "libspu/device/utils/debug_dump_constant.h"
 #include "libspu/dialect/pphlo/IR/dialect.h"
+#include "libspu/dialect/pphlo/IR/types.h"
 #include "libspu/dialect/utils/utils.h"
+#include "libspu/kernel/hal/fxp_base.h"
 #include "libspu/version.h"
 
 namespace spu::device {
@@ -248,12 +250,33 @@ void installLLVMErrorHandler() {
   llvm::remove_fatal_error_handler();
 }
 
+// The compiler lowers bf16 arithmetic to f32, so a half precision input may
+// feed an f32 parameter. Every float shares one fixed point encoding, hence
+// only the dtype is widened to what the type checker expects.
+void widenHalfFloatInputs(mlir::func::FuncOp entry,
+                          std::vector<spu::Value> *inputs) {
+  mlir::spu::pphlo::TypeTools tool(entry->getContext());
+  const auto arg_types = entry.getArgumentTypes();
+  for (size_t idx = 0; idx < arg_types.size() && idx < inputs->size(); ++idx) {
+    auto &input = (*inputs)[idx];
+    if (input.dtype() != DT_BF16 && input.dtype() != DT_F16) {
+      continue;
+    }
+    auto expressed = mlir::dyn_cast<mlir::RankedTensorType>(
+        tool.getExpressedType(arg_types[idx]));
+    if (expressed && expressed.getElementType().isF32()) {
+      input.setDtype(DT_F32, /*force*/ true);
+    }
+  }
+}
+
 }  // namespace
 
 void executeImpl(OpExecutor *executor, spu::SPUContext *sctx,
                  const ExecutableProto &executable, SymbolTable *env) {
   setupTrace(sctx, sctx->config());
   installLLVMErrorHandler();
+  ThreadPoolScope thread_pool_scope(sctx->threadPool());
 
   CommunicationStats comm_stats;
   comm_stats.reset(sctx->lctx());
@@ -314,6 +337,8 @@ void executeImpl(OpExecutor *executor, spu::SPUContext *sctx,
     auto entry_function = mlir::spu::get_entrypoint(moduleOpRef.get());
     SPU_ENFORCE(entry_function, "main module not found");
 
+    widenHalfFloatInputs(entry_function, &inputs);
+
     ExecutionOptions opts;
     opts.do_type_check = rt_config.enable_type_checker();
     opts.do_log_execution = rt_config.enable_pphlo_trace();
@@ -335,6 +360,11 @@ void executeImpl(OpExecutor *executor, spu::SPUContext *sctx,
   {
     TimeitGuard timeit(exec_stats.outfeed_time);
     for (int32_t idx = 0; idx < executable.output_names_size(); idx++) {
+      // Only values of the runtime scale can be exported.
+      if (outputs[idx].fxp_bits() != 0) {
+        outputs[idx] = kernel::hal::f_rescale(sctx, outputs[idx],
+                                              sctx->getFxpBits());
+      }
       env->setVar(executable.output_names(idx), outputs[idx]);
     }
   }
@@ -206,6 +206,7 @@ class OpExecTask final {
       event_->cv.wait(lk, [this] { return ready(); });
     }
 
+    ThreadPoolScope thread_pool_scope(sctx_->threadPool());
     executor_->runKernel(sctx_.get(), sscope_, *op_, opts);
     std::unique_lock lk(event_->mutex);
     event_->cv.notify_all();
@@ -25,6 +25,8 @@
 #define    GELU             "spu.gelu"
 #define    SILU             "spu.silu"
 #define    NEG_EXP          "spu.neg_exp"
+#define    FXP_BITS         "spu.fxp_bits"
+#define    SPLINE           "spu.spline"
 // should be consistent with python level
 #define    MAKE_CACHED_VAR  "spu.make_cached_var"
 #define    DROP_CACHED_VAR  "spu.drop_cached_var"
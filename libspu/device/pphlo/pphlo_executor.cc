@@ -49,6 +49,9 @@ std::pair<spu::PtType, bool> getPtTypeFromMlirType(mlir::Type mlir_ty) {
       tool.getType(mlir_ty, mlir::spu::pphlo::Visibility::PUBLIC);
 
   if (auto ft = mlir::dyn_cast<mlir::FloatType>(express_type)) {
+    if (ft.isBF16()) {
+      return {spu::PT_BF16, false};
+    }
     switch (ft.getWidth()) {
       case 16:
         return {spu::PT_F16, false};
@@ -114,6 +117,9 @@ spu::DataType getDtypeFromMlirType(mlir::Type mlir_ty) {
                   mlir::spu::mlirObjectToString(mlir_ty));
     }
   } else if (auto flp_ty = mlir::dyn_cast<mlir::FloatType>(express_type)) {
+    if (flp_ty.isBF16()) {
+      return spu::DT_BF16;
+    }
     switch (flp_ty.getWidth()) {
       case 16:
         return spu::DT_F16;
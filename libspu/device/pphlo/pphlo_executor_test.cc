@@ -2785,6 +2785,43 @@ func.func @main(%arg0: tensor<20xi32>) -> (tensor<20xi32>, tensor<20xi32>) {
   r.verifyOutput(expected_ret1.data(), 1);
 }
 
+TEST_P(ExecutorTest, BF16Input) {
+  Runner r(std::get<0>(GetParam()), std::get<1>(GetParam()),
+           std::get<2>(GetParam()));
+
+  std::vector<bfloat16> in = {1.5F, -2.25F, 3.0F};
+  r.addInput(in, VIS_SECRET);
+
+  r.run(r.compileMHlo(R"(
+func.func @main(%arg0: tensor<3xbf16>) -> (tensor<3xf32>) {
+  %0 = stablehlo.add %arg0, %arg0 : tensor<3xbf16>
+  %1 = stablehlo.convert %0 : (tensor<3xbf16>) -> tensor<3xf32>
+  return %1 : tensor<3xf32>
+})",
+                      {VIS_SECRET}));
+
+  std::array<float, 3> expected = {3.0F, -4.5F, 6.0F};
+  r.verifyOutput(expected.data());
+}
+
+TEST_P(ExecutorTest, BF16InputToF32Param) {
+  Runner r(std::get<0>(GetParam()), std::get<1>(GetParam()),
+           std::get<2>(GetParam()));
+
+  // As the compiler lowers bf16 to f32, a bf16 input feeds an f32 param.
+  std::vector<bfloat16> in = {1.5F, -2.25F, 3.0F};
+  r.addInput(in);
+
+  r.run(R"(
+func.func @main(%arg0: tensor<3xf32>) -> (tensor<3xf32>) {
+  %0 = pphlo.add %arg0, %arg0 : tensor<3xf32>
+  return %0 : tensor<3xf32>
+})");
+
+  std::array<float, 3> expected = {3.0F, -4.5F, 6.0F};
+  r.verifyOutput(expected.data());
+}
+
 INSTANTIATE_TEST_SUITE_P(
     ExecutorTestInstances, ExecutorTest,
     testing::Combine(testing::Values(4, 3, 2),
@@ -19,8 +19,10 @@
 #include "libspu/device/intrinsic_table.h"
 #include "libspu/kernel/hal/debug.h"
 #include "libspu/kernel/hal/fxp_approx.h"
+#include "libspu/kernel/hal/fxp_base.h"
 #include "libspu/kernel/hal/intrinsic/nn/bumblebee/activation.h"
 #include "libspu/kernel/hal/intrinsic/nn/puma/activation.h"
+#include "libspu/kernel/hal/intrinsic/nn/spline.h"
 #include "libspu/kernel/hlo/basic_binary.h"
 #include "libspu/kernel/hlo/casting.h"
 #include "libspu/kernel/hlo/const.h"
@@ -82,6 +84,36 @@ std::vector<Value> intrinsic_dispatcher(SPUContext* ctx,
     return {};
   }
 
+  if (name == FXP_BITS) {
+    // Scale hint from the compiler, following fixed-point ops keep the scale.
+    SPU_ENFORCE(inputs.size() == 1 && inputs[0].isFxp());
+    auto attr =
+        mlir::dyn_cast<mlir::DictionaryAttr>(call->getAttr("mhlo.attributes"));
+    auto bits =
+        mlir::dyn_cast<mlir::IntegerAttr>(attr.get("fxp_bits")).getInt();
+    return {kernel::hal::f_rescale(ctx, inputs[0], bits)};
+  }
+
+  // Intrinsics below expect fixed-point inputs in the runtime default scale.
+  std::vector<Value> rescaled_inputs;
+  for (const auto& in : inputs) {
+    rescaled_inputs.push_back(
+        in.isFxp() ? kernel::hal::f_rescale(ctx, in, ctx->getFxpBits()) : in);
+  }
+  inputs = rescaled_inputs;
+
+  if (name == SPLINE) {
+    // Piecewise polynomial given by the JSON form of SplineSpec.
+    SPU_ENFORCE(inputs.size() == 1 && inputs[0].isFxp());
+    auto attr =
+        mlir::dyn_cast<mlir::DictionaryAttr>(call->getAttr("mhlo.attributes"));
+    auto spec = mlir::dyn_cast<mlir::StringAttr>(attr.get("spec")).getValue();
+    return {kernel::hal::intrinsic::nn::f_spline(
+        ctx, inputs[0],
+        kernel::hal::intrinsic::nn::ParseSplineSpec(
+            std::string_view(spec.data(), spec.size())))};
+  }
+
   if (name == ERF) {
     SPU_ENFORCE(inputs.size() == 1 && inputs[0].isFxp());
     return {kernel::hal::f_erf(ctx, inputs[0])};
@@ -49,6 +49,8 @@ mlir::Type getElementType(mlir::MLIRContext *mlir_ctx, const spu::Value &v) {
       return mlir::IntegerType::get(mlir_ctx, 64, mlir::IntegerType::Unsigned);
     case DT_F16:
       return mlir::Float16Type::get(mlir_ctx);
+    case DT_BF16:
+      return mlir::BFloat16Type::get(mlir_ctx);
     case DT_F32:
       return mlir::Float32Type::get(mlir_ctx);
     case DT_F64:
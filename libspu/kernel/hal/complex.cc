@@ -19,11 +19,13 @@
 
 namespace spu::kernel::hal {
 
-Value real(SPUContext*, const Value& v) { return Value(v.data(), v.dtype()); }
+Value real(SPUContext*, const Value& v) {
+  return Value(v.data(), v.dtype()).setFxpBits(v.fxp_bits());
+}
 
 Value imag(SPUContext* ctx, const Value& v) {
   if (v.isComplex()) {
-    return Value(*v.imag(), v.dtype());  // NOLINT
+    return Value(*v.imag(), v.dtype()).setFxpBits(v.fxp_bits());  // NOLINT
   } else {
     auto zeros = hal::zeros(ctx, v.dtype(), v.shape());
     if (v.isSecret()) {
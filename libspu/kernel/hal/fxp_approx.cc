@@ -18,6 +18,7 @@
 #include <array>
 #include <cmath>
 #include <future>
+#include <vector>
 
 #include "libspu/core/trace.h"
 #include "libspu/kernel/hal/constants.h"
@@ -955,4 +956,81 @@ Value f_asin(SPUContext* ctx, const Value& x) {
   // asin(x) = pi/2 - acos(x)
   return f_sub(ctx, k_pi2, f_acos(ctx, x));
 }
+
+namespace {
+
+// ret[..., c] = table[(x >> shift) mod 2^index_bits, c]
+Value lookup_rows(SPUContext* ctx, const Value& x, const Value& table,
+                  size_t shift, size_t index_bits) {
+  const int64_t n = table.shape()[0];
+  const int64_t ncols = table.shape()[1];
+  Shape ret_shape = x.shape();
+  ret_shape.push_back(ncols);
+
+  if (auto ret = _lut(ctx, x, table, shift, index_bits)) {
+    return ret->setDtype(table.dtype());
+  }
+
+  // Fallback to onehot(digit) * table.
+  auto digit = _and(ctx, _rshift(ctx, x, shift),
+                    _constant(ctx, n - 1, x.shape()));
+  digit = broadcast_to(ctx, reshape(ctx, digit, {x.numel(), 1}),
+                       {x.numel(), n});
+  auto rows = broadcast_to(ctx, reshape(ctx, iota(ctx, DT_I64, n), {1, n}),
+                           {x.numel(), n});
+  auto onehot = _equal(ctx, digit, rows);
+
+  auto ret = _mmul(ctx, onehot, table).setDtype(table.dtype());
+  return reshape(ctx, ret, ret_shape);
+}
+
+}  // namespace
+
+Value table_lookup(SPUContext* ctx, const Value& x,
+                   absl::Span<const double> table, size_t input_bits,
+                   int64_t range_log2) {
+  SPU_TRACE_HAL_DISP(ctx, x, input_bits, range_log2);
+
+  SPU_ENFORCE(x.isFxp());
+  SPU_ENFORCE(input_bits >= 1 && input_bits <= 8,
+              "input_bits={} should be in [1, 8]", input_bits);
+
+  const int64_t n = 1LL << input_bits;
+  SPU_ENFORCE_EQ(static_cast<int64_t>(table.size()), n + 1);
+
+  const auto k = static_cast<int64_t>(SizeOf(ctx->getField()) * 8);
+  const auto m = static_cast<int64_t>(input_bits);
+  const int64_t shift =
+      static_cast<int64_t>(ctx->getFxpBits(x)) + range_log2 + 1 - m;
+  SPU_ENFORCE(shift >= 0 && shift + m <= k,
+              "range 2^{} is out of the fixed-point precision", range_log2);
+
+  // Row d is the line (intercept, slope) of the segment whose digit is d, i.e.,
+  // the segment [x_j, x_{j+1}) with j = d + n/2 mod n.
+  const double step = std::ldexp(1.0, range_log2 + 1 - input_bits);
+  const double lo = -std::ldexp(1.0, range_log2);
+  std::vector<double> lines(2 * n);
+  for (int64_t d = 0; d < n; ++d) {
+    const int64_t j = (d + n / 2) % n;
+    const double slope = (table[j + 1] - table[j]) / step;
+    lines[2 * d] = table[j] - slope * (lo + j * step);
+    lines[2 * d + 1] = slope;
+  }
+
+  auto lut = constant(ctx, lines, x.dtype(), {n, 2});
+  auto rows = lookup_rows(ctx, x, lut, shift, input_bits);
+
+  Index start(x.shape().size() + 1, 0);
+  Index end(x.shape().begin(), x.shape().end());
+  end.push_back(1);
+  auto intercept = reshape(ctx, slice(ctx, rows, start, end), x.shape());
+  start.back() = 1;
+  end.back() = 2;
+  auto slope = reshape(ctx, slice(ctx, rows, start, end), x.shape());
+
+  // The local digit sum may miss the carry of the lower bits, then the line
+  // of the previous segment is used, which is still close to f around x.
+  return f_add(ctx, intercept, f_mul(ctx, slope, x));
+}
+
 }  // namespace spu::kernel::hal
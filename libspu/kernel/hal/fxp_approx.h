@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include "absl/types/span.h"
+
 #include "libspu/core/value.h"
 
 namespace spu {
@@ -72,4 +74,18 @@ Value f_acos(SPUContext* ctx, const Value& x);
 
 Value f_asin(SPUContext* ctx, const Value& x);
 
+// Evaluates a function by the linear interpolation of its samples.
+//
+// `table` holds the 2^input_bits + 1 samples f(x_j) on the uniform grid
+//   x_j = -2^range_log2 + j * step, step = 2^(range_log2 + 1 - input_bits).
+// The segment of x is given by the `input_bits` high bits of x, which costs a
+// single table lookup (one 1-of-2^input_bits OT for Cheetah) plus one
+// multiplication for the linear correction.
+//
+// NOTE: x is expected in [-2^range_log2 + step, 2^range_log2), the index wraps
+// around out of this range. Clamp x beforehand if needed.
+Value table_lookup(SPUContext* ctx, const Value& x,
+                   absl::Span<const double> table, size_t input_bits,
+                   int64_t range_log2);
+
 }  // namespace spu::kernel::hal
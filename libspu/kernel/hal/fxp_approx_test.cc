@@ -14,12 +14,16 @@
 
 #include "libspu/kernel/hal/fxp_approx.h"
 
+#include <cmath>
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "xtensor/xio.hpp"
 
 #include "libspu/kernel/hal/constants.h"
 #include "libspu/kernel/hal/type_cast.h"
 #include "libspu/kernel/test_util.h"
+#include "libspu/mpc/utils/simulate.h"
 
 namespace spu::kernel::hal {
 
@@ -509,4 +513,80 @@ TEST(FxpTest, Asin) {
   }
 }
 
+class TableLookupTest : public ::testing::TestWithParam<
+                            std::tuple<size_t, FieldType, ProtocolKind>> {};
+
+TEST_P(TableLookupTest, Sigmoid) {
+  size_t npc = std::get<0>(GetParam());
+  FieldType field = std::get<1>(GetParam());
+  ProtocolKind prot = std::get<2>(GetParam());
+
+  // sigmoid sampled on [-8, 8] with 2^6 segments
+  constexpr size_t kInputBits = 6;
+  constexpr int64_t kRangeLog2 = 3;
+  std::vector<double> table((1 << kInputBits) + 1);
+  for (size_t j = 0; j < table.size(); ++j) {
+    double xj = -8.0 + static_cast<double>(j) * 0.25;
+    table[j] = 1.0 / (1.0 + std::exp(-xj));
+  }
+
+  xt::xarray<float> x = xt::linspace<float>(-7.7, 7.9, 200);
+  xt::xarray<float> expected = 1.0 / (1.0 + xt::exp(-x));
+
+  mpc::utils::simulate(
+      npc, [&](const std::shared_ptr<yacl::link::Context> &lctx) {
+        SPUContext ctx = test::makeSPUContext(prot, field, lctx);
+
+        // public
+        {
+          Value a = constant(&ctx, x, DT_F32);
+          Value c = table_lookup(&ctx, a, table, kInputBits, kRangeLog2);
+          EXPECT_EQ(c.dtype(), DT_F32);
+          auto y = dump_public_as<float>(&ctx, c);
+          EXPECT_TRUE(xt::allclose(expected, y, 0.01, 0.001))
+              << expected << std::endl
+              << y;
+        }
+        // secret
+        {
+          Value a = test::makeValue(&ctx, x, VIS_SECRET);
+          Value c = table_lookup(&ctx, a, table, kInputBits, kRangeLog2);
+          EXPECT_EQ(c.dtype(), DT_F32);
+          auto y = dump_public_as<float>(&ctx, reveal(&ctx, c));
+          EXPECT_TRUE(xt::allclose(expected, y, 0.01, 0.001))
+              << expected << std::endl
+              << y;
+        }
+      });
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    TableLookupRef2kTestInstances, TableLookupTest,
+    testing::Combine(testing::Values(1), testing::Values(FieldType::FM64),
+                     testing::Values(ProtocolKind::REF2K)),
+    [](const testing::TestParamInfo<TableLookupTest::ParamType> &p) {
+      return fmt::format("{}x{}x{}", std::get<0>(p.param), std::get<1>(p.param),
+                         std::get<2>(p.param));
+    });
+
+INSTANTIATE_TEST_SUITE_P(
+    TableLookup2PCTestInstances, TableLookupTest,
+    testing::Combine(testing::Values(2),
+                     testing::Values(FieldType::FM64, FieldType::FM128),
+                     testing::Values(ProtocolKind::SEMI2K,
+                                     ProtocolKind::CHEETAH)),
+    [](const testing::TestParamInfo<TableLookupTest::ParamType> &p) {
+      return fmt::format("{}x{}x{}", std::get<0>(p.param), std::get<1>(p.param),
+                         std::get<2>(p.param));
+    });
+
+INSTANTIATE_TEST_SUITE_P(
+    TableLookup3PCTestInstances, TableLookupTest,
+    testing::Combine(testing::Values(3), testing::Values(FieldType::FM64),
+                     testing::Values(ProtocolKind::SEMI2K)),
+    [](const testing::TestParamInfo<TableLookupTest::ParamType> &p) {
+      return fmt::format("{}x{}x{}", std::get<0>(p.param), std::get<1>(p.param),
+                         std::get<2>(p.param));
+    });
+
 }  // namespace spu::kernel::hal
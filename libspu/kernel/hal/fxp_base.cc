@@ -21,6 +21,7 @@
 #include "libspu/kernel/hal/constants.h"
 #include "libspu/kernel/hal/fxp_cleartext.h"
 #include "libspu/kernel/hal/ring.h"
+#include "libspu/kernel/hal/shape_ops.h"
 
 namespace spu::kernel::hal {
 namespace detail {
@@ -85,6 +86,18 @@ void hintNumberOfBits(const Value& a, size_t nbits) {
   }
 }
 
+Value trunc_product(SPUContext* ctx, const Value& prod, const Value& x,
+                    const Value& y, SignType sign) {
+  // prod carries bits(x) + bits(y) fraction bits, truncating by the smaller
+  // one keeps the finer scale of x and y.
+  const size_t x_bits = ctx->getFxpBits(x);
+  const size_t y_bits = ctx->getFxpBits(y);
+  Value ret = _trunc(ctx, prod, std::min(x_bits, y_bits), sign)
+                  .setDtype(x.dtype());
+  const size_t bits = std::max(x_bits, y_bits);
+  return ret.setFxpBits(bits == ctx->getFxpBits() ? 0 : bits);
+}
+
 namespace {
 
 Value reciprocal_goldschmidt_normalized_approx(SPUContext* ctx,
@@ -124,6 +137,103 @@ Value reciprocal_goldschmidt_normalized_approx(SPUContext* ctx,
 
   return r;
 }
+
+// Goldschmidt state of a positive b = c*2^{m}, c \in [0.5, 1).
+struct NormalizedReciprocal {
+  // approximation of 1/c
+  Value r;
+  // 2^{f-m}, the fixed point repr of 2^{-m}
+  Value factor;
+};
+
+NormalizedReciprocal reciprocal_goldschmidt_normalize(SPUContext* ctx,
+                                                      const Value& b_abs) {
+  auto b_msb = detail::highestOneBit(ctx, b_abs);
+
+  // factor = 2^{f-m} = 2^{-m} * 2^f, the fixed point repr of 2^{-m}
+  const size_t num_fxp_bits = ctx->getFxpBits();
+  auto factor =
+      _bitrev(ctx, b_msb, 0, 2 * num_fxp_bits).setDtype(b_abs.dtype());
+  detail::hintNumberOfBits(factor, 2 * num_fxp_bits);
+  // also, we use factor twice
+  factor = _prefer_a(ctx, factor);
+
+  // compute approximation of normalize b_abs
+  auto r = reciprocal_goldschmidt_normalized_approx(ctx, b_abs, factor);
+
+  return {std::move(r), std::move(factor)};
+}
+
+// Returns |b| and the msb of b, as a secret-shared bit.
+std::pair<Value, Value> abs_with_sign(SPUContext* ctx, const Value& b,
+                                      SignType b_sign) {
+  if (b_sign == SignType::Positive) {
+    return {b, _constant(ctx, 0, b.shape())};
+  }
+  if (b_sign == SignType::Negative) {
+    return {_negate(ctx, b).setDtype(b.dtype()),
+            _constant(ctx, static_cast<uint128_t>(1), b.shape())};
+  }
+  // We prefer  b_abs = b < 0 ? -b : b over b_abs = sign(b) * b
+  // because MulA1B is a better choice than MulAA for CHEETAH.
+  // For ABY3, these two computations give the same cost though.
+  auto is_negative = _msb(ctx, b);
+  // insert ``prefer_a'' because the msb bit are used twice.
+  is_negative = _prefer_a(ctx, is_negative);
+  auto b_abs = _mux(ctx, is_negative, _negate(ctx, b), b).setDtype(b.dtype());
+  return {std::move(b_abs), std::move(is_negative)};
+}
+
+// A broadcast value aliases the same elements along its zero-stride axes,
+// e.g. the row sums of a softmax broadcast along the columns. Returns the
+// compact tensor of its distinct elements and the axes of `x` they map to,
+// so the per-denominator work runs once per row instead of once per column.
+std::pair<Value, Axes> unique_broadcast(SPUContext* ctx, const Value& x) {
+  const Shape& shape = x.shape();
+  const Strides& strides = x.data().strides();
+
+  Index start(shape.size(), 0);
+  Index end(shape.begin(), shape.end());
+  Shape unique_shape;
+  Axes unique_axes;
+  for (size_t dim = 0; dim < shape.size(); ++dim) {
+    if (strides[dim] == 0 && shape[dim] > 1) {
+      end[dim] = 1;
+    } else {
+      unique_shape.push_back(shape[dim]);
+      unique_axes.push_back(static_cast<int64_t>(dim));
+    }
+  }
+
+  if (x.isComplex() || unique_axes.size() == shape.size()) {
+    return {x, std::move(unique_axes)};
+  }
+
+  auto unique = reshape(ctx, slice(ctx, x, start, end), unique_shape);
+  return {std::move(unique), std::move(unique_axes)};
+}
+
+// Signs the reciprocal factor 2^{-m} with sign(b), which folds the sign
+// correction of a/b into the multiplication by factor.
+Value signed_factor(SPUContext* ctx, const Value& factor,
+                    const Value& is_negative, SignType b_sign) {
+  if (b_sign == SignType::Positive) {
+    return factor;
+  }
+  if (b_sign == SignType::Negative) {
+    return _negate(ctx, factor).setDtype(factor.dtype());
+  }
+  return _mux(ctx, is_negative, _negate(ctx, factor), factor)
+      .setDtype(factor.dtype());
+}
+
+SignType product_sign(SignType a_sign, SignType b_sign) {
+  if (a_sign == SignType::Unknown || b_sign == SignType::Unknown) {
+    return SignType::Unknown;
+  }
+  return a_sign == b_sign ? SignType::Positive : SignType::Negative;
+}
+
 }  // namespace
 
 // Reference:
@@ -152,39 +262,25 @@ Value reciprocal_goldschmidt_normalized_approx(SPUContext* ctx,
 //   return r * a * 2^{-m}
 //
 // Precision is decided by magic number, i.e 2.9142 and f.
+//
+// When b is broadcast, the normalization and iterations only run on the
+// distinct denominators, and the sign of b is folded into 2^{-m} there.
 Value div_goldschmidt_general(SPUContext* ctx, const Value& a, const Value& b,
                               SignType a_sign, SignType b_sign) {
-  Value b_abs;
-  Value is_negative;
-  if (b_sign == SignType::Unknown) {
-    // We prefer  b_abs = b < 0 ? -b : b over b_abs = sign(b) * b
-    // because MulA1B is a better choice than MulAA for CHEETAH.
-    // For ABY3, these two computations give the same cost though.
-    is_negative = _msb(ctx, b);
-    // insert ``prefer_a'' because the msb bit are used twice.
-    is_negative = _prefer_a(ctx, is_negative);
-    b_abs = _mux(ctx, is_negative, _negate(ctx, b), b).setDtype(b.dtype());
-  } else if (b_sign == SignType::Positive) {
-    is_negative = _constant(ctx, 0, b.shape());
-    b_abs = b;
-  } else {
-    // b is negative
-    is_negative = _constant(ctx, static_cast<uint128_t>(1), b.shape());
-    b_abs = _negate(ctx, b).setDtype(b.dtype());
+  auto [b_unique, unique_axes] = unique_broadcast(ctx, b);
+  auto [b_abs, is_negative] = abs_with_sign(ctx, b_unique, b_sign);
+  auto [r, factor] = reciprocal_goldschmidt_normalize(ctx, b_abs);
+
+  if (b_unique.numel() < b.numel()) {
+    factor = signed_factor(ctx, factor, is_negative, b_sign);
+    r = broadcast_to(ctx, r, b.shape(), unique_axes);
+    factor = broadcast_to(ctx, factor, b.shape(), unique_axes);
+
+    r = f_mul(ctx, r, a, a_sign);
+    return f_mul(ctx, r, factor, product_sign(a_sign, b_sign))
+        .setDtype(a.dtype());
   }
 
-  auto b_msb = detail::highestOneBit(ctx, b_abs);
-
-  // factor = 2^{f-m} = 2^{-m} * 2^f, the fixed point repr of 2^{-m}
-  const size_t num_fxp_bits = ctx->getFxpBits();
-  auto factor = _bitrev(ctx, b_msb, 0, 2 * num_fxp_bits).setDtype(b.dtype());
-  detail::hintNumberOfBits(factor, 2 * num_fxp_bits);
-  // also, we use factor twice
-  factor = _prefer_a(ctx, factor);
-
-  // compute approximation of normalize b_abs
-  auto r = reciprocal_goldschmidt_normalized_approx(ctx, b_abs, factor);
-
   // r from goldschmidt iteration is always positive
   // so sign(r*a) = sign(a)
   r = f_mul(ctx, r, a, a_sign);
@@ -203,20 +299,12 @@ Value div_goldschmidt(SPUContext* ctx, const Value& a, const Value& b) {
 Value reciprocal_goldschmidt_positive(SPUContext* ctx, const Value& b_abs) {
   SPU_TRACE_HAL_DISP(ctx, b_abs);
 
-  auto b_msb = detail::highestOneBit(ctx, b_abs);
-
-  // factor = 2^{f-m} = 2^{-m} * 2^f, the fixed point repr of 2^{-m}
-  const size_t num_fxp_bits = ctx->getFxpBits();
-  auto factor =
-      _bitrev(ctx, b_msb, 0, 2 * num_fxp_bits).setDtype(b_abs.dtype());
-  detail::hintNumberOfBits(factor, 2 * num_fxp_bits);
-  // also, we use factor twice
-  factor = _prefer_a(ctx, factor);
+  auto [b_unique, unique_axes] = unique_broadcast(ctx, b_abs);
+  auto [r, factor] = reciprocal_goldschmidt_normalize(ctx, b_unique);
 
-  // compute approximation of normalize b_abs
-  auto r = reciprocal_goldschmidt_normalized_approx(ctx, b_abs, factor);
+  r = f_mul(ctx, r, factor, SignType::Positive);
 
-  return f_mul(ctx, r, factor, SignType::Positive);
+  return broadcast_to(ctx, r, b_abs.shape(), unique_axes);
 }
 
 // NOTE(junfeng): we have a separate reciprocal_goldschmidt is to avoid
@@ -224,38 +312,55 @@ Value reciprocal_goldschmidt_positive(SPUContext* ctx, const Value& b_abs) {
 Value reciprocal_goldschmidt(SPUContext* ctx, const Value& b) {
   SPU_TRACE_HAL_DISP(ctx, b);
 
-  // We prefer  b_abs = b < 0 ? -b : b over b_abs = sign(b) * b
-  // because MulA1B is a better choice than MulAA for CHEETAH.
-  // For ABY3, these two computations give the same cost though.
-  auto is_negative = _msb(ctx, b);
-  // insert ``prefer_a'' because the msb bit are used twice.
-  is_negative = _prefer_a(ctx, is_negative);
-  auto b_abs = _mux(ctx, is_negative, _negate(ctx, b), b).setDtype(b.dtype());
+  auto [b_unique, unique_axes] = unique_broadcast(ctx, b);
+  auto [b_abs, is_negative] = abs_with_sign(ctx, b_unique, SignType::Unknown);
+  auto [r, factor] = reciprocal_goldschmidt_normalize(ctx, b_abs);
 
-  auto b_msb = detail::highestOneBit(ctx, b_abs);
+  r = f_mul(ctx, r, factor, SignType::Positive);
+  r = _mux(ctx, is_negative, _negate(ctx, r), r).setDtype(b.dtype());
 
-  // factor = 2^{f-m} = 2^{-m} * 2^f, the fixed point repr of 2^{-m}
-  const size_t num_fxp_bits = ctx->getFxpBits();
-  auto factor = _bitrev(ctx, b_msb, 0, 2 * num_fxp_bits).setDtype(b.dtype());
-  detail::hintNumberOfBits(factor, 2 * num_fxp_bits);
-  // also, we use factor twice
-  factor = _prefer_a(ctx, factor);
+  return broadcast_to(ctx, r, b.shape(), unique_axes);
+}
 
-  // compute approximation of normalize b_abs
-  auto r = reciprocal_goldschmidt_normalized_approx(ctx, b_abs, factor);
+Value mul_reciprocal_goldschmidt(SPUContext* ctx, const Value& a,
+                                 const Value& b) {
+  SPU_TRACE_HAL_DISP(ctx, a, b);
 
-  r = f_mul(ctx, r, factor, SignType::Positive);
+  // The normalization and the 2f truncation below work on the runtime
+  // default scale, only a may keep its own.
+  const Value b_def = _rescale(ctx, b, ctx->getFxpBits());
 
-  return _mux(ctx, is_negative, _negate(ctx, r), r).setDtype(b.dtype());
+  auto [b_unique, unique_axes] = unique_broadcast(ctx, b_def);
+  auto [b_abs, is_negative] = abs_with_sign(ctx, b_unique, SignType::Unknown);
+  auto [r, factor] = reciprocal_goldschmidt_normalize(ctx, b_abs);
+  factor = signed_factor(ctx, factor, is_negative, SignType::Unknown);
+
+  // r * factor carries 2f fraction bits, keep it untruncated so a * r *
+  // factor only pays one truncation.
+  auto recip = _mul(ctx, r, factor).setDtype(b.dtype());
+  recip = broadcast_to(ctx, recip, b.shape(), unique_axes);
+
+  return _trunc(ctx, _mul(ctx, a, recip), 2 * ctx->getFxpBits())
+      .setDtype(a.dtype())
+      .setFxpBits(a.fxp_bits());
 }
 
 }  // namespace detail
 
+Value f_rescale(SPUContext* ctx, const Value& x, size_t bits) {
+  SPU_TRACE_HAL_LEAF(ctx, x, bits);
+
+  SPU_ENFORCE(x.isFxp(), "{}", x);
+  SPU_ENFORCE(bits > 0 && bits < SizeOf(ctx->getField()) * 8,
+              "invalid fraction bits {}", bits);
+  return _rescale(ctx, x, bits);
+}
+
 Value f_negate(SPUContext* ctx, const Value& x) {
   SPU_TRACE_HAL_LEAF(ctx, x);
 
   SPU_ENFORCE(x.isFxp());
-  return _negate(ctx, x).setDtype(x.dtype());
+  return _negate(ctx, x).setDtype(x.dtype()).setFxpBits(x.fxp_bits());
 }
 
 Value f_abs(SPUContext* ctx, const Value& x) {
@@ -283,7 +388,13 @@ Value f_add(SPUContext* ctx, const Value& x, const Value& y) {
 
   SPU_ENFORCE(x.isFxp() && y.isFxp() && x.dtype() == y.dtype());
 
-  return _add(ctx, x, y).setDtype(x.dtype());
+  if (ctx->getFxpBits(x) != ctx->getFxpBits(y)) {
+    // align to the finer scale, which is a local shift.
+    const size_t bits = std::max(ctx->getFxpBits(x), ctx->getFxpBits(y));
+    return f_add(ctx, _rescale(ctx, x, bits), _rescale(ctx, y, bits));
+  }
+
+  return _add(ctx, x, y).setDtype(x.dtype()).setFxpBits(x.fxp_bits());
 }
 
 Value f_sub(SPUContext* ctx, const Value& x, const Value& y) {
@@ -299,8 +410,7 @@ Value f_mul(SPUContext* ctx, const Value& x, const Value& y, SignType sign) {
 
   SPU_ENFORCE(x.isFxp() && y.isFxp() && x.dtype() == y.dtype());
 
-  return _trunc(ctx, _mul(ctx, x, y), ctx->getFxpBits(), sign)
-      .setDtype(x.dtype());
+  return detail::trunc_product(ctx, _mul(ctx, x, y), x, y, sign);
 }
 
 Value f_mmul(SPUContext* ctx, const Value& x, const Value& y) {
@@ -308,7 +418,7 @@ Value f_mmul(SPUContext* ctx, const Value& x, const Value& y) {
 
   SPU_ENFORCE(x.isFxp() && y.isFxp() && x.dtype() == y.dtype());
 
-  return _trunc(ctx, _mmul(ctx, x, y)).setDtype(x.dtype());
+  return detail::trunc_product(ctx, _mmul(ctx, x, y), x, y);
 }
 
 std::optional<Value> f_batch_mmul(SPUContext* ctx, const Value& x,
@@ -320,7 +430,7 @@ std::optional<Value> f_batch_mmul(SPUContext* ctx, const Value& x,
   if (not ret.has_value()) {
     return NotAvailable;
   }
-  return _trunc(ctx, *ret).setDtype(x.dtype());
+  return detail::trunc_product(ctx, *ret, x, y);
 }
 
 Value f_conv2d(SPUContext* ctx, const Value& x, const Value& y,
@@ -329,7 +439,7 @@ Value f_conv2d(SPUContext* ctx, const Value& x, const Value& y,
 
   SPU_ENFORCE(x.isFxp() && y.isFxp() && x.dtype() == y.dtype());
 
-  return _trunc(ctx, _conv2d(ctx, x, y, window_strides)).setDtype(x.dtype());
+  return detail::trunc_product(ctx, _conv2d(ctx, x, y, window_strides), x, y);
 }
 
 Value f_tensordot(SPUContext* ctx, const Value& x, const Value& y,
@@ -338,7 +448,7 @@ Value f_tensordot(SPUContext* ctx, const Value& x, const Value& y,
 
   SPU_ENFORCE(x.isFxp() && y.isFxp() && x.dtype() == y.dtype());
 
-  return _trunc(ctx, _tensordot(ctx, x, y, ix, iy)).setDtype(x.dtype());
+  return detail::trunc_product(ctx, _tensordot(ctx, x, y, ix, iy), x, y);
 }
 
 Value f_div(SPUContext* ctx, const Value& x, const Value& y) {
@@ -353,6 +463,18 @@ Value f_div(SPUContext* ctx, const Value& x, const Value& y) {
   return detail::div_goldschmidt(ctx, x, y);
 }
 
+Value f_mul_reciprocal(SPUContext* ctx, const Value& x, const Value& y) {
+  SPU_TRACE_HAL_LEAF(ctx, x, y);
+
+  SPU_ENFORCE(x.isFxp() && y.isFxp() && x.dtype() == y.dtype());
+
+  if (y.isPublic()) {
+    return f_mul(ctx, x, f_reciprocal_p(ctx, y));
+  }
+
+  return detail::mul_reciprocal_goldschmidt(ctx, x, y);
+}
+
 Value f_equal(SPUContext* ctx, const Value& x, const Value& y) {
   SPU_TRACE_HAL_LEAF(ctx, x, y);
 
@@ -373,8 +495,7 @@ Value f_square(SPUContext* ctx, const Value& x) {
   SPU_TRACE_HAL_LEAF(ctx, x);
 
   SPU_ENFORCE(x.isFxp(), "{}", x);
-  return _trunc(ctx, _square(ctx, x), ctx->getFxpBits(), SignType::Positive)
-      .setDtype(x.dtype());
+  return detail::trunc_product(ctx, _square(ctx, x), x, x, SignType::Positive);
 }
 
 Value f_floor(SPUContext* ctx, const Value& x) {
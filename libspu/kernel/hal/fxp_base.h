@@ -30,6 +30,10 @@ Value highestOneBit(SPUContext* ctx, const Value& x);
 
 void hintNumberOfBits(const Value& a, size_t nbits);
 
+// Truncate the ring product of fixed-point x and y back to fixed-point.
+Value trunc_product(SPUContext* ctx, const Value& prod, const Value& x,
+                    const Value& y, SignType sign = SignType::Unknown);
+
 // we provide this general function to support some special cases (a or b has
 // guarranteed sign) in fxp_approx for better both performance and accuracy.
 Value div_goldschmidt_general(SPUContext* ctx, const Value& a, const Value& b,
@@ -42,6 +46,10 @@ Value reciprocal_goldschmidt_positive(SPUContext* ctx, const Value& b_abs);
 
 Value reciprocal_goldschmidt(SPUContext* ctx, const Value& b);
 
+// a * (1/b) with a single truncation per element, see f_mul_reciprocal.
+Value mul_reciprocal_goldschmidt(SPUContext* ctx, const Value& a,
+                                 const Value& b);
+
 Value polynomial(SPUContext* ctx, const Value& x,
                  absl::Span<Value const> coeffs,
                  SignType sign_x = SignType::Unknown,
@@ -54,6 +62,13 @@ Value polynomial(SPUContext* ctx, const Value& x,
 
 }  // namespace detail
 
+// Rescale a fixed-point value to `bits` fraction bits.
+//
+// Values normally use RuntimeConfig.fxp_fraction_bits. f_add, f_sub, f_mul,
+// f_mmul, f_tensordot, f_conv2d and f_square keep per value scales, other
+// fixed-point kernels expect the runtime default.
+Value f_rescale(SPUContext* ctx, const Value& x, size_t bits);
+
 Value f_negate(SPUContext* ctx, const Value& x);
 
 Value f_abs(SPUContext* ctx, const Value& x);
@@ -80,6 +95,12 @@ Value f_tensordot(SPUContext* ctx, const Value& x, const Value& y,
 
 Value f_div(SPUContext* ctx, const Value& x, const Value& y);
 
+// x * (1/y) as one fused kernel. 1/y is kept at 2f fraction bits so each
+// element is truncated once instead of twice, which requires
+// |x/y| < 2^{k-3f-2}, e.g. softmax normalization and attention scaling.
+// Denominators broadcast along some axes are normalized only once.
+Value f_mul_reciprocal(SPUContext* ctx, const Value& x, const Value& y);
+
 Value f_equal(SPUContext* ctx, const Value& x, const Value& y);
 
 Value f_less(SPUContext* ctx, const Value& x, const Value& y);
@@ -19,6 +19,7 @@
 
 #include "libspu/core/parallel_utils.h"
 #include "libspu/kernel/hal/constants.h"
+#include "libspu/kernel/hal/shape_ops.h"
 #include "libspu/kernel/hal/type_cast.h"
 #include "libspu/kernel/test_util.h"
 
@@ -101,6 +102,73 @@ TEST_P(FxpMmulTest, Works) {
   }
 }
 
+TEST(FxpTest, MixedFractionBits) {
+  // GIVEN
+  SPUContext ctx = test::makeSPUContext();
+
+  xt::xarray<float> x = {1.5, -2.25, 3.0, 0.75};
+  xt::xarray<float> y = {0.5, 4.0, -1.25, -3.5};
+
+  Value a = test::makeValue(&ctx, x, VIS_SECRET);
+  Value b = test::makeValue(&ctx, y, VIS_SECRET);
+
+  // WHAT
+  Value a8 = f_rescale(&ctx, a, 8);
+  Value b8 = f_rescale(&ctx, b, 8);
+
+  // THEN
+  EXPECT_EQ(ctx.getFxpBits(a8), 8U);
+  EXPECT_EQ(a8.dtype(), DT_F32);
+  {
+    // decoding honors the per value scale.
+    auto z = dump_public_as<float>(&ctx, reveal(&ctx, a8));
+    EXPECT_TRUE(xt::allclose(x, z, 0.01, 0.001)) << x << std::endl << z;
+  }
+
+  {
+    // the finer scale wins.
+    Value c = f_add(&ctx, a8, b);
+    EXPECT_EQ(c.fxp_bits(), 0U);
+    auto z = dump_public_as<float>(&ctx, reveal(&ctx, c));
+    EXPECT_TRUE(xt::allclose(x + y, z, 0.01, 0.001)) << (x + y) << std::endl
+                                                     << z;
+  }
+
+  {
+    Value c = f_mul(&ctx, a8, b);
+    EXPECT_EQ(c.fxp_bits(), 0U);
+    auto z = dump_public_as<float>(&ctx, reveal(&ctx, c));
+    EXPECT_TRUE(xt::allclose(x * y, z, 0.01, 0.001)) << (x * y) << std::endl
+                                                     << z;
+  }
+
+  {
+    // both narrow, the product stays narrow.
+    Value c = f_mul(&ctx, a8, b8);
+    EXPECT_EQ(ctx.getFxpBits(c), 8U);
+    auto z = dump_public_as<float>(&ctx, reveal(&ctx, c));
+    EXPECT_TRUE(xt::allclose(x * y, z, 0.01, 0.01)) << (x * y) << std::endl
+                                                    << z;
+  }
+
+  {
+    // the divisor is normalized in the default scale, a keeps its own.
+    Value c = f_mul_reciprocal(&ctx, a8, b8);
+    EXPECT_EQ(ctx.getFxpBits(c), 8U);
+    auto z = dump_public_as<float>(&ctx, reveal(&ctx, c));
+    EXPECT_TRUE(xt::allclose(x / y, z, 0.01, 0.01)) << (x / y) << std::endl
+                                                    << z;
+  }
+
+  {
+    // back to the runtime default.
+    Value c = f_rescale(&ctx, a8, ctx.getFxpBits());
+    EXPECT_EQ(c.fxp_bits(), 0U);
+    auto z = dump_public_as<float>(&ctx, reveal(&ctx, c));
+    EXPECT_TRUE(xt::allclose(x, z, 0.01, 0.001)) << x << std::endl << z;
+  }
+}
+
 TEST(FxpTest, Reciprocal) {
   // GIVEN
   SPUContext ctx = test::makeSPUContext();
@@ -184,6 +252,43 @@ TEST(FxpTest, Div) {
   }
 }
 
+TEST(FxpTest, BroadcastDiv) {
+  // GIVEN
+  SPUContext ctx = test::makeSPUContext();
+
+  xt::xarray<float> x = {{1.0, -2.0, 3.0, 0.5},
+                         {-100.0, 20.0, 7.5, 0.0},
+                         {1.5, -3.0, 42.0, 8.0}};
+  xt::xarray<float> y = {2.0, -40.0, 64.0};
+  xt::xarray<float> y_col = {{2.0}, {-40.0}, {64.0}};
+  xt::xarray<float> expected = x / y_col;
+
+  Value a = test::makeValue(&ctx, x, VIS_SECRET);
+  // y is shared along the columns.
+  Value b = broadcast_to(&ctx, test::makeValue(&ctx, y, VIS_SECRET),
+                         a.shape(), {0});
+
+  // WHAT
+  Value c = f_div(&ctx, a, b);
+  Value d = f_mul_reciprocal(&ctx, a, b);
+  Value e = f_reciprocal(&ctx, b);
+
+  // THEN
+  EXPECT_EQ(c.shape(), a.shape());
+  auto z = dump_public_as<float>(&ctx, reveal(&ctx, c));
+  EXPECT_TRUE(xt::allclose(expected, z, 0.01, 0.001)) << expected << std::endl
+                                                      << z;
+
+  EXPECT_EQ(d.shape(), a.shape());
+  z = dump_public_as<float>(&ctx, reveal(&ctx, d));
+  EXPECT_TRUE(xt::allclose(expected, z, 0.01, 0.001)) << expected << std::endl
+                                                      << z;
+
+  xt::xarray<float> r = x * 0.0F + 1.0F / y_col;
+  z = dump_public_as<float>(&ctx, reveal(&ctx, e));
+  EXPECT_TRUE(xt::allclose(r, z, 0.01, 0.001)) << r << std::endl << z;
+}
+
 TEST(FxpTest, Abs) {
   // GIVEN
   SPUContext ctx = test::makeSPUContext();
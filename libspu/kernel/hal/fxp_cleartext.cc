@@ -65,8 +65,7 @@ Value applyFloatingPointFn(SPUContext* ctx, const Value& in, FN&& fn) {
 
   DataType dtype;
   const auto out = encodeToRing(fp_arr, field, fxp_bits, &dtype);
-  SPU_ENFORCE(dtype == DT_F16 || dtype == DT_F32 || dtype == DT_F64,
-              "sanity failed");
+  SPU_ENFORCE(isFixedPoint(dtype), "sanity failed");
   return Value(out.as(in.storage_type()), dtype);
 }
 
@@ -103,7 +102,7 @@ Value applyFloatingPointFn(SPUContext* ctx, const Value& x, const Value& y,
 
   DataType dtype;
   const auto out = encodeToRing(flp_x, field, fxp_bits, &dtype);
-  SPU_ENFORCE(dtype == DT_F32 || dtype == DT_F64, "sanity failed");
+  SPU_ENFORCE(isFixedPoint(dtype), "sanity failed");
   return Value(out.as(x.storage_type()), dtype);
 }
 
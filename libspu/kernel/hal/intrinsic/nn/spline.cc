@@ -0,0 +1,167 @@
+// Copyright 2024 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libspu/kernel/hal/intrinsic/nn/spline.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "google/protobuf/util/json_util.h"
+
+#include "libspu/core/context.h"
+#include "libspu/core/prelude.h"
+#include "libspu/core/trace.h"
+#include "libspu/kernel/hal/constants.h"
+#include "libspu/kernel/hal/fxp_base.h"
+#include "libspu/kernel/hal/ring.h"
+#include "libspu/kernel/hal/shape_ops.h"
+#include "libspu/mpc/cheetah/alg.h"
+
+namespace spu::kernel::hal::intrinsic::nn {
+
+namespace {
+
+void ValidateSpec(const SplineSpec& spec) {
+  SPU_ENFORCE_EQ(spec.segments_size(), spec.breakpoints_size() + 1,
+                 "{} breakpoints need {} segments", spec.breakpoints_size(),
+                 spec.breakpoints_size() + 1);
+  for (int i = 1; i < spec.breakpoints_size(); ++i) {
+    SPU_ENFORCE(spec.breakpoints(i - 1) < spec.breakpoints(i),
+                "breakpoints should be strictly ascending");
+  }
+}
+
+// ret[i, j] = x[j] < b[i] as a boolean of shape {b.size(), x.numel()}
+Value BatchLess(SPUContext* ctx, const Value& x, absl::Span<const float> b) {
+  const auto n = static_cast<int64_t>(b.size());
+  const int64_t numel = x.numel();
+
+  if (x.isSecret() && ctx->config().protocol() == ProtocolKind::CHEETAH) {
+    // pack the comparisons of all breakpoints into one OT with long messages
+    KernelEvalContext kctx(ctx);
+    auto lts = mpc::cheetah::BatchLessThan(&kctx, _prefer_a(ctx, x).data(), b);
+    std::vector<Value> rows;
+    for (auto& lt : lts) {
+      rows.emplace_back(lt.reshape({1, numel}), DT_I1);
+    }
+    return concatenate(ctx, rows, 0);
+  }
+
+  auto xs = broadcast_to(ctx, reshape(ctx, x, {1, numel}), {n, numel});
+  auto bs = broadcast_to(
+      ctx, constant(ctx, std::vector<float>(b.begin(), b.end()), x.dtype(),
+                    {n, 1}),
+      {n, numel});
+  return f_less(ctx, xs, bs);
+}
+
+// Segment indicators of shape {n + 1, numel} from the n rows of x < b_i.
+//   seg_0 = lt_0, seg_i = lt_i ^ lt_{i-1}, seg_n = lt_{n-1} ^ 1
+Value SegmentIndicators(SPUContext* ctx, const Value& lt) {
+  const int64_t n = lt.shape()[0];
+  const int64_t numel = lt.shape()[1];
+
+  std::vector<Value> segs;
+  segs.push_back(slice(ctx, lt, {0, 0}, {1, numel}));
+  if (n > 1) {
+    segs.push_back(_xor(ctx, slice(ctx, lt, {1, 0}, {n, numel}),
+                        slice(ctx, lt, {0, 0}, {n - 1, numel})));
+  }
+  segs.push_back(_xor(ctx, slice(ctx, lt, {n - 1, 0}, {n, numel}),
+                      _constant(ctx, 1, {1, numel})));
+  return concatenate(ctx, segs, 0);
+}
+
+// x^1, x^2, ..., x^d in depth log(d), each of shape {1, numel}
+std::vector<Value> Powers(SPUContext* ctx, const Value& x, int64_t d) {
+  std::vector<Value> pows(d + 1);
+  pows[1] = reshape(ctx, x, {1, x.numel()});
+  for (int64_t k = 2; k <= d; ++k) {
+    const int64_t a = k / 2;
+    pows[k] = a == k - a ? f_square(ctx, pows[a])
+                         : f_mul(ctx, pows[a], pows[k - a]);
+  }
+  pows.erase(pows.begin());
+  return pows;
+}
+
+}  // namespace
+
+Value f_spline(SPUContext* ctx, const Value& in, const SplineSpec& spec) {
+  SPU_TRACE_HAL_DISP(ctx, in);
+
+  SPU_ENFORCE(in.isFxp());
+  ValidateSpec(spec);
+
+  const auto fxp = static_cast<int64_t>(ctx->getFxpBits());
+  const Value x = f_rescale(ctx, in, fxp);
+  const int64_t numel = x.numel();
+  const int64_t nsegs = spec.segments_size();
+
+  int64_t degree = 0;
+  for (const auto& seg : spec.segments()) {
+    degree = std::max<int64_t>(degree, seg.coeffs_size() - 1);
+  }
+
+  // c[i, k] is the coefficient of x^k in the i-th segment
+  std::vector<double> c0(nsegs, 0.0);
+  std::vector<double> ck(nsegs * degree, 0.0);
+  for (int64_t i = 0; i < nsegs; ++i) {
+    const auto& coeffs = spec.segments(i).coeffs();
+    for (int64_t k = 0; k < coeffs.size(); ++k) {
+      if (k == 0) {
+        c0[i] = coeffs[k];
+      } else {
+        ck[i * degree + k - 1] = coeffs[k];
+      }
+    }
+  }
+
+  // All polynomials with 2 * fxp fraction bits, shape {nsegs, numel}
+  Value polys = broadcast_to(
+      ctx, _lshift(ctx, constant(ctx, c0, x.dtype(), {nsegs, 1}), fxp),
+      {nsegs, numel});
+  if (degree > 0) {
+    auto xs = concatenate(ctx, Powers(ctx, x, degree), 0);
+    polys = _add(ctx, polys,
+                 _mmul(ctx, constant(ctx, ck, x.dtype(), {nsegs, degree}), xs));
+  }
+
+  Value ret;
+  if (spec.breakpoints_size() == 0) {
+    ret = polys;
+  } else {
+    std::vector<float> b(spec.breakpoints().begin(),
+                         spec.breakpoints().end());
+    auto segs = SegmentIndicators(ctx, BatchLess(ctx, x, b));
+    // sum_i seg_i * poly_i
+    ret = _mmul(ctx, _constant(ctx, 1, {1, nsegs}), _mul(ctx, segs, polys));
+  }
+
+  ret = _trunc(ctx, ret, fxp).setDtype(x.dtype());
+  return reshape(ctx, ret, x.shape());
+}
+
+SplineSpec ParseSplineSpec(std::string_view json) {
+  SplineSpec spec;
+  auto status =
+      google::protobuf::util::JsonStringToMessage(std::string(json), &spec);
+  SPU_ENFORCE(status.ok(), "invalid spline spec {}, {}", json,
+              status.ToString());
+  ValidateSpec(spec);
+  return spec;
+}
+
+}  // namespace spu::kernel::hal::intrinsic::nn
@@ -0,0 +1,39 @@
+// Copyright 2024 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string_view>
+
+#include "libspu/core/value.h"
+#include "libspu/kernel/hal/intrinsic/nn/spline.pb.h"
+
+namespace spu {
+class SPUContext;
+}
+
+namespace spu::kernel::hal::intrinsic::nn {
+
+// Evaluates the piecewise polynomial `spec` on fixed-point x.
+//
+// All breakpoint comparisons are done in one batch, the powers of x are
+// computed once for all segments, and the segments are combined by a single
+// multiplexed sum followed by one truncation.
+Value f_spline(SPUContext* ctx, const Value& x, const SplineSpec& spec);
+
+// Parses the JSON form of SplineSpec, e.g., relu(x) on [-inf, +inf)
+//   {"breakpoints": [0], "segments": [{}, {"coeffs": [0, 1]}]}
+SplineSpec ParseSplineSpec(std::string_view json);
+
+}  // namespace spu::kernel::hal::intrinsic::nn
@@ -0,0 +1,106 @@
+// Copyright 2024 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libspu/kernel/hal/intrinsic/nn/spline.h"
+
+#include "gtest/gtest.h"
+#include "xtensor/xio.hpp"
+#include "xtensor/xmath.hpp"
+
+#include "libspu/kernel/hal/constants.h"
+#include "libspu/kernel/hal/type_cast.h"
+#include "libspu/kernel/test_util.h"
+#include "libspu/mpc/utils/simulate.h"
+
+namespace spu::kernel::hal::intrinsic::nn {
+namespace {
+
+// x < -2: -1, -2 <= x < 2: 0.75x - x^3 / 16, 2 <= x: 1
+constexpr char kSoftSign[] = R"({
+  "breakpoints": [-2, 2],
+  "segments": [
+    {"coeffs": [-1]},
+    {"coeffs": [0, 0.75, 0, -0.0625]},
+    {"coeffs": [1]}
+  ]
+})";
+
+xt::xarray<float> SoftSign(const xt::xarray<float>& x) {
+  return xt::where(x < -2.0F, -1.0F,
+                   xt::where(x < 2.0F, 0.75F * x - xt::pow(x, 3) / 16.0F,
+                             1.0F));
+}
+
+TEST(SplineTest, Relu) {
+  SPUContext ctx = test::makeSPUContext();
+  auto spec = ParseSplineSpec(
+      R"({"breakpoints": [0], "segments": [{}, {"coeffs": [0, 1]}]})");
+
+  xt::xarray<float> x = {{-3.5, -1.0, -0.25, 0.0}, {0.25, 1.0, 2.5, 7.0}};
+  Value a = test::makeValue(&ctx, x, VIS_SECRET);
+  Value c = f_spline(&ctx, a, spec);
+  EXPECT_EQ(c.dtype(), DT_F32);
+  EXPECT_EQ(c.shape(), a.shape());
+
+  auto y = dump_public_as<float>(&ctx, reveal(&ctx, c));
+  xt::xarray<float> expected = xt::maximum(x, 0.0F);
+  EXPECT_TRUE(xt::allclose(expected, y, 0.01, 0.001)) << expected << std::endl
+                                                       << y;
+}
+
+TEST(SplineTest, Polynomial) {
+  SPUContext ctx = test::makeSPUContext();
+  auto spec = ParseSplineSpec(kSoftSign);
+
+  xt::xarray<float> x = xt::linspace<float>(-4.0, 4.0, 33);
+  xt::xarray<float> expected = SoftSign(x);
+
+  for (auto vis : {VIS_PUBLIC, VIS_SECRET}) {
+    Value a = test::makeValue(&ctx, x, vis);
+    Value c = f_spline(&ctx, a, spec);
+    if (c.isSecret()) {
+      c = reveal(&ctx, c);
+    }
+    auto y = dump_public_as<float>(&ctx, c);
+    EXPECT_TRUE(xt::allclose(expected, y, 0.01, 0.001)) << expected
+                                                         << std::endl
+                                                         << y;
+  }
+}
+
+TEST(SplineTest, InvalidSpec) {
+  EXPECT_ANY_THROW(ParseSplineSpec(R"({"breakpoints": [0]})"));
+  EXPECT_ANY_THROW(ParseSplineSpec(
+      R"({"breakpoints": [1, 0], "segments": [{}, {}, {}]})"));
+  EXPECT_ANY_THROW(ParseSplineSpec("not a json"));
+}
+
+TEST(SplineTest, Cheetah) {
+  auto spec = ParseSplineSpec(kSoftSign);
+  xt::xarray<float> x = xt::linspace<float>(-4.0, 4.0, 33);
+  xt::xarray<float> expected = SoftSign(x);
+
+  mpc::utils::simulate(2, [&](std::shared_ptr<yacl::link::Context> lctx) {
+    SPUContext ctx = test::makeSPUContext(ProtocolKind::CHEETAH, FM64, lctx);
+    Value a = test::makeValue(&ctx, x, VIS_SECRET);
+    Value c = f_spline(&ctx, a, spec);
+    auto y = dump_public_as<float>(&ctx, reveal(&ctx, c));
+    EXPECT_TRUE(xt::allclose(expected, y, 0.01, 0.001)) << expected
+                                                         << std::endl
+                                                         << y;
+  });
+}
+
+}  // namespace
+}  // namespace spu::kernel::hal::intrinsic::nn
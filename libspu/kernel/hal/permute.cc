@@ -16,6 +16,8 @@
 
 #include <algorithm>
 
+#include "absl/numeric/bits.h"
+
 #include "libspu/core/bit_utils.h"
 #include "libspu/core/context.h"
 #include "libspu/core/trace.h"
@@ -64,7 +66,8 @@ spu::Value _2s(SPUContext *ctx, const Value &x) {
 
 Value _permute_1d(SPUContext *, const Value &x, const Index &indices) {
   SPU_ENFORCE(x.shape().size() == 1);
-  return Value(x.data().linear_gather(indices), x.dtype());
+  return Value(x.data().linear_gather(indices), x.dtype())
+      .setFxpBits(x.fxp_bits());
 }
 
 Value _prefix_sum(SPUContext *ctx, const Value &x) {
@@ -92,43 +95,67 @@ void _cmp_swap(SPUContext *ctx, const CompFn &comparator_body,
   spu::Value predicate = comparator_body(values);
   predicate = hal::_prefer_a(ctx, predicate);
 
+  // select all operands with one multiplication, i.e.
+  //   greater = sec + pred * (fst - sec)
+  //   less    = fst - pred * (fst - sec)
+  std::vector<spu::Value> diffs;
+  diffs.reserve(num_operands);
+  for (size_t i = 0; i < num_operands; ++i) {
+    diffs.emplace_back(_sub(ctx, values[2 * i], values[2 * i + 1]));
+  }
+  auto delta =
+      _mul(ctx, concatenate(ctx, std::vector(num_operands, predicate), 0),
+           concatenate(ctx, diffs, 0));
+
+  const auto n = static_cast<int64_t>(lhs_indices.size());
   for (size_t i = 0; i < num_operands; ++i) {
     const auto &fst = values[2 * i];
     const auto &sec = values[2 * i + 1];
+    const int64_t offset = static_cast<int64_t>(i) * n;
+    auto delta_i = slice(ctx, delta, {offset}, {offset + n});
 
-    auto greater = select(ctx, predicate, fst, sec);
-    auto less = sub(ctx, add(ctx, fst, sec), greater);
+    auto greater = _add(ctx, sec, delta_i);
+    auto less = _sub(ctx, fst, delta_i);
 
     values_to_sort[i].data().linear_scatter(greater.data(), lhs_indices);
     values_to_sort[i].data().linear_scatter(less.data(), rhs_indices);
   }
 }
 
-// Secure Odd-even mergesort
-// Ref:
-// https://hwlang.de/algorithmen/sortieren/networks/oemen.htm
-std::vector<spu::Value> odd_even_merge_sort(
-    SPUContext *ctx, const CompFn &comparator_body,
-    absl::Span<spu::Value const> inputs) {
-  // make a copy for inplace sort
-  std::vector<spu::Value> ret;
-  for (auto const &input : inputs) {
-    spu::Value casted;
-    if (!input.isSecret()) {
-      // we can not linear_scatter a secret value to a public operand
-      casted = _2s(ctx, input.clone()).setDtype(input.dtype());
-    } else {
-      casted = input.clone();
+// Apply the same compare-exchange of column pairs to every row of flattened
+// (num_rows, row_len) operands, so all rows share a single comparison.
+void _batched_cmp_swap(SPUContext *ctx, const CompFn &comparator_body,
+                       absl::Span<spu::Value> values_to_sort,
+                       const Index &lhs_cols, const Index &rhs_cols,
+                       int64_t num_rows, int64_t row_len) {
+  if (lhs_cols.empty()) {
+    return;
+  }
+
+  Index lhs_indices;
+  Index rhs_indices;
+  lhs_indices.reserve(num_rows * lhs_cols.size());
+  rhs_indices.reserve(num_rows * rhs_cols.size());
+  for (int64_t row = 0; row < num_rows; ++row) {
+    const int64_t offset = row * row_len;
+    for (size_t i = 0; i < lhs_cols.size(); ++i) {
+      lhs_indices.emplace_back(offset + lhs_cols[i]);
+      rhs_indices.emplace_back(offset + rhs_cols[i]);
     }
-    // we can not linear_scatter an ashare value to a bshare operand
-    casted = _prefer_a(ctx, casted);
-    ret.emplace_back(std::move(casted));
   }
 
-  // sort by per network layer for memory optimizations, sorting N elements
-  // needs log2(N) stages, and the i_th stage has i layers, which means the
-  // same latency cost as BitonicSort but less _cmp_swap unit.
-  const auto n = inputs.front().numel();
+  _cmp_swap(ctx, comparator_body, values_to_sort, lhs_indices, rhs_indices);
+}
+
+// Layers of odd-even mergesort network of `n` elements, each layer is a pair
+// of (lhs_indices, rhs_indices) which can be compare-exchanged parallelly.
+// Ref:
+// https://hwlang.de/algorithmen/sortieren/networks/oemen.htm
+std::vector<std::pair<Index, Index>> _odd_even_merge_sort_layers(int64_t n) {
+  std::vector<std::pair<Index, Index>> layers;
+
+  // sorting N elements needs log2(N) stages, and the i_th stage has i layers,
+  // which means the same latency cost as BitonicSort but less _cmp_swap unit.
   for (int64_t max_gap_in_stage = 1; max_gap_in_stage < n;
        max_gap_in_stage += max_gap_in_stage) {
     for (int64_t step = max_gap_in_stage; step > 0; step /= 2) {
@@ -152,14 +179,197 @@ std::vector<spu::Value> odd_even_merge_sort(
         }
       }
 
-      _cmp_swap(ctx, comparator_body, absl::MakeSpan(ret), lhs_indices,
-                rhs_indices);
+      layers.emplace_back(std::move(lhs_indices), std::move(rhs_indices));
+    }
+  }
+
+  return layers;
+}
+
+// make a copy of inputs for inplace compare-exchange.
+std::vector<spu::Value> _prepare_cmp_swap_operands(
+    SPUContext *ctx, absl::Span<spu::Value const> inputs) {
+  std::vector<spu::Value> ret;
+  for (auto const &input : inputs) {
+    spu::Value casted;
+    if (!input.isSecret()) {
+      // we can not linear_scatter a secret value to a public operand
+      casted = _2s(ctx, input.clone())
+                   .setDtype(input.dtype())
+                   .setFxpBits(input.fxp_bits());
+    } else {
+      casted = input.clone();
+    }
+    // we can not linear_scatter an ashare value to a bshare operand
+    casted = _prefer_a(ctx, casted);
+    ret.emplace_back(std::move(casted));
+  }
+  return ret;
+}
+
+// Secure Odd-even mergesort
+//
+// Inputs are flattened (num_rows, row_len) operands, every row is sorted by the
+// same network, so each layer is one batched comparison over all rows.
+std::vector<spu::Value> odd_even_merge_sort(SPUContext *ctx,
+                                            const CompFn &comparator_body,
+                                            absl::Span<spu::Value const> inputs,
+                                            int64_t num_rows = 1) {
+  auto ret = _prepare_cmp_swap_operands(ctx, inputs);
+
+  // sort by per network layer for memory optimizations.
+  const auto n = inputs.front().numel() / num_rows;
+  for (const auto &[lhs_cols, rhs_cols] : _odd_even_merge_sort_layers(n)) {
+    _batched_cmp_swap(ctx, comparator_body, absl::MakeSpan(ret), lhs_cols,
+                      rhs_cols, num_rows, n);
+  }
+
+  return ret;
+}
+
+// Gather the columns `cols` of every row of flattened (num_rows, row_len)
+// operands, the result is flattened (num_rows, cols.size()).
+std::vector<spu::Value> _gather_cols(absl::Span<spu::Value const> values,
+                                     const Index &cols, int64_t num_rows,
+                                     int64_t row_len) {
+  Index indices;
+  indices.reserve(num_rows * cols.size());
+  for (int64_t row = 0; row < num_rows; ++row) {
+    for (const auto col : cols) {
+      indices.emplace_back(row * row_len + col);
     }
   }
 
+  std::vector<spu::Value> ret;
+  ret.reserve(values.size());
+  for (const auto &v : values) {
+    ret.emplace_back(v.data().linear_gather(indices), v.dtype());
+  }
   return ret;
 }
 
+// Sort every consecutive chunk of `chunk_len` columns of each row, the last
+// chunk may be shorter.
+void _sort_chunks(SPUContext *ctx, const CompFn &comparator_body,
+                  absl::Span<spu::Value> values, int64_t num_rows,
+                  int64_t row_len, int64_t chunk_len) {
+  const int64_t num_full = row_len / chunk_len;
+  const int64_t tail_len = row_len % chunk_len;
+
+  const auto full_layers = _odd_even_merge_sort_layers(chunk_len);
+  const auto tail_layers = _odd_even_merge_sort_layers(tail_len);
+
+  for (size_t layer = 0; layer < full_layers.size(); ++layer) {
+    Index lhs_cols;
+    Index rhs_cols;
+    const auto &[lhs, rhs] = full_layers[layer];
+    for (int64_t c = 0; c < num_full; ++c) {
+      for (size_t i = 0; i < lhs.size(); ++i) {
+        lhs_cols.emplace_back(c * chunk_len + lhs[i]);
+        rhs_cols.emplace_back(c * chunk_len + rhs[i]);
+      }
+    }
+    // the tail network is never deeper than the full one.
+    if (layer < tail_layers.size()) {
+      const auto &[t_lhs, t_rhs] = tail_layers[layer];
+      for (size_t i = 0; i < t_lhs.size(); ++i) {
+        lhs_cols.emplace_back(num_full * chunk_len + t_lhs[i]);
+        rhs_cols.emplace_back(num_full * chunk_len + t_rhs[i]);
+      }
+    }
+
+    _batched_cmp_swap(ctx, comparator_body, values, lhs_cols, rhs_cols,
+                      num_rows, row_len);
+  }
+}
+
+// Oblivious topk with bitonic selection network.
+// Ref:
+// Efficient Top-K Query Processing on Massively Parallel Hardware
+// https://dl.acm.org/doi/10.1145/3183713.3183735
+//
+// Each row is split into chunks of K = bit_ceil(k) elements, then
+//   1) sort each chunk, with O(log^2(K)) layers.
+//   2) for each pair of sorted chunks (A, B), compare-exchange A[i] with
+//      B[K-1-i], the winners form a bitonic sequence which contains the top K
+//      of A and B, while the losers are dropped.
+//   3) rebuild the bitonic sequence to a sorted chunk, with log(K) layers.
+//   4) repeat 2) and 3) until there is only one chunk left.
+// So the total number of layers is O(log(n) * log(K)). Inputs are flattened
+// (num_rows, row_len) operands, and every layer is applied to all rows at
+// once.
+std::vector<spu::Value> bitonic_topk(SPUContext *ctx,
+                                     const CompFn &comparator_body,
+                                     absl::Span<spu::Value const> inputs,
+                                     int64_t num_rows, int64_t k) {
+  auto ret = _prepare_cmp_swap_operands(ctx, inputs);
+
+  int64_t len = inputs.front().numel() / num_rows;
+  const int64_t chunk = absl::bit_ceil(static_cast<uint64_t>(k));
+
+  if (len <= chunk) {
+    _sort_chunks(ctx, comparator_body, absl::MakeSpan(ret), num_rows, len,
+                 len);
+  } else {
+    _sort_chunks(ctx, comparator_body, absl::MakeSpan(ret), num_rows, len,
+                 chunk);
+  }
+
+  while (len > chunk) {
+    const int64_t num_chunks = (len + chunk - 1) / chunk;
+    const int64_t num_pairs = num_chunks / 2;
+
+    // merge each pair of chunks, the last chunk (maybe shorter) is paired with
+    // the imaginary worst values, so these positions of A are kept as is.
+    Index lhs_cols;
+    Index rhs_cols;
+    Index kept_cols;
+    for (int64_t p = 0; p < num_pairs; ++p) {
+      const int64_t a_begin = 2 * p * chunk;
+      const int64_t b_begin = a_begin + chunk;
+      const int64_t b_len = std::min(chunk, len - b_begin);
+      for (int64_t i = chunk - b_len; i < chunk; ++i) {
+        lhs_cols.emplace_back(a_begin + i);
+        rhs_cols.emplace_back(b_begin + chunk - 1 - i);
+      }
+      for (int64_t i = 0; i < chunk; ++i) {
+        kept_cols.emplace_back(a_begin + i);
+      }
+    }
+    _batched_cmp_swap(ctx, comparator_body, absl::MakeSpan(ret), lhs_cols,
+                      rhs_cols, num_rows, len);
+
+    // the unpaired chunk is already sorted.
+    for (int64_t col = 2 * num_pairs * chunk; col < len; ++col) {
+      kept_cols.emplace_back(col);
+    }
+
+    // drop the losers.
+    ret = _gather_cols(ret, kept_cols, num_rows, len);
+    len = kept_cols.size();
+
+    // bitonic merge of the merged chunks.
+    for (int64_t step = chunk / 2; step > 0; step /= 2) {
+      Index merge_lhs_cols;
+      Index merge_rhs_cols;
+      for (int64_t p = 0; p < num_pairs; ++p) {
+        for (int64_t i = 0; i < chunk; ++i) {
+          if ((i & step) == 0) {
+            merge_lhs_cols.emplace_back(p * chunk + i);
+            merge_rhs_cols.emplace_back(p * chunk + i + step);
+          }
+        }
+      }
+      _batched_cmp_swap(ctx, comparator_body, absl::MakeSpan(ret),
+                        merge_lhs_cols, merge_rhs_cols, num_rows, len);
+    }
+  }
+
+  Index topk_cols(k);
+  std::iota(topk_cols.begin(), topk_cols.end(), 0);
+  return _gather_cols(ret, topk_cols, num_rows, len);
+}
+
 void Swap(absl::Span<spu::Value> arr, const Index &lhs_indices,
           const Index &rhs_indices) {
   if (lhs_indices.empty() ||
@@ -320,7 +530,9 @@ std::vector<spu::Value> PrepareInput(SPUContext *ctx, const Value &input,
 
   // shuffle with random permutation to break link of values
   auto rand_perm = _rand_perm_s(ctx, input.shape());
-  inp.push_back(_perm_ss(ctx, input, rand_perm).setDtype(input.dtype()));
+  inp.push_back(_perm_ss(ctx, input, rand_perm)
+                    .setDtype(input.dtype())
+                    .setFxpBits(input.fxp_bits()));
 
   // we concate random value to hide the data-dependant running pattern
   // for quick select;
@@ -536,12 +748,27 @@ std::vector<spu::Value> _bit_decompose(SPUContext *ctx, const spu::Value &x,
   size_t nbits = valid_bits != -1
                      ? static_cast<size_t>(valid_bits)
                      : x_bshare.storage_type().as<BShare>()->nbits();
+  if (nbits == 0) {
+    return rets;
+  }
   rets.reserve(nbits);
 
+  // Extract the bits locally, then convert all of them with a single B2A,
+  // i.e. one batch of nbits * numel 1-bit conversions instead of nbits.
+  const int64_t numel = x.numel();
+  std::vector<spu::Value> bits;
+  bits.reserve(nbits);
   for (size_t bit = 0; bit < nbits; ++bit) {
     auto x_bshare_shift = right_shift_logical(ctx, x_bshare, bit);
     auto lowest_bit = _and(ctx, x_bshare_shift, k1);
-    rets.emplace_back(_prefer_a(ctx, lowest_bit));
+    bits.emplace_back(reshape(ctx, lowest_bit, {numel}));
+  }
+  auto bits_ashare = _prefer_a(ctx, concatenate(ctx, bits, 0));
+
+  for (size_t bit = 0; bit < nbits; ++bit) {
+    const int64_t offset = static_cast<int64_t>(bit) * numel;
+    auto bit_ashare = slice(ctx, bits_ashare, {offset}, {offset + numel});
+    rets.emplace_back(reshape(ctx, bit_ashare, x.shape()));
   }
 
   return rets;
@@ -938,21 +1165,26 @@ std::vector<spu::Value> apply_inv_perm(SPUContext *ctx,
   if (perm.isSecret()) {
     std::vector<spu::Value> inputs_s;
     for (const auto &input : inputs) {
-      inputs_s.emplace_back(_2s(ctx, input).setDtype(input.dtype()));
+      inputs_s.emplace_back(_2s(ctx, input)
+                                .setDtype(input.dtype())
+                                .setFxpBits(input.fxp_bits()));
     }
     return _apply_inv_perm_ss(ctx, inputs_s, perm);
   } else if (perm.isPrivate()) {
     if (ctx->hasKernel("inv_perm_av")) {
       std::vector<spu::Value> ret;
       for (const auto &input : inputs) {
-        ret.emplace_back(
-            _apply_inv_perm(ctx, input, perm).setDtype(input.dtype()));
+        ret.emplace_back(_apply_inv_perm(ctx, input, perm)
+                             .setDtype(input.dtype())
+                             .setFxpBits(input.fxp_bits()));
       }
       return ret;
     } else {
       std::vector<spu::Value> inputs_s;
       for (const auto &input : inputs) {
-        inputs_s.emplace_back(_2s(ctx, input).setDtype(input.dtype()));
+        inputs_s.emplace_back(_2s(ctx, input)
+                                  .setDtype(input.dtype())
+                                  .setFxpBits(input.fxp_bits()));
       }
       return _apply_inv_perm_ss(ctx, inputs_s, _2s(ctx, perm));
     }
@@ -1177,6 +1409,55 @@ std::vector<spu::Value> permute(SPUContext *ctx,
   return results;
 }
 
+std::vector<spu::Value> batched_sort(SPUContext *ctx,
+                                     absl::Span<const spu::Value> inputs,
+                                     int64_t sort_dim, const CompFn &cmp) {
+  // sanity check.
+  SPU_ENFORCE(!inputs.empty(), "Inputs should not be empty");
+  SPU_ENFORCE(std::all_of(inputs.begin(), inputs.end(),
+                          [&inputs](const spu::Value &v) {
+                            return v.shape() == inputs[0].shape();
+                          }),
+              "Inputs shape mismatched");
+
+  const Shape shape = inputs[0].shape();
+  SPU_ENFORCE(sort_dim < shape.ndim());
+
+  // let
+  // - N is the number of vector to sort
+  // - W is the vector length.
+  const int64_t W = shape.dim(sort_dim);
+  if (W == 0) {
+    return std::vector<spu::Value>(inputs.begin(), inputs.end());
+  }
+  const int64_t N = shape.numel() / W;
+
+  // put the to_sort dimension to the last dimension.
+  Axes perm(shape.ndim());
+  std::iota(perm.begin(), perm.end(), 0);
+  std::swap(perm[sort_dim], perm.back());
+
+  Shape perm_shape(shape.begin(), shape.end());
+  std::swap(perm_shape[sort_dim], perm_shape.back());
+
+  // flatten to (N * W), so every row is a consecutive vector.
+  std::vector<spu::Value> inputs1d;
+  inputs1d.reserve(inputs.size());
+  for (auto const &input : inputs) {
+    inputs1d.push_back(
+        hal::reshape(ctx, hal::transpose(ctx, input, perm), {N * W}));
+  }
+
+  auto sorted = internal::odd_even_merge_sort(ctx, cmp, inputs1d, N);
+
+  // swap is self-inverse.
+  for (auto &item : sorted) {
+    item = hal::transpose(ctx, hal::reshape(ctx, item, perm_shape), perm);
+  }
+
+  return sorted;
+}
+
 std::vector<Value> topk_1d(SPUContext *ctx, const spu::Value &input,
                            const SimpleCompFn &scalar_cmp,
                            const TopKConfig &config) {
@@ -1275,4 +1556,39 @@ std::vector<Value> topk_1d(SPUContext *ctx, const spu::Value &input,
   }
 }
 
+std::vector<Value> topk_2d(SPUContext *ctx, const spu::Value &input,
+                           const SimpleCompFn &scalar_cmp,
+                           const TopKConfig &config) {
+  SPU_ENFORCE(input.shape().ndim() == 2,
+              "Inputs should be 2-d but actually have {} dimensions",
+              input.shape().ndim());
+  const int64_t N = input.shape()[0];
+  const int64_t W = input.shape()[1];
+  SPU_ENFORCE(W >= config.k_hi, "k={} is larger than the last dimension={}",
+              config.k_hi, W);
+  SPU_ENFORCE(config.k_lo <= config.k_hi);
+
+  std::vector<spu::Value> inp;
+  inp.push_back(hal::reshape(ctx, input, {N * W}));
+  if (!config.value_only) {
+    auto dt =
+        ctx->config().field() == FieldType::FM32 ? spu::DT_I32 : spu::DT_I64;
+    auto index = hal::broadcast_to(ctx, hal::iota(ctx, dt, W), {N, W}, {1});
+    inp.push_back(hal::reshape(ctx, index, {N * W}));
+  }
+
+  hal::CompFn comp_fn =
+      [ctx, &scalar_cmp](absl::Span<const spu::Value> values) -> spu::Value {
+    // single key with extra payload
+    return scalar_cmp(ctx, values[0], values[1]);
+  };
+
+  auto topk = internal::bitonic_topk(ctx, comp_fn, inp, N, config.k_hi);
+  for (auto &item : topk) {
+    item = hal::reshape(ctx, item, {N, config.k_hi});
+  }
+
+  return topk;
+}
+
 }  // namespace spu::kernel::hal
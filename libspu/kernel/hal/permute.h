@@ -63,6 +63,15 @@ std::vector<spu::Value> simple_sort1d(SPUContext *ctx,
                                       SortDirection direction, int64_t num_keys,
                                       int64_t valid_bits);
 
+// batched sort with comparator, every 1-D vector along `sort_dim` is sorted by
+// the same sorting network, and each network layer is applied to all vectors
+// with one comparison.
+//
+// Note: the comparator must return secret, and the sort is not stable.
+std::vector<spu::Value> batched_sort(SPUContext *ctx,
+                                     absl::Span<const spu::Value> inputs,
+                                     int64_t sort_dim, const CompFn &cmp);
+
 // transform n-d permute to 1-d permute and applying permute function to each
 // 1-d array
 std::vector<spu::Value> permute(SPUContext *ctx,
@@ -79,4 +88,16 @@ std::vector<Value> topk_1d(SPUContext *ctx, const spu::Value &input,
                            const SimpleCompFn &scalar_cmp,
                            const TopKConfig &config);
 
+// batched topk with oblivious bitonic selection network
+// Inputs:
+//  -input: a 2-D operand, search top k elements of each row
+//  -scalar_cmp: comparison function for single value
+//  -config: topk config, `confusion` is ignored since the network is data
+//   oblivious.
+// Note: each network layer is a single comparison over all rows, and the
+// returned top k_hi elements of each row are sorted.
+std::vector<Value> topk_2d(SPUContext *ctx, const spu::Value &input,
+                           const SimpleCompFn &scalar_cmp,
+                           const TopKConfig &config);
+
 }  // namespace spu::kernel::hal
\ No newline at end of file
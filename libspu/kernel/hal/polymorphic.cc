@@ -35,7 +35,17 @@ DataType common_dtype(DataType lhs, DataType rhs) {
   return std::max(lhs, rhs);  // Always results to higher rank type
 }
 
-template <typename FnFxp, typename FnInt, typename... Args>
+// Fixed-point kernels other than the scale aware ones (see f_rescale) work
+// on the runtime default fraction bits.
+Value toDefaultFxpBits(SPUContext* ctx, const Value& x) {
+  if (x.isFxp() && x.fxp_bits() != 0) {
+    return _rescale(ctx, x, ctx->getFxpBits());
+  }
+  return x;
+}
+
+template <bool kScaleAware = false, typename FnFxp, typename FnInt,
+          typename... Args>
 Value dtypeBinaryDispatch(std::string_view op_name, FnFxp&& fn_fxp,
                           FnInt&& fn_int, SPUContext* ctx, const Value& x,
                           const Value& y, Args&&... args) {
@@ -47,21 +57,28 @@ Value dtypeBinaryDispatch(std::string_view op_name, FnFxp&& fn_fxp,
     return fn_int(ctx, xx, yy, std::forward<Args>(args)...);
   } else if (x.isInt() && y.isFxp()) {
     auto xx = dtype_cast(ctx, x, y.dtype());
-    return fn_fxp(ctx, xx, y, std::forward<Args>(args)...);
+    auto yy = kScaleAware ? y : toDefaultFxpBits(ctx, y);
+    return fn_fxp(ctx, xx, yy, std::forward<Args>(args)...);
   } else if (x.isFxp() && y.isInt()) {
+    auto xx = kScaleAware ? x : toDefaultFxpBits(ctx, x);
     auto yy = dtype_cast(ctx, y, x.dtype());
-    return fn_fxp(ctx, x, yy, std::forward<Args>(args)...);
+    return fn_fxp(ctx, xx, yy, std::forward<Args>(args)...);
   } else if (x.isFxp() && y.isFxp()) {
     auto common_type = common_dtype(x.dtype(), y.dtype());
     auto xx = dtype_cast(ctx, x, common_type);
     auto yy = dtype_cast(ctx, y, common_type);
+    if (!kScaleAware) {
+      xx = toDefaultFxpBits(ctx, xx);
+      yy = toDefaultFxpBits(ctx, yy);
+    }
     return fn_fxp(ctx, xx, yy, std::forward<Args>(args)...);
   } else {
     SPU_THROW("unsupported op {} for x={}, y={}", op_name, x, y);
   }
 }
 
-template <typename FnFxp, typename FnInt, typename... Args>
+template <bool kScaleAware = false, typename FnFxp, typename FnInt,
+          typename... Args>
 Value dtypeUnaryDispatch(std::string_view op_name, FnFxp&& fn_fxp,
                          FnInt&& fn_int, SPUContext* ctx, const Value& x,
                          Args&&... args) {
@@ -69,7 +86,8 @@ Value dtypeUnaryDispatch(std::string_view op_name, FnFxp&& fn_fxp,
   if (x.isInt()) {
     return fn_int(ctx, x, std::forward<Args>(args)...);
   } else if (x.isFxp()) {
-    return fn_fxp(ctx, x, std::forward<Args>(args)...);
+    auto xx = kScaleAware ? x : toDefaultFxpBits(ctx, x);
+    return fn_fxp(ctx, xx, std::forward<Args>(args)...);
   } else {
     SPU_THROW("unsupported op {} for x={}", op_name, x);
   }
@@ -83,24 +101,24 @@ bool isCrossIntFxp(const Value& x, const Value& y) {
 
 Value add(SPUContext* ctx, const Value& x, const Value& y) {
   SPU_TRACE_HAL_DISP(ctx, x, y);
-  return dtypeBinaryDispatch("add", f_add, i_add, ctx, x, y);
+  return dtypeBinaryDispatch<true>("add", f_add, i_add, ctx, x, y);
 }
 
 Value sub(SPUContext* ctx, const Value& x, const Value& y) {
   SPU_TRACE_HAL_DISP(ctx, x, y);
-  return dtypeBinaryDispatch("sub", f_sub, i_sub, ctx, x, y);
+  return dtypeBinaryDispatch<true>("sub", f_sub, i_sub, ctx, x, y);
 }
 
 Value mixed_mul(SPUContext* ctx, const Value& x, const Value& y) {
   SPU_TRACE_HAL_LEAF(ctx, x, y);
-  auto new_dtype = x.isFxp() ? x.dtype() : y.dtype();
-  return _mul(ctx, x, y).setDtype(new_dtype);
+  const auto& fxp = x.isFxp() ? x : y;
+  return _mul(ctx, x, y).setDtype(fxp.dtype()).setFxpBits(fxp.fxp_bits());
 }
 
 Value mixed_mmul(SPUContext* ctx, const Value& x, const Value& y) {
   SPU_TRACE_HAL_LEAF(ctx, x, y);
-  auto new_dtype = x.isFxp() ? x.dtype() : y.dtype();
-  return _mmul(ctx, x, y).setDtype(new_dtype);
+  const auto& fxp = x.isFxp() ? x : y;
+  return _mmul(ctx, x, y).setDtype(fxp.dtype()).setFxpBits(fxp.fxp_bits());
 }
 
 static Value f_mul_impl(SPUContext* ctx, const Value& x, const Value& y) {
@@ -114,13 +132,13 @@ Value mul(SPUContext* ctx, const Value& x, const Value& y) {
     return mixed_mul(ctx, x, y);
   }
 
-  return dtypeBinaryDispatch("mul", f_mul_impl, i_mul, ctx, x, y);
+  return dtypeBinaryDispatch<true>("mul", f_mul_impl, i_mul, ctx, x, y);
 }
 
 Value square(SPUContext* ctx, const Value& x) {
   SPU_TRACE_HAL_DISP(ctx, x);
 
-  return dtypeUnaryDispatch("square", f_square, i_square, ctx, x);
+  return dtypeUnaryDispatch<true>("square", f_square, i_square, ctx, x);
 }
 
 Value matmul(SPUContext* ctx, const Value& x, const Value& y) {
@@ -130,7 +148,7 @@ Value matmul(SPUContext* ctx, const Value& x, const Value& y) {
     return mixed_mmul(ctx, x, y);
   }
 
-  return dtypeBinaryDispatch("mmul", f_mmul, i_mmul, ctx, x, y);
+  return dtypeBinaryDispatch<true>("mmul", f_mmul, i_mmul, ctx, x, y);
 }
 
 std::optional<Value> batch_matmul(SPUContext* ctx, const Value& x,
@@ -139,8 +157,8 @@ std::optional<Value> batch_matmul(SPUContext* ctx, const Value& x,
   if (isCrossIntFxp(x, y)) {
     auto ret = _batch_mmul(ctx, x, y); // ring.h, Line 56
     if (ret.has_value()) {
-      auto new_dtype = x.isFxp() ? x.dtype() : y.dtype();
-      ret->setDtype(new_dtype);
+      const auto& fxp = x.isFxp() ? x : y;
+      ret->setDtype(fxp.dtype()).setFxpBits(fxp.fxp_bits());
     }
     return ret;
   }
@@ -158,16 +176,16 @@ std::optional<Value> batch_matmul(SPUContext* ctx, const Value& x,
 Value tensordot(SPUContext* ctx, const Value& x, const Value& y,
                 const Index& ix, const Index& iy) {
   SPU_TRACE_HAL_DISP(ctx, x, y, ix, iy);
-  return dtypeBinaryDispatch("tensordot", f_tensordot, i_tensordot, ctx, x, y,
-                             ix, iy);
+  return dtypeBinaryDispatch<true>("tensordot", f_tensordot, i_tensordot, ctx,
+                                   x, y, ix, iy);
 }
 
 Value conv2d(SPUContext* ctx, const Value& x, const Value& y,
              const Strides& window_strides) {
   SPU_TRACE_HAL_DISP(ctx, x, y, window_strides);
 
-  return dtypeBinaryDispatch("conv2d", f_conv2d, i_conv2d, ctx, x, y,
-                             window_strides);
+  return dtypeBinaryDispatch<true>("conv2d", f_conv2d, i_conv2d, ctx, x, y,
+                                   window_strides);
 }
 
 Value logical_not(SPUContext* ctx, const Value& in) {
@@ -230,7 +248,7 @@ Value greater_equal(SPUContext* ctx, const Value& x, const Value& y) {
 Value negate(SPUContext* ctx, const Value& x) {
   SPU_TRACE_HAL_DISP(ctx, x);
 
-  return dtypeUnaryDispatch("negate", f_negate, i_negate, ctx, x);
+  return dtypeUnaryDispatch<true>("negate", f_negate, i_negate, ctx, x);
 }
 
 Value abs(SPUContext* ctx, const Value& x) {
@@ -244,7 +262,7 @@ Value exp(SPUContext* ctx, const Value& in) {
 
   SPU_ENFORCE(in.isFxp());
 
-  return f_exp(ctx, in);
+  return f_exp(ctx, toDefaultFxpBits(ctx, in));
 }
 
 Value select(SPUContext* ctx, const Value& pred, const Value& a,
@@ -255,10 +273,15 @@ Value select(SPUContext* ctx, const Value& pred, const Value& a,
   SPU_ENFORCE(a.shape() == b.shape());
   SPU_ENFORCE(a.dtype() == b.dtype());
 
+  if (a.isFxp() && ctx->getFxpBits(a) != ctx->getFxpBits(b)) {
+    const size_t bits = std::max(ctx->getFxpBits(a), ctx->getFxpBits(b));
+    return select(ctx, pred, _rescale(ctx, a, bits), _rescale(ctx, b, bits));
+  }
+
   // To ensure pred is {0, 1} on integer range, we have to promote pred to an
   // actual integer here. Otherwise, when we use pred to do computation the
   // result will be wrong
-  return _mux(ctx, pred, a, b).setDtype(a.dtype());
+  return _mux(ctx, pred, a, b).setDtype(a.dtype()).setFxpBits(a.fxp_bits());
 }
 
 Value bitwise_and(SPUContext* ctx, const Value& x, const Value& y) {
@@ -297,7 +320,7 @@ Value logistic(SPUContext* ctx, const Value& in) {
 
   SPU_ENFORCE(in.isFxp());
 
-  return f_sigmoid(ctx, in);
+  return f_sigmoid(ctx, toDefaultFxpBits(ctx, in));
 }
 
 Value log(SPUContext* ctx, const Value& in) {
@@ -305,7 +328,7 @@ Value log(SPUContext* ctx, const Value& in) {
 
   SPU_ENFORCE(in.isFxp());
 
-  return f_log(ctx, in);
+  return f_log(ctx, toDefaultFxpBits(ctx, in));
 }
 
 Value log1p(SPUContext* ctx, const Value& in) {
@@ -313,14 +336,14 @@ Value log1p(SPUContext* ctx, const Value& in) {
 
   SPU_ENFORCE(in.isFxp());
 
-  return f_log1p(ctx, in);
+  return f_log1p(ctx, toDefaultFxpBits(ctx, in));
 }
 
 Value reciprocal(SPUContext* ctx, const Value& in) {
   SPU_TRACE_HAL_DISP(ctx, in);
   SPU_ENFORCE(in.isFxp());
 
-  return f_reciprocal(ctx, in);
+  return f_reciprocal(ctx, toDefaultFxpBits(ctx, in));
 }
 
 Value floor(SPUContext* ctx, const Value& in) {
@@ -328,7 +351,7 @@ Value floor(SPUContext* ctx, const Value& in) {
 
   SPU_ENFORCE(in.isFxp());
 
-  return f_floor(ctx, in);
+  return f_floor(ctx, toDefaultFxpBits(ctx, in));
 }
 
 Value ceil(SPUContext* ctx, const Value& in) {
@@ -336,7 +359,7 @@ Value ceil(SPUContext* ctx, const Value& in) {
 
   SPU_ENFORCE(in.isFxp());
 
-  return f_ceil(ctx, in);
+  return f_ceil(ctx, toDefaultFxpBits(ctx, in));
 }
 
 Value max(SPUContext* ctx, const Value& x, const Value& y) {
@@ -358,6 +381,10 @@ Value min(SPUContext* ctx, const Value& x, const Value& y) {
 Value power(SPUContext* ctx, const Value& x, const Value& y) {
   SPU_TRACE_HAL_DISP(ctx, x, y);
 
+  if (x.fxp_bits() != 0 || y.fxp_bits() != 0) {
+    return power(ctx, toDefaultFxpBits(ctx, x), toDefaultFxpBits(ctx, y));
+  }
+
   if (x.isInt()) {
     // ref:
     // https://github.com/openxla/stablehlo/blob/main/stablehlo/reference/Element.cpp#L912
@@ -484,7 +511,8 @@ Value div(SPUContext* ctx, const Value& x, const Value& y) {
 
 #define F_DIV_WITH_DIRECT_GOLDSCHMIDT_METHOD
 #ifdef F_DIV_WITH_DIRECT_GOLDSCHMIDT_METHOD
-  auto res_f = f_div(ctx, x_f, y_f);
+  auto res_f =
+      f_div(ctx, toDefaultFxpBits(ctx, x_f), toDefaultFxpBits(ctx, y_f));
 #else
   auto res_f = mul(ctx, x, reciprocal(ctx, y));
 #endif
@@ -533,7 +561,7 @@ Value log2(SPUContext* ctx, const Value& in) {
 
   SPU_ENFORCE(in.isFxp());
 
-  return f_log2(ctx, in);
+  return f_log2(ctx, toDefaultFxpBits(ctx, in));
 }
 
 Value exp2(SPUContext* ctx, const Value& x) {
@@ -541,7 +569,7 @@ Value exp2(SPUContext* ctx, const Value& x) {
 
   SPU_ENFORCE(x.isFxp());
 
-  return f_exp2(ctx, x);
+  return f_exp2(ctx, toDefaultFxpBits(ctx, x));
 }
 
 Value tanh(SPUContext* ctx, const Value& x) {
@@ -549,7 +577,7 @@ Value tanh(SPUContext* ctx, const Value& x) {
 
   SPU_ENFORCE(x.isFxp());
 
-  return f_tanh(ctx, x);
+  return f_tanh(ctx, toDefaultFxpBits(ctx, x));
 }
 
 Value sine(SPUContext* ctx, const Value& x) {
@@ -557,7 +585,7 @@ Value sine(SPUContext* ctx, const Value& x) {
 
   SPU_ENFORCE(x.isFxp());
 
-  return f_sine(ctx, x);
+  return f_sine(ctx, toDefaultFxpBits(ctx, x));
 }
 
 Value cosine(SPUContext* ctx, const Value& x) {
@@ -565,7 +593,7 @@ Value cosine(SPUContext* ctx, const Value& x) {
 
   SPU_ENFORCE(x.isFxp());
 
-  return f_cosine(ctx, x);
+  return f_cosine(ctx, toDefaultFxpBits(ctx, x));
 }
 
 Value atan2(SPUContext* ctx, const Value& y, const Value& x) {
@@ -573,7 +601,7 @@ Value atan2(SPUContext* ctx, const Value& y, const Value& x) {
 
   SPU_ENFORCE(x.isFxp() && y.isFxp());
 
-  return f_atan2(ctx, y, x);
+  return f_atan2(ctx, toDefaultFxpBits(ctx, y), toDefaultFxpBits(ctx, x));
 }
 
 Value acos(SPUContext* ctx, const Value& x) {
@@ -581,7 +609,7 @@ Value acos(SPUContext* ctx, const Value& x) {
 
   SPU_ENFORCE(x.isFxp());
 
-  return f_acos(ctx, x);
+  return f_acos(ctx, toDefaultFxpBits(ctx, x));
 }
 
 Value asin(SPUContext* ctx, const Value& x) {
@@ -589,7 +617,7 @@ Value asin(SPUContext* ctx, const Value& x) {
 
   SPU_ENFORCE(x.isFxp());
 
-  return f_asin(ctx, x);
+  return f_asin(ctx, toDefaultFxpBits(ctx, x));
 }
 
 Value rsqrt(SPUContext* ctx, const Value& x) {
@@ -597,7 +625,7 @@ Value rsqrt(SPUContext* ctx, const Value& x) {
 
   SPU_ENFORCE(x.isFxp());
 
-  return f_rsqrt(ctx, x);
+  return f_rsqrt(ctx, toDefaultFxpBits(ctx, x));
 }
 
 Value sqrt(SPUContext* ctx, const Value& x) {
@@ -605,7 +633,7 @@ Value sqrt(SPUContext* ctx, const Value& x) {
 
   SPU_ENFORCE(x.isFxp());
 
-  return f_sqrt(ctx, x);
+  return f_sqrt(ctx, toDefaultFxpBits(ctx, x));
 }
 
 Value sign(SPUContext* ctx, const Value& x) {
@@ -148,6 +148,13 @@ Value _oramread_sp(SPUContext* ctx, const Value& x, const Value& y,
   return mpc::oram_read_sp(ctx, x, y, offset);
 }
 
+std::optional<Value> _lut_sp(SPUContext* ctx, const Value& x,
+                             const Value& table, size_t shift,
+                             size_t index_bits) {
+  SPU_TRACE_HAL_DISP(ctx, x, table, shift, index_bits);
+  return mpc::lut_sp(ctx, x, table, shift, index_bits);
+}
+
 // p<->s
 MAP_UNARY_OP(p2s)
 MAP_UNARY_OP(s2p)
@@ -248,6 +255,19 @@ MAP_OPTIONAL_BINARY_OP(equal_ss)
 MAP_OPTIONAL_BINARY_OP(equal_sp)
 MAP_BINARY_OP(equal_pp)
 
+std::optional<Value> _mux_s(SPUContext* ctx, const Value& pred, const Value& x,
+                            const Value& y) {
+  SPU_TRACE_HAL_DISP(ctx, pred, x, y);
+  SPU_ENFORCE(pred.shape() == x.shape() && x.shape() == y.shape(),
+              "shape mismatch: pred={}, x={}, y={}", pred.shape(), x.shape(),
+              y.shape());
+  auto ret = mpc::mux_s(ctx, pred, x, y);
+  if (!ret.has_value()) {
+    return std::nullopt;
+  }
+  return ret.value();
+}
+
 #define MAP_OPTIONAL_PERM_OP(NAME)                                    \
   Value _##NAME(SPUContext* ctx, const Value& x, const Value& y) {    \
     SPU_TRACE_HAL_DISP(ctx, x, y);                                    \
@@ -256,7 +276,7 @@ MAP_BINARY_OP(equal_pp)
     SPU_ENFORCE(x.shape().ndim() == 1, "x should be a 1-d tensor");   \
     auto ret = mpc::NAME(ctx, x, y);                                  \
     SPU_ENFORCE(ret.has_value(), "{} api not implemented", #NAME);    \
-    return ret.value().setDtype(x.dtype());                           \
+    return ret->setDtype(x.dtype()).setFxpBits(x.fxp_bits());         \
   }  // namespace spu::kernel::hal
 
 MAP_OPTIONAL_PERM_OP(perm_ss);
@@ -275,35 +295,48 @@ Value _rand_perm_s(SPUContext* ctx, const Shape& shape) {
 
 Value _broadcast(SPUContext* ctx, const Value& in, const Shape& to_shape,
                  const Axes& in_dims) {
-  return mpc::broadcast(ctx, in, to_shape, in_dims).setDtype(in.dtype());
+  return mpc::broadcast(ctx, in, to_shape, in_dims)
+      .setDtype(in.dtype())
+      .setFxpBits(in.fxp_bits());
 }
 
 Value _reshape(SPUContext* ctx, const Value& in, const Shape& to_shape) {
-  return mpc::reshape(ctx, in, to_shape).setDtype(in.dtype());
+  return mpc::reshape(ctx, in, to_shape)
+      .setDtype(in.dtype())
+      .setFxpBits(in.fxp_bits());
 }
 
 Value _extract_slice(SPUContext* ctx, const Value& in,
                      const Index& start_indices, const Index& end_indices,
                      const Strides& strides) {
   return mpc::extract_slice(ctx, in, start_indices, end_indices, strides)
-      .setDtype(in.dtype());
+      .setDtype(in.dtype())
+      .setFxpBits(in.fxp_bits());
 }
 
 Value _update_slice(SPUContext* ctx, const Value& in, const Value& update,
                     const Index& start_indices) {
-  return mpc::update_slice(ctx, in, update, start_indices).setDtype(in.dtype());
+  return mpc::update_slice(ctx, in, update, start_indices)
+      .setDtype(in.dtype())
+      .setFxpBits(in.fxp_bits());
 }
 
 Value _transpose(SPUContext* ctx, const Value& in, const Axes& permutation) {
-  return mpc::transpose(ctx, in, permutation).setDtype(in.dtype());
+  return mpc::transpose(ctx, in, permutation)
+      .setDtype(in.dtype())
+      .setFxpBits(in.fxp_bits());
 }
 
 Value _reverse(SPUContext* ctx, const Value& in, const Axes& dimensions) {
-  return mpc::reverse(ctx, in, dimensions).setDtype(in.dtype());
+  return mpc::reverse(ctx, in, dimensions)
+      .setDtype(in.dtype())
+      .setFxpBits(in.fxp_bits());
 }
 
 Value _fill(SPUContext* ctx, const Value& in, const Shape& to_shape) {
-  return mpc::fill(ctx, in, to_shape).setDtype(in.dtype());
+  return mpc::fill(ctx, in, to_shape)
+      .setDtype(in.dtype())
+      .setFxpBits(in.fxp_bits());
 }
 
 Value _pad(SPUContext* ctx, const Value& in, const Value& padding_value,
@@ -311,12 +344,15 @@ Value _pad(SPUContext* ctx, const Value& in, const Value& padding_value,
            const Sizes& interior_padding) {
   return mpc::pad(ctx, in, padding_value, edge_padding_low, edge_padding_high,
                   interior_padding)
-      .setDtype(in.dtype());
+      .setDtype(in.dtype())
+      .setFxpBits(in.fxp_bits());
 }
 
 Value _concatenate(SPUContext* ctx, const std::vector<Value>& values,
                    int64_t axis) {
-  return mpc::concatenate(ctx, values, axis).setDtype(values.front().dtype());
+  return mpc::concatenate(ctx, values, axis)
+      .setDtype(values.front().dtype())
+      .setFxpBits(values.front().fxp_bits());
 }
 
 Value _gen_inv_perm_p(SPUContext* ctx, const Value& in, bool is_ascending) {
@@ -352,7 +388,7 @@ Value _merge_keys_v(SPUContext* ctx, absl::Span<Value const> inputs,
                 x.shape(), y.shape());                                \
     SPU_ENFORCE(x.shape().ndim() == 1, "x should be a 1-d tensor");   \
     auto ret = mpc::NAME(ctx, x, y);                                  \
-    return ret.setDtype(x.dtype());                                   \
+    return ret.setDtype(x.dtype()).setFxpBits(x.fxp_bits());          \
   }
 
 MAP_PERM_OP(inv_perm_pp);
@@ -52,6 +52,10 @@ Value _equal_pp(SPUContext* ctx, const Value& x, const Value& y);
 std::optional<Value> _equal_sp(SPUContext* ctx, const Value& x, const Value& y);
 std::optional<Value> _equal_ss(SPUContext* ctx, const Value& x, const Value& y);
 
+// pred ? x : y with a secret pred, x and y are secret or public.
+std::optional<Value> _mux_s(SPUContext* ctx, const Value& pred, const Value& x,
+                            const Value& y);
+
 Value _lshift_p(SPUContext* ctx, const Value& in, size_t bits);
 Value _lshift_s(SPUContext* ctx, const Value& in, size_t bits);
 Value _lshift_v(SPUContext* ctx, const Value& in, size_t bits);
@@ -171,6 +175,11 @@ std::optional<Value> _oramonehot_sp(SPUContext* ctx, const Value& x,
 Value _oramread_sp(SPUContext* ctx, const Value& x, const Value& y,
                    int64_t offset);
 
+// public table, secret index
+std::optional<Value> _lut_sp(SPUContext* ctx, const Value& x,
+                             const Value& table, size_t shift,
+                             size_t index_bits);
+
 // NOLINTEND(readability-identifier-naming)
 
 }  // namespace spu::kernel::hal
@@ -33,7 +33,7 @@ NdArrayRef dump_public(SPUContext* ctx, const Value& v) {
   PtBufferView pv(static_cast<void*>(dst.data()), pt_type, dst.shape(),
                   dst.strides());
 
-  decodeFromRing(encoded, v.dtype(), ctx->getFxpBits(), &pv);
+  decodeFromRing(encoded, v.dtype(), ctx->getFxpBits(v), &pv);
 
   return dst;
 }
@@ -218,6 +218,21 @@ Value _trunc(SPUContext* ctx, const Value& x, size_t bits, SignType sign) {
   }
 }
 
+Value _rescale(SPUContext* ctx, const Value& x, size_t bits, SignType sign) {
+  SPU_TRACE_HAL_LEAF(ctx, x, bits);
+  const size_t cur_bits = ctx->getFxpBits(x);
+
+  Value ret = x;
+  if (bits > cur_bits) {
+    ret = _lshift(ctx, x, bits - cur_bits).setDtype(x.dtype());
+  } else if (bits < cur_bits) {
+    ret = _trunc(ctx, x, cur_bits - bits, sign).setDtype(x.dtype());
+  }
+
+  // keep the runtime default implicit, see Value::fxp_bits.
+  return ret.setFxpBits(bits == ctx->getFxpBits() ? 0 : bits);
+}
+
 // swap bits of [start, end)
 Value _bitrev(SPUContext* ctx, const Value& x, size_t start, size_t end) {
   SPU_TRACE_HAL_LEAF(ctx, x, start, end);
@@ -487,6 +502,13 @@ Value _less(SPUContext* ctx, const Value& x, const Value& y) {
 Value _mux(SPUContext* ctx, const Value& pred, const Value& a, const Value& b) {
   SPU_TRACE_HAL_LEAF(ctx, pred, a, b);
 
+  // Fast path, select with the secret predicate in a single mpc kernel.
+  if (pred.isSecret() && !a.isPrivate() && !b.isPrivate()) {
+    if (auto ret = _mux_s(ctx, pred, a, b)) {
+      return ret.value();
+    }
+  }
+
   // b + pred*(a-b)
   return _add(ctx, b, _mul(ctx, pred, _sub(ctx, a, b)));
 }
@@ -598,7 +620,9 @@ Value _bitdeintl(SPUContext* ctx, const Value& in) {
 Value _prefer_a(SPUContext* ctx, const Value& x) {
   if (x.storage_type().isa<BShare>()) {
     // B2A
-    return _add(ctx, x, _constant(ctx, 0, x.shape())).setDtype(x.dtype());
+    return _add(ctx, x, _constant(ctx, 0, x.shape()))
+        .setDtype(x.dtype())
+        .setFxpBits(x.fxp_bits());
   }
 
   return x;
@@ -613,7 +637,8 @@ Value _prefer_a(SPUContext* ctx, const Value& x) {
 Value _prefer_b(SPUContext* ctx, const Value& x) {
   if (x.storage_type().isa<AShare>()) {
     const auto k0 = _constant(ctx, 0U, x.shape());
-    return _xor(ctx, x, k0).setDtype(x.dtype());  // noop, to bshare
+    // noop, to bshare
+    return _xor(ctx, x, k0).setDtype(x.dtype()).setFxpBits(x.fxp_bits());
   }
 
   return x;
@@ -722,4 +747,17 @@ Value _oramread(SPUContext* ctx, const Value& x, const Value& y,
   return ret;
 }
 
+std::optional<Value> _lut(SPUContext* ctx, const Value& x, const Value& table,
+                          size_t shift, size_t index_bits) {
+  SPU_TRACE_HAL_DISP(ctx, x, table, shift, index_bits);
+  SPU_ENFORCE(table.isPublic(), "table should be public, got {}",
+              table.vtype());
+
+  if (!x.isSecret()) {
+    return std::nullopt;
+  }
+
+  return _lut_sp(ctx, x, table, shift, index_bits);
+}
+
 }  // namespace spu::kernel::hal
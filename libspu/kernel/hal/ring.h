@@ -83,6 +83,11 @@ Value _arshift(SPUContext* ctx, const Value& in, size_t bits);
 Value _trunc(SPUContext* ctx, const Value& x, size_t bits = 0,
              SignType sign = SignType::Unknown);
 
+// Rescale x to `bits` fraction bits, widening is a local shift while
+// narrowing truncates. The dtype is kept.
+Value _rescale(SPUContext* ctx, const Value& x, size_t bits,
+               SignType sign = SignType::Unknown);
+
 Value _bitrev(SPUContext* ctx, const Value&, size_t start_idx, size_t end_idx);
 
 // Expect pred is either {0, 1}.
@@ -131,6 +136,13 @@ std::optional<Value> _oramonehot(SPUContext* ctx, const Value& x,
 Value _oramread(SPUContext* ctx, const Value& x, const Value& y,
                 int64_t offset);
 
+// Lookup the public table of shape {2^index_bits, C} by the digit
+// (x >> shift) mod 2^index_bits of a secret x. Return std::nullopt if the
+// protocol has no such kernel.
+// NOTE: the protocol may use the digit minus one, see mpc::lut_sp.
+std::optional<Value> _lut(SPUContext* ctx, const Value& x, const Value& table,
+                          size_t shift, size_t index_bits);
+
 // NOLINTEND(readability-identifier-naming)
 
 }  // namespace spu::kernel::hal
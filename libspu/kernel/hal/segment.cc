@@ -0,0 +1,184 @@
+// Copyright 2024 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libspu/kernel/hal/segment.h"
+
+#include "libspu/core/context.h"
+#include "libspu/core/trace.h"
+#include "libspu/kernel/hal/constants.h"
+#include "libspu/kernel/hal/permute.h"
+#include "libspu/kernel/hal/polymorphic.h"
+#include "libspu/kernel/hal/ring.h"
+#include "libspu/kernel/hal/shape_ops.h"
+#include "libspu/kernel/hal/utils.h"
+
+namespace spu::kernel::hal {
+
+namespace {
+
+Value _slice1d(SPUContext *ctx, const Value &x, int64_t start, int64_t end) {
+  return slice(ctx, x, {start}, {end});
+}
+
+// flatten and concatenate values of the same shape regardless of dtype.
+Value _concat_flat(SPUContext *ctx, std::vector<Value> xs) {
+  for (auto &x : xs) {
+    x = reshape(ctx, Value(x.data(), DT_INVALID), {x.numel()});
+  }
+  return concatenate(ctx, xs, 0);
+}
+
+// the j-th of the flattened values concatenated by _concat_flat.
+Value _split_flat(SPUContext *ctx, const Value &x, size_t j,
+                  const Shape &shape) {
+  const int64_t numel = shape.numel();
+  return reshape(ctx, _slice1d(ctx, x, j * numel, (j + 1) * numel), shape);
+}
+
+// The segmented combine over (g, v...) tuples, where g = 1 means v still
+// needs to absorb values before it, i.e.
+//   (g1, v1) + (g2, v2) = (g1 * g2, g2 ? op(v1, v2) : v2)
+// All operands of one round are combined with batched multiplications.
+std::vector<Value> _segment_combine(SPUContext *ctx,
+                                    absl::Span<const Value> lhs,
+                                    absl::Span<const Value> rhs,
+                                    SegmentReduceOp op) {
+  const size_t m = lhs.size() - 1;
+  const Shape &shape = lhs[0].shape();
+  const auto &g_prev = lhs[0];
+  const auto &g_cur = rhs[0];
+
+  std::vector<Value> factors = {g_prev};
+  if (op == SegmentReduceOp::Sum) {
+    // v_cur += g_cur * v_prev, together with g_cur * g_prev.
+    factors.insert(factors.end(), lhs.begin() + 1, lhs.end());
+  } else {
+    // prev wins when it is in the same segment and better than cur.
+    for (size_t j = 1; j <= m; ++j) {
+      auto c = op == SegmentReduceOp::Max ? less(ctx, rhs[j], lhs[j])
+                                          : less(ctx, lhs[j], rhs[j]);
+      factors.emplace_back(_prefer_a(ctx, c));
+    }
+  }
+  auto prod = _mul(ctx, _concat_flat(ctx, std::vector(m + 1, g_cur)),
+                   _concat_flat(ctx, factors));
+
+  std::vector<Value> rets = {_split_flat(ctx, prod, 0, shape)};
+  Value deltas;
+  if (op == SegmentReduceOp::Sum) {
+    deltas = _slice1d(ctx, prod, shape.numel(), prod.numel());
+  } else {
+    // v_cur += sel * (v_prev - v_cur)
+    std::vector<Value> diffs(m);
+    for (size_t j = 0; j < m; ++j) {
+      diffs[j] = _sub(ctx, lhs[j + 1], rhs[j + 1]);
+    }
+    deltas = _mul(ctx, _slice1d(ctx, prod, shape.numel(), prod.numel()),
+                  _concat_flat(ctx, diffs));
+  }
+
+  for (size_t j = 0; j < m; ++j) {
+    rets.emplace_back(_add(ctx, rhs[j + 1], _split_flat(ctx, deltas, j, shape))
+                          .setDtype(rhs[j + 1].dtype())
+                          .setFxpBits(rhs[j + 1].fxp_bits()));
+  }
+  return rets;
+}
+
+}  // namespace
+
+std::vector<Value> segment_scan(SPUContext *ctx, const Value &same_as_prev,
+                                absl::Span<const Value> values,
+                                SegmentReduceOp op) {
+  SPU_TRACE_HAL_DISP(ctx, same_as_prev);
+  SPU_ENFORCE(op != SegmentReduceOp::Count, "scan ones with sum for count");
+  SPU_ENFORCE(same_as_prev.shape().ndim() == 1, "expect 1-D input, got {}",
+              same_as_prev.shape());
+  for (const auto &v : values) {
+    SPU_ENFORCE(v.shape() == same_as_prev.shape(), "shape mismatch {} vs {}",
+                v.shape(), same_as_prev.shape());
+  }
+
+  if (values.empty()) {
+    return {};
+  }
+
+  std::vector<Value> operands = {_prefer_a(ctx, same_as_prev)};
+  operands.insert(operands.end(), values.begin(), values.end());
+
+  BatchedScanFn fn = [op](SPUContext *ctx, absl::Span<const Value> lhs,
+                          absl::Span<const Value> rhs) {
+    return _segment_combine(ctx, lhs, rhs, op);
+  };
+  auto scanned =
+      associative_scan(fn, ctx, operands, 0, ScanSchedule::Sklansky);
+
+  std::vector<Value> rets;
+  for (size_t j = 0; j < values.size(); ++j) {
+    rets.emplace_back(scanned[j + 1]
+                          .setDtype(values[j].dtype(), true)
+                          .setFxpBits(values[j].fxp_bits()));
+  }
+  return rets;
+}
+
+std::vector<Value> segment_aggregate(SPUContext *ctx, const Value &keys,
+                                     absl::Span<const Value> values,
+                                     SegmentReduceOp op, int64_t valid_bits) {
+  SPU_TRACE_HAL_DISP(ctx, keys);
+  SPU_ENFORCE(keys.shape().ndim() == 1, "expect 1-D keys, got {}",
+              keys.shape());
+
+  const int64_t n = keys.numel();
+
+  std::vector<Value> operands = {keys};
+  if (op == SegmentReduceOp::Count) {
+    auto dt =
+        ctx->config().field() == FieldType::FM32 ? spu::DT_I32 : spu::DT_I64;
+    operands.emplace_back(constant(ctx, 1, dt, keys.shape()));
+  } else {
+    operands.insert(operands.end(), values.begin(), values.end());
+  }
+
+  if (n == 0) {
+    operands.insert(operands.begin() + 1, constant(ctx, false, DT_I1, {0}));
+    return operands;
+  }
+
+  // 1. sort by keys with the permutation machinery.
+  auto sorted = simple_sort1d(ctx, operands, SortDirection::Ascending,
+                              /*num_keys*/ 1, valid_bits);
+
+  // 2. boundary flags with one batched equality test,
+  //    eq[i] = 1{key[i] == key[i+1]}
+  auto eq = equal(ctx, _slice1d(ctx, sorted[0], 0, n - 1),
+                  _slice1d(ctx, sorted[0], 1, n));
+  auto same_as_prev =
+      concatenate(ctx, {constant(ctx, false, DT_I1, {1}), eq}, 0);
+  auto is_last =
+      concatenate(ctx, {logical_not(ctx, eq), constant(ctx, true, DT_I1, {1})},
+                  0);
+
+  // 3. segmented scan, the last element of each segment holds the aggregated
+  //    result.
+  auto scanned = segment_scan(
+      ctx, same_as_prev, absl::MakeSpan(sorted).subspan(1),
+      op == SegmentReduceOp::Count ? SegmentReduceOp::Sum : op);
+
+  std::vector<Value> rets = {sorted[0], is_last};
+  rets.insert(rets.end(), scanned.begin(), scanned.end());
+  return rets;
+}
+
+}  // namespace spu::kernel::hal
@@ -0,0 +1,66 @@
+// Copyright 2024 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "absl/types/span.h"
+
+#include "libspu/core/value.h"
+
+namespace spu {
+class SPUContext;
+}
+
+namespace spu::kernel::hal {
+
+enum class SegmentReduceOp {
+  Sum,
+  Count,
+  Min,
+  Max,
+};
+
+// Segmented inclusive scan, i.e. prefix reduce of each segment.
+//
+// Inputs:
+//  - same_as_prev: 1-D {0, 1} value, same_as_prev[i] = 1 means the i-th
+//    element belongs to the same segment as the (i-1)-th element.
+//  - values: 1-D operands to scan, with the same shape as same_as_prev.
+//  - op: the reduce op, `Count` is not accepted here, scan ones with `Sum`
+//    instead.
+//
+// The scan is an associative_scan with the Sklansky schedule, i.e. log(n)
+// rounds, and each round combines all operands with batched multiplications.
+std::vector<Value> segment_scan(SPUContext *ctx, const Value &same_as_prev,
+                                absl::Span<const Value> values,
+                                SegmentReduceOp op);
+
+// Group-by aggregation over (possibly secret) keys.
+//
+// Inputs:
+//  - keys: 1-D group keys.
+//  - values: 1-D operands to aggregate, ignored when op is `Count`.
+//  - op: the reduce op.
+//  - valid_bits: indicates the numeric range of keys for performance hint.
+//
+// Returns [sorted_keys, is_last, aggregated...], all with the same shape as
+// keys. Since the number of groups is secret, the aggregated results of a
+// group are placed at the last element of the group, where is_last is 1.
+// When op is `Count`, there is exactly one aggregated output.
+std::vector<Value> segment_aggregate(SPUContext *ctx, const Value &keys,
+                                     absl::Span<const Value> values,
+                                     SegmentReduceOp op,
+                                     int64_t valid_bits = -1);
+
+}  // namespace spu::kernel::hal
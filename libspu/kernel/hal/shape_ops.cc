@@ -21,6 +21,29 @@
 
 namespace spu::kernel::hal {
 
+namespace {
+
+// Elements put into one value must share the scale, widen fixed-point values
+// to the finest scale among them.
+std::vector<Value> _align_fxp_bits(SPUContext* ctx,
+                                   const std::vector<Value>& values) {
+  size_t bits = 0;
+  for (const auto& v : values) {
+    if (!v.isFxp()) {
+      return values;
+    }
+    bits = std::max(bits, ctx->getFxpBits(v));
+  }
+
+  std::vector<Value> rets;
+  for (const auto& v : values) {
+    rets.push_back(_rescale(ctx, v, bits));
+  }
+  return rets;
+}
+
+}  // namespace
+
 Value transpose(SPUContext* ctx, const Value& in, const Axes& permutation) {
   SPU_TRACE_HAL_DISP(ctx, in, permutation);
 
@@ -35,16 +58,23 @@ Value slice(SPUContext* ctx, const Value& in, const Index& start_indices,
 }
 
 Value slice_scalar_at(SPUContext*, const Value& input, const Index& indices) {
-  return Value(input.data().slice_scalar_at(indices), input.dtype());
+  return Value(input.data().slice_scalar_at(indices), input.dtype())
+      .setFxpBits(input.fxp_bits());
 }
 
 Value update_slice(SPUContext* ctx, const Value& in, const Value& update,
                    const Index& start_indices) {
   SPU_TRACE_HAL_DISP(ctx, in, start_indices);
 
+  if (in.isFxp() && ctx->getFxpBits(in) != ctx->getFxpBits(update)) {
+    return update_slice(ctx, in, _rescale(ctx, update, ctx->getFxpBits(in)),
+                        start_indices);
+  }
+
   if (in.storage_type() != update.storage_type()) {
-    auto u =
-        _cast_type(ctx, update, in.storage_type()).setDtype(update.dtype());
+    auto u = _cast_type(ctx, update, in.storage_type())
+                 .setDtype(update.dtype())
+                 .setFxpBits(update.fxp_bits());
 
     return update_slice(ctx, in, u, start_indices);
   }
@@ -80,12 +110,21 @@ Value expand(SPUContext* ctx, const Value& in, const Shape& to_shape) {
 Value pad(SPUContext* ctx, const Value& in, const Value& padding_value,
           const Sizes& edge_padding_low, const Sizes& edge_padding_high,
           const Sizes& interior_padding) {
+  if (in.isFxp() && ctx->getFxpBits(in) != ctx->getFxpBits(padding_value)) {
+    auto aligned = _align_fxp_bits(ctx, {in, padding_value});
+    return pad(ctx, aligned[0], aligned[1], edge_padding_low,
+               edge_padding_high, interior_padding);
+  }
+
   if (in.storage_type() != padding_value.storage_type()) {
     auto ct =
         _common_type(ctx, in.storage_type(), padding_value.storage_type());
-    auto normalized_in = _cast_type(ctx, in, ct).setDtype(in.dtype());
-    auto normalized_padding_value =
-        _cast_type(ctx, padding_value, ct).setDtype(padding_value.dtype());
+    auto normalized_in = _cast_type(ctx, in, ct)
+                             .setDtype(in.dtype())
+                             .setFxpBits(in.fxp_bits());
+    auto normalized_padding_value = _cast_type(ctx, padding_value, ct)
+                                        .setDtype(padding_value.dtype())
+                                        .setFxpBits(padding_value.fxp_bits());
     return pad(ctx, normalized_in, normalized_padding_value, edge_padding_low,
                edge_padding_high, interior_padding);
   }
@@ -109,6 +148,14 @@ Value concatenate(SPUContext* ctx, const std::vector<Value>& values,
       [&](const Value& v) { return v.dtype() == values.begin()->dtype(); });
   SPU_ENFORCE(all_same_dtype, "not all element has same dtype");
 
+  bool all_same_fxp_bits =
+      std::all_of(values.begin() + 1, values.end(), [&](const Value& v) {
+        return ctx->getFxpBits(v) == ctx->getFxpBits(values.front());
+      });
+  if (values.front().isFxp() && !all_same_fxp_bits) {
+    return concatenate(ctx, _align_fxp_bits(ctx, values), axis);
+  }
+
   bool all_same_stype =
       std::all_of(values.begin() + 1, values.end(), [&](const Value& v) {
         return v.storage_type() == values.begin()->storage_type();
@@ -123,7 +170,9 @@ Value concatenate(SPUContext* ctx, const std::vector<Value>& values,
     std::vector<Value> common_values;
     std::transform(values.cbegin(), values.cend(),
                    std::back_inserter(common_values), [&](const Value& x) {
-                     return _cast_type(ctx, x, common_type).setDtype(x.dtype());
+                     return _cast_type(ctx, x, common_type)
+                         .setDtype(x.dtype())
+                         .setFxpBits(x.fxp_bits());
                    });
 
     return concatenate(ctx, common_values, axis);
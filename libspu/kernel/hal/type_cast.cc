@@ -49,7 +49,7 @@ Value fxp2int(SPUContext* ctx, const Value& x, DataType to_type) {
   SPU_TRACE_HAL_LEAF(ctx, x);
   SPU_ENFORCE(x.isFxp());
 
-  const size_t fxp_bits = ctx->getFxpBits();
+  const size_t fxp_bits = ctx->getFxpBits(x);
   const Value kOneMinusEps = _constant(ctx, (1 << fxp_bits) - 1, x.shape());
 
   // (x + 0.99 * (x < 0)) >> fxp_bits
@@ -64,17 +64,17 @@ Value fxp2int(SPUContext* ctx, const Value& x, DataType to_type) {
 Value seal(SPUContext* ctx, const Value& x) {
   SPU_TRACE_HAL_LEAF(ctx, x);
   if (x.isPrivate()) {
-    return _v2s(ctx, x).setDtype(x.dtype());
+    return _v2s(ctx, x).setDtype(x.dtype()).setFxpBits(x.fxp_bits());
   }
-  return _p2s(ctx, x).setDtype(x.dtype());
+  return _p2s(ctx, x).setDtype(x.dtype()).setFxpBits(x.fxp_bits());
 }
 
 Value reveal(SPUContext* ctx, const Value& x) {
   SPU_TRACE_HAL_LEAF(ctx, x);
   if (x.isPrivate()) {
-    return _v2p(ctx, x).setDtype(x.dtype());
+    return _v2p(ctx, x).setDtype(x.dtype()).setFxpBits(x.fxp_bits());
   }
-  return _s2p(ctx, x).setDtype(x.dtype());
+  return _s2p(ctx, x).setDtype(x.dtype()).setFxpBits(x.fxp_bits());
 }
 
 Value dtype_cast(SPUContext* ctx, const Value& in, DataType to_type) {
@@ -102,7 +102,7 @@ Value dtype_cast(SPUContext* ctx, const Value& in, DataType to_type) {
       SPU_ENFORCE(to_type == DT_F32 || to_type == DT_F64,
                   "expect to_type FXP, got {}", to_type);
       SPU_ENFORCE(in.isFxp(), "expect in type FXP, got {}", in.dtype());
-      return Value(in.data(), to_type);
+      return Value(in.data(), to_type).setFxpBits(in.fxp_bits());
     }
   }
 
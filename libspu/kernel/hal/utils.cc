@@ -14,8 +14,211 @@
 
 #include "libspu/kernel/hal/utils.h"
 
+#include <numeric>
+
+#include "absl/numeric/bits.h"
+
 namespace spu::kernel::hal {
 
+namespace {
+
+// slice [start, end) with stride along the axis.
+Value _slice_along(SPUContext* ctx, const Value& in, int64_t axis,
+                   int64_t start, int64_t end, int64_t stride = 1) {
+  Index start_indices(in.shape().ndim(), 0);
+  Index end_indices(in.shape().begin(), in.shape().end());
+  Strides strides(in.shape().ndim(), 1);
+  start_indices[axis] = start;
+  end_indices[axis] = end;
+  strides[axis] = stride;
+  return hal::slice(ctx, in, start_indices, end_indices, strides);
+}
+
+// the combined results keep the dtype of inputs, ring level fn may drop it.
+std::vector<Value> _apply(const BatchedScanFn& fn, SPUContext* ctx,
+                          absl::Span<const Value> lhs,
+                          absl::Span<const Value> rhs) {
+  auto rets = fn(ctx, lhs, rhs);
+  SPU_ENFORCE(rets.size() == lhs.size(), "expect {} results, got {}",
+              lhs.size(), rets.size());
+  for (size_t i = 0; i < rets.size(); ++i) {
+    rets[i].setDtype(lhs[i].dtype(), true);
+  }
+  return rets;
+}
+
+// ret[2i] = even[i], ret[2i+1] = odd[i] along the axis.
+Value _interleave(SPUContext* ctx, const Value& even, const Value& odd,
+                  int64_t axis) {
+  const int64_t num_even = even.shape()[axis];
+  const int64_t num_odd = odd.shape()[axis];
+  SPU_ENFORCE(num_even == num_odd || num_even == num_odd + 1);
+
+  Shape stacked_shape = odd.shape();
+  stacked_shape.insert(stacked_shape.begin() + axis + 1, 1);
+
+  auto head = _slice_along(ctx, even, axis, 0, num_odd);
+  auto stacked = concatenate(ctx,
+                             {reshape(ctx, head, stacked_shape),
+                              reshape(ctx, odd, stacked_shape)},
+                             axis + 1);
+
+  Shape merged_shape = odd.shape();
+  merged_shape[axis] = 2 * num_odd;
+  auto merged = reshape(ctx, stacked, merged_shape);
+
+  if (num_even > num_odd) {
+    merged = concatenate(
+        ctx, {merged, _slice_along(ctx, even, axis, num_odd, num_even)},
+        axis);
+  }
+  return merged;
+}
+
+std::vector<Value> _brent_kung_scan(const BatchedScanFn& fn, SPUContext* ctx,
+                                    absl::Span<const Value> in, int64_t axis) {
+  const int64_t numel = in[0].shape()[axis];
+  if (numel < 2) {
+    return {in.begin(), in.end()};
+  }
+
+  // merge consecutive even/odd index elements
+  std::vector<Value> lhs;
+  std::vector<Value> rhs;
+  for (const auto& x : in) {
+    lhs.push_back(_slice_along(ctx, x, axis, 0, numel - 1, 2));
+    rhs.push_back(_slice_along(ctx, x, axis, 1, numel, 2));
+  }
+  auto reduced = _apply(fn, ctx, lhs, rhs);
+
+  // process half elements recursively and get odd index elements
+  auto odd_elems = _brent_kung_scan(fn, ctx, reduced, axis);
+
+  // get even index elements, the 0th element is kept as is.
+  const int64_t num_even_rest = (numel - 1) / 2;
+  std::vector<Value> even_elems;
+  for (const auto& x : in) {
+    even_elems.push_back(_slice_along(ctx, x, axis, 0, 1));
+  }
+  if (num_even_rest > 0) {
+    std::vector<Value> prev;
+    std::vector<Value> cur;
+    for (size_t i = 0; i < in.size(); ++i) {
+      prev.push_back(_slice_along(ctx, odd_elems[i], axis, 0, num_even_rest));
+      cur.push_back(_slice_along(ctx, in[i], axis, 2, numel, 2));
+    }
+    auto rest = _apply(fn, ctx, prev, cur);
+    for (size_t i = 0; i < in.size(); ++i) {
+      even_elems[i] = concatenate(ctx, {even_elems[i], rest[i]}, axis);
+    }
+  }
+
+  // concat even and odd elems interleavely
+  std::vector<Value> rets;
+  for (size_t i = 0; i < in.size(); ++i) {
+    rets.push_back(_interleave(ctx, even_elems[i], odd_elems[i], axis));
+  }
+  return rets;
+}
+
+std::vector<Value> _sklansky_scan(const BatchedScanFn& fn, SPUContext* ctx,
+                                  absl::Span<const Value> in, int64_t axis) {
+  const int64_t numel = in[0].shape()[axis];
+  if (numel < 2) {
+    return {in.begin(), in.end()};
+  }
+
+  // move the axis to scan to the last, swap is self-inverse.
+  const int64_t ndim = in[0].shape().ndim();
+  Axes perm(ndim);
+  std::iota(perm.begin(), perm.end(), 0);
+  std::swap(perm[axis], perm.back());
+
+  // pad to power of 2 by repeating the last element, trailing elements never
+  // affect the prefix before them.
+  const int64_t padded = absl::bit_ceil(static_cast<uint64_t>(numel));
+  std::vector<Value> xs;
+  for (const auto& x : in) {
+    auto t = transpose(ctx, x, perm);
+    if (padded > numel) {
+      Shape pad_shape = t.shape();
+      pad_shape.back() = padded - numel;
+      Axes in_dims(ndim - 1);
+      std::iota(in_dims.begin(), in_dims.end(), 0);
+      auto last = reshape(ctx, _slice_along(ctx, t, ndim - 1, numel - 1, numel),
+                          Shape(pad_shape.begin(), pad_shape.end() - 1));
+      t = concatenate(ctx, {t, broadcast_to(ctx, last, pad_shape, in_dims)},
+                      ndim - 1);
+    }
+    xs.push_back(t);
+  }
+
+  const Shape batch_shape(xs[0].shape().begin(), xs[0].shape().end() - 1);
+
+  // for each block of 2*half elements, the upper half absorbs the last
+  // element of the lower half.
+  for (int64_t half = 1; half < padded; half *= 2) {
+    Shape block_shape = batch_shape;
+    block_shape.push_back(padded / (2 * half));
+    block_shape.push_back(2);
+    block_shape.push_back(half);
+    const int64_t block_ndim = block_shape.size();
+    Axes in_dims(block_ndim - 2);
+    std::iota(in_dims.begin(), in_dims.end(), 0);
+
+    std::vector<Value> lower;
+    std::vector<Value> upper;
+    std::vector<Value> last;
+    for (const auto& x : xs) {
+      auto t = reshape(ctx, x, block_shape);
+      auto l = _slice_along(ctx, t, block_ndim - 2, 0, 1);
+      upper.push_back(_slice_along(ctx, t, block_ndim - 2, 1, 2));
+      auto l_last = reshape(
+          ctx, _slice_along(ctx, l, block_ndim - 1, half - 1, half),
+          Shape(block_shape.begin(), block_shape.end() - 2));
+      last.push_back(broadcast_to(ctx, l_last, upper.back().shape(), in_dims));
+      lower.push_back(l);
+    }
+
+    auto combined = _apply(fn, ctx, last, upper);
+
+    for (size_t i = 0; i < xs.size(); ++i) {
+      xs[i] = reshape(
+          ctx, concatenate(ctx, {lower[i], combined[i]}, block_ndim - 2),
+          xs[i].shape());
+    }
+  }
+
+  std::vector<Value> rets;
+  for (const auto& x : xs) {
+    rets.push_back(
+        transpose(ctx, _slice_along(ctx, x, ndim - 1, 0, numel), perm));
+  }
+  return rets;
+}
+
+}  // namespace
+
+std::vector<Value> associative_scan(const BatchedScanFn& fn, SPUContext* ctx,
+                                    absl::Span<const Value> in, int64_t axis,
+                                    ScanSchedule schedule) {
+  SPU_ENFORCE(!in.empty(), "inputs should not be empty");
+  for (const auto& x : in) {
+    SPU_ENFORCE(x.shape() == in[0].shape(), "shape mismatch {} vs {}",
+                x.shape(), in[0].shape());
+  }
+  SPU_ENFORCE(axis >= 0 && axis < in[0].shape().ndim(),
+              "invalid axis {} for shape {}", axis, in[0].shape());
+
+  switch (schedule) {
+    case ScanSchedule::BrentKung:
+      return _brent_kung_scan(fn, ctx, in, axis);
+    case ScanSchedule::Sklansky:
+      return _sklansky_scan(fn, ctx, in, axis);
+  }
+  SPU_THROW("should not be here");
+}
+
 Value squeeze(SPUContext* ctx, const Value& in, int64_t dim) {
   SPU_ENFORCE(dim >= 0 && dim < in.shape().ndim(),
               "input shape {} and squeezing dim {} are mismatched", in.shape(),
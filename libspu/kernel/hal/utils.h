@@ -14,6 +14,10 @@
 
 #pragma once
 
+#include <functional>
+
+#include "absl/types/span.h"
+
 #include "libspu/core/context.h"
 #include "libspu/core/value.h"
 #include "libspu/kernel/hal/constants.h"
@@ -23,54 +27,54 @@
 
 namespace spu::kernel::hal {
 
-// This is SPU's version of JAX's associative_scan
+enum class ScanSchedule {
+  // Work efficient, 2*log(n) rounds of fn, O(n) elements are combined.
+  BrentKung,
+  // Latency optimal, log(n) rounds of fn, O(n*log(n)) elements are combined.
+  Sklansky,
+};
+
+// An associative binary function over tuples of operands, i.e.
+//   (lhs[0], lhs[1], ...) op (rhs[0], rhs[1], ...)
+// All operands of one side have the same shape.
+using BatchedScanFn = std::function<std::vector<Value>(
+    SPUContext*, absl::Span<const Value>, absl::Span<const Value>)>;
+
+// This is SPU's version of JAX's associative_scan over multiple operands
 // See:
 // https://jax.readthedocs.io/en/latest/_autosummary/jax.lax.associative_scan.html
 //
+// Each round of the schedule calls fn exactly once, with all elements to be
+// combined in that round, so every round is one batched MPC call.
+//
+// fn: an associative binary function over tuples
+// in: operands with the same shape
+// axis: the axis to scan along
+// schedule: the parallel prefix schedule
+std::vector<Value> associative_scan(
+    const BatchedScanFn& fn, SPUContext* ctx, absl::Span<const Value> in,
+    int64_t axis, ScanSchedule schedule = ScanSchedule::BrentKung);
+
+// This is SPU's version of JAX's associative_scan
+//
 // Refer to
 // https://developer.nvidia.com/gpugems/gpugems3/part-vi-gpu-computing/chapter-39-parallel-prefix-sum-scan-cuda
 // for the detailed algorithm explanation
 //
 // fn: an associative binary Function
-// in: a 1-d tensor
+// in: a tensor
+// axis: the axis to scan along
 template <typename Fn>
-spu::Value associative_scan(Fn&& fn, SPUContext* ctx, const Value& in) {
-  SPU_ENFORCE(in.shape().ndim() == 1U, "input should be 1d");
-  const auto numel = in.numel();
-  if (numel < 2) {
-    return in;
-  }
-
-  // merge consecutive even/odd index elements
-  auto reduced_elems = fn(ctx, hal::slice(ctx, in, {0}, {numel - 1}, {2}),
-                          hal::slice(ctx, in, {1}, {numel}, {2}));
-  // process half elements recursively and get odd index elements
-  auto odd_elems = associative_scan(fn, ctx, reduced_elems);
-
-  // get even index elements
-  spu::Value even_elems;
-  if (numel % 2 == 0) {
-    even_elems =
-        fn(ctx, hal::slice(ctx, odd_elems, {0}, {odd_elems.numel() - 1}, {1}),
-           hal::slice(ctx, in, {2}, {numel}, {2}));
-  } else {
-    even_elems = fn(ctx, odd_elems, hal::slice(ctx, in, {2}, {numel}, {2}));
-  }
-  // concat the 0th element
-  auto final_even_elems =
-      hal::concatenate(ctx, {hal::slice(ctx, in, {0}, {1}), even_elems}, 0);
-
-  // concat even and odd elems interleavely
-  auto zero = hal::constant(ctx, 0U, in.dtype(), {1});
-  auto pad_even =
-      hal::pad(ctx, final_even_elems, zero, {0},
-               {final_even_elems.numel() == odd_elems.numel() ? 1 : 0}, {1});
-  auto pad_odd =
-      hal::pad(ctx, odd_elems, zero, {1},
-               {final_even_elems.numel() == odd_elems.numel() ? 0 : 1}, {1});
-
-  auto ret = hal::_add(ctx, pad_even, pad_odd).setDtype(in.dtype());
-  return ret;
+spu::Value associative_scan(Fn&& fn, SPUContext* ctx, const Value& in,
+                            int64_t axis = 0,
+                            ScanSchedule schedule = ScanSchedule::BrentKung) {
+  BatchedScanFn batched_fn = [&fn](SPUContext* ctx,
+                                   absl::Span<const Value> lhs,
+                                   absl::Span<const Value> rhs) {
+    return std::vector<Value>{fn(ctx, lhs[0], rhs[0])};
+  };
+  return associative_scan(batched_fn, ctx, absl::MakeConstSpan(&in, 1), axis,
+                          schedule)[0];
 }
 
 //////////////////////////////////////////////////////////////////////////////
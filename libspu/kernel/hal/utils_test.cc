@@ -16,6 +16,7 @@
 
 #include "gtest/gtest.h"
 #include "xtensor/xio.hpp"
+#include "xtensor/xmath.hpp"
 
 #include "libspu/kernel/hal/polymorphic.h"
 #include "libspu/kernel/hal/type_cast.h"
@@ -82,6 +83,50 @@ TEST(UtilsTest, associative_scan) {
   }
 }
 
+TEST(UtilsTest, associative_scan_axis) {
+  SPUContext ctx = test::makeSPUContext();
+
+  const xt::xarray<int32_t> x = {{1, 2, 3, 4, 5, 6, 7}, {7, 6, 5, 4, 3, 2, 1}};
+  Value a = test::makeValue(&ctx, x, VIS_SECRET);
+
+  for (auto schedule : {ScanSchedule::BrentKung, ScanSchedule::Sklansky}) {
+    for (int64_t axis : {0, 1}) {
+      const xt::xarray<int32_t> expected = xt::cumsum(x, axis);
+      Value b = associative_scan(hal::add, &ctx, a, axis, schedule);
+      auto ret = dump_public_as<int32_t>(&ctx, hal::reveal(&ctx, b));
+      EXPECT_TRUE(expected == ret) << x << std::endl
+                                   << expected << std::endl
+                                   << ret;
+    }
+  }
+}
+
+TEST(UtilsTest, associative_scan_tuple) {
+  SPUContext ctx = test::makeSPUContext();
+
+  // h[i] = a[i] * h[i-1] + b[i], h[-1] = 0
+  const xt::xarray<int32_t> a = {2, 1, 3, 1, 2, 1};
+  const xt::xarray<int32_t> b = {1, 2, 1, 3, 1, 2};
+  const xt::xarray<int32_t> expected = {1, 3, 10, 13, 27, 29};
+
+  // (a1, b1) then (a2, b2) => (a1 * a2, a2 * b1 + b2)
+  auto affine = [](SPUContext* ctx, absl::Span<const Value> lhs,
+                   absl::Span<const Value> rhs) {
+    return std::vector<Value>{
+        hal::mul(ctx, lhs[0], rhs[0]),
+        hal::add(ctx, hal::mul(ctx, rhs[0], lhs[1]), rhs[1])};
+  };
+
+  std::vector<Value> in = {test::makeValue(&ctx, a, VIS_SECRET),
+                           test::makeValue(&ctx, b, VIS_SECRET)};
+  for (auto schedule : {ScanSchedule::BrentKung, ScanSchedule::Sklansky}) {
+    auto rets = associative_scan(affine, &ctx, in, 0, schedule);
+    ASSERT_EQ(rets.size(), 2);
+    auto ret = dump_public_as<int32_t>(&ctx, hal::reveal(&ctx, rets[1]));
+    EXPECT_TRUE(expected == ret) << expected << std::endl << ret;
+  }
+}
+
 TEST(UtilsTest, Squeeze) {
   // GIVEN
   xt::xarray<int32_t> x = xt::ones<int32_t>({2, 1, 2, 1, 2});
@@ -15,6 +15,8 @@
 #include "libspu/kernel/hlo/indexing.h"
 
 #include <cstring>
+#include <numeric>
+#include <optional>
 
 #include "llvm/ADT/STLExtras.h"
 
@@ -27,7 +29,6 @@
 #include "libspu/kernel/hal/shape_ops.h"
 #include "libspu/kernel/hal/type_cast.h"
 #include "libspu/kernel/hal/utils.h"
-#include "libspu/kernel/hlo/basic_unary.h"
 #include "libspu/kernel/hlo/const.h"
 #include "libspu/kernel/hlo/utils.h"
 
@@ -310,112 +311,131 @@ spu::Value reshapedGatherIndices(spu::SPUContext *ctx, int64_t index_vector_dim,
   return spu::kernel::hal::reshape(ctx, start_indices, new_shape);
 }
 
-spu::Value SecretLinearUpdateIndexing(spu::SPUContext *ctx,
-                                      const spu::Value &operand,
-                                      const spu::Value &update,
-                                      const spu::Value &linear_idx) {
-  // TODO: Consider utilizing DLP to improve performance
-  SPU_ENFORCE(operand.shape().size() == 1, "operand must be a 1D tensor");
-  SPU_ENFORCE(linear_idx.numel() == 1, "index must be a 1D indexing");
-  SPU_ENFORCE(update.numel() == 1, "update must be a scalar");
-
-  // Basic idea here:
-  // eq(iota, idx) * update + !eq(iota, idx) * operand
-  auto linear_idx_broadcasted =
-      spu::kernel::hal::broadcast_to(ctx, linear_idx, {operand.numel()}, {});
-  spu::Value idx_iota =
-      spu::kernel::hal::iota(ctx, spu::DT_I64, operand.numel());
-  auto mask = spu::kernel::hal::equal(ctx, linear_idx_broadcasted, idx_iota);
-
-  auto c0 = spu::kernel::hlo::Constant(ctx, static_cast<int64_t>(0), {});
-  auto i0 = spu::kernel::hal::dtype_cast(ctx, c0, operand.dtype());
-
-  auto reverse_mask = spu::kernel::hlo::Not(ctx, mask);
-
-  auto broadcast_update =
-      spu::kernel::hal::broadcast_to(ctx, update, operand.shape(), {0});
-
-  return spu::kernel::hal::add(
-      ctx, spu::kernel::hal::mul(ctx, operand, reverse_mask),
-      spu::kernel::hal::mul(ctx, broadcast_update, mask));
-}
-
-std::vector<spu::Value> ClampAndFlattenIndex(
+// start_indices[i] = clamp(start_indices[i], 0, limit_shape[i] -
+// window_shape[i]), all indices are clamped in one batch.
+std::vector<spu::Value> ClampStartIndices(
     spu::SPUContext *ctx, absl::Span<const spu::Value> start_indices,
-    const spu::Shape &iterate_shape, const spu::Shape &limit_shape) {
-  // Transform start_indices
-  // start_indices[i] = clamp(start_indices[i], 0, operand.dimension_size[i]
-  // - size_indices[i])
+    const spu::Shape &window_shape, const spu::Shape &limit_shape) {
+  std::vector<spu::Value> reshaped_start_indices;
+  std::transform(start_indices.cbegin(), start_indices.cend(),
+                 std::back_inserter(reshaped_start_indices),
+                 [&](const spu::Value &x) {
+                   return spu::kernel::hal::reshape(ctx, x, {1});
+                 });
+
+  auto concat_idx =
+      spu::kernel::hal::concatenate(ctx, reshaped_start_indices, 0);
+  auto lower_bound = spu::kernel::hlo::Constant(ctx, static_cast<int64_t>(0),
+                                                concat_idx.shape());
+  lower_bound =
+      spu::kernel::hal::dtype_cast(ctx, lower_bound, concat_idx.dtype());
+
+  std::vector<int64_t> upper_bound_pt(start_indices.size());
+  for (size_t idx = 0; idx < upper_bound_pt.size(); ++idx) {
+    upper_bound_pt[idx] = limit_shape[idx] - window_shape[idx];
+  }
+  auto upper_bound =
+      spu::kernel::hlo::Constant(ctx, upper_bound_pt, concat_idx.shape());
+  upper_bound =
+      spu::kernel::hal::dtype_cast(ctx, upper_bound, concat_idx.dtype());
+
+  auto c = spu::kernel::hal::clamp(ctx, concat_idx, lower_bound, upper_bound);
 
   std::vector<spu::Value> clamped_start(start_indices.size());
-  {
-    std::vector<spu::Value> reshaped_start_indices;
-    std::transform(start_indices.cbegin(), start_indices.cend(),
-                   std::back_inserter(reshaped_start_indices),
-                   [&](const spu::Value &x) {
-                     return spu::kernel::hal::unsqueeze(ctx, x);
-                   });
-
-    auto concat_idx =
-        spu::kernel::hal::concatenate(ctx, reshaped_start_indices, 0);
-    auto lower_bound = spu::kernel::hlo::Constant(ctx, static_cast<int64_t>(0),
-                                                  concat_idx.shape());
-    lower_bound =
-        spu::kernel::hal::dtype_cast(ctx, lower_bound, concat_idx.dtype());
-
-    std::vector<int64_t> upper_bound_pt(start_indices.size());
-    for (size_t idx = 0; idx < upper_bound_pt.size(); ++idx) {
-      upper_bound_pt[idx] = limit_shape[idx] - iterate_shape[idx];
-    }
-    auto upper_bound =
-        spu::kernel::hlo::Constant(ctx, upper_bound_pt, concat_idx.shape());
-    upper_bound =
-        spu::kernel::hal::dtype_cast(ctx, upper_bound, concat_idx.dtype());
-
-    auto c = spu::kernel::hal::clamp(ctx, concat_idx, lower_bound, upper_bound);
-    for (int64_t idx = 0; idx < static_cast<int64_t>(clamped_start.size());
-         ++idx) {
-      clamped_start[idx] = spu::kernel::hal::squeeze(
-          ctx, spu::kernel::hal::slice(ctx, c, {idx}, {idx + 1}, {1}));
+  for (int64_t idx = 0; idx < static_cast<int64_t>(clamped_start.size());
+       ++idx) {
+    clamped_start[idx] = spu::kernel::hal::squeeze(
+        ctx, spu::kernel::hal::slice(ctx, c, {idx}, {idx + 1}, {1}));
+  }
+  return clamped_start;
+}
+
+// For each axis i where the window is narrower than the limit, build the
+// selection matrix S of shape {window_shape[i], limit_shape[i]} with
+//   S[j][k] = (k == start_indices[i] + j)
+// start_indices must be clamped already, so the start only takes
+// limit - window + 1 values. The one-hot over these valid offsets is computed
+// for all axes with a single batched equality, and S is derived from it with
+// local shape ops only.
+//
+// Axes fully covered by the window need no selection and get std::nullopt.
+std::vector<std::optional<spu::Value>> SecretWindowSelectors(
+    spu::SPUContext *ctx, absl::Span<const spu::Value> start_indices,
+    const spu::Shape &window_shape, const spu::Shape &limit_shape) {
+  std::vector<std::optional<spu::Value>> selectors(start_indices.size());
+
+  std::vector<spu::Value> indices;
+  std::vector<spu::Value> offsets;
+  for (size_t axis = 0; axis < start_indices.size(); ++axis) {
+    if (window_shape[axis] == limit_shape[axis]) {
+      continue;
     }
+    const int64_t num_offsets = limit_shape[axis] - window_shape[axis] + 1;
+    indices.push_back(spu::kernel::hal::broadcast_to(
+        ctx, start_indices[axis], {num_offsets}));
+    offsets.push_back(spu::kernel::hal::iota(
+        ctx, start_indices[axis].dtype(), num_offsets));
   }
 
-  // Now flatten start index
-  auto linear_idx =
-      spu::kernel::hlo::Constant(ctx, static_cast<int64_t>(0), {});
-  int64_t stride = 1;
-  for (int64_t idx = iterate_shape.size() - 1; idx >= 0; --idx) {
-    linear_idx = spu::kernel::hal::add(
-        ctx, linear_idx,
-        spu::kernel::hal::mul(ctx, clamped_start[idx],
-                              spu::kernel::hlo::Constant(ctx, stride, {})));
-    stride *= limit_shape[idx];
-  }
-
-  // Now compute offsets of each index
-  spu::Index base(iterate_shape.size(), 0);
-  spu::Index incr(iterate_shape.size(), 1);
-
-  spu::Index flatten_idx;
-  spu::kernel::forEachIndex(
-      limit_shape, base, iterate_shape, incr,
-      [&flatten_idx, &limit_shape](const spu::Index &idx) {
-        flatten_idx.emplace_back(spu::flattenIndex(idx, limit_shape));
-      });
-
-  auto num_index = iterate_shape.numel();
-  std::vector<spu::Value> linear_indices;
-  linear_indices.reserve(num_index);
-  auto added = spu::kernel::hal::add(
-      ctx,
-      spu::kernel::hal::broadcast_to(
-          ctx, spu::kernel::hal::unsqueeze(ctx, linear_idx), {num_index}, {0}),
-      spu::kernel::hlo::Constant(ctx, flatten_idx, {num_index}));
-  for (int64_t idx = 0; idx < num_index; ++idx) {
-    linear_indices.emplace_back(spu::kernel::hal::squeeze(
-        ctx, spu::kernel::hal::slice(ctx, added, {idx}, {idx + 1}, {1})));
-  }
-  return linear_indices;
+  if (indices.empty()) {
+    return selectors;
+  }
+
+  auto onehot = spu::kernel::hal::equal(
+      ctx, spu::kernel::hal::concatenate(ctx, indices, 0),
+      spu::kernel::hal::concatenate(ctx, offsets, 0));
+  auto pad_value = spu::kernel::hal::constant(ctx, false, onehot.dtype());
+
+  int64_t pos = 0;
+  for (size_t axis = 0; axis < start_indices.size(); ++axis) {
+    if (window_shape[axis] == limit_shape[axis]) {
+      continue;
+    }
+    const int64_t window = window_shape[axis];
+    const int64_t limit = limit_shape[axis];
+    const int64_t num_offsets = limit - window + 1;
+
+    // Row j of S is the one-hot shifted right by j. Repeating the one-hot
+    // padded to limit + 1 and reading it with row length limit shifts each
+    // row by one more position.
+    auto row = spu::kernel::hal::slice(ctx, onehot, {pos}, {pos + num_offsets},
+                                       {1});
+    row = spu::kernel::hal::pad(ctx, row, pad_value, {0}, {window}, {0});
+    auto rows =
+        spu::kernel::hal::broadcast_to(ctx, row, {window, limit + 1}, {1});
+    rows = spu::kernel::hal::reshape(ctx, rows, {window * (limit + 1)});
+    rows = spu::kernel::hal::slice(ctx, rows, {0}, {window * limit}, {1});
+    rows = spu::kernel::hal::reshape(ctx, rows, {window, limit});
+    // Let the following matmul use the light 1-bit B2A.
+    spu::kernel::hal::detail::hintNumberOfBits(rows, 1);
+
+    selectors[axis] = rows;
+    pos += num_offsets;
+  }
+
+  return selectors;
+}
+
+// Contract axis of in with the selection matrix, i.e.
+//   ret[..., j, ...] = sum_k selector[j][k] * in[..., k, ...]
+spu::Value SelectAlongAxis(spu::SPUContext *ctx, const spu::Value &selector,
+                           const spu::Value &in, int64_t axis) {
+  // swap the axis to the front, swap is self-inverse.
+  spu::Axes perm(in.shape().size());
+  std::iota(perm.begin(), perm.end(), 0);
+  std::swap(perm[0], perm[axis]);
+
+  auto transposed = spu::kernel::hal::transpose(ctx, in, perm);
+  auto collapsed = spu::kernel::hal::reshape(
+      ctx, transposed,
+      {transposed.shape()[0], transposed.numel() / transposed.shape()[0]});
+
+  auto selected = spu::kernel::hal::matmul(ctx, selector, collapsed);
+
+  spu::Shape selected_shape = transposed.shape();
+  selected_shape[0] = selector.shape()[0];
+  return spu::kernel::hal::transpose(
+      ctx, spu::kernel::hal::reshape(ctx, selected, selected_shape), perm);
 }
 
 }  // namespace
@@ -468,6 +488,7 @@ spu::Value Gather(SPUContext *ctx, const spu::Value &operand,
         Value(result.data(), NdArrayRef(operand.imag()->eltype(), result_shape),
               operand.dtype());
   }
+  result.setFxpBits(operand.fxp_bits());
 
   auto gather_inner_loop_body = [&](const spu::Index &output_window_index,
                                     const spu::Index &input_gather_index,
@@ -536,27 +557,48 @@ spu::Value DynamicUpdateSlice(SPUContext *ctx, const spu::Value &operand,
   SPU_ENFORCE_EQ(start_indices.size(), update.shape().size());
   SPU_ENFORCE(!start_indices.empty());
 
-  if (start_indices[0].isSecret()) {
-    // flatten first
-    spu::Value flattened_operand =
-        hal::reshape(ctx, operand, {operand.numel()});
-
-    spu::Value flattened_update = hal::reshape(ctx, update, {update.numel()});
-
-    auto flattened_indices = ClampAndFlattenIndex(
-        ctx, start_indices, update.shape(), operand.shape());
-
-    spu::Value ret = flattened_operand;
-
-    for (int64_t n = 0; n < static_cast<int64_t>(flattened_indices.size());
-         ++n) {
-      auto update_slice = hal::slice(ctx, flattened_update, {n}, {n + 1}, {1});
-      ret = SecretLinearUpdateIndexing(ctx, ret, update_slice,
-                                       flattened_indices[n]);
+  if (std::any_of(start_indices.begin(), start_indices.end(),
+                  [](const spu::Value &v) { return v.isSecret(); })) {
+    auto clamped_indices =
+        ClampStartIndices(ctx, start_indices, update.shape(), operand.shape());
+    auto selectors = SecretWindowSelectors(ctx, clamped_indices,
+                                           update.shape(), operand.shape());
+
+    // Scatter update into the window with S^T along each axis, and build the
+    // window mask as the outer product of per axis indicators.
+    spu::Value scattered = update;
+    std::optional<spu::Value> mask;
+    for (size_t axis = 0; axis < selectors.size(); ++axis) {
+      if (!selectors[axis].has_value()) {
+        continue;
+      }
+      const auto &selector = *selectors[axis];
+      scattered = SelectAlongAxis(ctx, hal::transpose(ctx, selector),
+                                  scattered, axis);
+
+      // indicator[k] = sum_j S[j][k]
+      auto ones = hal::constant(ctx, static_cast<int64_t>(1), DT_I64,
+                                {1, selector.shape()[0]});
+      auto indicator = hal::broadcast_to(
+          ctx,
+          hal::reshape(ctx, hal::matmul(ctx, ones, selector),
+                       {operand.shape()[axis]}),
+          operand.shape(), {static_cast<int64_t>(axis)});
+      mask = mask.has_value() ? hal::mul(ctx, *mask, indicator) : indicator;
     }
 
-    return hal::reshape(ctx, ret, operand.shape());
+    if (!mask.has_value()) {
+      // update covers the whole operand
+      return hal::dtype_cast(ctx, scattered, operand.dtype());
+    }
 
+    // ret = scattered + (1 - mask) * operand
+    auto ret = hal::add(ctx, scattered,
+                        hal::sub(ctx, operand, hal::mul(ctx, *mask, operand)));
+    if (ret.dtype() != operand.dtype()) {
+      ret = hal::dtype_cast(ctx, ret, operand.dtype());
+    }
+    return ret;
   } else {
     // Start indices
     Index start_indices_i64(start_indices.size());
@@ -588,100 +630,18 @@ spu::Value UpdateSlice(SPUContext *ctx, const spu::Value &in,
 spu::Value SecretDynamicSliceImpl(SPUContext *ctx, const spu::Value &operand,
                                   const Sizes &slice_size,
                                   absl::Span<const spu::Value> start_indices) {
-  if (slice_size[0] == operand.shape()[0]) {
-    if (slice_size.size() == 1) {
-      return operand;
+  // One batched equality for all axes, then one contraction per indexed axis.
+  Shape window_shape(slice_size.begin(), slice_size.end());
+  auto selectors =
+      SecretWindowSelectors(ctx, start_indices, window_shape, operand.shape());
+
+  spu::Value ret = operand;
+  for (size_t axis = 0; axis < selectors.size(); ++axis) {
+    if (selectors[axis].has_value()) {
+      ret = SelectAlongAxis(ctx, *selectors[axis], ret, axis);
     }
-
-    // Full dimension
-    Index start(operand.shape().size(), 0);
-    Index limit(operand.shape().begin(), operand.shape().end());
-    Strides strides(operand.shape().size(), 1);
-
-    std::vector<spu::Value> results(operand.shape()[0]);
-    for (int64_t idx = 0; idx < operand.shape()[0]; ++idx) {
-      start[0] = idx;
-      limit[0] = idx + 1;
-      // Slice one...
-      auto sliced = hal::slice(ctx, operand, start, limit, strides);
-      // Remove leading one
-      auto reshaped = hal::squeeze(ctx, sliced);
-      // Do indexing
-      auto indexed = SecretDynamicSliceImpl(
-          ctx, reshaped, {slice_size.begin() + 1, slice_size.end()},
-          start_indices.subspan(1));
-      // Add leading one dimension back
-      results[idx] = hal::unsqueeze(ctx, indexed);
-    }
-
-    if (results.size() == 1) {
-      return results[0];
-    }
-    return hal::concatenate(ctx, results, 0);
-  }
-
-  // equal(adjusted, iota)
-  spu::Value mask;
-  spu::Value idx_iota =
-      hal::iota(ctx, start_indices[0].dtype(), operand.shape()[0]);
-
-  mask = hal::equal(ctx,
-                    hal::broadcast_to(ctx, start_indices[0], idx_iota.shape()),
-                    idx_iota);
-
-  if (slice_size[0] >= 1) {
-    auto pad_value = hal::seal(ctx, hal::constant(ctx, false, mask.dtype()));
-    mask = hal::pad(ctx, mask, pad_value, {slice_size[0]}, {0}, {0});
-    // FIXME(juhou): we should avoid setting the BShr here
-    // However mask.storage_type().as<BShare>->nbits() is not 1 after the
-    // padding. We implicitly set mask as a 1-bit BShr so that the following
-    // hal::matmul can use a much lighter B2A proc for both ABY3 and CHEETAH.
-    hal::detail::hintNumberOfBits(mask, 1);
-  }
-
-  // foreach
-  std::vector<spu::Value> results(slice_size[0]);
-
-  // Do collapse inner dims when necessary
-  auto collapsed_operand = operand;
-  if (collapsed_operand.shape().size() > 2) {
-    // Reshape from XxYxZ to Xx(Y*Z)
-    collapsed_operand = hal::reshape(
-        ctx, collapsed_operand,
-        {operand.shape()[0],
-         Shape(operand.shape().begin() + 1, operand.shape().end()).numel()});
   }
-
-  Shape indexed_shape = operand.shape();
-  indexed_shape[0] = 1;
-
-  for (int64_t idx = 0; idx < slice_size[0]; ++idx) {
-    auto mask_slice =
-        hal::slice(ctx, mask, {mask.numel() - idx - operand.shape()[0]},
-                   {mask.numel() - idx}, {1});
-    mask_slice = hal::unsqueeze(ctx, mask_slice);
-
-    results[idx] = hal::matmul(ctx, mask_slice, collapsed_operand);
-
-    results[idx] = hal::reshape(ctx, results[idx], indexed_shape);
-  }
-
-  if (slice_size.size() > 1) {
-    // Keep indexing deeper
-    for (int64_t idx = 0; idx < slice_size[0]; ++idx) {
-      results[idx] = hal::squeeze(ctx, results[idx]);
-      results[idx] = SecretDynamicSliceImpl(
-          ctx, results[idx], {slice_size.begin() + 1, slice_size.end()},
-          start_indices.subspan(1));
-      results[idx] = hal::unsqueeze(ctx, results[idx]);
-    }
-  }
-
-  if (results.size() == 1) {
-    return results[0];
-  }
-
-  return hal::concatenate(ctx, results, 0);
+  return ret;
 }
 
 spu::Value SecretDynamicSliceOramImpl(
@@ -908,12 +868,14 @@ spu::Value FilterByMask(SPUContext *, const spu::Value &operand,
     }
   }
 
-  return Value(operand.data().linear_gather(indices), operand.dtype());
+  return Value(operand.data().linear_gather(indices), operand.dtype())
+      .setFxpBits(operand.fxp_bits());
 }
 
 spu::Value LinearGather(SPUContext *, const spu::Value &in,
                         const Index &indices) {
-  return Value(in.data().linear_gather(indices), in.dtype());
+  return Value(in.data().linear_gather(indices), in.dtype())
+      .setFxpBits(in.fxp_bits());
 }
 
 void LinearScatterInPlace(SPUContext *ctx, spu::Value &in,
@@ -921,11 +883,14 @@ void LinearScatterInPlace(SPUContext *ctx, spu::Value &in,
   if (in.data().eltype() != update.data().eltype()) {
     auto common_type =
         hal::_common_type(ctx, in.data().eltype(), update.data().eltype());
-    in = hal::_cast_type(ctx, in, common_type).setDtype(in.dtype());
-    LinearScatterInPlace(
-        ctx, in,
-        hal::_cast_type(ctx, update, common_type).setDtype(update.dtype()),
-        indices);
+    in = hal::_cast_type(ctx, in, common_type)
+             .setDtype(in.dtype())
+             .setFxpBits(in.fxp_bits());
+    LinearScatterInPlace(ctx, in,
+                         hal::_cast_type(ctx, update, common_type)
+                             .setDtype(update.dtype())
+                             .setFxpBits(update.fxp_bits()),
+                         indices);
     return;
   }
   in.data().linear_scatter(update.data(), indices);
@@ -15,11 +15,14 @@
 #include "libspu/kernel/hlo/indexing.h"
 
 #include "gtest/gtest.h"
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xview.hpp"
 
 #include "libspu/core/context.h"
 #include "libspu/core/ndarray_ref.h"
 #include "libspu/core/type.h"
 #include "libspu/core/value.h"
+#include "libspu/kernel/hal/fxp_base.h"
 #include "libspu/kernel/hlo/casting.h"
 #include "libspu/kernel/hlo/const.h"
 #include "libspu/kernel/test_util.h"
@@ -68,6 +71,31 @@ TEST(IndexingTest, Take2) {
   EXPECT_EQ(r.data().at<int64_t>(1), 4);
 }
 
+TEST(IndexingTest, GatherRescaledOperand) {
+  SPUContext ctx = test::makeSPUContext();
+  xt::xarray<float> x = {{0.5, -1.25}, {3.0, 7.75}, {2.5, -4.0}};
+  xt::xarray<int64_t> rows = {{2}, {0}};
+
+  auto operand = hal::f_rescale(&ctx, test::makeValue(&ctx, x, VIS_SECRET), 8);
+  auto indices = test::makeValue(&ctx, rows, VIS_PUBLIC);
+
+  GatherConfig config;
+  config.sliceSizes = {1, 2};
+  config.indexVectorDim = 1;
+  config.offsetDims = {1};
+  config.collapsedSliceDims = {0};
+  config.startIndexMap = {0};
+
+  auto output = Gather(&ctx, operand, indices, config, {2, 2});
+  EXPECT_EQ(ctx.getFxpBits(output), 8U);
+
+  auto p_ret = hal::dump_public_as<float>(&ctx, Reveal(&ctx, output));
+  xt::xarray<float> expected{{2.5, -4.0}, {0.5, -1.25}};
+  EXPECT_TRUE(xt::allclose(p_ret, expected, 0.01, 0.001))
+      << p_ret << std::endl
+      << expected << std::endl;
+}
+
 TEST(IndexingTest, DynamicUpdateSliceScalarWithPublicIndices) {
   SPUContext sctx = test::makeSPUContext();
   auto input = Constant(&sctx, static_cast<int64_t>(1), {5});
@@ -132,6 +160,47 @@ TEST(IndexingTest, DynamicUpdateSliceMultiValuesWithSecretIndices) {
   EXPECT_EQ(p_ret, expected);
 }
 
+TEST(IndexingTest, DynamicUpdateSliceCacheRowWithSecretIndices) {
+  SPUContext sctx = test::makeSPUContext();
+  xt::xarray<float> cache = xt::zeros<float>({4, 2, 3});
+  xt::xarray<float> row = {{{1.5, 2, 3}, {4, 5, 6.5}}};
+  auto input = test::makeValue(&sctx, cache, VIS_SECRET);
+  auto update = test::makeValue(&sctx, row, VIS_SECRET);
+  std::vector<spu::Value> start_indices{
+      Seal(&sctx, Constant(&sctx, static_cast<int64_t>(2), {})),
+      Seal(&sctx, Constant(&sctx, static_cast<int64_t>(0), {})),
+      Seal(&sctx, Constant(&sctx, static_cast<int64_t>(0), {}))};
+
+  auto output = DynamicUpdateSlice(&sctx, input, update, start_indices);
+
+  auto p_ret = hal::dump_public_as<float>(&sctx, Reveal(&sctx, output));
+  xt::xarray<float> expected = cache;
+  xt::view(expected, 2) = xt::view(row, 0);
+  EXPECT_TRUE(xt::allclose(p_ret, expected, 0.01, 0.001))
+      << p_ret << std::endl
+      << expected << std::endl;
+}
+
+TEST(IndexingTest, DynamicUpdateSliceWindowWithSecretIndices) {
+  SPUContext sctx = test::makeSPUContext();
+  auto input = Constant(&sctx, static_cast<int64_t>(1), {4, 5});
+  xt::xarray<int64_t> u = {{7, 8}, {9, 10}};
+  auto update = test::makeValue(&sctx, u, VIS_SECRET);
+  // the second index is out of range, clamped to 3
+  std::vector<spu::Value> start_indices{
+      Seal(&sctx, Constant(&sctx, static_cast<int64_t>(1), {})),
+      Seal(&sctx, Constant(&sctx, static_cast<int64_t>(4), {}))};
+
+  auto output = DynamicUpdateSlice(&sctx, input, update, start_indices);
+
+  auto p_ret = hal::dump_public_as<int64_t>(&sctx, Reveal(&sctx, output));
+  xt::xarray<int64_t> expected = {{1, 1, 1, 1, 1},
+                                  {1, 1, 1, 7, 8},
+                                  {1, 1, 1, 9, 10},
+                                  {1, 1, 1, 1, 1}};
+  EXPECT_EQ(p_ret, expected);
+}
+
 TEST(DynamicSliceTest, DynamicSliceWithPublicIndices) {
   SPUContext sctx = test::makeSPUContext();
   xt::xarray<float> x = {{0.05, 0.24, 0.5}, {2, 5, 50}};
@@ -186,6 +255,27 @@ TEST(DynamicSliceTest, DynamicSliceWithSecretIndicesFull) {
       << expected << std::endl;
 }
 
+TEST(DynamicSliceTest, DynamicSliceWithSecretIndices3D) {
+  SPUContext sctx = test::makeSPUContext();
+  xt::xarray<float> x = xt::arange<float>(24);
+  x.reshape({2, 3, 4});
+  auto input = test::makeValue(&sctx, x, VIS_SECRET);
+
+  auto start_indices = std::vector<spu::Value>{
+      Seal(&sctx, Constant(&sctx, static_cast<int64_t>(1), {})),
+      Seal(&sctx, Constant(&sctx, static_cast<int64_t>(0), {})),
+      Seal(&sctx, Constant(&sctx, static_cast<int64_t>(2), {}))};
+
+  auto output = DynamicSlice(&sctx, input, {1, 3, 2}, start_indices);
+
+  auto p_ret = hal::dump_public_as<float>(&sctx, Reveal(&sctx, output));
+  xt::xarray<float> expected =
+      xt::view(x, xt::range(1, 2), xt::all(), xt::range(2, 4));
+  EXPECT_TRUE(xt::allclose(p_ret, expected, 0.01, 0.001))
+      << p_ret << std::endl
+      << expected << std::endl;
+}
+
 TEST(DynamicSliceTest, DynamicSliceWithPublicIndicesOffRangeLow) {
   SPUContext sctx = test::makeSPUContext();
   xt::xarray<float> x = {{0.05, 0.24, 0.5}, {2, 5, 50}};
@@ -14,6 +14,7 @@
 
 #include "libspu/kernel/hlo/rank.h"
 
+#include "libspu/core/context.h"
 #include "libspu/kernel/hal/permute.h"
 #include "libspu/kernel/hal/polymorphic.h"
 #include "libspu/kernel/hal/shape_ops.h"
@@ -103,6 +104,25 @@ std::vector<spu::Value> TopK(SPUContext *ctx, const spu::Value &input,
 
   hal::TopKConfig config = {value_only, false, k_lo, k_hi};
 
+  // Quick select is data dependent and runs row by row, use the batched
+  // oblivious network when there are many rows, or when the secure shuffle is
+  // not available.
+  const int64_t W = shape.back();
+  const int64_t N = shape.numel() / W;
+  const bool has_shuffle =
+      ctx->hasKernel("rand_perm_m") && ctx->hasKernel("perm_am");
+  if (!input.isPublic() && (N > 1 || !has_shuffle)) {
+    auto rets = hal::topk_2d(ctx, hal::reshape(ctx, input, {N, W}),
+                             scalar_cmp_fn, config);
+
+    Shape new_shape(shape.begin(), shape.end());
+    new_shape.back() = k_hi;
+    for (auto &ret : rets) {
+      ret = hal::reshape(ctx, ret, new_shape);
+    }
+    return rets;
+  }
+
   auto topk_fn = [&](const spu::Value &input) {
     return hal::topk_1d(ctx, input, scalar_cmp_fn, config);
   };
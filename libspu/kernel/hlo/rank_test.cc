@@ -15,6 +15,7 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "xtensor/xio.hpp"
 #include "xtensor/xsort.hpp"
 
 #include "libspu/core/context.h"
@@ -128,6 +129,54 @@ TEST_P(TopkTest, MultiDimArrayTest) {
       });
 }
 
+TEST_P(TopkTest, BatchedRowsTest) {
+  size_t npc = std::get<0>(GetParam());
+  FieldType field = std::get<1>(GetParam());
+  ProtocolKind prot = std::get<2>(GetParam());
+
+  mpc::utils::simulate(
+      npc, [&](const std::shared_ptr<yacl::link::Context> &lctx) {
+        SPUContext sctx = test::makeSPUContext(prot, field, lctx);
+
+        // the row is longer than several chunks, and the last chunk is
+        // shorter than others.
+        xt::xarray<double> a = {
+            {3.2, 0.2, 3.1, 0.3, -0.2, 0, 1, 7.5, -3, 2.5, 4.4},
+            {0.5, -0.2, 0, 1, 0.12, 9, -1, 2, 6, 8, 3},
+            {-1, -2, -3, -4, -5, -6, -7, -8, -9, -10, -11}};
+        int64_t k = 3;
+
+        auto inp = test::makeValue(&sctx, a, VIS_SECRET);
+        auto out = TopK(&sctx, inp, k);
+
+        auto val_pub =
+            hal::dump_public_as<float>(&sctx, hal::reveal(&sctx, out[0]));
+        auto ind_pub =
+            hal::dump_public_as<int64_t>(&sctx, hal::reveal(&sctx, out[1]));
+
+        xt::xarray<float> gt_val = {
+            {7.5F, 4.4F, 3.2F}, {9.0F, 8.0F, 6.0F}, {-1.0F, -2.0F, -3.0F}};
+        xt::xarray<int64_t> gt_ind = {{7, 10, 0}, {5, 9, 8}, {0, 1, 2}};
+
+        ASSERT_THAT(val_pub.shape(), testing::ElementsAre(3, k));
+        ASSERT_THAT(ind_pub.shape(), testing::ElementsAre(3, k));
+
+        // the batched network returns sorted top k.
+        EXPECT_TRUE(xt::allclose(val_pub, gt_val, 0.001, 0.001)) << val_pub;
+        EXPECT_TRUE(xt::all(xt::equal(ind_pub, gt_ind))) << ind_pub;
+
+        // smallest
+        auto s_out = TopK(&sctx, inp, k, -1, false);
+        auto s_val_pub =
+            hal::dump_public_as<float>(&sctx, hal::reveal(&sctx, s_out[0]));
+        xt::xarray<float> gt_s_val = {{-3.0F, -0.2F, 0.0F},
+                                      {-1.0F, -0.2F, 0.0F},
+                                      {-11.0F, -10.0F, -9.0F}};
+        EXPECT_TRUE(xt::allclose(s_val_pub, gt_s_val, 0.001, 0.001))
+            << s_val_pub;
+      });
+}
+
 TEST_P(TopkTest, MultiKTest) {
   size_t npc = std::get<0>(GetParam());
   FieldType field = std::get<1>(GetParam());
@@ -19,6 +19,9 @@
 #include <stack>
 #include <vector>
 
+#include "absl/numeric/bits.h"
+
+#include "libspu/core/context.h"
 #include "libspu/kernel/hal/constants.h"
 #include "libspu/kernel/hal/polymorphic.h"
 #include "libspu/kernel/hal/ring.h"
@@ -105,6 +108,132 @@ std::vector<spu::Value> TreeReduce(SPUContext *ctx,
   return outputs;
 }
 
+std::pair<spu::Value, spu::Value> TreeArgMax(SPUContext *ctx,
+                                             const spu::Value &input,
+                                             int64_t axis) {
+  const int64_t ndim = input.shape().size();
+  SPU_ENFORCE(axis >= 0 && axis < ndim, "invalid axis={}, ndim={}", axis,
+              ndim);
+  const int64_t n = input.shape()[axis];
+  SPU_ENFORCE(n > 0, "can not argmax over an empty axis");
+
+  // move the axis to reduce to inner most.
+  Axes perm(ndim);
+  std::iota(perm.begin(), perm.end(), 0);
+  perm.erase(perm.begin() + axis);
+  perm.push_back(axis);
+  spu::Value value = hal::transpose(ctx, input, perm);
+
+  const Shape batch_shape(value.shape().begin(), value.shape().end() - 1);
+
+  // Pad the axis to power of 2 with copies of the first element in the front.
+  // Since ties are resolved in favor of the later position, a padded copy
+  // never beats the original element, so the padded slots of the one-hot are
+  // always zero and could be dropped at the end.
+  const int64_t padded = absl::bit_ceil(static_cast<uint64_t>(n));
+  const int64_t npad = padded - n;
+  if (npad > 0) {
+    Index end(value.shape().begin(), value.shape().end());
+    end.back() = 1;
+    auto first = hal::slice(ctx, value, Index(ndim, 0), end);
+    Shape pad_shape = batch_shape;
+    pad_shape.push_back(npad);
+    value = hal::concatenate(
+        ctx, {hal::broadcast_to(ctx, first, pad_shape), value}, ndim - 1);
+  }
+
+  // onehot is in tiled layout (batch..., len, width), where each group of
+  // `width` adjacent positions has been reduced to one candidate.
+  Shape onehot_shape = batch_shape;
+  onehot_shape.push_back(padded);
+  onehot_shape.push_back(1);
+  spu::Value onehot = hal::constant(ctx, true, DT_I1, onehot_shape);
+
+  // The multiplexer can consume the boolean comparison result directly when
+  // the protocol has a 1-bit boolean x arithmetic multiplication, otherwise
+  // convert it to arithmetic share once.
+  const bool has_mul_a1b = ctx->hasKernel("mul_a1b");
+
+  int64_t len = padded;
+  int64_t width = 1;
+  while (len > 1) {
+    Index start(ndim, 0);
+    Index end(value.shape().begin(), value.shape().end());
+    Strides strides(ndim, 1);
+    strides.back() = 2;
+    auto lhs = hal::slice(ctx, value, start, end, strides);
+    start.back() = 1;
+    auto rhs = hal::slice(ctx, value, start, end, strides);
+
+    Index i_start(ndim + 1, 0);
+    Index i_end(onehot.shape().begin(), onehot.shape().end());
+    Strides i_strides(ndim + 1, 1);
+    i_strides[ndim - 1] = 2;
+    auto lhs_i = hal::slice(ctx, onehot, i_start, i_end, i_strides);
+    i_start[ndim - 1] = 1;
+    auto rhs_i = hal::slice(ctx, onehot, i_start, i_end, i_strides);
+
+    // c = 1 when lhs wins.
+    auto c = hal::less(ctx, rhs, lhs);
+    if (!has_mul_a1b) {
+      c = hal::_prefer_a(ctx, c);
+    }
+
+    len /= 2;
+    Shape tiled_shape = batch_shape;
+    tiled_shape.push_back(len);
+    tiled_shape.push_back(1);
+
+    // Pack (lhs - rhs, lhs_i, rhs_i) into one tensor, so that both the value
+    // and the one-hot are selected by a single multiplication, i.e.
+    //   max    = rhs + c * (lhs - rhs)
+    //   onehot = concat(c * lhs_i, rhs_i - c * rhs_i)
+    auto diff = hal::reshape(ctx, hal::_sub(ctx, lhs, rhs), tiled_shape)
+                    .setDtype(onehot.dtype());
+    auto packed = hal::concatenate(ctx, {diff, lhs_i, rhs_i}, ndim);
+
+    auto c_i = hal::reshape(ctx, c, tiled_shape);
+    c_i = hal::broadcast_to(ctx, c_i, packed.shape());
+    auto prod = hal::_mul(ctx, c_i, packed);
+
+    Index p_start(ndim + 1, 0);
+    Index p_end(prod.shape().begin(), prod.shape().end());
+    p_end.back() = 1;
+    auto sel_diff = hal::reshape(ctx, hal::slice(ctx, prod, p_start, p_end),
+                                 rhs.shape());
+    value = hal::_add(ctx, rhs, sel_diff)
+                .setDtype(rhs.dtype())
+                .setFxpBits(rhs.fxp_bits());
+
+    p_start.back() = 1;
+    p_end.back() = 1 + width;
+    auto sel_lhs_i = hal::slice(ctx, prod, p_start, p_end);
+    p_start.back() = 1 + width;
+    p_end.back() = 1 + 2 * width;
+    auto sel_rhs_i =
+        hal::_sub(ctx, rhs_i, hal::slice(ctx, prod, p_start, p_end));
+    onehot = hal::concatenate(ctx,
+                              {sel_lhs_i.setDtype(onehot.dtype()),
+                               sel_rhs_i.setDtype(onehot.dtype())},
+                              ndim);
+    width *= 2;
+  }
+
+  value = hal::reshape(ctx, value, batch_shape);
+
+  Shape ret_onehot_shape = batch_shape;
+  ret_onehot_shape.push_back(padded);
+  onehot = hal::reshape(ctx, onehot, ret_onehot_shape);
+  if (npad > 0) {
+    Index start(ndim, 0);
+    start.back() = npad;
+    onehot = hal::slice(ctx, onehot, start, Index(ret_onehot_shape.begin(),
+                                                  ret_onehot_shape.end()));
+  }
+
+  return {value, onehot};
+}
+
 std::vector<spu::Value> ReduceWindowWithoutDilation(
     SPUContext *ctx, absl::Span<const spu::Value> inputs,
     absl::Span<const spu::Value> init_values, const Shape &window_shape,
@@ -494,35 +623,48 @@ std::pair<spu::Value, spu::Value> ArgMax(SPUContext *ctx,
                                                  config.window_strides);
   }
 
-  // Create eye
-  size_t window_size =
-      std::accumulate(config.window_shape.begin(), config.window_shape.end(), 1,
-                      std::multiplies<size_t>());
-  xt::xarray<bool> e = xt::eye<bool>({window_size, window_size}, 0);
-
-  auto mask = hal::constant(ctx, e, DT_I1);
-
-  auto result = ReduceWindowImpl(
-      ctx, {input, mask}, {spu::Value(), spu::Value()}, ret_shape, config, true,
-      true,
-      [&](absl::Span<spu::Value const> lhs,
-          absl::Span<spu::Value const> rhs) -> std::vector<spu::Value> {
-        SPU_ENFORCE(lhs.size() == 2);
-        auto c = hal::less(ctx, rhs[0], lhs[0]);
-        c = hal::_prefer_a(ctx, c);
-        // Select value
-        auto v = hal::select(ctx, c, lhs[0], rhs[0]);
-        // Select index
-        auto c_i_shape = c.shape();
-        c_i_shape.emplace_back(1);
-        auto c_i = hal::reshape(ctx, c, c_i_shape);
-        c_i_shape.back() = window_size;
-        c_i = hal::broadcast_to(ctx, c_i, c_i_shape);
-        auto i = hal::select(ctx, c_i, lhs[1], rhs[1]);
-
-        return {v, i};
-      });
-  return {result[0], result[1]};
+  SPU_ENFORCE(no_padding, "argmax with padding is not supported");
+  SPU_ENFORCE(std::all_of(config.base_dilations.begin(),
+                          config.base_dilations.end(),
+                          [](const int64_t x) { return x == 1; }),
+              "argmax with base dilation is not supported");
+
+  const int64_t ndims = input.shape().size();
+  const Shape &W = config.window_shape;
+  const Strides &S = config.window_strides;
+  const Sizes &D = config.window_dilations;
+
+  // Sample all windows into tiled layout (N..., W...), then run the tournament
+  // over the flattened window, no eye mask is needed.
+  const int64_t window_size = W.numel();
+  Shape tiled_1d_shape(ret_shape.begin(), ret_shape.end());
+  tiled_1d_shape.push_back(window_size);
+
+  spu::Value expanded;
+  if (std::all_of(D.begin(), D.end(), [](int64_t d) { return d == 1; })) {
+    expanded = expandWindow(ctx, input, W, S);
+  } else {
+    // With window dilation, the elements at the same offset of all windows
+    // form a strided slice of the input, so it takes W.numel() slices.
+    std::vector<spu::Value> offsets;
+    Index offset(ndims, 0);
+    do {
+      Index start(ndims);
+      Index end(ndims);
+      for (int64_t dim = 0; dim < ndims; dim++) {
+        start[dim] = offset[dim] * D[dim];
+        end[dim] = start[dim] + (ret_shape[dim] - 1) * S[dim] + 1;
+      }
+      Shape unsqueezed(ret_shape.begin(), ret_shape.end());
+      unsqueezed.push_back(1);
+      offsets.emplace_back(hal::reshape(
+          ctx, hal::slice(ctx, input, start, end, S), unsqueezed));
+    } while (bumpIndices(W, absl::MakeSpan(offset)));
+    expanded = hal::concatenate(ctx, offsets, ndims);
+  }
+  expanded = hal::reshape(ctx, expanded, tiled_1d_shape);
+
+  return TreeArgMax(ctx, expanded, ndims);
 }
 
 }  // namespace spu::kernel::hlo
@@ -64,4 +64,16 @@ std::vector<spu::Value> TreeReduce(SPUContext *ctx,
                                    int64_t axis,
                                    const BatchedValueBinaryFn &reducer);
 
+// Reduce `input` along `axis` with max, and track the position of the maximum.
+//
+// Each level of the tournament issues exactly one comparison and one
+// multiplexer call, the value and the one-hot index are selected together.
+// Ties are resolved in favor of the later position.
+//
+// @returns a pair of (max, onehot), where max has `axis` removed, and onehot
+//          has `axis` moved to the inner most dimension.
+std::pair<spu::Value, spu::Value> TreeArgMax(SPUContext *ctx,
+                                             const spu::Value &input,
+                                             int64_t axis);
+
 }  // namespace spu::kernel::hlo
@@ -0,0 +1,164 @@
+// Copyright 2024 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libspu/kernel/hlo/reduce.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xtensor/xio.hpp"
+
+#include "libspu/core/context.h"
+#include "libspu/core/value.h"
+#include "libspu/kernel/hal/type_cast.h"
+#include "libspu/kernel/test_util.h"
+#include "libspu/mpc/utils/simulate.h"
+
+namespace spu::kernel::hlo {
+
+class ArgMaxTest : public ::testing::TestWithParam<
+                       std::tuple<size_t, FieldType, ProtocolKind>> {};
+
+TEST_P(ArgMaxTest, TreeArgMax) {
+  size_t npc = std::get<0>(GetParam());
+  FieldType field = std::get<1>(GetParam());
+  ProtocolKind prot = std::get<2>(GetParam());
+
+  mpc::utils::simulate(
+      npc, [&](const std::shared_ptr<yacl::link::Context> &lctx) {
+        SPUContext sctx = test::makeSPUContext(prot, field, lctx);
+
+        // non power of 2 axis, with ties.
+        xt::xarray<double> a = {{3.2, 0.2, 3.1, 0.2, -0.2},
+                               {0.2, -0.2, 1, 1, 0.12},
+                               {-1, -2, -3, -4, -5}};
+
+        for (auto vis : {VIS_PUBLIC, VIS_SECRET}) {
+          auto inp = test::makeValue(&sctx, a, vis);
+          auto [max, onehot] = TreeArgMax(&sctx, inp, 1);
+
+          auto max_pub =
+              hal::dump_public_as<float>(&sctx, hal::reveal(&sctx, max));
+          auto onehot_pub =
+              hal::dump_public_as<int64_t>(&sctx, hal::reveal(&sctx, onehot));
+
+          xt::xarray<float> gt_max = {3.2F, 1.0F, -1.0F};
+          xt::xarray<int64_t> gt_onehot = {
+              {1, 0, 0, 0, 0}, {0, 0, 0, 1, 0}, {1, 0, 0, 0, 0}};
+
+          ASSERT_THAT(onehot_pub.shape(), testing::ElementsAre(3, 5));
+          EXPECT_TRUE(xt::allclose(max_pub, gt_max, 0.001, 0.001))
+              << max_pub;
+          EXPECT_TRUE(xt::all(xt::equal(onehot_pub, gt_onehot)))
+              << onehot_pub;
+        }
+
+        // reduce the outer axis.
+        {
+          auto inp = test::makeValue(&sctx, a, VIS_SECRET);
+          auto [max, onehot] = TreeArgMax(&sctx, inp, 0);
+
+          auto max_pub =
+              hal::dump_public_as<float>(&sctx, hal::reveal(&sctx, max));
+          auto onehot_pub =
+              hal::dump_public_as<int64_t>(&sctx, hal::reveal(&sctx, onehot));
+
+          xt::xarray<float> gt_max = {3.2F, 0.2F, 3.1F, 1.0F, 0.12F};
+          xt::xarray<int64_t> gt_onehot = {
+              {1, 0, 0}, {1, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 1, 0}};
+
+          EXPECT_TRUE(xt::allclose(max_pub, gt_max, 0.001, 0.001))
+              << max_pub;
+          EXPECT_TRUE(xt::all(xt::equal(onehot_pub, gt_onehot)))
+              << onehot_pub;
+        }
+      });
+}
+
+TEST_P(ArgMaxTest, ReduceWindow) {
+  size_t npc = std::get<0>(GetParam());
+  FieldType field = std::get<1>(GetParam());
+  ProtocolKind prot = std::get<2>(GetParam());
+
+  mpc::utils::simulate(
+      npc, [&](const std::shared_ptr<yacl::link::Context> &lctx) {
+        SPUContext sctx = test::makeSPUContext(prot, field, lctx);
+
+        xt::xarray<float> a = {{1, 2, 3, 4}, {8, 7, 6, 5}, {9, 12, 11, 10}};
+
+        std::vector<std::pair<int64_t, int64_t>> padding(2, {0, 0});
+        ReduceWindowConfig config;
+        config.window_shape = {2, 3};
+        config.window_strides = {1, 1};
+        config.window_dilations = {1, 1};
+        config.window_padding = padding;
+        config.base_dilations = {1, 1};
+
+        auto inp = test::makeValue(&sctx, a, VIS_SECRET);
+        auto [max, onehot] = ArgMax(&sctx, inp, {2, 2}, config);
+
+        auto max_pub =
+            hal::dump_public_as<float>(&sctx, hal::reveal(&sctx, max));
+        auto onehot_pub =
+            hal::dump_public_as<int64_t>(&sctx, hal::reveal(&sctx, onehot));
+
+        xt::xarray<float> gt_max = {{8, 7}, {12, 12}};
+        xt::xarray<int64_t> gt_onehot = {
+            {{0, 0, 0, 1, 0, 0}, {0, 0, 0, 1, 0, 0}},
+            {{0, 0, 0, 0, 1, 0}, {0, 0, 0, 1, 0, 0}}};
+
+        EXPECT_TRUE(xt::allclose(max_pub, gt_max, 0.001, 0.001)) << max_pub;
+        EXPECT_TRUE(xt::all(xt::equal(onehot_pub, gt_onehot)))
+            << onehot_pub;
+
+        // with window dilation
+        config.window_shape = {2, 2};
+        config.window_dilations = {2, 2};
+        auto [d_max, d_onehot] = ArgMax(&sctx, inp, {1, 2}, config);
+
+        auto d_max_pub =
+            hal::dump_public_as<float>(&sctx, hal::reveal(&sctx, d_max));
+        auto d_onehot_pub =
+            hal::dump_public_as<int64_t>(&sctx, hal::reveal(&sctx, d_onehot));
+
+        xt::xarray<float> gt_d_max = {{11, 12}};
+        xt::xarray<int64_t> gt_d_onehot = {{{0, 0, 0, 1}, {0, 0, 1, 0}}};
+
+        EXPECT_TRUE(xt::allclose(d_max_pub, gt_d_max, 0.001, 0.001))
+            << d_max_pub;
+        EXPECT_TRUE(xt::all(xt::equal(d_onehot_pub, gt_d_onehot)))
+            << d_onehot_pub;
+      });
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    ArgMax2PCTestInstances, ArgMaxTest,
+    testing::Combine(testing::Values(2),
+                     testing::Values(FieldType::FM64, FieldType::FM128),
+                     testing::Values(ProtocolKind::SEMI2K,
+                                     ProtocolKind::CHEETAH)),
+    [](const testing::TestParamInfo<ArgMaxTest::ParamType> &p) {
+      return fmt::format("{}x{}x{}", std::get<0>(p.param), std::get<1>(p.param),
+                         std::get<2>(p.param));
+    });
+
+INSTANTIATE_TEST_SUITE_P(
+    ArgMax3PCTestInstances, ArgMaxTest,
+    testing::Combine(testing::Values(3), testing::Values(FieldType::FM64),
+                     testing::Values(ProtocolKind::SEMI2K, ProtocolKind::ABY3)),
+    [](const testing::TestParamInfo<ArgMaxTest::ParamType> &p) {
+      return fmt::format("{}x{}x{}", std::get<0>(p.param), std::get<1>(p.param),
+                         std::get<2>(p.param));
+    });
+
+}  // namespace spu::kernel::hlo
@@ -0,0 +1,41 @@
+// Copyright 2024 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libspu/kernel/hlo/segment.h"
+
+#include "libspu/kernel/hal/shape_ops.h"
+
+namespace spu::kernel::hlo {
+
+std::vector<spu::Value> SegmentAggregate(SPUContext *ctx,
+                                         const spu::Value &keys,
+                                         absl::Span<const spu::Value> values,
+                                         hal::SegmentReduceOp op,
+                                         int64_t valid_bits) {
+  const Shape flat_shape = {keys.numel()};
+
+  std::vector<spu::Value> flat_values;
+  flat_values.reserve(values.size());
+  for (const auto &v : values) {
+    SPU_ENFORCE(v.shape() == keys.shape(),
+                "value shape {} mismatch with key shape {}", v.shape(),
+                keys.shape());
+    flat_values.push_back(hal::reshape(ctx, v, flat_shape));
+  }
+
+  return hal::segment_aggregate(ctx, hal::reshape(ctx, keys, flat_shape),
+                                flat_values, op, valid_bits);
+}
+
+}  // namespace spu::kernel::hlo
@@ -0,0 +1,35 @@
+// Copyright 2024 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "libspu/kernel/hal/segment.h"
+
+namespace spu::kernel::hlo {
+
+// Group-by aggregation, i.e. SQL style
+//   SELECT key, AGG(value) FROM table GROUP BY key
+// All operands are flattened before grouping.
+//
+// Returns [sorted_keys, is_last, aggregated...] as 1-D values, the aggregated
+// results of a group are placed at the last element of the group, where
+// is_last is 1, other positions hold partial results and should be dropped
+// (e.g. after revealing is_last, or with an oblivious compaction).
+std::vector<spu::Value> SegmentAggregate(SPUContext *ctx,
+                                         const spu::Value &keys,
+                                         absl::Span<const spu::Value> values,
+                                         hal::SegmentReduceOp op,
+                                         int64_t valid_bits = -1);
+
+}  // namespace spu::kernel::hlo
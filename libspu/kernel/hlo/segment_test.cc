@@ -0,0 +1,99 @@
+// Copyright 2024 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libspu/kernel/hlo/segment.h"
+
+#include "gtest/gtest.h"
+#include "xtensor/xio.hpp"
+
+#include "libspu/core/context.h"
+#include "libspu/kernel/hal/type_cast.h"
+#include "libspu/kernel/test_util.h"
+#include "libspu/mpc/utils/simulate.h"
+
+namespace spu::kernel::hlo {
+
+class SegmentTest : public ::testing::TestWithParam<
+                        std::tuple<size_t, FieldType, ProtocolKind>> {};
+
+TEST_P(SegmentTest, Aggregate) {
+  size_t npc = std::get<0>(GetParam());
+  FieldType field = std::get<1>(GetParam());
+  ProtocolKind prot = std::get<2>(GetParam());
+
+  mpc::utils::simulate(
+      npc, [&](const std::shared_ptr<yacl::link::Context> &lctx) {
+        SPUContext sctx = test::makeSPUContext(prot, field, lctx);
+
+        xt::xarray<int64_t> keys = {3, 1, 2, 3, 1, 3, 7};
+        xt::xarray<float> values = {1.5, -2, 4, 0.5, 3, -1, 6};
+
+        auto k = test::makeValue(&sctx, keys, VIS_SECRET);
+        auto v = test::makeValue(&sctx, values, VIS_SECRET);
+
+        // sorted keys: 1 1 2 3 3 3 7
+        xt::xarray<int64_t> gt_keys = {1, 1, 2, 3, 3, 3, 7};
+        xt::xarray<int64_t> gt_last = {0, 1, 1, 0, 0, 1, 1};
+
+        auto check = [&](hal::SegmentReduceOp op,
+                         const xt::xarray<float> &expected) {
+          auto rets = SegmentAggregate(&sctx, k, {v}, op);
+          ASSERT_EQ(rets.size(), 3);
+
+          auto keys_hat = hal::dump_public_as<int64_t>(
+              &sctx, hal::reveal(&sctx, rets[0]));
+          auto last_hat = hal::dump_public_as<int64_t>(
+              &sctx, hal::reveal(&sctx, rets[1]));
+          auto agg_hat =
+              hal::dump_public_as<float>(&sctx, hal::reveal(&sctx, rets[2]));
+
+          EXPECT_TRUE(xt::all(xt::equal(keys_hat, gt_keys))) << keys_hat;
+          EXPECT_TRUE(xt::all(xt::equal(last_hat, gt_last))) << last_hat;
+
+          // only check the aggregated results.
+          for (size_t i = 0; i < gt_last.size(); ++i) {
+            if (gt_last(i) == 1) {
+              EXPECT_NEAR(agg_hat(i), expected(i), 0.01) << agg_hat;
+            }
+          }
+        };
+
+        check(hal::SegmentReduceOp::Sum, {0, 1, 4, 0, 0, 1, 6});
+        check(hal::SegmentReduceOp::Count, {0, 2, 1, 0, 0, 3, 1});
+        check(hal::SegmentReduceOp::Max, {0, 3, 4, 0, 0, 1.5, 6});
+        check(hal::SegmentReduceOp::Min, {0, -2, 4, 0, 0, -1, 6});
+      });
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Segment2PCTestInstances, SegmentTest,
+    testing::Combine(testing::Values(2),
+                     testing::Values(FieldType::FM64, FieldType::FM128),
+                     testing::Values(ProtocolKind::SEMI2K,
+                                     ProtocolKind::CHEETAH)),
+    [](const testing::TestParamInfo<SegmentTest::ParamType> &p) {
+      return fmt::format("{}x{}x{}", std::get<0>(p.param), std::get<1>(p.param),
+                         std::get<2>(p.param));
+    });
+
+INSTANTIATE_TEST_SUITE_P(
+    Segment3PCTestInstances, SegmentTest,
+    testing::Combine(testing::Values(3), testing::Values(FieldType::FM64),
+                     testing::Values(ProtocolKind::SEMI2K, ProtocolKind::ABY3)),
+    [](const testing::TestParamInfo<SegmentTest::ParamType> &p) {
+      return fmt::format("{}x{}x{}", std::get<0>(p.param), std::get<1>(p.param),
+                         std::get<2>(p.param));
+    });
+
+}  // namespace spu::kernel::hlo
@@ -51,7 +51,8 @@ std::vector<spu::Value> Shuffle(SPUContext* ctx,
       auto rand_perm = hal::_rand_perm_s(ctx, input_shape);
       for (size_t i = 0; i < input.size(); ++i) {
         rets.emplace_back(hal::_perm_ss(ctx, _2s(ctx, input[i]), rand_perm)
-                              .setDtype(input[i].dtype()));
+                              .setDtype(input[i].dtype())
+                              .setFxpBits(input[i].fxp_bits()));
       }
       return rets;
     };
@@ -23,6 +23,14 @@ std::vector<spu::Value> Sort(SPUContext *ctx,
                              int64_t sort_dim, bool is_stable,
                              const hal::CompFn &comparator_body,
                              Visibility comparator_ret_vis) {
+  if (comparator_ret_vis == VIS_SECRET) {
+    SPU_ENFORCE(!is_stable,
+                "Stable sort is unsupported if comparator return is secret.");
+
+    // sort all vectors together, instead of one by one.
+    return hal::batched_sort(ctx, inputs, sort_dim, comparator_body);
+  }
+
   auto sort_fn = [&](absl::Span<const spu::Value> input) {
     return hal::sort1d(ctx, input, comparator_body, comparator_ret_vis,
                        is_stable);
@@ -22,6 +22,7 @@
 #include "gtest/gtest.h"
 #include "xtensor/xio.hpp"
 
+#include "libspu/kernel/hal/fxp_base.h"
 #include "libspu/kernel/hal/polymorphic.h"
 #include "libspu/kernel/hal/type_cast.h"
 #include "libspu/kernel/hlo/casting.h"
@@ -78,6 +79,35 @@ TEST(SortTest, SimpleWithNoPadding) {
       << sorted_x_hat << std::endl;
 }
 
+TEST(SortTest, BatchedInnerDim) {
+  SPUContext ctx = test::makeSPUContext();
+  // sort along a non-last dimension, with many vectors to sort.
+  xt::xarray<float> x = {{{3, 1, 4}, {1, 5, 9}},
+                         {{2, 6, 5}, {3, 5, 8}},
+                         {{9, 7, 9}, {3, 2, 3}},
+                         {{8, 4, 6}, {2, 6, 4}},
+                         {{3, 3, 8}, {3, 2, 7}}};
+  xt::xarray<float> sorted_x = xt::sort(x, 0);
+
+  Value x_v = test::makeValue(&ctx, x, VIS_SECRET);
+
+  std::vector<spu::Value> rets = Sort(
+      &ctx, {x_v}, 0, false,
+      [&](absl::Span<const spu::Value> inputs) {
+        return hal::less(&ctx, inputs[0], inputs[1]);
+      },
+      Visibility::VIS_SECRET);
+
+  EXPECT_EQ(rets.size(), 1);
+
+  auto sorted_x_hat =
+      hal::dump_public_as<float>(&ctx, hal::reveal(&ctx, rets[0]));
+
+  EXPECT_TRUE(xt::allclose(sorted_x, sorted_x_hat, 0.01, 0.001))
+      << sorted_x << std::endl
+      << sorted_x_hat << std::endl;
+}
+
 TEST(SortTest, MultiInputs) {
   SPUContext ctx = test::makeSPUContext();
   xt::xarray<float> x1 = {{0.5, 0.05, 0.5, 0.24, 0.5, 0.5, 0.5}};
@@ -151,6 +181,31 @@ TEST(SortTest, MultiOperands) {
       << sorted_k2_hat << std::endl;
 }
 
+TEST(SortTest, RescaledOperand) {
+  SPUContext ctx = test::makeSPUContext();
+  xt::xarray<float> x = {{0.5, -1.25, 3.0}, {7.75, 2.5, -4.0}};
+  xt::xarray<float> sorted_x = {{-1.25, 0.5, 3.0}, {-4.0, 2.5, 7.75}};
+
+  Value x_v = hal::f_rescale(&ctx, test::makeValue(&ctx, x, VIS_SECRET), 8);
+
+  std::vector<spu::Value> rets = Sort(
+      &ctx, {x_v}, 1, false,
+      [&](absl::Span<const spu::Value> inputs) {
+        return hal::less(&ctx, inputs[0], inputs[1]);
+      },
+      Visibility::VIS_SECRET);
+
+  EXPECT_EQ(rets.size(), 1);
+  EXPECT_EQ(ctx.getFxpBits(rets[0]), 8U);
+
+  auto sorted_x_hat =
+      hal::dump_public_as<float>(&ctx, hal::reveal(&ctx, rets[0]));
+
+  EXPECT_TRUE(xt::allclose(sorted_x, sorted_x_hat, 0.01, 0.001))
+      << sorted_x << std::endl
+      << sorted_x_hat << std::endl;
+}
+
 TEST(SortTest, EmptyOperands) {
   SPUContext ctx = test::makeSPUContext();
   auto empty_x = Seal(&ctx, Constant(&ctx, 1, {0}));
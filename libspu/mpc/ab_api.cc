@@ -133,6 +133,12 @@ OptionalAPI<Value> mul_a1bv(SPUContext* ctx, const Value& x, const Value& y) {
   return NotAvailable;
 }
 
+OptionalAPI<Value> mux_a1b(SPUContext* ctx, const Value& pred, const Value& x,
+                           const Value& y) {
+  TRY_DISPATCH(ctx, pred, x, y);
+  return NotAvailable;
+}
+
 Value lshift_a(SPUContext* ctx, const Value& x, size_t nbits) {
   FORCE_DISPATCH(ctx, x, nbits);
 }
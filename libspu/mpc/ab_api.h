@@ -45,6 +45,9 @@ OptionalAPI<Value> mul_av(SPUContext* ctx, const Value& x, const Value& y);
 
 Value mul_a1b(SPUContext* ctx, const Value& x, const Value& y);
 OptionalAPI<Value> mul_a1bv(SPUContext* ctx, const Value& x, const Value& y);
+// pred ? x : y for a 1-bit boolean pred and arithmetic x and y.
+OptionalAPI<Value> mux_a1b(SPUContext* ctx, const Value& pred, const Value& x,
+                           const Value& y);
 
 Value lshift_a(SPUContext* ctx, const Value& x, size_t nbits);
 Value trunc_a(SPUContext* ctx, const Value& x, size_t nbits, SignType sign);
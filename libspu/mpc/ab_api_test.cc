@@ -226,6 +226,45 @@ TEST_P(ArithmeticTest, MulA1B) {
   });
 }
 
+TEST_P(ArithmeticTest, MuxA1B) {
+  const auto factory = std::get<0>(GetParam());
+  const RuntimeConfig& conf = std::get<1>(GetParam());
+  const size_t npc = std::get<2>(GetParam());
+
+  utils::simulate(npc, [&](const std::shared_ptr<yacl::link::Context>& lctx) {
+    auto obj = factory(conf, lctx);
+
+    if (!obj->prot()->hasKernel("mux_a1b")) {
+      return;
+    }
+
+    const size_t K = spu::SizeOf(conf.field()) * 8;
+
+    /* GIVEN */
+    auto p0 = rand_p(obj.get(), kShape);
+    auto p1 = rand_p(obj.get(), kShape);
+    auto pred = rshift_p(obj.get(), rand_p(obj.get(), kShape), K - 1);
+    auto a0 = p2a(obj.get(), p0);
+    auto a1 = p2a(obj.get(), p1);
+    auto b = p2b(obj.get(), pred);
+    // hint runtime this is a 1bit value.
+    b = lshift_b(obj.get(), b, K - 1);
+    b = rshift_b(obj.get(), b, K - 1);
+
+    /* WHEN */
+    auto tmp = mux_a1b(obj.get(), b, a0, a1);
+    ASSERT_TRUE(tmp.has_value());
+    auto r_aa = a2p(obj.get(), tmp.value());
+
+    /* THEN */
+    // p1 + pred * (p0 - p1)
+    auto expected = ring_add(
+        p1.data(), ring_mul(pred.data(), ring_sub(p0.data(), p1.data())));
+    EXPECT_EQ(r_aa.shape(), kShape);
+    EXPECT_TRUE(ring_all_equal(r_aa.data(), expected));
+  });
+}
+
 TEST_P(ArithmeticTest, MulAV) {
   const auto factory = std::get<0>(GetParam());
   const RuntimeConfig& conf = std::get<1>(GetParam());
@@ -71,7 +71,7 @@ std::vector<NdArrayRef> a1b_offline(size_t sender, const NdArrayRef& a,
             NdArrayView<ashr_el_t> _c2(c2);
 
             // (i \xor b1 \xor b2) * a - c1 - c2
-            pforeach(0, numel, [&](int64_t idx) {
+            SPU_PFOREACH(0, numel, 1, [&](int64_t idx) {
               _m0[idx] = (_m0[idx] ^ (_b[idx][0] & 0x1) ^ (_b[idx][1] & 0x1)) *
                              _a[idx] -
                          _c1[idx] - _c2[idx];
@@ -111,7 +111,7 @@ std::vector<uint8_t> ring_cast_boolean(const NdArrayRef& x) {
 
   DISPATCH_UINT_PT_TYPES(x.eltype().as<PtTy>()->pt_type(), "_", [&]() {
     NdArrayView<ScalarT> _x(x);
-    pforeach(0, numel, [&](int64_t idx) {
+    SPU_PFOREACH(0, numel, 1, [&](int64_t idx) {
       res[idx] = static_cast<uint8_t>(_x[idx] & 0x1);
     });
   });
@@ -137,7 +137,7 @@ NdArrayRef RandA::proc(KernelEvalContext* ctx, const Shape& shape) const {
 
     NdArrayView<std::array<el_t, 2>> _out(out);
 
-    pforeach(0, out.numel(), [&](int64_t idx) {
+    SPU_PFOREACH(0, out.numel(), 1, [&](int64_t idx) {
       // Comparison only works for [-2^(k-2), 2^(k-2)).
       // TODO: Move this constraint to upper layer, saturate it here.
       _out[idx][0] = r0[idx] >> 2;
@@ -164,11 +164,11 @@ NdArrayRef A2P::proc(KernelEvalContext* ctx, const NdArrayRef& in) const {
 
     std::vector<ashr_el_t> x2(numel);
 
-    pforeach(0, numel, [&](int64_t idx) { x2[idx] = _in[idx][1]; });
+    SPU_PFOREACH(0, numel, 1, [&](int64_t idx) { x2[idx] = _in[idx][1]; });
 
     auto x3 = comm->rotate<ashr_el_t>(x2, "a2p");  // comm => 1, k
 
-    pforeach(0, numel, [&](int64_t idx) {
+    SPU_PFOREACH(0, numel, 1, [&](int64_t idx) {
       _out[idx] = _in[idx][0] + _in[idx][1] + x3[idx];
     });
 
@@ -193,7 +193,7 @@ NdArrayRef P2A::proc(KernelEvalContext* ctx, const NdArrayRef& in) const {
     NdArrayView<ashr_t> _out(out);
     NdArrayView<pshr_el_t> _in(in);
 
-    pforeach(0, in.numel(), [&](int64_t idx) {
+    SPU_PFOREACH(0, in.numel(), 1, [&](int64_t idx) {
       _out[idx][0] = rank == 0 ? _in[idx] : 0;
       _out[idx][1] = rank == 2 ? _in[idx] : 0;
     });
@@ -240,7 +240,7 @@ NdArrayRef A2V::proc(KernelEvalContext* ctx, const NdArrayRef& in,
       NdArrayRef out(out_ty, in.shape());
       NdArrayView<vshr_el_t> _out(out);
 
-      pforeach(0, in.numel(), [&](int64_t idx) {
+      SPU_PFOREACH(0, in.numel(), 1, [&](int64_t idx) {
         _out[idx] = _in[idx][0] + _in[idx][1] + x3[idx];
       });
       return out;
@@ -248,7 +248,8 @@ NdArrayRef A2V::proc(KernelEvalContext* ctx, const NdArrayRef& in,
     } else if (comm->getRank() == (rank + 1) % 3) {
       std::vector<ashr_el_t> x2(in.numel());
 
-      pforeach(0, in.numel(), [&](int64_t idx) { x2[idx] = _in[idx][1]; });
+      SPU_PFOREACH(0, in.numel(), 1,
+                   [&](int64_t idx) { x2[idx] = _in[idx][1]; });
 
       comm->sendAsync<ashr_el_t>(comm->prevRank(), x2,
                                  "a2v");  // comm => 1, k
@@ -282,19 +283,19 @@ NdArrayRef V2A::proc(KernelEvalContext* ctx, const NdArrayRef& in) const {
       NdArrayView<ashr_el_t> _s0(splits[0]);
       NdArrayView<ashr_el_t> _s1(splits[1]);
 
-      pforeach(0, in.numel(), [&](int64_t idx) {
+      SPU_PFOREACH(0, in.numel(), 1, [&](int64_t idx) {
         _out[idx][0] = _s0[idx];
         _out[idx][1] = _s1[idx];
       });
     } else if (comm->getRank() == (owner_rank + 1) % 3) {
       auto x0 = comm->recv<ashr_el_t>(comm->prevRank(), "v2a");  // comm => 1, k
-      pforeach(0, in.numel(), [&](int64_t idx) {
+      SPU_PFOREACH(0, in.numel(), 1, [&](int64_t idx) {
         _out[idx][0] = x0[idx];
         _out[idx][1] = 0;
       });
     } else {
       auto x1 = comm->recv<ashr_el_t>(comm->nextRank(), "v2a");  // comm => 1, k
-      pforeach(0, in.numel(), [&](int64_t idx) {
+      SPU_PFOREACH(0, in.numel(), 1, [&](int64_t idx) {
         _out[idx][0] = 0;
         _out[idx][1] = x1[idx];
       });
@@ -321,7 +322,7 @@ NdArrayRef NotA::proc(KernelEvalContext* ctx, const NdArrayRef& in) const {
 
     // neg(x) = not(x) + 1
     // not(x) = neg(x) - 1
-    pforeach(0, in.numel(), [&](int64_t idx) {
+    SPU_PFOREACH(0, in.numel(), 1, [&](int64_t idx) {
       _out[idx][0] = -_in[idx][0];
       _out[idx][1] = -_in[idx][1];
       if (rank == 0) {
@@ -358,7 +359,7 @@ NdArrayRef AddAP::proc(KernelEvalContext* ctx, const NdArrayRef& lhs,
     NdArrayView<shr_t> _lhs(lhs);
     NdArrayView<el_t> _rhs(rhs);
 
-    pforeach(0, lhs.numel(), [&](int64_t idx) {
+    SPU_PFOREACH(0, lhs.numel(), 1, [&](int64_t idx) {
       _out[idx][0] = _lhs[idx][0];
       _out[idx][1] = _lhs[idx][1];
       if (rank == 0) _out[idx][1] += _rhs[idx];
@@ -384,7 +385,7 @@ NdArrayRef AddAA::proc(KernelEvalContext*, const NdArrayRef& lhs,
     NdArrayView<shr_t> _lhs(lhs);
     NdArrayView<shr_t> _rhs(rhs);
 
-    pforeach(0, lhs.numel(), [&](int64_t idx) {
+    SPU_PFOREACH(0, lhs.numel(), 1, [&](int64_t idx) {
       _out[idx][0] = _lhs[idx][0] + _rhs[idx][0];
       _out[idx][1] = _lhs[idx][1] + _rhs[idx][1];
     });
@@ -412,7 +413,7 @@ NdArrayRef MulAP::proc(KernelEvalContext*, const NdArrayRef& lhs,
     NdArrayView<shr_t> _lhs(lhs);
     NdArrayView<el_t> _rhs(rhs);
 
-    pforeach(0, lhs.numel(), [&](int64_t idx) {
+    SPU_PFOREACH(0, lhs.numel(), 1, [&](int64_t idx) {
       _out[idx][0] = _lhs[idx][0] * _rhs[idx];
       _out[idx][1] = _lhs[idx][1] * _rhs[idx];
     });
@@ -439,7 +440,7 @@ NdArrayRef MulAA::proc(KernelEvalContext* ctx, const NdArrayRef& lhs,
     NdArrayView<shr_t> _rhs(rhs);
 
     // z1 = (x1 * y1) + (x1 * y2) + (x2 * y1) + (r0 - r1);
-    pforeach(0, lhs.numel(), [&](int64_t idx) {
+    SPU_PFOREACH(0, lhs.numel(), 1, [&](int64_t idx) {
       r0[idx] = (_lhs[idx][0] * _rhs[idx][0]) + (_lhs[idx][0] * _rhs[idx][1]) +
                 (_lhs[idx][1] * _rhs[idx][0]) + (r0[idx] - r1[idx]);
     });
@@ -449,7 +450,7 @@ NdArrayRef MulAA::proc(KernelEvalContext* ctx, const NdArrayRef& lhs,
     NdArrayRef out(makeType<AShrTy>(field), lhs.shape());
     NdArrayView<shr_t> _out(out);
 
-    pforeach(0, lhs.numel(), [&](int64_t idx) {
+    SPU_PFOREACH(0, lhs.numel(), 1, [&](int64_t idx) {
       _out[idx][0] = r0[idx];
       _out[idx][1] = r1[idx];
     });
@@ -584,7 +585,7 @@ NdArrayRef MulA1B::proc(KernelEvalContext* ctx, const NdArrayRef& lhs,
       NdArrayView<ring2k_t> r2_1(r2.second);
       // r1.first = r1.first + r2.first
       // r1.second = r1.second + r2.second
-      pforeach(0, r1.first.numel(), [&](int64_t idx) {
+      SPU_PFOREACH(0, r1.first.numel(), 1, [&](int64_t idx) {
         r1_0[idx] = r1_0[idx] + r2_0[idx];
         r1_1[idx] = r1_1[idx] + r2_1[idx];
       });
@@ -686,7 +687,7 @@ NdArrayRef LShiftA::proc(KernelEvalContext*, const NdArrayRef& in,
     NdArrayView<shr_t> _out(out);
     NdArrayView<shr_t> _in(in);
 
-    pforeach(0, in.numel(), [&](int64_t idx) {
+    SPU_PFOREACH(0, in.numel(), 1, [&](int64_t idx) {
       _out[idx][0] = _in[idx][0] << bits;
       _out[idx][1] = _in[idx][1] << bits;
     });
@@ -754,7 +755,7 @@ std::vector<T> openWith(Communicator* comm, size_t peer_rank,
   SPU_ENFORCE(peer.size() == in.size());
   std::vector<T> out(in.size());
 
-  pforeach(0, in.size(), [&](int64_t idx) {  //
+  SPU_PFOREACH(0, in.size(), 1, [&](int64_t idx) {  //
     out[idx] = in[idx] + peer[idx];
   });
 
@@ -803,7 +804,7 @@ NdArrayRef TruncAPr::proc(KernelEvalContext* ctx, const NdArrayRef& in,
                                     PrgState::GenPrssCtrl::First);
 
       std::vector<el_t> x_plus_r(numel);
-      pforeach(0, numel, [&](int64_t idx) {
+      SPU_PFOREACH(0, numel, 1, [&](int64_t idx) {
         // convert to 2-outof-2 share.
         auto x = _in[idx][0] + _in[idx][1];
 
@@ -827,7 +828,7 @@ NdArrayRef TruncAPr::proc(KernelEvalContext* ctx, const NdArrayRef& in,
       auto rc = absl::MakeSpan(cr).subspan(numel, numel);
 
       std::vector<el_t> y2(numel);  // the 2-out-of-2 truncation result
-      pforeach(0, numel, [&](int64_t idx) {
+      SPU_PFOREACH(0, numel, 1, [&](int64_t idx) {
         // c_hat = c/2^m mod 2^(k-m-1) = (c << 1) >> (1+m)
         auto c_hat = (c[idx] << 1) >> (1 + bits);
 
@@ -849,7 +850,7 @@ NdArrayRef TruncAPr::proc(KernelEvalContext* ctx, const NdArrayRef& in,
       std::vector<el_t> y1(numel);
       prg_state->fillPrssPair<el_t>(y1.data(), nullptr, r.size(),
                                     PrgState::GenPrssCtrl::First);
-      pforeach(0, numel, [&](int64_t idx) {  //
+      SPU_PFOREACH(0, numel, 1, [&](int64_t idx) {  //
         y2[idx] -= y1[idx];
       });
 
@@ -857,7 +858,7 @@ NdArrayRef TruncAPr::proc(KernelEvalContext* ctx, const NdArrayRef& in,
       auto tmp = comm->recv<el_t>(P1, "2to3");
 
       // rebuild the final result.
-      pforeach(0, numel, [&](int64_t idx) {
+      SPU_PFOREACH(0, numel, 1, [&](int64_t idx) {
         _out[idx][0] = y1[idx];
         _out[idx][1] = y2[idx] + tmp[idx];
       });
@@ -867,7 +868,7 @@ NdArrayRef TruncAPr::proc(KernelEvalContext* ctx, const NdArrayRef& in,
                                     PrgState::GenPrssCtrl::Second);
 
       std::vector<el_t> x_plus_r(numel);
-      pforeach(0, numel, [&](int64_t idx) {
+      SPU_PFOREACH(0, numel, 1, [&](int64_t idx) {
         // let t as 2-out-of-2 share, mask it with ra.
         x_plus_r[idx] = _in[idx][1] + r[idx];
       });
@@ -883,7 +884,7 @@ NdArrayRef TruncAPr::proc(KernelEvalContext* ctx, const NdArrayRef& in,
       auto rc = absl::MakeSpan(cr).subspan(numel, numel);
 
       std::vector<el_t> y2(numel);  // the 2-out-of-2 truncation result
-      pforeach(0, numel, [&](int64_t idx) {
+      SPU_PFOREACH(0, numel, 1, [&](int64_t idx) {
         // <b> = <rb> ^ c{k-1} = <rb> + c{k-1} - 2*c{k-1}*<rb>
         // note: <rb> is a randbit (in r^2k)
         const auto ck_1 = c[idx] >> (k - 1);
@@ -896,14 +897,14 @@ NdArrayRef TruncAPr::proc(KernelEvalContext* ctx, const NdArrayRef& in,
       std::vector<el_t> y3(numel);
       prg_state->fillPrssPair<el_t>(nullptr, y3.data(), y3.size(),
                                     PrgState::GenPrssCtrl::Second);
-      pforeach(0, numel, [&](int64_t idx) {  //
+      SPU_PFOREACH(0, numel, 1, [&](int64_t idx) {  //
         y2[idx] -= y3[idx];
       });
       comm->sendAsync<el_t>(P0, y2, "2to3");
       auto tmp = comm->recv<el_t>(P0, "2to3");
 
       // rebuild the final result.
-      pforeach(0, numel, [&](int64_t idx) {
+      SPU_PFOREACH(0, numel, 1, [&](int64_t idx) {
         _out[idx][0] = y2[idx] + tmp[idx];
         _out[idx][1] = y3[idx];
       });
@@ -921,7 +922,7 @@ NdArrayRef TruncAPr::proc(KernelEvalContext* ctx, const NdArrayRef& in,
       auto rc1 = absl::MakeSpan(cr1).subspan(numel, numel);
 
       prg_state->fillPriv(absl::MakeSpan(cr0));
-      pforeach(0, numel, [&](int64_t idx) {
+      SPU_PFOREACH(0, numel, 1, [&](int64_t idx) {
         // let <rb> = <rc> = 0
         rb1[idx] = -rb0[idx];
         rc1[idx] = -rc0[idx];
@@ -943,7 +944,7 @@ NdArrayRef TruncAPr::proc(KernelEvalContext* ctx, const NdArrayRef& in,
       std::vector<el_t> y1(numel);
       prg_state->fillPrssPair(y3.data(), y1.data(), y1.size(),
                               PrgState::GenPrssCtrl::Both);
-      pforeach(0, numel, [&](int64_t idx) {
+      SPU_PFOREACH(0, numel, 1, [&](int64_t idx) {
         _out[idx][0] = y3[idx];
         _out[idx][1] = y1[idx];
       });
@@ -53,7 +53,7 @@ NdArrayRef CastTypeB::proc(KernelEvalContext*, const NdArrayRef& in,
       NdArrayView<out_shr_t> _out(out);
       NdArrayView<in_shr_t> _in(in);
 
-      pforeach(0, in.numel(), [&](int64_t idx) {
+      SPU_PFOREACH(0, in.numel(), 1, [&](int64_t idx) {
         const auto& v = _in[idx];
         _out[idx][0] = static_cast<out_el_t>(v[0]);
         _out[idx][1] = static_cast<out_el_t>(v[1]);
@@ -84,7 +84,7 @@ NdArrayRef B2P::proc(KernelEvalContext* ctx, const NdArrayRef& in) const {
       auto x2 = getShareAs<bshr_el_t>(in, 1);
       auto x3 = comm->rotate<bshr_el_t>(x2, "b2p");  // comm => 1, k
 
-      pforeach(0, in.numel(), [&](int64_t idx) {
+      SPU_PFOREACH(0, in.numel(), 1, [&](int64_t idx) {
         const auto& v = _in[idx];
         _out[idx] = static_cast<pshr_el_t>(v[0] ^ v[1] ^ x3[idx]);
       });
@@ -111,7 +111,7 @@ NdArrayRef P2B::proc(KernelEvalContext* ctx, const NdArrayRef& in) const {
       NdArrayRef out(makeType<BShrTy>(btype, nbits), in.shape());
       NdArrayView<bshr_t> _out(out);
 
-      pforeach(0, in.numel(), [&](int64_t idx) {
+      SPU_PFOREACH(0, in.numel(), 1, [&](int64_t idx) {
         if (comm->getRank() == 0) {
           _out[idx][0] = static_cast<bshr_el_t>(_in[idx]);
           _out[idx][1] = 0U;
@@ -151,7 +151,7 @@ NdArrayRef B2V::proc(KernelEvalContext* ctx, const NdArrayRef& in,
         NdArrayRef out(out_ty, in.shape());
         NdArrayView<vshr_scalar_t> _out(out);
 
-        pforeach(0, in.numel(), [&](int64_t idx) {
+        SPU_PFOREACH(0, in.numel(), 1, [&](int64_t idx) {
           const auto& v = _in[idx];
           _out[idx] = v[0] ^ v[1] ^ x3[idx];
         });
@@ -159,7 +159,8 @@ NdArrayRef B2V::proc(KernelEvalContext* ctx, const NdArrayRef& in,
       } else if (comm->getRank() == (rank + 1) % 3) {
         std::vector<bshr_el_t> x2(in.numel());
 
-        pforeach(0, in.numel(), [&](int64_t idx) { x2[idx] = _in[idx][1]; });
+        SPU_PFOREACH(0, in.numel(), 1,
+                     [&](int64_t idx) { x2[idx] = _in[idx][1]; });
 
         comm->sendAsync<bshr_el_t>(comm->prevRank(), x2,
                                    "b2v");  // comm => 1, k
@@ -199,7 +200,7 @@ NdArrayRef AndBP::proc(KernelEvalContext*, const NdArrayRef& lhs,
         NdArrayRef out(makeType<BShrTy>(out_btype, out_nbits), lhs.shape());
         NdArrayView<out_shr_t> _out(out);
 
-        pforeach(0, lhs.numel(), [&](int64_t idx) {
+        SPU_PFOREACH(0, lhs.numel(), 1, [&](int64_t idx) {
           const auto& l = _lhs[idx];
           const auto& r = _rhs[idx];
           _out[idx][0] = l[0] & r;
@@ -244,7 +245,7 @@ NdArrayRef AndBB::proc(KernelEvalContext* ctx, const NdArrayRef& lhs,
                                 PrgState::GenPrssCtrl::Both);
 
         // z1 = (x1 & y1) ^ (x1 & y2) ^ (x2 & y1) ^ (r0 ^ r1);
-        pforeach(0, lhs.numel(), [&](int64_t idx) {
+        SPU_PFOREACH(0, lhs.numel(), 1, [&](int64_t idx) {
           const auto& l = _lhs[idx];
           const auto& r = _rhs[idx];
           r0[idx] = (l[0] & r[0]) ^ (l[0] & r[1]) ^ (l[1] & r[0]) ^
@@ -254,7 +255,7 @@ NdArrayRef AndBB::proc(KernelEvalContext* ctx, const NdArrayRef& lhs,
         r1 = comm->rotate<out_el_t>(r0, "andbb");  // comm => 1, k
 
         NdArrayView<out_shr_t> _out(out);
-        pforeach(0, lhs.numel(), [&](int64_t idx) {
+        SPU_PFOREACH(0, lhs.numel(), 1, [&](int64_t idx) {
           _out[idx][0] = r0[idx];
           _out[idx][1] = r1[idx];
         });
@@ -291,7 +292,7 @@ NdArrayRef XorBP::proc(KernelEvalContext*, const NdArrayRef& lhs,
         using out_shr_t = std::array<out_el_t, 2>;
 
         NdArrayView<out_shr_t> _out(out);
-        pforeach(0, lhs.numel(), [&](int64_t idx) {
+        SPU_PFOREACH(0, lhs.numel(), 1, [&](int64_t idx) {
           const auto& l = _lhs[idx];
           const auto& r = _rhs[idx];
           _out[idx][0] = l[0] ^ r;
@@ -330,7 +331,7 @@ NdArrayRef XorBB::proc(KernelEvalContext*, const NdArrayRef& lhs,
         NdArrayRef out(makeType<BShrTy>(out_btype, out_nbits), lhs.shape());
         NdArrayView<out_shr_t> _out(out);
 
-        pforeach(0, lhs.numel(), [&](int64_t idx) {
+        SPU_PFOREACH(0, lhs.numel(), 1, [&](int64_t idx) {
           const auto& l = _lhs[idx];
           const auto& r = _rhs[idx];
           _out[idx][0] = l[0] ^ r[0];
@@ -364,7 +365,7 @@ NdArrayRef LShiftB::proc(KernelEvalContext* ctx, const NdArrayRef& in,
       NdArrayRef out(makeType<BShrTy>(out_btype, out_nbits), in.shape());
       NdArrayView<out_shr_t> _out(out);
 
-      pforeach(0, in.numel(), [&](int64_t idx) {
+      SPU_PFOREACH(0, in.numel(), 1, [&](int64_t idx) {
         const auto& v = _in[idx];
         _out[idx][0] = static_cast<out_el_t>(v[0]) << bits;
         _out[idx][1] = static_cast<out_el_t>(v[1]) << bits;
@@ -395,7 +396,7 @@ NdArrayRef RShiftB::proc(KernelEvalContext*, const NdArrayRef& in,
       NdArrayRef out(makeType<BShrTy>(out_btype, out_nbits), in.shape());
       NdArrayView<out_shr_t> _out(out);
 
-      pforeach(0, in.numel(), [&](int64_t idx) {
+      SPU_PFOREACH(0, in.numel(), 1, [&](int64_t idx) {
         const auto& v = _in[idx];
         _out[idx][0] = static_cast<out_el_t>(v[0] >> bits);
         _out[idx][1] = static_cast<out_el_t>(v[1] >> bits);
@@ -426,7 +427,7 @@ NdArrayRef ARShiftB::proc(KernelEvalContext* ctx, const NdArrayRef& in,
     NdArrayView<shr_t> _out(out);
     NdArrayView<shr_t> _in(in);
 
-    pforeach(0, in.numel(), [&](int64_t idx) {
+    SPU_PFOREACH(0, in.numel(), 1, [&](int64_t idx) {
       const auto& v = _in[idx];
       _out[idx][0] = v[0] >> bits;
       _out[idx][1] = v[1] >> bits;
@@ -469,7 +470,7 @@ NdArrayRef BitrevB::proc(KernelEvalContext*, const NdArrayRef& in, size_t start,
         return (el & ~mask) | tmp;
       };
 
-      pforeach(0, in.numel(), [&](int64_t idx) {
+      SPU_PFOREACH(0, in.numel(), 1, [&](int64_t idx) {
         const auto& v = _in[idx];
         _out[idx][0] = bitrev_fn(static_cast<out_el_t>(v[0]));
         _out[idx][1] = bitrev_fn(static_cast<out_el_t>(v[1]));
@@ -494,7 +495,7 @@ NdArrayRef BitIntlB::proc(KernelEvalContext*, const NdArrayRef& in,
     NdArrayView<shr_t> _out(out);
     NdArrayView<shr_t> _in(in);
 
-    pforeach(0, in.numel(), [&](int64_t idx) {
+    SPU_PFOREACH(0, in.numel(), 1, [&](int64_t idx) {
       const auto& v = _in[idx];
       _out[idx][0] = BitIntl<el_t>(v[0], stride, nbits);
       _out[idx][1] = BitIntl<el_t>(v[1], stride, nbits);
@@ -517,7 +518,7 @@ NdArrayRef BitDeintlB::proc(KernelEvalContext*, const NdArrayRef& in,
     NdArrayView<shr_t> _out(out);
     NdArrayView<shr_t> _in(in);
 
-    pforeach(0, in.numel(), [&](int64_t idx) {
+    SPU_PFOREACH(0, in.numel(), 1, [&](int64_t idx) {
       const auto& v = _in[idx];
       _out[idx][0] = BitDeintl<el_t>(v[0], stride, nbits);
       _out[idx][1] = BitDeintl<el_t>(v[1], stride, nbits);
@@ -472,6 +472,23 @@ Value square_v(SPUContext* ctx, const Value& x) { return mul_vv(ctx, x, x); }
 
 Value square_p(SPUContext* ctx, const Value& x) { return mul_pp(ctx, x, x); }
 
+OptionalAPI<Value> mux_s(SPUContext* ctx, const Value& pred, const Value& x,
+                         const Value& y) {
+  SPU_TRACE_MPC_DISP(ctx, pred, x, y);
+  TRY_DISPATCH(ctx, pred, x, y);
+
+  // The 1-bit boolean predicate selects directly, e.g., as the choice bits of
+  // an OT based multiplexer, without converting it to arithmetic first.
+  if (ctx->hasKernel("mux_a1b") && IsB(pred) && NBits(pred) == 1) {
+    auto to_a = [&](const Value& v) {
+      return IsP(v) ? p2a(ctx, v) : _2a(ctx, v);
+    };
+    return mux_a1b(ctx, pred, to_a(x), to_a(y));
+  }
+
+  return NotAvailable;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 
 Value mmul_ss(SPUContext* ctx, const Value& x, const Value& y) {
@@ -752,6 +769,17 @@ Value oram_read_sp(SPUContext* ctx, const Value& x, const Value& y,
   return dynDispatch(ctx, "oram_read_ap", x, y, offset);
 };
 
+OptionalAPI<Value> lut_sp(SPUContext* ctx, const Value& x, const Value& table,
+                          size_t shift, size_t index_bits) {
+  SPU_TRACE_MPC_DISP(ctx, x, table, shift, index_bits);
+
+  if (IsA(x)) {
+    TRY_NAMED_DISPATCH(ctx, "lut_ap", x, table, shift, index_bits);
+  }
+
+  return NotAvailable;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 
 OptionalAPI<Value> rand_perm_s(SPUContext* ctx, const Shape& shape) {
@@ -122,6 +122,10 @@ Value square_s(SPUContext* ctx, const Value& x);
 Value square_v(SPUContext* ctx, const Value& x);
 Value square_p(SPUContext* ctx, const Value& x);
 
+// pred ? x : y, where pred is a secret and x, y are secret or public.
+OptionalAPI<Value> mux_s(SPUContext* ctx, const Value& pred, const Value& x,
+                         const Value& y);
+
 Value mmul_ss(SPUContext* ctx, const Value& x, const Value& y);
 Value mmul_sv(SPUContext* ctx, const Value& x, const Value& y);
 Value mmul_sp(SPUContext* ctx, const Value& x, const Value& y);
@@ -180,6 +184,13 @@ Value oram_read_ss(SPUContext* ctx, const Value& x, const Value& y,
 Value oram_read_sp(SPUContext* ctx, const Value& x, const Value& y,
                    int64_t offset);
 
+// Lookup a public table with the digit d = (x >> shift) mod 2^index_bits.
+// table is of shape {2^index_bits, C}, ret is of shape x.shape + {C}.
+// NOTE: the kernel may use d - 1 (mod 2^index_bits) instead of d, i.e., the
+// carry from the low `shift` bits can be dropped.
+OptionalAPI<Value> lut_sp(SPUContext* ctx, const Value& x, const Value& table,
+                          size_t shift, size_t index_bits);
+
 //////////////////////////////////////////////////////////////////////////////
 // TODO: Formalize these permutation APIs
 //////////////////////////////////////////////////////////////////////////////
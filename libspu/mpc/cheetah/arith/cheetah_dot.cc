@@ -167,34 +167,32 @@ struct CheetahDot::Impl : public EnableCPRNG {
     SPU_ENFORCE_EQ(rnd_mask.size(), num_poly);
 
     constexpr int64_t heuristic_group = 4;
-    yacl::parallel_for(
-        0, num_poly, heuristic_group, [&](size_t bgn, size_t end) {
-          RLWECt zero_ct;
-          for (size_t idx = bgn; idx < end; ++idx) {
-            // NOTE(lwj): we hope the final ct is in the non-ntt form
-            // We perform the intt before the modulus down which is faster
-            // than modulus down then intt.
-            InvNttInplace(ct[idx], context);
-
-            ModulusSwtichInplace(ct[idx], target_modulus_size, context);
-
-            // TODO(lwj): improve the performance of pk encryption of zero.
-            // ct <- ct + enc(0)
-            if (0 == zero_ct.size()) {
-              seal::util::encrypt_zero_asymmetric(
-                  pk, context, ct[idx].parms_id(), ct[idx].is_ntt_form(),
-                  zero_ct);
-            }
-
-            evaluator.add_inplace(ct[idx], zero_ct);
-            SPU_ENFORCE(!ct[idx].is_ntt_form());
-
-            // sample r <- Rq
-            // (ct[0] - r, ct[1]) <- ct
-            UniformPoly(context, &rnd_mask[idx], ct[idx].parms_id());
-            SubPlainInplace(ct[idx], rnd_mask[idx], context);
-          }
-        });
+    pforeach(0, num_poly, heuristic_group, [&](size_t bgn, size_t end) {
+      RLWECt zero_ct;
+      for (size_t idx = bgn; idx < end; ++idx) {
+        // NOTE(lwj): we hope the final ct is in the non-ntt form
+        // We perform the intt before the modulus down which is faster
+        // than modulus down then intt.
+        InvNttInplace(ct[idx], context);
+
+        ModulusSwtichInplace(ct[idx], target_modulus_size, context);
+
+        // TODO(lwj): improve the performance of pk encryption of zero.
+        // ct <- ct + enc(0)
+        if (0 == zero_ct.size()) {
+          seal::util::encrypt_zero_asymmetric(
+              pk, context, ct[idx].parms_id(), ct[idx].is_ntt_form(), zero_ct);
+        }
+
+        evaluator.add_inplace(ct[idx], zero_ct);
+        SPU_ENFORCE(!ct[idx].is_ntt_form());
+
+        // sample r <- Rq
+        // (ct[0] - r, ct[1]) <- ct
+        UniformPoly(context, &rnd_mask[idx], ct[idx].parms_id());
+        SubPlainInplace(ct[idx], rnd_mask[idx], context);
+      }
+    });
   }
 
  private:
@@ -339,7 +337,8 @@ void CheetahDot::Impl::doDotOLEReceiverRecvStep(const NdArrayRef &prv_mat,
   const size_t out_n = matmat_prot.GetOutSize(meta, subshape);
   SPU_ENFORCE_EQ(out_n, result_cts.size());
 
-  // 1. launch IO task to recv ct from peer
+  // 1. launch IO task to recv ct from peer, off the runtime pool since it
+  // mostly waits on the link (see tiled_dispatch.cc)
   std::vector<RLWECt> enc_mat(is_self_lhs ? rhs_n : lhs_n);
   auto io_task = std::async(std::launch::async, [&]() {
     for (auto &ct : enc_mat) {
@@ -356,7 +355,7 @@ void CheetahDot::Impl::doDotOLEReceiverRecvStep(const NdArrayRef &prv_mat,
     matmat_prot.EncodeRHS(prv_mat, meta, false, absl::MakeSpan(plain_mat));
   }
 
-  yacl::parallel_for(0, plain_mat.size(), [&](size_t bgn, size_t end) {
+  pforeach(0, plain_mat.size(), 1, [&](size_t bgn, size_t end) {
     for (size_t i = bgn; i < end; ++i) {
       NttInplace(plain_mat[i], this_context);
     }
@@ -421,15 +420,13 @@ NdArrayRef CheetahDot::Impl::doDotOLEReceiverSendStep(
         *(peer_galois_keys_.find(field_bitlen)->second);
 
     // Drop some modulus before packing
-    yacl::parallel_for(
-        0, ct_array_to_pack.size(), [&](int64_t bgn, int64_t end) {
-          for (int64_t i = bgn; i < end; ++i) {
-            InvNttInplace(ct_array_to_pack[i], this_context);
-            ModulusSwtichInplace(ct_array_to_pack[i],
-                                 this_dcd_msh.coeff_modulus_size(),
-                                 this_context);
-          }
-        });
+    pforeach(0, ct_array_to_pack.size(), 1, [&](int64_t bgn, int64_t end) {
+      for (int64_t i = bgn; i < end; ++i) {
+        InvNttInplace(ct_array_to_pack[i], this_context);
+        ModulusSwtichInplace(ct_array_to_pack[i],
+                             this_dcd_msh.coeff_modulus_size(), this_context);
+      }
+    });
 
     // Extract Phantom LWECt from RLWEs
     size_t out_numel = meta.dims[0] * meta.dims[2];
@@ -537,7 +534,7 @@ void CheetahDot::Impl::doDotOLESenderSendStep(const NdArrayRef &prv_mat,
                          /*ntt*/ true,
                          /*seed*/ true, absl::MakeSpan(enc_mat));
 
-    yacl::parallel_for(0, this_batch, [&](size_t bgn, size_t end) {
+    pforeach(0, this_batch, 1, [&](size_t bgn, size_t end) {
       for (size_t j = bgn; j < end; ++j) {
         ct_s[j] = EncodeSEALObject(enc_mat[j]);
       }
@@ -578,7 +575,7 @@ NdArrayRef CheetahDot::Impl::doDotOLESenderRecvStep(FieldType field,
       DecodeSEALObject(ct_s, this_context, &recv_ct[j]);
     }
 
-    yacl::parallel_for(0, this_batch, [&](size_t bgn, size_t end) {
+    pforeach(0, this_batch, 1, [&](size_t bgn, size_t end) {
       for (size_t j = bgn; j < end; ++j) {
         NttInplace(recv_ct[j], this_context);
         this_decryptor->decrypt(recv_ct[j], result_poly[i + j]);
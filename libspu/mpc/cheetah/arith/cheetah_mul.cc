@@ -32,8 +32,8 @@
 #include "seal/valcheck.h"
 #include "spdlog/spdlog.h"
 #include "yacl/link/link.h"
-#include "yacl/utils/parallel.h"
 
+#include "libspu/core/parallel_utils.h"
 #include "libspu/mpc/cheetah/arith/common.h"
 #include "libspu/mpc/cheetah/arith/simd_mul_prot.h"
 #include "libspu/mpc/cheetah/rlwe/modswitch_helper.h"
@@ -373,6 +373,7 @@ NdArrayRef CheetahMul::Impl::MulOLE(const NdArrayRef &shr,
 
     size_t payload_sze = encoded_shr.size();
     std::vector<yacl::Buffer> recv_ct(payload_sze);
+    // Receiving only waits on the link, so it stays off the runtime pool.
     auto io_task = std::async(std::launch::async, [&]() {
       for (size_t idx = 0; idx < payload_sze; ++idx) {
         recv_ct[idx] = conn->Recv(nxt_rank, "");
@@ -490,7 +491,7 @@ size_t CheetahMul::Impl::EncryptArrayThenSend(const NdArrayRef &array,
 
   std::vector<yacl::Buffer> payload(num_polys);
 
-  yacl::parallel_for(0, num_polys, [&](int64_t job_bgn, int64_t job_end) {
+  pforeach(0, num_polys, 1, [&](int64_t job_bgn, int64_t job_end) {
     RLWECt ct;
     for (int64_t job_id = job_bgn; job_id < job_end; ++job_id) {
       int64_t cntxt_id = job_id / num_splits;
@@ -564,7 +565,7 @@ void CheetahMul::Impl::EncodeArray(const NdArrayRef &array, bool need_encrypt,
 
   auto &ms_helper = ms_helpers_.find(options)->second;
 
-  yacl::parallel_for(0, num_polys, [&](int64_t job_bgn, int64_t job_end) {
+  pforeach(0, num_polys, 1, [&](int64_t job_bgn, int64_t job_end) {
     std::vector<uint64_t> _u64tmp(num_slots());
     auto u64tmp = absl::MakeSpan(_u64tmp);
 
@@ -619,7 +620,7 @@ void CheetahMul::Impl::MulThenResponse(FieldType, int64_t num_elts,
               "CheetahMul: rnd_mask size mismatch");
 
   std::vector<yacl::Buffer> response(num_ciphers);
-  yacl::parallel_for(0, num_ciphers, [&](int64_t job_bgn, int64_t job_end) {
+  pforeach(0, num_ciphers, 1, [&](int64_t job_bgn, int64_t job_end) {
     RLWECt ct;
     std::vector<uint64_t> u64tmp(num_slots(), 0);
     for (int64_t job_id = job_bgn; job_id < job_end; ++job_id) {
@@ -683,7 +684,7 @@ void CheetahMul::Impl::FMAThenResponse(
               "CheetahMul: rnd_mask size mismatch");
 
   std::vector<yacl::Buffer> response(num_ciphers);
-  yacl::parallel_for(0, num_ciphers, [&](int64_t job_bgn, int64_t job_end) {
+  pforeach(0, num_ciphers, 1, [&](int64_t job_bgn, int64_t job_end) {
     RLWECt ct_x;
     RLWECt ct_y;
     std::vector<uint64_t> u64tmp(num_slots(), 0);
@@ -739,7 +740,7 @@ NdArrayRef CheetahMul::Impl::DecryptArray(
   // Decrypt ciphertexts into size x num_modulus
   // Then apply the ModulusDown to get value in Z_{2^k}.
   std::vector<uint64_t> rns_temp(size * num_seal_ctx, 0);
-  yacl::parallel_for(0, num_ciphers, [&](int64_t job_bgn, int64_t job_end) {
+  pforeach(0, num_ciphers, 1, [&](int64_t job_bgn, int64_t job_end) {
     RLWEPt pt;
     RLWECt ct;
     std::vector<uint64_t> subarray(num_slots(), 0);
@@ -21,9 +21,9 @@
 #include "seal/seal.h"
 #include "seal/util/polyarithsmallmod.h"
 #include "spdlog/spdlog.h"
-#include "yacl/utils/parallel.h"
 #include "yacl/utils/platform_utils.h"
 
+#include "libspu/core/parallel_utils.h"
 #include "libspu/mpc/cheetah/arith/vector_encoder.h"
 #include "libspu/mpc/cheetah/rlwe/lwe_ct.h"
 #include "libspu/mpc/cheetah/rlwe/utils.h"
@@ -257,7 +257,7 @@ void MatMatProtocol::EncodeMatrix(const NdArrayRef& mat, const Meta& meta,
   Indexer indexer(subshape, poly_deg_);
   size_t num_jobs = num_row_blocks * num_col_blocks;
 
-  yacl::parallel_for(0, num_jobs, [&](int64_t job_bgn, int64_t job_end) {
+  pforeach(0, num_jobs, 1, [&](int64_t job_bgn, int64_t job_end) {
     std::array<int64_t, 2> extents;
     for (int64_t job_id = job_bgn; job_id < job_end; ++job_id) {
       int64_t rblk = job_id / num_col_blocks;
@@ -469,7 +469,7 @@ NdArrayRef MatMatProtocol::ParseBatchPackedResult(
   const int64_t numel_per_dot = meta.dims[0] * meta.dims[2];
 
   std::vector<NdArrayRef> decoded_vectors(polys.size());
-  yacl::parallel_for(0, polys.size(), [&](int64_t bgn, int64_t end) {
+  pforeach(0, polys.size(), 1, [&](int64_t bgn, int64_t end) {
     for (int64_t i = bgn; i < end; ++i) {
       decoded_vectors[i] = msh.ModulusDownRNS(
           field, {poly_deg_}, {polys[i].data(), polys[i].coeff_count()});
@@ -668,7 +668,7 @@ void MatMatProtocol::DoCompute(absl::Span<const LHS> lhs,
   }
 
   if (dims[0] >= dims[2]) {
-    yacl::parallel_for(0, dims[0], [&](int64_t bgn, int64_t end) {
+    pforeach(0, dims[0], 1, [&](int64_t bgn, int64_t end) {
       // Loop dim0
       for (int64_t i = bgn; i < end; ++i) {
         // out[i, k]
@@ -686,7 +686,7 @@ void MatMatProtocol::DoCompute(absl::Span<const LHS> lhs,
       }
     });
   } else {
-    yacl::parallel_for(0, dims[2], [&](int64_t bgn, int64_t end) {
+    pforeach(0, dims[2], 1, [&](int64_t bgn, int64_t end) {
       // Loop dim2
       for (int64_t k = bgn; k < end; ++k) {
         // NOTE(lwj): RHS is stored in column-major
@@ -21,6 +21,7 @@
 #include "libspu/mpc/cheetah/arith/common.h"
 #include "libspu/mpc/cheetah/nonlinear/compare_prot.h"
 #include "libspu/mpc/cheetah/nonlinear/equal_prot.h"
+#include "libspu/mpc/cheetah/nonlinear/lut_prot.h"
 #include "libspu/mpc/cheetah/nonlinear/truncate_prot.h"
 #include "libspu/mpc/cheetah/ot/basic_ot_prot.h"
 #include "libspu/mpc/cheetah/state.h"
@@ -163,6 +164,27 @@ NdArrayRef EqualAA::proc(KernelEvalContext* ctx, const NdArrayRef& x,
       .as(makeType<BShrTy>(field, 1));
 }
 
+NdArrayRef LutAP::proc(KernelEvalContext* ctx, const NdArrayRef& x,
+                       const NdArrayRef& table, size_t shift,
+                       size_t index_bits) const {
+  const int64_t ncols = table.shape()[1];
+  Shape oshape = x.shape();
+  oshape.push_back(ncols);
+  if (x.numel() == 0 || ncols == 0) {
+    return NdArrayRef(x.eltype(), oshape);
+  }
+
+  // Every input element yields one row of `ncols` outputs.
+  return DispatchUnaryFuncWithBatchedInput(
+             ctx, x.reshape({x.numel()}), /*is_batcher*/ false, ncols,
+             [&](const NdArrayRef& input,
+                 const std::shared_ptr<BasicOTProtocols>& base_ot) {
+               LookUpTableProtocol prot(base_ot);
+               return prot.Compute(input, table, shift, index_bits);
+             })
+      .reshape(oshape);
+}
+
 NdArrayRef MulA1B::proc(KernelEvalContext* ctx, const NdArrayRef& ashr,
                         const NdArrayRef& bshr) const {
   SPU_ENFORCE_EQ(ashr.shape(), bshr.shape());
@@ -181,6 +203,26 @@ NdArrayRef MulA1B::proc(KernelEvalContext* ctx, const NdArrayRef& ashr,
       .as(ashr.eltype());
 }
 
+NdArrayRef MuxA1B::proc(KernelEvalContext* ctx, const NdArrayRef& pred,
+                        const NdArrayRef& x, const NdArrayRef& y) const {
+  SPU_ENFORCE_EQ(pred.eltype().as<BShrTy>()->nbits(), 1UL);
+  const int64_t numel = x.numel();
+
+  if (numel == 0) {
+    return NdArrayRef(x.eltype(), x.shape());
+  }
+
+  // y + pred * (x - y)
+  auto out = DispatchBinaryFunc(
+      ctx, ring_sub(x, y), pred,
+      [&](const NdArrayRef& input0, const NdArrayRef& input1,
+          const std::shared_ptr<BasicOTProtocols>& base_ot) {
+        return base_ot->Multiplexer(input0, input1);
+      });
+  ring_add_(out, y);
+  return out.as(x.eltype());
+}
+
 NdArrayRef MulA1BV::proc(KernelEvalContext* ctx, const NdArrayRef& ashr,
                          const NdArrayRef& bshr) const {
   auto* comm = ctx->getState<Communicator>();
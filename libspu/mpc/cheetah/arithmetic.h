@@ -121,6 +121,17 @@ class MulA1B : public BinaryKernel {
                   const NdArrayRef& bshr) const override;
 };
 
+// pred ? x : y, the boolean pred goes to the multiplexer as the OT choices.
+class MuxA1B : public TernaryKernel {
+ public:
+  static constexpr char kBindName[] = "mux_a1b";
+
+  Kind kind() const override { return Kind::Dynamic; }
+
+  NdArrayRef proc(KernelEvalContext* ctx, const NdArrayRef& pred,
+                  const NdArrayRef& x, const NdArrayRef& y) const override;
+};
+
 class MulA1BV : public BinaryKernel {
  public:
   static constexpr char kBindName[] = "mul_a1bv";
@@ -325,6 +336,17 @@ class EqualAP : public BinaryKernel {
                   const NdArrayRef& y) const override;
 };
 
+class LutAP : public TableLookupKernel {
+ public:
+  static constexpr char kBindName[] = "lut_ap";
+
+  Kind kind() const override { return Kind::Dynamic; }
+
+  NdArrayRef proc(KernelEvalContext* ctx, const NdArrayRef& x,
+                  const NdArrayRef& table, size_t shift,
+                  size_t index_bits) const override;
+};
+
 class LessAP : public BinaryKernel {
  public:
   static constexpr char kBindName[] = "f_less_ap";
@@ -17,6 +17,7 @@
 #include "libspu/core/ndarray_ref.h"
 #include "libspu/mpc/cheetah/ot/basic_ot_prot.h"
 #include "libspu/mpc/cheetah/tiled_dispatch.h"
+#include "libspu/mpc/cheetah/type.h"
 
 namespace spu::mpc::cheetah {
 
@@ -24,9 +25,16 @@ NdArrayRef AndBB::proc(KernelEvalContext* ctx, const NdArrayRef& lhs,
                        const NdArrayRef& rhs) const {
   SPU_ENFORCE_EQ(lhs.shape(), rhs.shape());
 
+  // Only spend OTs on the bits that are live in both operands, e.g., a
+  // 1-bit predicate ANDed with a full width mask costs 1 OT per element.
+  const auto field = lhs.eltype().as<Ring2k>()->field();
+  const size_t out_nbits = std::min(lhs.eltype().as<BShrTy>()->nbits(),
+                                    rhs.eltype().as<BShrTy>()->nbits());
+  const auto out_ty = makeType<BShrTy>(field, out_nbits);
+
   int64_t numel = lhs.numel();
   if (numel == 0) {
-    return NdArrayRef(lhs.eltype(), lhs.shape());
+    return NdArrayRef(out_ty, lhs.shape());
   }
 
   return DispatchBinaryFunc(
@@ -35,7 +43,7 @@ NdArrayRef AndBB::proc(KernelEvalContext* ctx, const NdArrayRef& lhs,
                  const std::shared_ptr<BasicOTProtocols>& base_ot) {
                return base_ot->BitwiseAnd(input0, input1);
              })
-      .as(lhs.eltype());
+      .as(out_ty);
 }
 
 }  // namespace spu::mpc::cheetah
@@ -18,45 +18,31 @@
 #include "libspu/core/trace.h"
 #include "libspu/core/type_util.h"
 #include "libspu/mpc/ab_api.h"
+#include "libspu/mpc/cheetah/nonlinear/a2b_prot.h"
 #include "libspu/mpc/cheetah/nonlinear/ring_ext_prot.h"
 #include "libspu/mpc/cheetah/ot/basic_ot_prot.h"
 #include "libspu/mpc/cheetah/tiled_dispatch.h"
 #include "libspu/mpc/cheetah/type.h"
-#include "libspu/mpc/common/prg_state.h"
 #include "libspu/mpc/common/pv2k.h"
 #include "libspu/mpc/utils/ring_ops.h"
 
 namespace spu::mpc::cheetah {
 
-static NdArrayRef wrap_add_bb(SPUContext* ctx, const NdArrayRef& x,
-                              const NdArrayRef& y) {
-  SPU_ENFORCE(x.shape() == y.shape());
-  return UnwrapValue(add_bb(ctx, WrapValue(x), WrapValue(y)));
-}
-
 NdArrayRef A2B::proc(KernelEvalContext* ctx, const NdArrayRef& x) const {
   const auto field = x.eltype().as<Ring2k>()->field();
-  auto* comm = ctx->getState<Communicator>();
-  auto* prg_state = ctx->getState<PrgState>();
-
-  std::vector<NdArrayRef> bshrs;
   const auto bty = makeType<BShrTy>(field);
-  for (size_t idx = 0; idx < comm->getWorldSize(); idx++) {
-    auto [r0, r1] =
-        prg_state->genPrssPair(field, x.shape(), PrgState::GenPrssCtrl::Both);
-    auto b = ring_xor(r0, r1).as(bty);
-
-    if (idx == comm->getRank()) {
-      ring_xor_(b, x);
-    }
-    bshrs.push_back(b.as(bty));
+  if (x.numel() == 0) {
+    return NdArrayRef(bty, x.shape());
   }
 
-  NdArrayRef res = vreduce(bshrs.begin(), bshrs.end(),
-                           [&](const NdArrayRef& xx, const NdArrayRef& yy) {
-                             return wrap_add_bb(ctx->sctx(), xx, yy);
-                           });
-  return res.as(bty);
+  return DispatchUnaryFunc(
+             ctx, x,
+             [&](const NdArrayRef& input,
+                 const std::shared_ptr<BasicOTProtocols>& base_ot) {
+               A2BProtocol a2b_prot(base_ot);
+               return a2b_prot.Compute(input);
+             })
+      .as(bty);
 }
 
 NdArrayRef B2A::proc(KernelEvalContext* ctx, const NdArrayRef& x) const {
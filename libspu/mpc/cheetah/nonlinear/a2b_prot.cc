@@ -0,0 +1,237 @@
+// Copyright 2024 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libspu/mpc/cheetah/nonlinear/a2b_prot.h"
+
+#include "yacl/crypto/tools/prg.h"
+
+#include "libspu/core/type.h"
+#include "libspu/mpc/cheetah/ot/basic_ot_prot.h"
+#include "libspu/mpc/cheetah/ot/ot_util.h"
+#include "libspu/mpc/cheetah/type.h"
+#include "libspu/mpc/utils/ring_ops.h"
+
+namespace spu::mpc::cheetah {
+
+namespace {
+
+NdArrayRef ToBoolShare(FieldType field, absl::Span<const uint8_t> bits) {
+  auto out = ring_zeros(field, {static_cast<int64_t>(bits.size())});
+  DISPATCH_ALL_FIELDS(field, "to_bool_share", [&]() {
+    NdArrayView<ring2k_t> xout(out);
+    pforeach(0, out.numel(), [&](int64_t i) { xout[i] = bits[i]; });
+  });
+  return out.as(makeType<BShrTy>(field, 1));
+}
+
+void FromBoolShare(const NdArrayRef& inp, absl::Span<uint8_t> bits) {
+  const auto field = inp.eltype().as<Ring2k>()->field();
+  DISPATCH_ALL_FIELDS(field, "from_bool_share", [&]() {
+    NdArrayView<ring2k_t> xinp(inp);
+    pforeach(0, inp.numel(), [&](int64_t i) { bits[i] = xinp[i] & 1; });
+  });
+}
+
+// The leaf of digit u against digit v, bit 2(t-1) is 1{u[0:t) > v[0:t)} and
+// bit 2(t-1)+1 is 1{u[0:t) = v[0:t)} for t in [1, radix].
+uint8_t LeafBits(uint8_t u, uint8_t v, size_t radix) {
+  uint8_t leaf = 0;
+  for (size_t t = 1; t <= radix; ++t) {
+    const uint8_t mask = makeBitsMask<uint8_t>(t);
+    const uint8_t gt = (u & mask) > (v & mask);
+    const uint8_t eq = (u & mask) == (v & mask);
+    leaf |= gt << (2 * (t - 1));
+    leaf |= eq << (2 * (t - 1) + 1);
+  }
+  return leaf;
+}
+
+}  // namespace
+
+A2BProtocol::A2BProtocol(const std::shared_ptr<BasicOTProtocols>& base,
+                         size_t radix)
+    : radix_(radix), basic_ot_prot_(base) {
+  SPU_ENFORCE(base != nullptr);
+  SPU_ENFORCE(radix_ >= 1 && radix_ <= 4);
+  is_sender_ = base->Rank() != ChoiceProvider();
+}
+
+A2BProtocol::~A2BProtocol() { basic_ot_prot_->Flush(); }
+
+NdArrayRef A2BProtocol::Compute(const NdArrayRef& inp) {
+  const auto field = inp.eltype().as<Ring2k>()->field();
+  const int64_t n = inp.numel();
+  const int64_t k = SizeOf(field) * 8;
+  const int64_t m = static_cast<int64_t>(radix_);
+  const int64_t num_digits = CeilDiv(k, m);
+  const size_t N = static_cast<size_t>(1) << radix_;  // one-of-N OT
+
+  // Step 1: break a = x0 (sender) or b = ~x1 (receiver) into digits
+  std::vector<uint8_t> digits(n * num_digits);
+  DISPATCH_ALL_FIELDS(field, "break_digits", [&]() {
+    using u2k = std::make_unsigned<ring2k_t>::type;
+    const auto mask_radix = makeBitsMask<u2k>(radix_);
+    NdArrayView<u2k> xinp(inp);
+    pforeach(0, n, [&](int64_t i) {
+      const u2k v = is_sender_ ? xinp[i] : ~xinp[i];
+      for (int64_t j = 0; j < num_digits; ++j) {
+        digits[i * num_digits + j] = (v >> (j * m)) & mask_radix;
+      }
+    });
+  });
+
+  // Step 2: the leaves of all the digits, one OT per digit
+  std::vector<uint8_t> leaf(n * num_digits);
+  const size_t leaf_width = 2 * radix_;
+  if (is_sender_) {
+    yacl::crypto::Prg<uint8_t> prg;
+    prg.Fill(absl::MakeSpan(leaf));
+    const auto leaf_mask = makeBitsMask<uint8_t>(leaf_width);
+
+    std::vector<uint8_t> table(N * N);
+    for (size_t u = 0; u < N; ++u) {
+      for (size_t v = 0; v < N; ++v) {
+        table[u * N + v] = LeafBits(u, v, radix_);
+      }
+    }
+
+    std::vector<uint8_t> leaf_ot_msg(N * leaf.size());
+    pforeach(0, leaf.size(), [&](int64_t i) {
+      leaf[i] &= leaf_mask;
+      const uint8_t* row = table.data() + digits[i] * N;
+      for (size_t v = 0; v < N; ++v) {
+        leaf_ot_msg[i * N + v] = leaf[i] ^ row[v];
+      }
+    });
+
+    basic_ot_prot_->GetSenderCOT()->SendCMCC(absl::MakeSpan(leaf_ot_msg), N,
+                                             leaf_width);
+    basic_ot_prot_->GetSenderCOT()->Flush();
+  } else {
+    basic_ot_prot_->GetReceiverCOT()->RecvCMCC(absl::MakeSpan(digits), N,
+                                               absl::MakeSpan(leaf),
+                                               leaf_width);
+  }
+
+  auto gt_bit = [&](int64_t i, int64_t j, int64_t t) -> uint8_t {
+    return (leaf[i * num_digits + j] >> (2 * (t - 1))) & 1;
+  };
+  auto eq_bit = [&](int64_t i, int64_t j, int64_t t) -> uint8_t {
+    return (leaf[i * num_digits + j] >> (2 * (t - 1) + 1)) & 1;
+  };
+
+  // Step 3: carries into the digits. After the prefix, gt[i * P + j] is the
+  // carry out of digits [0, j], i.e., the carry into digit j + 1.
+  const int64_t P = num_digits - 1;
+  std::vector<uint8_t> gt(n * P);
+  std::vector<uint8_t> eq(n * P);
+  pforeach(0, n, [&](int64_t i) {
+    for (int64_t j = 0; j < P; ++j) {
+      gt[i * P + j] = gt_bit(i, j, m);
+      eq[i * P + j] = eq_bit(i, j, m);
+    }
+  });
+
+  for (int64_t s = 1; s < P; s *= 2) {
+    // (gt_j, eq_j) <- (gt_j ^ eq_j & gt_{j-s}, eq_j & eq_{j-s}) for j >= s.
+    // The eq of the last level is never used.
+    const int64_t cnt = P - s;
+    const bool keep_eq = 2 * s < P;
+    std::vector<uint8_t> eq_hi(n * cnt);
+    std::vector<uint8_t> gt_lo(n * cnt);
+    std::vector<uint8_t> eq_lo(keep_eq ? n * cnt : 0);
+    pforeach(0, n, [&](int64_t i) {
+      for (int64_t j = s; j < P; ++j) {
+        eq_hi[i * cnt + j - s] = eq[i * P + j];
+        gt_lo[i * cnt + j - s] = gt[i * P + j - s];
+        if (keep_eq) {
+          eq_lo[i * cnt + j - s] = eq[i * P + j - s];
+        }
+      }
+    });
+
+    std::vector<uint8_t> and_gt(n * cnt);
+    std::vector<uint8_t> and_eq(keep_eq ? n * cnt : 0);
+    if (keep_eq) {
+      auto [_gt, _eq] = basic_ot_prot_->CorrelatedBitwiseAnd(
+          ToBoolShare(field, eq_hi), ToBoolShare(field, gt_lo),
+          ToBoolShare(field, eq_lo));
+      FromBoolShare(_gt, absl::MakeSpan(and_gt));
+      FromBoolShare(_eq, absl::MakeSpan(and_eq));
+    } else {
+      FromBoolShare(basic_ot_prot_->BitwiseAnd(ToBoolShare(field, eq_hi),
+                                               ToBoolShare(field, gt_lo)),
+                    absl::MakeSpan(and_gt));
+    }
+
+    pforeach(0, n, [&](int64_t i) {
+      for (int64_t j = s; j < P; ++j) {
+        gt[i * P + j] ^= and_gt[i * cnt + j - s];
+        if (keep_eq) {
+          eq[i * P + j] = and_eq[i * cnt + j - s];
+        }
+      }
+    });
+  }
+
+  // Step 4: carries inside the digits, c_{j*m+t} = gt_t(j) ^ eq_t(j) & C_j
+  // for j >= 1 and 1 <= t < m. No carry comes into the first digit.
+  const int64_t Q = P * (m - 1);
+  std::vector<uint8_t> inner(n * Q, 0);
+  if (Q > 0) {
+    std::vector<uint8_t> lhs(n * Q, 0);
+    std::vector<uint8_t> rhs(n * Q, 0);
+    pforeach(0, n, [&](int64_t i) {
+      for (int64_t j = 1; j < num_digits; ++j) {
+        for (int64_t t = 1; t < m && j * m + t < k; ++t) {
+          const int64_t q = i * Q + (j - 1) * (m - 1) + t - 1;
+          lhs[q] = eq_bit(i, j, t);
+          rhs[q] = gt[i * P + j - 1];
+        }
+      }
+    });
+    FromBoolShare(basic_ot_prot_->BitwiseAnd(ToBoolShare(field, lhs),
+                                             ToBoolShare(field, rhs)),
+                  absl::MakeSpan(inner));
+  }
+
+  // Step 5: x_i = x0_i ^ x1_i ^ c_i
+  NdArrayRef out(makeType<BShrTy>(field), inp.shape());
+  DISPATCH_ALL_FIELDS(field, "compose_bits", [&]() {
+    using u2k = std::make_unsigned<ring2k_t>::type;
+    NdArrayView<u2k> xinp(inp);
+    NdArrayView<u2k> xout(out);
+    pforeach(0, n, [&](int64_t i) {
+      u2k carry = 0;
+      for (int64_t p = 1; p < k; ++p) {
+        const int64_t j = p / m;
+        const int64_t t = p % m;
+        u2k c;
+        if (t == 0) {
+          c = gt[i * P + j - 1];
+        } else if (j == 0) {
+          c = gt_bit(i, 0, t);
+        } else {
+          c = gt_bit(i, j, t) ^ inner[i * Q + (j - 1) * (m - 1) + t - 1];
+        }
+        carry |= c << p;
+      }
+      xout[i] = xinp[i] ^ carry;
+    });
+  });
+
+  return out;
+}
+
+}  // namespace spu::mpc::cheetah
@@ -0,0 +1,65 @@
+// Copyright 2024 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+
+#include "libspu/core/ndarray_ref.h"
+
+namespace spu::mpc::cheetah {
+
+class BasicOTProtocols;
+
+// clang-format off
+// [x]_B <- A2B([x]_A) for two parties.
+//
+// Math:
+//   1. x = x0 + x1 mod 2^k, then the i-th bit of x is x0_i ^ x1_i ^ c_i where
+//      the carry c_i = 1{x0[0:i) + x1[0:i) >= 2^i} = 1{x0[0:i) > ~x1[0:i)}.
+//      That is, every carry is a millionaire comparison on the low bits.
+//   2. Break a = x0 and b = ~x1 into digits of `radix` bits. One 1-of-2^{radix}
+//      OT per digit gives the shares of gt_t = 1{a_j[0:t) > b_j[0:t)} and
+//      eq_t = 1{a_j[0:t) = b_j[0:t)} for every t in [1, radix] at once.
+//   3. The carries into the digits C_j are the prefixes of the comparison tree
+//      C_{j+1} = gt_radix(j) ^ eq_radix(j) & C_j, computed with a parallel
+//      prefix (Kogge-Stone) over the digits in log2(k / radix) AND rounds.
+//   4. The carries inside a digit c_{j*radix+t} = gt_t(j) ^ eq_t(j) & C_j
+//      take a single AND round.
+//
+// Compared to a boolean adder over the XOR shares, this uses the same leaves
+// as CompareProtocol and 1-bit ANDs only.
+// clang-format on
+class A2BProtocol {
+ public:
+  // REQUIRE 1 <= radix <= 4
+  explicit A2BProtocol(const std::shared_ptr<BasicOTProtocols>& base,
+                       size_t radix = 4);
+
+  ~A2BProtocol();
+
+  // The party rank that provides the choices of the leaf OTs.
+  static constexpr int ChoiceProvider() { return 1; }
+
+  // Input: the arithmetic share.
+  // Output: the boolean share of the same field.
+  NdArrayRef Compute(const NdArrayRef& inp);
+
+ private:
+  size_t radix_;
+  bool is_sender_{false};
+  std::shared_ptr<BasicOTProtocols> basic_ot_prot_;
+};
+
+}  // namespace spu::mpc::cheetah
@@ -0,0 +1,90 @@
+// Copyright 2024 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libspu/mpc/cheetah/nonlinear/a2b_prot.h"
+
+#include "gtest/gtest.h"
+
+#include "libspu/mpc/cheetah/ot/basic_ot_prot.h"
+#include "libspu/mpc/cheetah/type.h"
+#include "libspu/mpc/utils/ring_ops.h"
+#include "libspu/mpc/utils/simulate.h"
+
+namespace spu::mpc::cheetah {
+
+class A2BProtTest
+    : public ::testing::TestWithParam<std::tuple<FieldType, size_t>> {};
+
+INSTANTIATE_TEST_SUITE_P(
+    Cheetah, A2BProtTest,
+    testing::Combine(testing::Values(FieldType::FM32, FieldType::FM64,
+                                     FieldType::FM128),
+                     testing::Values(1UL, 3UL, 4UL)),  // 3 does not divide k
+    [](const testing::TestParamInfo<A2BProtTest::ParamType> &p) {
+      return fmt::format("{}Radix{}", std::get<0>(p.param),
+                         (int)std::get<1>(p.param));
+    });
+
+TEST_P(A2BProtTest, Basic) {
+  size_t kWorldSize = 2;
+  Shape shape = {11, 3, 5};
+  FieldType field = std::get<0>(GetParam());
+  size_t radix = std::get<1>(GetParam());
+
+  NdArrayRef inp[2];
+  inp[0] = ring_rand(field, shape);
+  inp[1] = ring_rand(field, shape);
+
+  DISPATCH_ALL_FIELDS(field, "", [&]() {
+    auto xinp0 = NdArrayView<ring2k_t>(inp[0]);
+    auto xinp1 = NdArrayView<ring2k_t>(inp[1]);
+    // all carries
+    xinp0[0] = static_cast<ring2k_t>(-1);
+    xinp1[0] = 1;
+    // no carry
+    xinp0[1] = 0;
+    xinp1[1] = static_cast<ring2k_t>(-1);
+    // negative values
+    xinp0[2] = static_cast<ring2k_t>(-5);
+    xinp1[2] = 2;
+  });
+
+  NdArrayRef oup[2];
+  utils::simulate(kWorldSize, [&](std::shared_ptr<yacl::link::Context> ctx) {
+    auto conn = std::make_shared<Communicator>(ctx);
+    int rank = ctx->Rank();
+    auto base = std::make_shared<BasicOTProtocols>(
+        conn, CheetahOtKind::YACL_Softspoken);
+    A2BProtocol a2b_prot(base, radix);
+    oup[rank] = a2b_prot.Compute(inp[rank]);
+  });
+
+  EXPECT_EQ(oup[0].shape(), shape);
+  EXPECT_TRUE(oup[0].eltype().isa<BShrTy>());
+
+  DISPATCH_ALL_FIELDS(field, "", [&]() {
+    auto xout0 = NdArrayView<ring2k_t>(oup[0]);
+    auto xout1 = NdArrayView<ring2k_t>(oup[1]);
+    auto xinp0 = NdArrayView<ring2k_t>(inp[0]);
+    auto xinp1 = NdArrayView<ring2k_t>(inp[1]);
+
+    for (int64_t i = 0; i < shape.numel(); ++i) {
+      ring2k_t expected = xinp0[i] + xinp1[i];
+      ring2k_t got = xout0[i] ^ xout1[i];
+      ASSERT_EQ(expected, got) << i;
+    }
+  });
+}
+
+}  // namespace spu::mpc::cheetah
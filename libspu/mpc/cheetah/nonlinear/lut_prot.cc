@@ -0,0 +1,194 @@
+// Copyright 2024 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libspu/mpc/cheetah/nonlinear/lut_prot.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "yacl/base/int128.h"
+#include "yacl/crypto/tools/crhash.h"
+
+#include "libspu/core/parallel_utils.h"
+#include "libspu/core/prelude.h"
+#include "libspu/core/type.h"
+#include "libspu/mpc/cheetah/ot/basic_ot_prot.h"
+#include "libspu/mpc/utils/ring_ops.h"
+
+namespace spu::mpc::cheetah {
+
+LookUpTableProtocol::LookUpTableProtocol(
+    const std::shared_ptr<BasicOTProtocols> &base)
+    : basic_ot_prot_(base) {
+  SPU_ENFORCE(base != nullptr);
+}
+
+NdArrayRef LookUpTableProtocol::Compute(const NdArrayRef &inp,
+                                        const NdArrayRef &table, size_t shift,
+                                        size_t index_bits) {
+  const auto field = inp.eltype().as<Ring2k>()->field();
+  const size_t bw = SizeOf(field) * 8;
+  SPU_ENFORCE(index_bits >= 1 && index_bits <= kMaxIndexBits,
+              "index_bits={} out of range", index_bits);
+  SPU_ENFORCE(shift + index_bits <= bw, "shift={} index_bits={} exceed {}",
+              shift, index_bits, bw);
+  SPU_ENFORCE_EQ(table.eltype().as<Ring2k>()->field(), field);
+  SPU_ENFORCE(table.shape().ndim() == 2 &&
+                  table.shape()[0] == (1LL << index_bits),
+              "table of shape {} mismatch index_bits={}", table.shape(),
+              index_bits);
+
+  const int64_t numel = inp.numel();
+  const int64_t ncols = table.shape()[1];
+  const int64_t N = 1LL << index_bits;
+  const int rank = basic_ot_prot_->Rank();
+
+  if (numel == 0 || ncols == 0) {
+    return ring_zeros(field, {numel, ncols}).as(inp.eltype());
+  }
+
+  // The i-th element runs one 1-of-N OT built from logN random 1-of-2 OTs
+  // (s_{0,k}, s_{1,k}), see "Oblivious transfer and polynomial evaluation".
+  // The message M_j of all the ncols columns is masked by the pads
+  //   P_j = \xor_k H(s_{j_k,k} ^ <j mod 2^{k+1}, b>) for the 128-bit blocks b
+  // so the receiver who knows s_{d1_k,k} can only unmask M_{d1}.
+  const size_t logN = index_bits;
+  const int64_t epb = 128 / static_cast<int64_t>(bw);
+  const int64_t nblk = (ncols + epb - 1) / epb;
+  const int64_t nkeys = numel * static_cast<int64_t>(logN);
+
+  // Tweak of the level k and the low k+1 bits p of the choice.
+  auto tweak = [&](size_t k, size_t p, int64_t b) {
+    return yacl::MakeUint128((static_cast<uint64_t>(2) << k) | p,
+                             static_cast<uint64_t>(b));
+  };
+
+  auto conn = basic_ot_prot_->GetConn();
+  NdArrayRef out;
+
+  DISPATCH_ALL_FIELDS(field, "lut", [&]() {
+    using u2k = std::make_unsigned<ring2k_t>::type;
+    NdArrayView<const u2k> xinp(inp);
+    const u2k msk = static_cast<u2k>(N - 1);
+
+    auto unpack = [&](const uint128_t *pad, int64_t c) {
+      return static_cast<u2k>(pad[c / epb] >> (bw * (c % epb)));
+    };
+
+    if (rank == 0) {
+      std::vector<uint128_t> s0(nkeys);
+      std::vector<uint128_t> s1(nkeys);
+      auto sender = basic_ot_prot_->GetSenderCOT();
+      sender->SendRMCC(absl::MakeSpan(s0), absl::MakeSpan(s1), 128);
+      sender->Flush();
+
+      out = ring_rand(field, {numel, ncols});
+      NdArrayView<const u2k> xtbl(table);
+      NdArrayView<const u2k> xrnd(out);
+
+      std::vector<u2k> send(numel * N * ncols);
+      pforeach(0, numel, [&](int64_t bgn, int64_t end) {
+        // hash[(2^{k+1} - 2 + p) * nblk + b] for the level k and prefix p
+        std::vector<uint128_t> hash(2 * (N - 1) * nblk);
+        std::vector<uint128_t> pad(nblk);
+        for (int64_t i = bgn; i < end; ++i) {
+          const uint128_t *keys[2] = {s0.data() + i * logN,
+                                      s1.data() + i * logN};
+          auto *h = hash.data();
+          for (size_t k = 0; k < logN; ++k) {
+            for (size_t p = 0; p < (2UL << k); ++p) {
+              uint128_t key = keys[(p >> k) & 1][k];
+              for (int64_t b = 0; b < nblk; ++b) {
+                *h++ = key ^ tweak(k, p, b);
+              }
+            }
+          }
+          yacl::crypto::ParaCrHashInplace_128(absl::MakeSpan(hash));
+
+          u2k d0 = (xinp[i] >> shift) & msk;
+          for (int64_t j = 0; j < N; ++j) {
+            std::fill(pad.begin(), pad.end(), 0);
+            for (size_t k = 0; k < logN; ++k) {
+              size_t p = j & ((2UL << k) - 1);
+              const auto *hk = hash.data() + ((2UL << k) - 2 + p) * nblk;
+              for (int64_t b = 0; b < nblk; ++b) {
+                pad[b] ^= hk[b];
+              }
+            }
+
+            u2k row = (d0 + static_cast<u2k>(j)) & msk;
+            u2k *msg = send.data() + (i * N + j) * ncols;
+            for (int64_t c = 0; c < ncols; ++c) {
+              msg[c] = (xtbl[row * ncols + c] - xrnd[i * ncols + c]) ^
+                       unpack(pad.data(), c);
+            }
+          }
+        }
+      });
+
+      conn->sendAsync<u2k>(conn->nextRank(), absl::MakeConstSpan(send),
+                           "lut");
+    } else {
+      std::vector<uint8_t> choices(nkeys);
+      pforeach(0, numel, [&](int64_t i) {
+        auto d1 = static_cast<size_t>((xinp[i] >> shift) & msk);
+        for (size_t k = 0; k < logN; ++k) {
+          choices[i * logN + k] = (d1 >> k) & 1;
+        }
+      });
+
+      std::vector<uint128_t> keys(nkeys);
+      auto receiver = basic_ot_prot_->GetReceiverCOT();
+      receiver->RecvRMCC(absl::MakeConstSpan(choices), absl::MakeSpan(keys),
+                         128);
+      receiver->Flush();
+
+      auto recv = conn->recv<u2k>(conn->nextRank(), "lut");
+      SPU_ENFORCE_EQ(recv.size(), static_cast<size_t>(numel * N * ncols));
+
+      out = ring_zeros(field, {numel, ncols});
+      NdArrayView<u2k> xout(out);
+      pforeach(0, numel, [&](int64_t bgn, int64_t end) {
+        std::vector<uint128_t> pad(nblk);
+        std::vector<uint128_t> hash(logN * nblk);
+        for (int64_t i = bgn; i < end; ++i) {
+          auto d1 = static_cast<size_t>((xinp[i] >> shift) & msk);
+          for (size_t k = 0; k < logN; ++k) {
+            size_t p = d1 & ((2UL << k) - 1);
+            for (int64_t b = 0; b < nblk; ++b) {
+              hash[k * nblk + b] = keys[i * logN + k] ^ tweak(k, p, b);
+            }
+          }
+          yacl::crypto::ParaCrHashInplace_128(absl::MakeSpan(hash));
+
+          std::fill(pad.begin(), pad.end(), 0);
+          for (size_t k = 0; k < logN; ++k) {
+            for (int64_t b = 0; b < nblk; ++b) {
+              pad[b] ^= hash[k * nblk + b];
+            }
+          }
+
+          const u2k *msg = recv.data() + (i * N + d1) * ncols;
+          for (int64_t c = 0; c < ncols; ++c) {
+            xout[i * ncols + c] = msg[c] ^ unpack(pad.data(), c);
+          }
+        }
+      });
+    }
+  });
+
+  return out.as(inp.eltype());
+}
+
+}  // namespace spu::mpc::cheetah
@@ -0,0 +1,61 @@
+// Copyright 2024 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+
+#include "libspu/core/ndarray_ref.h"
+
+namespace spu::mpc::cheetah {
+
+class BasicOTProtocols;
+
+// REF: SIRNN: A Math Library for Secure RNN Inference
+//  https://eprint.iacr.org/2021/459.pdf
+//
+// [T[d]]_A <- LUT([x]_A, T) for a public table T of 2^m rows.
+//
+// Math:
+//   Given x = x0 + x1 mod 2^k, each party takes the local digit
+//     d0 = (x0 >> s) mod 2^m, d1 = (x1 >> s) mod 2^m
+//   The sender (rank 0) samples r and prepares 2^m messages
+//     M_j = T[(d0 + j) mod 2^m] - r for j \in [0, 2^m)
+//   and the receiver (rank 1) obtains M_{d1} via one 1-of-2^m OT.
+//   Then r + M_{d1} = T[d0 + d1 mod 2^m].
+//
+// NOTE: d0 + d1 equals to the digit (x >> s) mod 2^m or one less of it,
+// depending on the carry from the lower s bits which is not computed.
+// Each row of T can carry several columns. The columns of M_j are sent as
+// one message of C * k bits, so each element costs one 1-of-2^m OT, i.e.,
+// m random 1-of-2 OTs, whatever the number of columns C.
+class LookUpTableProtocol {
+ public:
+  // REQUIRE 1 <= index_bits <= 8.
+  static constexpr size_t kMaxIndexBits = 8;
+
+  explicit LookUpTableProtocol(const std::shared_ptr<BasicOTProtocols> &base);
+
+  ~LookUpTableProtocol() = default;
+
+  // table: public ring elements of shape {2^index_bits, C}
+  // Return the shares of shape {inp.numel(), C}
+  NdArrayRef Compute(const NdArrayRef &inp, const NdArrayRef &table,
+                     size_t shift, size_t index_bits);
+
+ private:
+  std::shared_ptr<BasicOTProtocols> basic_ot_prot_ = nullptr;
+};
+
+}  // namespace spu::mpc::cheetah
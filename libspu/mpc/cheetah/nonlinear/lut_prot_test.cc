@@ -0,0 +1,91 @@
+// Copyright 2024 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libspu/mpc/cheetah/nonlinear/lut_prot.h"
+
+#include "gtest/gtest.h"
+
+#include "libspu/core/ndarray_ref.h"
+#include "libspu/core/type_util.h"
+#include "libspu/mpc/cheetah/ot/basic_ot_prot.h"
+#include "libspu/mpc/utils/ring_ops.h"
+#include "libspu/mpc/utils/simulate.h"
+
+namespace spu::mpc::cheetah {
+
+class LookUpTableProtocolTest
+    : public ::testing::TestWithParam<std::tuple<FieldType, size_t, int64_t>> {
+};
+
+INSTANTIATE_TEST_SUITE_P(
+    Cheetah, LookUpTableProtocolTest,
+    testing::Combine(testing::Values(FieldType::FM32, FieldType::FM64,
+                                     FieldType::FM128),
+                     testing::Values(1UL, 4UL, 8UL),
+                     testing::Values(1L, 3L)),
+    [](const testing::TestParamInfo<LookUpTableProtocolTest::ParamType> &p) {
+      return fmt::format("{}Bits{}Cols{}", std::get<0>(p.param),
+                         std::get<1>(p.param), std::get<2>(p.param));
+    });
+
+TEST_P(LookUpTableProtocolTest, Basic) {
+  size_t kWorldSize = 2;
+  Shape shape = {10, 11};
+  FieldType field = std::get<0>(GetParam());
+  size_t index_bits = std::get<1>(GetParam());
+  int64_t ncols = std::get<2>(GetParam());
+  size_t shift = SizeOf(field) * 8 - index_bits - 3;
+
+  NdArrayRef inp[2];
+  inp[0] = ring_rand(field, shape);
+  inp[1] = ring_rand(field, shape);
+  NdArrayRef table = ring_rand(field, {1L << index_bits, ncols});
+
+  NdArrayRef oup[2];
+  utils::simulate(kWorldSize, [&](std::shared_ptr<yacl::link::Context> ctx) {
+    int rank = ctx->Rank();
+    auto conn = std::make_shared<Communicator>(ctx);
+    auto base = std::make_shared<BasicOTProtocols>(
+        conn, CheetahOtKind::YACL_Softspoken);
+    LookUpTableProtocol prot(base);
+    oup[rank] = prot.Compute(inp[rank], table, shift, index_bits);
+  });
+
+  ASSERT_EQ(oup[0].shape(), (Shape{shape.numel(), ncols}));
+  ASSERT_EQ(oup[1].shape(), (Shape{shape.numel(), ncols}));
+  auto got = ring_add(oup[0], oup[1]);
+  auto x = ring_add(inp[0], inp[1]);
+
+  DISPATCH_ALL_FIELDS(field, "check", [&]() {
+    using u2k = std::make_unsigned<ring2k_t>::type;
+    NdArrayView<u2k> xinp0(inp[0]);
+    NdArrayView<u2k> xinp1(inp[1]);
+    NdArrayView<u2k> xx(x);
+    NdArrayView<u2k> xgot(got);
+    NdArrayView<u2k> xtbl(table);
+    const u2k msk = (static_cast<u2k>(1) << index_bits) - 1;
+
+    for (int64_t i = 0; i < shape.numel(); ++i) {
+      u2k row = ((xinp0[i] >> shift) + (xinp1[i] >> shift)) & msk;
+      // the digit of x or one less of it
+      u2k digit = (xx[i] >> shift) & msk;
+      ASSERT_TRUE(row == digit || row == ((digit - 1) & msk));
+      for (int64_t c = 0; c < ncols; ++c) {
+        ASSERT_EQ(xgot[i * ncols + c], xtbl[row * ncols + c]);
+      }
+    }
+  });
+}
+
+}  // namespace spu::mpc::cheetah
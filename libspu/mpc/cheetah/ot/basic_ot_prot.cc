@@ -230,11 +230,14 @@ NdArrayRef BasicOTProtocols::BitwiseAnd(const NdArrayRef &lhs,
   SPU_ENFORCE_EQ(lhs.shape(), rhs.shape());
 
   auto field = lhs.eltype().as<Ring2k>()->field();
-  const auto *shareType = lhs.eltype().as<BShrTy>();
-  auto [a, b, c] = AndTriple(field, lhs.shape(), shareType->nbits());
+  SPU_ENFORCE_EQ(field, rhs.eltype().as<Ring2k>()->field());
+  // Only the low bits that are live in both operands are ANDed. The triples,
+  // the opened messages and the output all stay within these `nbits` bits.
+  const size_t nbits = std::min(lhs.eltype().as<BShrTy>()->nbits(),
+                                rhs.eltype().as<BShrTy>()->nbits());
+  auto [a, b, c] = AndTriple(field, lhs.shape(), nbits);
 
   // open x^a, y^b
-  int nbits = shareType->nbits();
   auto xa = OpenShare(ring_xor(lhs, a), ReduceOp::XOR, nbits, conn_);
   auto yb = OpenShare(ring_xor(rhs, b), ReduceOp::XOR, nbits, conn_);
 
@@ -244,7 +247,7 @@ NdArrayRef BasicOTProtocols::BitwiseAnd(const NdArrayRef &lhs,
     ring_xor_(z, ring_and(xa, yb));
   }
 
-  return z.as(lhs.eltype());
+  return z.as(makeType<BShrTy>(field, nbits));
 }
 
 std::array<NdArrayRef, 2> BasicOTProtocols::CorrelatedBitwiseAnd(
@@ -73,6 +73,8 @@ class BasicOTProtocols {
     return ferret_receiver_;
   }
 
+  std::shared_ptr<Communicator> GetConn() { return conn_; }
+
   void Flush();
 
  protected:
@@ -334,6 +334,45 @@ TEST_P(BasicOTProtTest, BitwiseAnd) {
   });
 }
 
+TEST_P(BasicOTProtTest, BitwiseAndNarrow) {
+  size_t kWorldSize = 2;
+  Shape shape = {55};
+  FieldType field = std::get<0>(GetParam());
+  auto ot_type = std::get<1>(GetParam());
+
+  // A full width lhs against a 3-bit rhs, only the low 3 bits are ANDed.
+  const size_t nbits = 3;
+  NdArrayRef lhs[2];
+  NdArrayRef rhs[2];
+  NdArrayRef out[2];
+  for (int i : {0, 1}) {
+    lhs[i] = ring_rand(field, shape).as(makeType<BShrTy>(field));
+    rhs[i] = ring_rand(field, shape).as(makeType<BShrTy>(field, nbits));
+  }
+
+  utils::simulate(kWorldSize, [&](std::shared_ptr<yacl::link::Context> ctx) {
+    auto conn = std::make_shared<Communicator>(ctx);
+    BasicOTProtocols ot_prot(conn, ot_type);
+    int r = ctx->Rank();
+    out[r] = ot_prot.BitwiseAnd(lhs[r].clone(), rhs[r].clone());
+  });
+
+  EXPECT_EQ(out[0].eltype(), makeType<BShrTy>(field, nbits));
+
+  auto expected = ring_and(ring_xor(lhs[0], lhs[1]), ring_xor(rhs[0], rhs[1]));
+  auto got = ring_xor(out[0], out[1]);
+
+  DISPATCH_ALL_FIELDS(field, "", [&]() {
+    NdArrayView<ring2k_t> e(expected);
+    NdArrayView<ring2k_t> g(got);
+    const auto mask = makeBitsMask<ring2k_t>(nbits);
+
+    for (int64_t i = 0; i < shape.numel(); ++i) {
+      ASSERT_EQ(e[i] & mask, g[i]);
+    }
+  });
+}
+
 TEST_P(BasicOTProtTest, AndTripleFull) {
   size_t kWorldSize = 2;
   Shape shape = {55, 11};
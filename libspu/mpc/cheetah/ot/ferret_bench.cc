@@ -0,0 +1,286 @@
+// Copyright 2024 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Throughput of the ferret OT backends per message type.
+//
+// Both parties run in this process over an in-memory link. The network is
+// simulated from the traffic of every run, i.e.
+//
+//   sim_time = cpu_time + flights * latency + bytes / bandwidth
+//
+// where flights is the number of messages sent by both parties, an upper
+// bound of the sequential one-way trips. Usage:
+//
+//   ferret_bench [--latency_ms=<ms>] [--bandwidth_mbps=<Mbps>]
+//                [--benchmark_* options]
+//
+// The fastest backend of every (primitive, field, n) under the simulated
+// network is printed in the end as csv lines
+// `recommend,<primitive>,<field>,<n>,<kind>`, where n is the number of OTs per
+// call. The kind can be put into CheetahConfig.ot_kind directly.
+
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "yacl/link/test_util.h"
+
+#include "libspu/core/type_util.h"
+#include "libspu/mpc/cheetah/ot/emp/ferret.h"
+#include "libspu/mpc/cheetah/ot/ferret_ot_interface.h"
+#include "libspu/mpc/cheetah/ot/yacl/ferret.h"
+#include "libspu/mpc/common/communicator.h"
+#include "libspu/spu.pb.h"
+
+namespace spu::mpc::cheetah {
+namespace {
+
+// Simulated network, 1ms RTT/2 and 1Gbps by default.
+double latency_ms = 0.5;
+double bandwidth_mbps = 1000.;
+
+enum class Primitive { CAMCC, RMRC, CMCC, Collapse };
+
+// The 1-of-N OT of CMCC, as the leaves of the millionaire with radix 4.
+constexpr size_t kCmccN = 16;
+// The number of levels of Collapse, as in PackedB2A of 8-bit values.
+constexpr int kCollapseLevels = 8;
+
+const char* PrimitiveName(Primitive prim) {
+  switch (prim) {
+    case Primitive::CAMCC:
+      return "CAMCC";
+    case Primitive::RMRC:
+      return "RMRC";
+    case Primitive::CMCC:
+      return "CMCC";
+    case Primitive::Collapse:
+      return "Collapse";
+  }
+  return "Unknown";
+}
+
+std::unique_ptr<FerretOtInterface> MakeFerret(
+    CheetahOtKind kind, const std::shared_ptr<Communicator>& conn,
+    bool is_sender) {
+  if (kind == CheetahOtKind::EMP_Ferret) {
+    return std::make_unique<EmpFerretOt>(conn, is_sender);
+  }
+  return std::make_unique<YaclFerretOt>(
+      conn, is_sender, kind == CheetahOtKind::YACL_Softspoken);
+}
+
+// A connected pair of OT instances, rank 0 sends and rank 1 receives.
+struct FerretPair {
+  std::vector<std::shared_ptr<yacl::link::Context>> lctxs;
+  std::unique_ptr<FerretOtInterface> sender;
+  std::unique_ptr<FerretOtInterface> receiver;
+
+  explicit FerretPair(CheetahOtKind kind) {
+    lctxs = yacl::link::test::SetupWorld("ferret_bench", 2);
+    // The base OTs of both sides run together.
+    auto recv = std::async(std::launch::async, [&]() {
+      return MakeFerret(kind, std::make_shared<Communicator>(lctxs[1]), false);
+    });
+    sender = MakeFerret(kind, std::make_shared<Communicator>(lctxs[0]), true);
+    receiver = recv.get();
+  }
+
+  size_t SentBytes() const {
+    return lctxs[0]->GetStats()->sent_bytes.load() +
+           lctxs[1]->GetStats()->sent_bytes.load();
+  }
+
+  size_t SentActions() const {
+    return lctxs[0]->GetStats()->sent_actions.load() +
+           lctxs[1]->GetStats()->sent_actions.load();
+  }
+};
+
+template <typename T>
+void RunOnce(Primitive prim, FerretPair& pair, int64_t n) {
+  std::mt19937_64 rdv(n);
+  std::vector<T> msg(prim == Primitive::CMCC ? n * kCmccN : n);
+  std::vector<T> out0(n);
+  std::vector<T> out1(n);
+  std::vector<uint8_t> choices(n);
+  for (auto& m : msg) {
+    m = static_cast<T>(rdv());
+  }
+  for (auto& c : choices) {
+    c = static_cast<uint8_t>(rdv() % (prim == Primitive::CMCC ? kCmccN : 2));
+  }
+  const int bw = sizeof(T) * 8;
+
+  auto recv = std::async(std::launch::async, [&]() {
+    auto* ot = pair.receiver.get();
+    switch (prim) {
+      case Primitive::CAMCC:
+        ot->RecvCAMCC(absl::MakeConstSpan(choices), absl::MakeSpan(out1));
+        break;
+      case Primitive::RMRC:
+        ot->RecvRMRC(absl::MakeSpan(choices), absl::MakeSpan(out1));
+        break;
+      case Primitive::CMCC:
+        ot->RecvCMCC(absl::MakeConstSpan(choices), kCmccN,
+                     absl::MakeSpan(out1));
+        break;
+      case Primitive::Collapse:
+        ot->RecvCAMCC_Collapse(absl::MakeConstSpan(choices),
+                               absl::MakeSpan(out1), bw, kCollapseLevels);
+        break;
+    }
+  });
+
+  auto* ot = pair.sender.get();
+  switch (prim) {
+    case Primitive::CAMCC:
+      ot->SendCAMCC(absl::MakeConstSpan(msg), absl::MakeSpan(out0));
+      break;
+    case Primitive::RMRC:
+      ot->SendRMRC(absl::MakeSpan(out0), absl::MakeSpan(msg));
+      break;
+    case Primitive::CMCC:
+      ot->SendCMCC(absl::MakeConstSpan(msg), kCmccN);
+      break;
+    case Primitive::Collapse:
+      ot->SendCAMCC_Collapse(absl::MakeConstSpan(msg), absl::MakeSpan(out0),
+                             bw, kCollapseLevels);
+      break;
+  }
+  ot->Flush();
+  recv.get();
+}
+
+// (primitive, field, n) -> kind -> simulated OTs per second
+std::mutex results_mutex;
+std::map<std::tuple<std::string, FieldType, int64_t>,
+         std::map<CheetahOtKind, double>>
+    results;
+
+void BM_FerretOt(benchmark::State& state, Primitive prim) {
+  const auto kind = static_cast<CheetahOtKind>(state.range(0));
+  const auto field = static_cast<FieldType>(state.range(1));
+  const int64_t n = state.range(2);
+
+  FerretPair pair(kind);
+  const size_t bytes0 = pair.SentBytes();
+  const size_t actions0 = pair.SentActions();
+
+  double cpu_seconds = 0;
+  for (auto _ : state) {
+    const auto start = std::chrono::steady_clock::now();
+    DISPATCH_ALL_FIELDS(field, "ferret_bench", [&]() {
+      using T = std::make_unsigned_t<ring2k_t>;
+      RunOnce<T>(prim, pair, n);
+    });
+    cpu_seconds += std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  }
+
+  const double iters = static_cast<double>(state.iterations());
+  const double bytes = static_cast<double>(pair.SentBytes() - bytes0);
+  const double flights = static_cast<double>(pair.SentActions() - actions0);
+  const double sim_seconds = cpu_seconds + flights * latency_ms * 1e-3 +
+                             bytes * 8 / (bandwidth_mbps * 1e6);
+  const double sim_ots_per_sec = iters * n / sim_seconds;
+
+  state.counters["OTs/s"] = benchmark::Counter(
+      static_cast<double>(n), benchmark::Counter::kIsIterationInvariantRate);
+  state.counters["bytes/OT"] = bytes / (iters * n);
+  state.counters["flights"] = flights / iters;
+  state.counters["sim_OTs/s"] = sim_ots_per_sec;
+  state.SetLabel(fmt::format("{}/{}", CheetahOtKind_Name(kind), field));
+
+  std::lock_guard guard(results_mutex);
+  results[{PrimitiveName(prim), field, n}][kind] = sim_ots_per_sec;
+}
+
+void MakeArgs(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"kind", "field", "n"});
+  b->ArgsProduct({
+      {CheetahOtKind::YACL_Ferret, CheetahOtKind::YACL_Softspoken,
+       CheetahOtKind::EMP_Ferret},
+      {FM32, FM64, FM128},
+      {1 << 16, 1 << 20},
+  });
+  b->Unit(benchmark::kMillisecond);
+  b->UseRealTime();
+}
+
+BENCHMARK_CAPTURE(BM_FerretOt, CAMCC, Primitive::CAMCC)->Apply(MakeArgs);
+BENCHMARK_CAPTURE(BM_FerretOt, RMRC, Primitive::RMRC)->Apply(MakeArgs);
+BENCHMARK_CAPTURE(BM_FerretOt, CMCC, Primitive::CMCC)->Apply(MakeArgs);
+BENCHMARK_CAPTURE(BM_FerretOt, Collapse, Primitive::Collapse)->Apply(MakeArgs);
+
+void PrintRecommendation() {
+  std::cout << "# simulated network: latency=" << latency_ms
+            << "ms, bandwidth=" << bandwidth_mbps << "Mbps\n";
+  for (const auto& [key, by_kind] : results) {
+    auto best = by_kind.begin();
+    for (auto it = by_kind.begin(); it != by_kind.end(); ++it) {
+      if (it->second > best->second) {
+        best = it;
+      }
+    }
+    std::cout << fmt::format("recommend,{},{},{},{}\n", std::get<0>(key),
+                             std::get<1>(key), std::get<2>(key),
+                             CheetahOtKind_Name(best->first));
+  }
+}
+
+// Takes `--name=value` out of argv.
+bool ParseFlag(const char* arg, const char* name, double* value) {
+  const auto len = std::strlen(name);
+  if (std::strncmp(arg, name, len) != 0 || arg[len] != '=') {
+    return false;
+  }
+  *value = std::stod(arg + len + 1);
+  return true;
+}
+
+}  // namespace
+}  // namespace spu::mpc::cheetah
+
+int main(int argc, char** argv) {
+  using namespace spu::mpc::cheetah;
+
+  int num_args = 0;
+  for (int i = 0; i < argc; ++i) {
+    if (i > 0 && (ParseFlag(argv[i], "--latency_ms", &latency_ms) ||
+                  ParseFlag(argv[i], "--bandwidth_mbps", &bandwidth_mbps))) {
+      continue;
+    }
+    argv[num_args++] = argv[i];
+  }
+
+  benchmark::Initialize(&num_args, argv);
+  if (benchmark::ReportUnrecognizedArguments(num_args, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  PrintRecommendation();
+  return 0;
+}
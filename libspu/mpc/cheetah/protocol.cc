@@ -67,8 +67,9 @@ void regCheetahProtocol(SPUContext* ctx,
                   cheetah::AddAP, cheetah::AddAA,                           //
                   cheetah::MulAP, cheetah::MulAA, cheetah::MulAV,           //
                   cheetah::SquareA,                                         //
-                  cheetah::MulA1B, cheetah::MulA1BV,                        //
+                  cheetah::MulA1B, cheetah::MulA1BV, cheetah::MuxA1B,       //
                   cheetah::EqualAA, cheetah::EqualAP,                       //
+                  cheetah::LutAP,                                           //
                   cheetah::MatMulAP, cheetah::MatMulAA, cheetah::MatMulAV,  //
                   cheetah::MatMulVVS,                                       //
                   cheetah::BatchMatMulAA,                                   //
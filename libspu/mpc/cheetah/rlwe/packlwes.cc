@@ -24,7 +24,6 @@
 #include "seal/util/polyarithsmallmod.h"
 #include "seal/util/rlwe.h"
 #include "seal/valcheck.h"
-#include "yacl/utils/parallel.h"
 
 #include "libspu/core/parallel_utils.h"
 #include "libspu/core/prelude.h"
@@ -120,7 +119,7 @@ void PackingHelper::doPackingRLWEs(absl::Span<RLWECt> rlwes,
   SPU_ENFORCE(num_ct > 0 && num_ct <= (int)gap_,
               fmt::format("invalid #rlwes = {} for gap = {}", num_ct, gap_));
 
-  yacl::parallel_for(0, num_ct, [&](int64_t bgn, int64_t end) {
+  pforeach(0, num_ct, 1, [&](int64_t bgn, int64_t end) {
     for (int64_t i = bgn; i < end; ++i) {
       InvNttInplace(rlwes[i], context_, true);
       // multiply gap^{-1} mod Q
@@ -135,7 +134,7 @@ void PackingHelper::doPackingRLWEs(absl::Span<RLWECt> rlwes,
   const int64_t logn = absl::bit_width(gap_) - 1;
   for (int64_t k = logn; k >= 1; --k) {
     int64_t h = 1 << (k - 1);
-    yacl::parallel_for(0, h, [&](int64_t bgn, int64_t end) {
+    pforeach(0, h, 1, [&](int64_t bgn, int64_t end) {
       RLWECt dummy;  // zero-padding with zero RLWE
       for (int64_t i = bgn; i < end; ++i) {
         // E' <- E + X^k*O + Auto(E - X^k*O, k')
@@ -304,7 +303,7 @@ static void doPackingLWEs(absl::Span<RLWECt> rlwes, const GaloisKeys &galois,
     };
 
     if (h > 0) {
-      yacl::parallel_for(0, h, merge_callback);
+      pforeach(0, h, 1, merge_callback);
     }
   }
 
@@ -346,7 +345,7 @@ static void doPackLWEs(absl::Span<const LWEType> lwes, const GaloisKeys &galois,
 
   // Step 1: cast all LWEs to RLWEs
   std::vector<RLWECt> rlwes(num_lwes);
-  yacl::parallel_for(0, num_lwes, [&](size_t start, size_t end) {
+  pforeach(0, num_lwes, 1, [&](size_t start, size_t end) {
     for (size_t i = start; i < end; ++i) {
       lwes[i].CastAsRLWE(context, poly_degree, &rlwes[i]);
     }
@@ -20,6 +20,14 @@
 
 namespace spu::mpc::cheetah {
 
+// The Dispatch* functions below run every OT slice on its own std::async
+// thread instead of the runtime ThreadPool. A slice talks to the peer over
+// its own OT channel and mostly blocks on the network, so it should not hold
+// a compute worker; loops nested in a pool task also run inline, which would
+// serialize the compute inside the slice, and the pool size would cap the
+// number of channels in flight. The loops inside a slice still run on the
+// runtime pool via ThreadPoolScope.
+
 namespace {
 // Return num_workers for the given size of jobs
 size_t InitOTState(KernelEvalContext* ctx, size_t njobs) {
@@ -62,6 +70,7 @@ NdArrayRef DispatchUnaryFunc(KernelEvalContext* ctx, const NdArrayRef& x,
     auto slice_input = x.slice({slice_bgn}, {slice_end}, {});
     futures.emplace_back(std::async(
         [&](int64_t idx, const NdArrayRef& input) {
+          ThreadPoolScope scope(ctx->sctx()->threadPool());
           auto ot_instance = ctx->getState<CheetahOTState>()->get(idx);
           outs[idx] = func(input, ot_instance);
         },
@@ -115,6 +124,7 @@ NdArrayRef DispatchBinaryFunc(KernelEvalContext* ctx, const NdArrayRef& x,
     auto y_slice = y.slice({slice_bgn}, {slice_end}, {1});
     futures.emplace_back(std::async(
         [&](int64_t idx, const NdArrayRef& inp0, const NdArrayRef& inp1) {
+          ThreadPoolScope scope(ctx->sctx()->threadPool());
           auto ot_instance = ctx->getState<CheetahOTState>()->get(idx);
           outs[idx] = func(inp0, inp1, ot_instance);
         },
@@ -183,6 +193,7 @@ NdArrayRef DispatchUnaryFuncWithBatchedInput(KernelEvalContext* ctx,
     auto x_slice = x.slice({sidx}, {eidx}, {});
     futures.emplace_back(std::async(
         [&](int64_t idx, const NdArrayRef& input0) {
+          ThreadPoolScope scope(ctx->sctx()->threadPool());
           auto ot_instance = ctx->getState<CheetahOTState>()->get(idx);
           outs[idx] = func(input0, ot_instance);
         },
@@ -249,6 +260,7 @@ NdArrayRef DispatchBinaryFuncWithBatchedInput(KernelEvalContext* ctx,
 
     futures.emplace_back(std::async(
         [&](int64_t idx, const NdArrayRef& input0, const NdArrayRef& input1) {
+          ThreadPoolScope scope(ctx->sctx()->threadPool());
           auto ot_instance = ctx->getState<CheetahOTState>()->get(idx);
           outs[idx] = func(input0, input1, ot_instance);
         },
@@ -294,6 +306,7 @@ NdArrayRef TiledDispatchOTFunc(KernelEvalContext* ctx,
     auto slice_input = x.subspan(slice_bgn, slice_end - slice_bgn);
     futures.emplace_back(std::async(
         [&](int64_t idx, absl::Span<const uint8_t> input) {
+          ThreadPoolScope scope(ctx->sctx()->threadPool());
           auto ot_instance = ctx->getState<CheetahOTState>()->get(idx);
           outs[idx] = func(input, ot_instance);
         },
@@ -349,6 +362,7 @@ NdArrayRef TiledDispatchOTFunc(KernelEvalContext* ctx, const NdArrayRef& x,
     futures.emplace_back(std::async(
         [&](int64_t idx, const NdArrayRef& inp0,
             absl::Span<const uint8_t> inp1) {
+          ThreadPoolScope scope(ctx->sctx()->threadPool());
           auto ot_instance = ctx->getState<CheetahOTState>()->get(idx);
           outs[idx] = func(inp0, inp1, ot_instance);
         },
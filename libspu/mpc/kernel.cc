@@ -62,6 +62,19 @@ void BinaryKernel::evaluate(KernelEvalContext* ctx) const {
   ctx->pushOutput(WrapValue(z));
 }
 
+void TernaryKernel::evaluate(KernelEvalContext* ctx) const {
+  const auto& x = ctx->getParam<Value>(0);
+  const auto& y = ctx->getParam<Value>(1);
+  const auto& z = ctx->getParam<Value>(2);
+
+  SPU_ENFORCE(x.shape() == y.shape() && x.shape() == z.shape(),
+              "shape mismatch {} {} {}", x.shape(), y.shape(), z.shape());
+
+  auto res = proc(ctx, UnwrapValue(x), UnwrapValue(y), UnwrapValue(z));
+
+  ctx->pushOutput(WrapValue(res));
+}
+
 void MatmulKernel::evaluate(KernelEvalContext* ctx) const {
   const auto& lhs = ctx->getParam<Value>(0);
   const auto& rhs = ctx->getParam<Value>(1);
@@ -134,6 +147,23 @@ void PermKernel::evaluate(KernelEvalContext* ctx) const {
   ctx->pushOutput(WrapValue(z));
 }
 
+void TableLookupKernel::evaluate(KernelEvalContext* ctx) const {
+  const auto& in = ctx->getParam<Value>(0);
+  const auto& table = ctx->getParam<Value>(1);
+  auto shift = ctx->getParam<size_t>(2);
+  auto index_bits = ctx->getParam<size_t>(3);
+
+  SPU_ENFORCE(table.shape().size() == 2, "table should be 2D, got {}",
+              table.shape());
+  SPU_ENFORCE(index_bits < 64 && table.shape()[0] == (1LL << index_bits),
+              "table of shape {} mismatch index_bits={}", table.shape(),
+              index_bits);
+
+  auto res = proc(ctx, UnwrapValue(in), UnwrapValue(table), shift, index_bits);
+
+  ctx->pushOutput(WrapValue(res));
+}
+
 void GenInvPermKernel::evaluate(KernelEvalContext* ctx) const {
   const auto& in = ctx->getParam<Value>(0);
   bool is_ascending = ctx->getParam<bool>(1);
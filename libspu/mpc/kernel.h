@@ -52,6 +52,13 @@ class BinaryKernel : public Kernel {
                           const NdArrayRef& rhs) const = 0;
 };
 
+class TernaryKernel : public Kernel {
+ public:
+  void evaluate(KernelEvalContext* ctx) const override;
+  virtual NdArrayRef proc(KernelEvalContext* ctx, const NdArrayRef& x,
+                          const NdArrayRef& y, const NdArrayRef& z) const = 0;
+};
+
 class MatmulKernel : public Kernel {
  public:
   void evaluate(KernelEvalContext* ctx) const override;
@@ -141,6 +148,16 @@ class OramReadKernel : public Kernel {
                           const NdArrayRef& db, int64_t offset) const = 0;
 };
 
+class TableLookupKernel : public Kernel {
+ public:
+  void evaluate(KernelEvalContext* ctx) const override;
+
+  // ret[..., c] = table[(in >> shift) mod 2^index_bits, c]
+  virtual NdArrayRef proc(KernelEvalContext* ctx, const NdArrayRef& in,
+                          const NdArrayRef& table, size_t shift,
+                          size_t index_bits) const = 0;
+};
+
 class GenInvPermKernel : public Kernel {
  public:
   void evaluate(KernelEvalContext* ctx) const override;
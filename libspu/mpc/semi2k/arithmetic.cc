@@ -76,7 +76,7 @@ NdArrayRef A2V::proc(KernelEvalContext* ctx, const NdArrayRef& in,
   return DISPATCH_ALL_FIELDS(field, "_", [&]() {
     std::vector<ring2k_t> share(numel);
     NdArrayView<ring2k_t> _in(in);
-    pforeach(0, numel, [&](int64_t idx) { share[idx] = _in[idx]; });
+    SPU_PFOREACH(0, numel, 1, [&](int64_t idx) { share[idx] = _in[idx]; });
 
     std::vector<std::vector<ring2k_t>> shares =
         comm->gather<ring2k_t>(share, rank, "a2v");  // comm => 1, k
@@ -84,7 +84,7 @@ NdArrayRef A2V::proc(KernelEvalContext* ctx, const NdArrayRef& in,
       SPU_ENFORCE(shares.size() == comm->getWorldSize());
       NdArrayRef out(out_ty, in.shape());
       NdArrayView<ring2k_t> _out(out);
-      pforeach(0, numel, [&](int64_t idx) {
+      SPU_PFOREACH(0, numel, 1, [&](int64_t idx) {
         ring2k_t s = 0;
         for (auto& share : shares) {
           s += share[idx];
@@ -435,7 +435,7 @@ NdArrayRef TruncAPr::proc(KernelEvalContext* ctx, const NdArrayRef& in,
     {
       std::vector<U> x_plus_r(numel);
 
-      pforeach(0, numel, [&](int64_t idx) {
+      SPU_PFOREACH(0, numel, 1, [&](int64_t idx) {
         auto x = _in[idx];
         // handle negative number.
         // assume secret x in [-2^(k-2), 2^(k-2)), by
@@ -450,7 +450,7 @@ NdArrayRef TruncAPr::proc(KernelEvalContext* ctx, const NdArrayRef& in,
       c = comm->allReduce<U, std::plus>(x_plus_r, kBindName);
     }
 
-    pforeach(0, numel, [&](int64_t idx) {
+    SPU_PFOREACH(0, numel, 1, [&](int64_t idx) {
       auto ck_1 = c[idx] >> (k - 1);
 
       U y;
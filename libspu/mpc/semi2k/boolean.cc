@@ -124,8 +124,8 @@ NdArrayRef AndBP::proc(KernelEvalContext* ctx, const NdArrayRef& lhs,
     NdArrayView<ring2k_t> _rhs(rhs);
     NdArrayView<ring2k_t> _out(out);
 
-    pforeach(0, lhs.numel(),
-             [&](int64_t idx) { _out[idx] = _lhs[idx] & _rhs[idx]; });
+    SPU_PFOREACH(0, lhs.numel(), 1,
+                 [&](int64_t idx) { _out[idx] = _lhs[idx] & _rhs[idx]; });
   });
   return out;
 }
@@ -166,7 +166,7 @@ NdArrayRef AndBB::proc(KernelEvalContext* ctx, const NdArrayRef& lhs,
 
       // first half mask x^a, second half mask y^b.
       std::vector<V> mask(numel * 2, 0);
-      pforeach(0, numel, [&](int64_t idx) {
+      SPU_PFOREACH(0, numel, 1, [&](int64_t idx) {
         mask[idx] = _lhs[idx] ^ _a[idx];
         mask[numel + idx] = _rhs[idx] ^ _b[idx];
       });
@@ -175,7 +175,7 @@ NdArrayRef AndBB::proc(KernelEvalContext* ctx, const NdArrayRef& lhs,
 
       // Zi = Ci ^ ((X ^ A) & Bi) ^ ((Y ^ B) & Ai) ^ <(X ^ A) & (Y ^ B)>
       NdArrayView<T> _z(out);
-      pforeach(0, numel, [&](int64_t idx) {
+      SPU_PFOREACH(0, numel, 1, [&](int64_t idx) {
         _z[idx] = _c[idx];
         _z[idx] ^= mask[idx] & _b[idx];
         _z[idx] ^= mask[numel + idx] & _a[idx];
@@ -272,7 +272,7 @@ NdArrayRef BitIntlB::proc(KernelEvalContext*, const NdArrayRef& in,
     NdArrayView<ring2k_t> _in(in);
     NdArrayView<ring2k_t> _out(out);
 
-    pforeach(0, numel, [&](int64_t idx) {
+    SPU_PFOREACH(0, numel, 1, [&](int64_t idx) {
       _out[idx] = BitIntl<ring2k_t>(_in[idx], stride, nbits);
     });
   });
@@ -293,7 +293,7 @@ NdArrayRef BitDeintlB::proc(KernelEvalContext*, const NdArrayRef& in,
     NdArrayView<ring2k_t> _in(in);
     NdArrayView<ring2k_t> _out(out);
 
-    pforeach(0, numel, [&](int64_t idx) {
+    SPU_PFOREACH(0, numel, 1, [&](int64_t idx) {
       _out[idx] = BitDeintl<ring2k_t>(_in[idx], stride, nbits);
     });
   });
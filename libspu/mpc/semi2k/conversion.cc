@@ -121,7 +121,7 @@ NdArrayRef B2A_Randbit::proc(KernelEvalContext* ctx,
     // Ref: III.D @ https://eprint.iacr.org/2019/599.pdf (SPDZ-2K primitives)
     std::vector<U> x_xor_r(numel);
 
-    pforeach(0, numel, [&](int64_t idx) {
+    SPU_PFOREACH(0, numel, 1, [&](int64_t idx) {
       // use _r[i*nbits, (i+1)*nbits) to construct rb[i]
       U mask = 0;
       for (int64_t bit = 0; bit < nbits; ++bit) {
@@ -134,7 +134,7 @@ NdArrayRef B2A_Randbit::proc(KernelEvalContext* ctx,
     x_xor_r = comm->allReduce<U, std::bit_xor>(x_xor_r, "open(x^r)");
 
     NdArrayView<U> _res(res);
-    pforeach(0, numel, [&](int64_t idx) {
+    SPU_PFOREACH(0, numel, 1, [&](int64_t idx) {
       _res[idx] = 0;
       for (int64_t bit = 0; bit < nbits; bit++) {
         auto c_i = (x_xor_r[idx] >> bit) & 0x1;
@@ -248,7 +248,8 @@ NdArrayRef eqz(KernelEvalContext* ctx, const NdArrayRef& in) {
     // 1 bit info in lsb
     NdArrayView<el_t> _out(out);
     NdArrayView<el_t> _round_out(round_out);
-    pforeach(0, numel, [&](int64_t idx) { _out[idx] = _round_out[idx] & 1; });
+    SPU_PFOREACH(0, numel, 1,
+                 [&](int64_t idx) { _out[idx] = _round_out[idx] & 1; });
   });
 
   return out;
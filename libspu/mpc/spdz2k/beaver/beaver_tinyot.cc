@@ -72,7 +72,7 @@ NdArrayRef ring_sqrt2k(const NdArrayRef& x, size_t bits = 0) {
     using U = std::make_unsigned<ring2k_t>::type;
     NdArrayView<U> _ret(ret);
     NdArrayView<U> _x(x);
-    yacl::parallel_for(0, numel, 4096, [&](int64_t beg, int64_t end) {
+    pforeach(0, numel, 4096, [&](int64_t beg, int64_t end) {
       for (int64_t idx = beg; idx < end; ++idx) {
         _ret[idx] = Sqrt2k(_x[idx], bits);
       }
@@ -105,7 +105,7 @@ NdArrayRef ring_inv2k(const NdArrayRef& x, size_t bits = 0) {
     using U = std::make_unsigned<ring2k_t>::type;
     NdArrayView<U> _ret(ret);
     NdArrayView<U> _x(x);
-    yacl::parallel_for(0, numel, 4096, [&](int64_t beg, int64_t end) {
+    pforeach(0, numel, 4096, [&](int64_t beg, int64_t end) {
       for (int64_t idx = beg; idx < end; ++idx) {
         _ret[idx] = Invert2k(_x[idx], bits);
       }
@@ -120,7 +120,7 @@ std::vector<bool> ring_cast_vector_boolean(const NdArrayRef& x) {
   std::vector<bool> res(x.numel());
   DISPATCH_ALL_FIELDS(field, "RingOps", [&]() {
     NdArrayView<ring2k_t> _x(x);
-    yacl::parallel_for(0, x.numel(), 4096, [&](size_t start, size_t end) {
+    pforeach(0, x.numel(), 4096, [&](size_t start, size_t end) {
       for (size_t i = start; i < end; i++) {
         res[i] = static_cast<bool>(_x[i] & 0x1);
       }
@@ -351,7 +351,7 @@ BeaverTinyOt::Triple_Pair BeaverTinyOt::AuthAnd(FieldType field,
     auto _size = auth_abcr.choices.size();
     NdArrayView<U> _spdz_choices(spdz_choices);
     // copy authbit choices
-    yacl::parallel_for(0, _size, 4096, [&](int64_t beg, int64_t end) {
+    pforeach(0, _size, 4096, [&](int64_t beg, int64_t end) {
       for (int64_t idx = beg; idx < end; ++idx) {
         _spdz_choices[idx] = auth_abcr.choices[idx];
       }
@@ -42,17 +42,18 @@ constexpr char kModule[] = "RingOps";
   SPU_ENFORCE((lhs).shape() == (rhs).shape(),                                  \
               "numel mismatch, lhs={}, rhs={}", lhs, rhs);
 
-#define DEF_UNARY_RING_OP(NAME, OP)                                     \
-  void NAME##_impl(NdArrayRef& ret, const NdArrayRef& x) {              \
-    ENFORCE_EQ_ELSIZE_AND_SHAPE(ret, x);                                \
-    const auto field = x.eltype().as<Ring2k>()->field();                \
-    const int64_t numel = ret.numel();                                  \
-    return DISPATCH_ALL_FIELDS(field, kModule, [&]() {                  \
-      using T = std::make_signed_t<ring2k_t>;                           \
-      NdArrayView<T> _x(x);                                             \
-      NdArrayView<T> _ret(ret);                                         \
-      pforeach(0, numel, [&](int64_t idx) { _ret[idx] = OP _x[idx]; }); \
-    });                                                                 \
+#define DEF_UNARY_RING_OP(NAME, OP)                               \
+  void NAME##_impl(NdArrayRef& ret, const NdArrayRef& x) {        \
+    ENFORCE_EQ_ELSIZE_AND_SHAPE(ret, x);                          \
+    const auto field = x.eltype().as<Ring2k>()->field();          \
+    const int64_t numel = ret.numel();                            \
+    return DISPATCH_ALL_FIELDS(field, kModule, [&]() {            \
+      using T = std::make_signed_t<ring2k_t>;                     \
+      NdArrayView<T> _x(x);                                       \
+      NdArrayView<T> _ret(ret);                                   \
+      SPU_PFOREACH(0, numel, 1,                                   \
+                   [&](int64_t idx) { _ret[idx] = OP _x[idx]; }); \
+    });                                                           \
   }
 
 DEF_UNARY_RING_OP(ring_not, ~);
@@ -60,29 +61,31 @@ DEF_UNARY_RING_OP(ring_neg, -);
 
 #undef DEF_UNARY_RING_OP
 
-#define DEF_BINARY_RING_OP(NAME, OP)                                  \
-  void NAME##_impl(NdArrayRef& ret, const NdArrayRef& x,              \
-                   const NdArrayRef& y) {                             \
-    ENFORCE_EQ_ELSIZE_AND_SHAPE(ret, x);                              \
-    ENFORCE_EQ_ELSIZE_AND_SHAPE(ret, y);                              \
-    const auto field = x.eltype().as<Ring2k>()->field();              \
-    const int64_t numel = ret.numel();                                \
-    return DISPATCH_ALL_FIELDS(field, kModule, [&]() {                \
-      NdArrayView<ring2k_t> _x(x);                                    \
-      NdArrayView<ring2k_t> _y(y);                                    \
-      NdArrayView<ring2k_t> _ret(ret);                                \
-      pforeach(0, numel,                                              \
-               [&](int64_t idx) { _ret[idx] = _x[idx] OP _y[idx]; }); \
-    });                                                               \
+// COST is the initial estimate of one element in 64-bit adds, the grain size
+// of each op is then tuned from measurements, see SPU_PFOREACH.
+#define DEF_BINARY_RING_OP(NAME, OP, COST)                                \
+  void NAME##_impl(NdArrayRef& ret, const NdArrayRef& x,                  \
+                   const NdArrayRef& y) {                                 \
+    ENFORCE_EQ_ELSIZE_AND_SHAPE(ret, x);                                  \
+    ENFORCE_EQ_ELSIZE_AND_SHAPE(ret, y);                                  \
+    const auto field = x.eltype().as<Ring2k>()->field();                  \
+    const int64_t numel = ret.numel();                                    \
+    return DISPATCH_ALL_FIELDS(field, kModule, [&]() {                    \
+      NdArrayView<ring2k_t> _x(x);                                        \
+      NdArrayView<ring2k_t> _y(y);                                        \
+      NdArrayView<ring2k_t> _ret(ret);                                    \
+      SPU_PFOREACH(0, numel, COST,                                        \
+                   [&](int64_t idx) { _ret[idx] = _x[idx] OP _y[idx]; }); \
+    });                                                                   \
   }
 
-DEF_BINARY_RING_OP(ring_add, +)
-DEF_BINARY_RING_OP(ring_sub, -)
-DEF_BINARY_RING_OP(ring_mul, *)
-DEF_BINARY_RING_OP(ring_equal, ==)
+DEF_BINARY_RING_OP(ring_add, +, 1)
+DEF_BINARY_RING_OP(ring_sub, -, 1)
+DEF_BINARY_RING_OP(ring_mul, *, sizeof(ring2k_t) > 8 ? 4 : 1)
+DEF_BINARY_RING_OP(ring_equal, ==, 1)
 
-DEF_BINARY_RING_OP(ring_and, &);
-DEF_BINARY_RING_OP(ring_xor, ^);
+DEF_BINARY_RING_OP(ring_and, &, 1);
+DEF_BINARY_RING_OP(ring_xor, ^, 1);
 
 #undef DEF_BINARY_RING_OP
 
@@ -96,7 +99,8 @@ void ring_arshift_impl(NdArrayRef& ret, const NdArrayRef& x, size_t bits) {
     using S = std::make_signed<ring2k_t>::type;
     NdArrayView<S> _ret(ret);
     NdArrayView<S> _x(x);
-    pforeach(0, numel, [&](int64_t idx) { _ret[idx] = _x[idx] >> bits; });
+    SPU_PFOREACH(0, numel, 1,
+                 [&](int64_t idx) { _ret[idx] = _x[idx] >> bits; });
   });
 }
 
@@ -108,7 +112,8 @@ void ring_rshift_impl(NdArrayRef& ret, const NdArrayRef& x, size_t bits) {
     using U = ring2k_t;
     NdArrayView<U> _ret(ret);
     NdArrayView<U> _x(x);
-    pforeach(0, numel, [&](int64_t idx) { _ret[idx] = _x[idx] >> bits; });
+    SPU_PFOREACH(0, numel, 1,
+                 [&](int64_t idx) { _ret[idx] = _x[idx] >> bits; });
   });
 }
 
@@ -119,7 +124,8 @@ void ring_lshift_impl(NdArrayRef& ret, const NdArrayRef& x, size_t bits) {
   return DISPATCH_ALL_FIELDS(field, kModule, [&]() {
     NdArrayView<ring2k_t> _ret(ret);
     NdArrayView<ring2k_t> _x(x);
-    pforeach(0, numel, [&](int64_t idx) { _ret[idx] = _x[idx] << bits; });
+    SPU_PFOREACH(0, numel, 1,
+                 [&](int64_t idx) { _ret[idx] = _x[idx] << bits; });
   });
 }
 
@@ -148,7 +154,8 @@ void ring_bitrev_impl(NdArrayRef& ret, const NdArrayRef& x, size_t start,
 
     NdArrayView<U> _ret(ret);
     NdArrayView<U> _x(x);
-    pforeach(0, numel, [&](int64_t idx) { _ret[idx] = bitrev_fn(_x[idx]); });
+    SPU_PFOREACH(0, numel, 16,
+                 [&](int64_t idx) { _ret[idx] = bitrev_fn(_x[idx]); });
   });
 }
 
@@ -173,7 +180,8 @@ void ring_bitmask_impl(NdArrayRef& ret, const NdArrayRef& x, size_t low,
 
     NdArrayView<U> _ret(ret);
     NdArrayView<U> _x(x);
-    pforeach(0, numel, [&](int64_t idx) { _ret[idx] = mark_fn(_x[idx]); });
+    SPU_PFOREACH(0, numel, 1,
+                 [&](int64_t idx) { _ret[idx] = mark_fn(_x[idx]); });
   });
 }
 
@@ -253,7 +261,7 @@ void ring_assign(NdArrayRef& x, const NdArrayRef& y) {
   return DISPATCH_ALL_FIELDS(field, kModule, [&]() {
     NdArrayView<ring2k_t> _y(y);
     NdArrayView<ring2k_t> _x(x);
-    pforeach(0, numel, [&](int64_t idx) { _x[idx] = _y[idx]; });
+    SPU_PFOREACH(0, numel, 1, [&](int64_t idx) { _x[idx] = _y[idx]; });
   });
 }
 
@@ -263,7 +271,7 @@ NdArrayRef ring_zeros(FieldType field, const Shape& shape) {
 
   return DISPATCH_ALL_FIELDS(field, kModule, [&]() {
     NdArrayView<ring2k_t> _ret(ret);
-    pforeach(0, numel, [&](int64_t idx) { _ret[idx] = ring2k_t(0); });
+    SPU_PFOREACH(0, numel, 1, [&](int64_t idx) { _ret[idx] = ring2k_t(0); });
     return ret;
   });
 }
@@ -274,7 +282,7 @@ NdArrayRef ring_ones(FieldType field, const Shape& shape) {
 
   return DISPATCH_ALL_FIELDS(field, kModule, [&]() {
     NdArrayView<ring2k_t> _ret(ret);
-    pforeach(0, numel, [&](int64_t idx) { _ret[idx] = ring2k_t(1); });
+    SPU_PFOREACH(0, numel, 1, [&](int64_t idx) { _ret[idx] = ring2k_t(1); });
     return ret;
   });
 }
@@ -345,7 +353,8 @@ void ring_mul_impl(NdArrayRef& ret, const NdArrayRef& x, uint128_t y) {
     using U = std::make_unsigned<ring2k_t>::type;
     NdArrayView<U> _x(x);
     NdArrayView<U> _ret(ret);
-    pforeach(0, numel, [&](int64_t idx) { _ret[idx] = _x[idx] * y; });
+    SPU_PFOREACH(0, numel, sizeof(ring2k_t) > 8 ? 4 : 1,
+                 [&](int64_t idx) { _ret[idx] = _x[idx] * y; });
   });
 }
 
@@ -531,7 +540,7 @@ std::vector<uint8_t> ring_cast_boolean(const NdArrayRef& x) {
 
   DISPATCH_ALL_FIELDS(field, kModule, [&]() {
     NdArrayView<ring2k_t> _x(x);
-    pforeach(0, numel, [&](int64_t idx) {
+    SPU_PFOREACH(0, numel, 1, [&](int64_t idx) {
       res[idx] = static_cast<uint8_t>(_x[idx] & 0x1);
     });
   });
@@ -554,8 +563,8 @@ NdArrayRef ring_select(const std::vector<uint8_t>& c, const NdArrayRef& x,
     NdArrayView<ring2k_t> _y(y);
     NdArrayView<ring2k_t> _z(z);
 
-    pforeach(0, numel,
-             [&](int64_t idx) { _z[idx] = (c[idx] ? _y[idx] : _x[idx]); });
+    SPU_PFOREACH(0, numel, 1,
+                 [&](int64_t idx) { _z[idx] = (c[idx] ? _y[idx] : _x[idx]); });
   });
 
   return z;
@@ -64,8 +64,46 @@ static void BM_RingAdd_(benchmark::State& state) {  // NOLINT
   }
 }
 
+// Mid-size tensors, where the grain size decides how many threads are used.
+static void makeMidSizeArgs(benchmark::internal::Benchmark* b) {
+  b->ArgsProduct({
+      benchmark::CreateRange(1 << 10, 1 << 20, /*multi=*/4),  // numel
+      {1},                                                    // stride
+      {FM64, FM128},                                          // field
+  });
+  b->UseRealTime();
+}
+
+static void BM_RingMul(benchmark::State& state) {
+  const int64_t numel = state.range(0);
+  const int64_t stride = state.range(1);
+  const auto field = static_cast<spu::FieldType>(state.range(2));
+
+  const auto x = makeRandomArray(field, numel, stride);
+  const auto y = makeRandomArray(field, numel, stride);
+
+  for (auto _ : state) {
+    ring_mul(x, y);
+  }
+}
+
+static void BM_RingBitrev(benchmark::State& state) {
+  const int64_t numel = state.range(0);
+  const int64_t stride = state.range(1);
+  const auto field = static_cast<spu::FieldType>(state.range(2));
+
+  const auto x = makeRandomArray(field, numel, stride);
+
+  for (auto _ : state) {
+    ring_bitrev(x, 0, SizeOf(field) * 8);
+  }
+}
+
 BENCHMARK(BM_RingAdd)->Apply(makeUnaryArgs);
 BENCHMARK(BM_RingAdd_)->Apply(makeUnaryArgs);
+BENCHMARK(BM_RingAdd)->Apply(makeMidSizeArgs);
+BENCHMARK(BM_RingMul)->Apply(makeMidSizeArgs);
+BENCHMARK(BM_RingBitrev)->Apply(makeMidSizeArgs);
 
 }  // namespace spu::mpc::utils
 
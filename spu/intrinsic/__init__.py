@@ -16,14 +16,18 @@ from .example_binary_impl import example_binary
 from .example_impl import example
 
 # DO-NOT-EDIT:ADD_IMPORT
+from .spu_fxp_bits_impl import spu_fxp_bits
 from .spu_gelu_impl import spu_gelu
 from .spu_nexp_impl import spu_neg_exp
 from .spu_silu_impl import spu_silu
+from .spu_spline_impl import spu_spline
 
 __all__ = [
     "spu_gelu",
     "spu_silu",
     "spu_neg_exp",
+    "spu_fxp_bits",
+    "spu_spline",
     # "example",
     # "example_binary",
     # DO-NOT-EDIT:EOL
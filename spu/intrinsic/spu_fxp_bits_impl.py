@@ -0,0 +1,107 @@
+# Copyright 2024 Ant Group Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+__all__ = ["spu_fxp_bits"]
+
+from functools import partial
+
+from jax import core, dtypes
+from jax.core import ShapedArray
+from jax.interpreters import ad, batching, mlir, xla
+from jaxlib.hlo_helpers import custom_call
+
+
+# Public facing interface
+def spu_fxp_bits(input, fxp_bits):
+    """Rescales a fixed-point value to `fxp_bits` fraction bits.
+
+    The value itself is unchanged, following add/sub/mul/dot ops keep the new
+    scale, other ops and the program outputs use the runtime default again.
+    """
+    return _spu_fxp_bits_prim.bind(input, fxp_bits=int(fxp_bits))
+
+
+# *********************************
+# *  SUPPORT FOR JIT COMPILATION  *
+# *********************************
+
+
+# For JIT compilation we need a function to evaluate the shape and dtype of the
+# outputs of our op for some given inputs
+def _spu_fxp_bits_abstract(input, *, fxp_bits):
+    shape = input.shape
+    dtype = dtypes.canonicalize_dtype(input.dtype)
+    return ShapedArray(shape, dtype)
+
+
+# We also need a lowering rule to provide an MLIR "lowering" of out primitive.
+def _spu_fxp_bits_lowering(ctx, input, *, fxp_bits):
+    # The inputs and outputs all have the same shape and memory layout
+    # so let's predefine this specification
+    dtype = mlir.ir.RankedTensorType(input.type)
+
+    # The scale is passed as `mhlo.attributes`, which is kept by the compiler.
+    attrs = mlir.ir.DictAttr.get(
+        {
+            "fxp_bits": mlir.ir.IntegerAttr.get(
+                mlir.ir.IntegerType.get_signless(64), fxp_bits
+            )
+        }
+    )
+
+    call = custom_call(
+        "spu.fxp_bits",
+        # Output types
+        result_types=[dtype],
+        # The inputs:
+        operands=[input],
+        extra_attributes={"mhlo.attributes": attrs},
+    )
+
+    return call.results
+
+
+# **********************************
+# *  SUPPORT FOR FORWARD AUTODIFF  *
+# **********************************
+
+
+# Rescaling does not change the value, so does the tangent.
+def _spu_fxp_bits_jvp(args, tangents, *, fxp_bits):
+    return spu_fxp_bits(args[0], fxp_bits), tangents[0]
+
+
+# ************************************
+# *  SUPPORT FOR BATCHING WITH VMAP  *
+# ************************************
+
+
+# The op is element-wise, the batch axis is unchanged.
+def _spu_fxp_bits_batch(args, axes, *, fxp_bits):
+    return spu_fxp_bits(args[0], fxp_bits), axes[0]
+
+
+# *********************************************
+# *  BOILERPLATE TO REGISTER THE OP WITH JAX  *
+# *********************************************
+_spu_fxp_bits_prim = core.Primitive("spu_fxp_bits")
+_spu_fxp_bits_prim.multiple_results = False
+_spu_fxp_bits_prim.def_impl(partial(xla.apply_primitive, _spu_fxp_bits_prim))
+_spu_fxp_bits_prim.def_abstract_eval(_spu_fxp_bits_abstract)
+
+mlir.register_lowering(_spu_fxp_bits_prim, _spu_fxp_bits_lowering)
+
+# Connect the JVP and batching rules
+ad.primitive_jvps[_spu_fxp_bits_prim] = _spu_fxp_bits_jvp
+batching.primitive_batchers[_spu_fxp_bits_prim] = _spu_fxp_bits_batch
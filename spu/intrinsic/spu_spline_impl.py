@@ -0,0 +1,122 @@
+# Copyright 2024 Ant Group Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+__all__ = ["spu_spline"]
+
+import json
+from functools import partial
+
+from jax import core, dtypes
+from jax.core import ShapedArray
+from jax.interpreters import ad, batching, mlir, xla
+from jaxlib.hlo_helpers import custom_call
+
+
+# Public facing interface
+def spu_spline(input, breakpoints, segments):
+    """Evaluates a piecewise polynomial element-wise.
+
+    With n sorted breakpoints b_0 < ... < b_{n-1}, segments holds the n + 1
+    coefficient lists of (-inf, b_0), [b_0, b_1), ..., [b_{n-1}, +inf), each
+    from the lowest degree, e.g. relu is spu_spline(x, [0], [[], [0, 1]]).
+    """
+    breakpoints = tuple(float(b) for b in breakpoints)
+    segments = tuple(tuple(float(c) for c in coeffs) for coeffs in segments)
+    if len(segments) != len(breakpoints) + 1:
+        raise ValueError(
+            f"expect {len(breakpoints) + 1} segments, got {len(segments)}"
+        )
+    return _spu_spline_prim.bind(
+        input, breakpoints=breakpoints, segments=segments
+    )
+
+
+# *********************************
+# *  SUPPORT FOR JIT COMPILATION  *
+# *********************************
+
+
+# For JIT compilation we need a function to evaluate the shape and dtype of the
+# outputs of our op for some given inputs
+def _spu_spline_abstract(input, *, breakpoints, segments):
+    shape = input.shape
+    dtype = dtypes.canonicalize_dtype(input.dtype)
+    return ShapedArray(shape, dtype)
+
+
+# We also need a lowering rule to provide an MLIR "lowering" of out primitive.
+def _spu_spline_lowering(ctx, input, *, breakpoints, segments):
+    # The inputs and outputs all have the same shape and memory layout
+    # so let's predefine this specification
+    dtype = mlir.ir.RankedTensorType(input.type)
+
+    # The JSON form of SplineSpec, passed in `mhlo.attributes`.
+    spec = json.dumps(
+        {
+            "breakpoints": list(breakpoints),
+            "segments": [{"coeffs": list(coeffs)} for coeffs in segments],
+        }
+    )
+    attrs = mlir.ir.DictAttr.get({"spec": mlir.ir.StringAttr.get(spec)})
+
+    call = custom_call(
+        "spu.spline",
+        # Output types
+        result_types=[dtype],
+        # The inputs:
+        operands=[input],
+        extra_attributes={"mhlo.attributes": attrs},
+    )
+
+    return call.results
+
+
+# **********************************
+# *  SUPPORT FOR FORWARD AUTODIFF  *
+# **********************************
+
+
+# The derivative of a spline is the spline of the derived polynomials.
+def _spu_spline_jvp(args, tangents, *, breakpoints, segments):
+    derived = tuple(
+        tuple(k * c for k, c in enumerate(coeffs) if k > 0) for coeffs in segments
+    )
+    primal = spu_spline(args[0], breakpoints, segments)
+    tangent = spu_spline(args[0], breakpoints, derived) * tangents[0]
+    return primal, tangent
+
+
+# ************************************
+# *  SUPPORT FOR BATCHING WITH VMAP  *
+# ************************************
+
+
+# The op is element-wise, the batch axis is unchanged.
+def _spu_spline_batch(args, axes, *, breakpoints, segments):
+    return spu_spline(args[0], breakpoints, segments), axes[0]
+
+
+# *********************************************
+# *  BOILERPLATE TO REGISTER THE OP WITH JAX  *
+# *********************************************
+_spu_spline_prim = core.Primitive("spu_spline")
+_spu_spline_prim.multiple_results = False
+_spu_spline_prim.def_impl(partial(xla.apply_primitive, _spu_spline_prim))
+_spu_spline_prim.def_abstract_eval(_spu_spline_abstract)
+
+mlir.register_lowering(_spu_spline_prim, _spu_spline_lowering)
+
+# Connect the JVP and batching rules
+ad.primitive_jvps[_spu_spline_prim] = _spu_spline_jvp
+batching.primitive_batchers[_spu_spline_prim] = _spu_spline_batch
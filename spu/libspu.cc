@@ -401,6 +401,7 @@ class RuntimeWrapper {
   FN("uint32", PT_U32)     \
   FN("uint64", PT_U64)     \
   FN("float16", PT_F16)    \
+  FN("bfloat16", PT_BF16)  \
   FN("float32", PT_F32)    \
   FN("float64", PT_F64)    \
   FN("bool", PT_I1)        \